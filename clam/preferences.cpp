@@ -70,8 +70,6 @@ void Preferences::on_saveButton_clicked() {
     params.Set("AGG_DS",ui->downSampleEdit->text().toInt());
     params.Set("COMPUTE_HOG",(int)ui->hogOnCheckBox->isChecked());
     params.Set("KEYFRAME_RATE",ui->kfrSpinBox->value());
-    params.Set("CGLS_NITER",ui->cglsNiterSpinBox->value());
-    params.Set("CGLS_EPS",ui->cglsEpsEdit->text().toDouble());
     params.Set("LM_NITER_OUTER",ui->lmNiterOuterSpinBox->value());
     params.Set("LM_NITER_INNER",ui->lmNiterInnerSpinBox->value());
     params.Set("LM_EPS",ui->lmEpsEdit->text().toDouble());
@@ -132,8 +130,6 @@ void Preferences::on_loadButton_clicked() {
     ui->downSampleEdit->setText(QString::number(params.GetIntParameter("AGG_DS")));
     ui->hogOnCheckBox->setChecked((bool)params.GetIntParameter("COMPUTE_HOG"));
     ui->kfrSpinBox->setValue(params.GetIntParameter("KEYFRAME_RATE"));
-    ui->cglsNiterSpinBox->setValue(params.GetIntParameter("CGLS_NITER"));
-    ui->cglsEpsEdit->setText(QString::number(params.GetDoubleParameter("CGLS_EPS")));
     ui->lmNiterOuterSpinBox->setValue(params.GetIntParameter("LM_NITER_OUTER"));
     ui->lmNiterInnerSpinBox->setValue(params.GetIntParameter("LM_NITER_INNER"));
     ui->lmEpsEdit->setText(QString::number(params.GetDoubleParameter("LM_EPS")));
@@ -185,8 +181,6 @@ void Preferences::on_applyButton_clicked() {
     params.Set("AGG_DS",ui->downSampleEdit->text().toInt());
     params.Set("COMPUTE_HOG",(int)ui->hogOnCheckBox->isChecked());
     params.Set("KEYFRAME_RATE",ui->kfrSpinBox->value());
-    params.Set("CGLS_NITER",ui->cglsNiterSpinBox->value());
-    params.Set("CGLS_EPS",ui->cglsEpsEdit->text().toDouble());
     params.Set("LM_NITER_OUTER",ui->lmNiterOuterSpinBox->value());
     params.Set("LM_NITER_INNER",ui->lmNiterInnerSpinBox->value());
     params.Set("LM_EPS",ui->lmEpsEdit->text().toDouble());
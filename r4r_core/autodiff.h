@@ -0,0 +1,176 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef R4RAUTODIFF_H_
+#define R4RAUTODIFF_H_
+
+#include "lm.h"
+#include "dual.h"
+
+namespace R4R {
+
+/*! \brief least-squares problem with Jacobian by automatic differentiation
+ *
+ * Turns a functor which evaluates blocks of \f$R\f$ residuals, each depending on \f$N\f$ model
+ * parameters, into a CLeastSquaresProblem. The Jacobian is obtained by evaluating the functor
+ * on dual numbers CDual<T,N>, and its sparse structure follows from the parameter indices. The
+ * functor must provide
+ *
+ * \code
+ * // indices of the N model parameters that the i-th block depends on
+ * void GetParameterIndices(size_t i, size_t* indices) const;
+ *
+ * // R residuals of the i-th block from the values of its parameters
+ * template<typename U> void operator()(size_t i, const U* x, U* r) const;
+ * \endcode
+ *
+ * Blocks are evaluated independently by row ranges, so CLevenbergMarquardt distributes them
+ * over all threads. The functor hence must be safe to call concurrently.
+ *
+ */
+template<class Functor,typename T,u_int R,u_int N>
+class CAutoDiffLeastSquaresProblem:public CLeastSquaresProblem<CCSRMatrix<T>,T> {
+
+public:
+
+    /*! \brief Constructor.
+     *
+     * \param[in] f residual functor
+     * \param[in] nblocks number of residual blocks
+     * \param[in] noparams number of model parameters
+     *
+     */
+    CAutoDiffLeastSquaresProblem(const Functor& f, size_t nblocks, size_t noparams):
+        CLeastSquaresProblem<CCSRMatrix<T>,T>::CLeastSquaresProblem(nblocks*R,noparams),
+        m_functor(f) {}
+
+    //! Access to the functor.
+    const Functor& GetFunctor() const { return m_functor; }
+
+    //! \copydoc CLeastSquaresProblem::ComputeResidualAndJacobian(CDenseVector<T>&,Matrix&)
+    void ComputeResidualAndJacobian(CDenseVector<T>& r, CCSRMatrix<T>& J) const {
+
+        this->PrepareJacobian(J);
+        ComputeResidualAndJacobian(0,m_nopts,r,J);
+
+    }
+
+    //! \copydoc CLeastSquaresProblem::ComputeResidual(CDenseVector<T>&)
+    void ComputeResidual(CDenseVector<T>& r) const { ComputeResidual(0,m_nopts,r); }
+
+    //! \copydoc CLeastSquaresProblem::ComputeResidualAndJacobian(size_t,size_t,CDenseVector<T>&,Matrix&)
+    bool ComputeResidualAndJacobian(size_t begin, size_t end, CDenseVector<T>& r, CCSRMatrix<T>& J) const {
+
+        size_t* cols = J.GetCols()->data();
+        T* vals = J.GetValues()->data();
+        const T* model = m_model.Data().get();
+
+        size_t indices[N];
+        CDual<T,N> x[N];
+        CDual<T,N> res[R];
+
+        for(size_t i=begin/R; i*R<end; i++) {
+
+            // seed the parameters of the block
+            m_functor.GetParameterIndices(i,indices);
+
+            for(u_int j=0; j<N; j++)
+                x[j] = CDual<T,N>(model[indices[j]],j);
+
+            m_functor(i,x,res);
+
+            for(u_int k=0; k<R; k++) {
+
+                size_t row = i*R + k;
+
+                if(row<begin || row>=end)
+                    continue;
+
+                // every row has exactly N entries
+                T w = m_weights.Get(row);
+                r(row) = w*res[k].Get();
+
+                for(u_int j=0; j<N; j++) {
+
+                    cols[row*N+j] = indices[j];
+                    vals[row*N+j] = w*res[k].GetDerivative(j);
+
+                }
+
+            }
+
+        }
+
+        return true;
+
+    }
+
+    //! \copydoc CLeastSquaresProblem::ComputeResidual(size_t,size_t,CDenseVector<T>&)
+    bool ComputeResidual(size_t begin, size_t end, CDenseVector<T>& r) const {
+
+        const T* model = m_model.Data().get();
+
+        size_t indices[N];
+        T x[N];
+        T res[R];
+
+        for(size_t i=begin/R; i*R<end; i++) {
+
+            m_functor.GetParameterIndices(i,indices);
+
+            for(u_int j=0; j<N; j++)
+                x[j] = model[indices[j]];
+
+            m_functor(i,x,res);
+
+            for(u_int k=0; k<R; k++) {
+
+                size_t row = i*R + k;
+
+                if(row>=begin && row<end)
+                    r(row) = res[k];
+
+            }
+
+        }
+
+        return true;
+
+    }
+
+    //! \copydoc CLeastSquaresProblem::GetJacobianRowLength(size_t)
+    size_t GetJacobianRowLength(size_t /*i*/) const { return N; }
+
+protected:
+
+    using CLeastSquaresProblem<CCSRMatrix<T>,T>::m_nopts;
+    using CLeastSquaresProblem<CCSRMatrix<T>,T>::m_model;
+    using CLeastSquaresProblem<CCSRMatrix<T>,T>::m_weights;
+
+    Functor m_functor;                  //!< residual functor
+
+};
+
+}
+
+#endif /* R4RAUTODIFF_H_ */
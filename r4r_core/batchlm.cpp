@@ -0,0 +1,351 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "batchlm.h"
+
+#include <math.h>
+#include <algorithm>
+#include <limits>
+
+using namespace std;
+
+namespace R4R {
+
+template<typename T>
+CBatchedLeastSquaresProblem<T>::CBatchedLeastSquaresProblem(size_t nproblems, size_t noparams):
+    m_nproblems(nproblems),
+    m_noparams(noparams),
+    m_model(nproblems,noparams) {
+
+}
+
+template class CBatchedLeastSquaresProblem<float>;
+template class CBatchedLeastSquaresProblem<double>;
+
+//! Index of the entry \f$(k,l)\f$, \f$k\geq l\f$, of a packed lower triangle.
+static inline size_t PackedIndex(size_t k, size_t l) { return k*(k+1)/2 + l; }
+
+/*! \brief Cholesky decomposition of a batch of packed matrices in place.
+ *
+ * Matrices which are not positive definite are flagged in \f$\mathrm{ok}\f$.
+ *
+ */
+template<typename T>
+static void BatchedCholesky(T* L, unsigned char* ok, size_t p, size_t n, size_t stride) {
+
+    for(size_t j=0; j<p; j++) {
+
+        T* ljj = L + PackedIndex(j,j)*stride;
+
+        for(size_t k=0; k<j; k++) {
+
+            const T* ljk = L + PackedIndex(j,k)*stride;
+
+            for(size_t i=0; i<n; i++)
+                ljj[i] -= ljk[i]*ljk[i];
+
+        }
+
+        // keep arithmetic finite for failed decompositions
+        for(size_t i=0; i<n; i++) {
+
+            if(!(ljj[i]>0)) {
+
+                ok[i] = 0;
+                ljj[i] = 1;
+
+            }
+
+            ljj[i] = sqrt(ljj[i]);
+
+        }
+
+        for(size_t l=j+1; l<p; l++) {
+
+            T* llj = L + PackedIndex(l,j)*stride;
+
+            for(size_t k=0; k<j; k++) {
+
+                const T* llk = L + PackedIndex(l,k)*stride;
+                const T* ljk = L + PackedIndex(j,k)*stride;
+
+                for(size_t i=0; i<n; i++)
+                    llj[i] -= llk[i]*ljk[i];
+
+            }
+
+            for(size_t i=0; i<n; i++)
+                llj[i] /= ljj[i];
+
+        }
+
+    }
+
+}
+
+//! Solves \f$LL^{\top}x=y\f$ for a batch of packed factors in the memory of \f$y\f$.
+template<typename T>
+static void BatchedCholeskySolve(const T* L, T* x, size_t p, size_t n, size_t stride) {
+
+    for(size_t j=0; j<p; j++) {
+
+        T* xj = x + j*stride;
+
+        for(size_t k=0; k<j; k++) {
+
+            const T* ljk = L + PackedIndex(j,k)*stride;
+            const T* xk = x + k*stride;
+
+            for(size_t i=0; i<n; i++)
+                xj[i] -= ljk[i]*xk[i];
+
+        }
+
+        const T* ljj = L + PackedIndex(j,j)*stride;
+
+        for(size_t i=0; i<n; i++)
+            xj[i] /= ljj[i];
+
+    }
+
+    for(size_t j=p; j-->0; ) {
+
+        T* xj = x + j*stride;
+
+        for(size_t l=j+1; l<p; l++) {
+
+            const T* llj = L + PackedIndex(l,j)*stride;
+            const T* xl = x + l*stride;
+
+            for(size_t i=0; i<n; i++)
+                xj[i] -= llj[i]*xl[i];
+
+        }
+
+        const T* ljj = L + PackedIndex(j,j)*stride;
+
+        for(size_t i=0; i<n; i++)
+            xj[i] /= ljj[i];
+
+    }
+
+}
+
+template<typename T>
+const size_t CBatchedLevenbergMarquardt<T>::m_chunk = 256;
+
+template<typename T>
+CBatchedLevenbergMarquardt<T>::CBatchedLevenbergMarquardt(CBatchedLeastSquaresProblem<T>& problem, T tau):
+    m_problem(problem),
+    m_tau(tau),
+    m_converged() {
+
+}
+
+template<typename T>
+CDenseVector<T> CBatchedLevenbergMarquardt<T>::Iterate(size_t n, T epsilon1, T epsilon2) {
+
+    size_t N = m_problem.GetNumberOfProblems();
+    size_t p = m_problem.GetNumberOfModelParameters();
+    size_t np = p*(p+1)/2;
+    size_t nchunks = (N + m_chunk - 1)/m_chunk;
+
+    T* model = m_problem.Get().Data().get();
+
+    CDenseVector<T> result(N);
+    T* presult = result.Data().get();
+
+    m_converged.assign(N,0);
+
+#pragma omp parallel if(nchunks>1)
+    {
+
+        const size_t s = m_chunk;
+
+        // chunk-local state, parameter j of problem i is at j*s+i
+        vector<T> x(p*s), xt(p*s), step(p*s), g(p*s), H(np*s), L(np*s);
+        vector<T> cost(s), costt(s), lambda(s), nu(s);
+        vector<unsigned char> active(s), ok(s);
+
+#pragma omp for schedule(dynamic)
+        for(size_t c=0; c<nchunks; c++) {
+
+            size_t begin = c*s;
+            size_t end = min(N,begin+s);
+            size_t nb = end - begin;
+
+            for(size_t j=0; j<p; j++)
+                copy(model+j*N+begin,model+j*N+end,x.begin()+j*s);
+
+            m_problem.ComputeNormalEquations(begin,end,s,x.data(),cost.data(),g.data(),H.data());
+
+            // initial damping and gradient test
+            size_t nactive = 0;
+
+            for(size_t i=0; i<nb; i++) {
+
+                T hmax = 0;
+                T gmax = 0;
+
+                for(size_t j=0; j<p; j++) {
+
+                    hmax = max(hmax,H[PackedIndex(j,j)*s+i]);
+                    gmax = max(gmax,T(fabs(g[j*s+i])));
+
+                }
+
+                lambda[i] = m_tau*hmax;
+                nu[i] = 2;
+                active[i] = gmax>=epsilon1;
+                m_converged[begin+i] = !active[i];
+                nactive += active[i];
+
+            }
+
+            for(size_t k=0; k<n && nactive>0; k++) {
+
+                // solve damped normal equations
+                copy(H.begin(),H.end(),L.begin());
+
+                for(size_t j=0; j<p; j++) {
+
+                    T* ljj = L.data() + PackedIndex(j,j)*s;
+
+                    for(size_t i=0; i<nb; i++)
+                        ljj[i] += lambda[i];
+
+                }
+
+                copy(active.begin(),active.end(),ok.begin());
+                BatchedCholesky(L.data(),ok.data(),p,nb,s);
+
+                copy(g.begin(),g.end(),step.begin());
+                BatchedCholeskySolve(L.data(),step.data(),p,nb,s);
+
+                for(size_t j=0; j<p*s; j++)
+                    xt[j] = x[j] - step[j];
+
+                m_problem.ComputeCost(begin,end,s,xt.data(),costt.data());
+
+                // acceptance test and damping update
+                bool accepted = false;
+                nactive = 0;
+
+                for(size_t i=0; i<nb; i++) {
+
+                    if(!active[i])
+                        continue;
+
+                    T normstep = 0;
+                    T normx = 0;
+                    T pred = 0;
+
+                    for(size_t j=0; j<p; j++) {
+
+                        T sj = step[j*s+i];
+                        normstep += sj*sj;
+                        normx += x[j*s+i]*x[j*s+i];
+                        pred += sj*(lambda[i]*sj + g[j*s+i]);
+
+                    }
+
+                    T rho = (cost[i] - costt[i])/pred;
+
+                    if(ok[i] && sqrt(normstep)<epsilon2*(sqrt(normx)+epsilon2)) {
+
+                        active[i] = 0;
+                        m_converged[begin+i] = 1;
+
+                    }
+                    else if(ok[i] && rho>0) {
+
+                        for(size_t j=0; j<p; j++)
+                            x[j*s+i] = xt[j*s+i];
+
+                        T r = 2*rho - 1;
+                        lambda[i] *= max(T(1.0/3.0),1-r*r*r);
+                        nu[i] = 2;
+                        accepted = true;
+
+                    }
+                    else {
+
+                        lambda[i] = lambda[i]>0 ? lambda[i]*nu[i] : numeric_limits<T>::epsilon();
+                        nu[i] *= 2;
+
+                        if(lambda[i]>numeric_limits<T>::max())
+                            active[i] = 0;
+
+                    }
+
+                    nactive += active[i];
+
+                }
+
+                // relinearize, rejected problems keep their normal equations
+                if(accepted) {
+
+                    m_problem.ComputeNormalEquations(begin,end,s,x.data(),cost.data(),g.data(),H.data());
+
+                    for(size_t i=0; i<nb; i++) {
+
+                        if(!active[i])
+                            continue;
+
+                        T gmax = 0;
+
+                        for(size_t j=0; j<p; j++)
+                            gmax = max(gmax,T(fabs(g[j*s+i])));
+
+                        if(gmax<epsilon1) {
+
+                            active[i] = 0;
+                            m_converged[begin+i] = 1;
+                            nactive--;
+
+                        }
+
+                    }
+
+                }
+
+            }
+
+            for(size_t j=0; j<p; j++)
+                copy(x.begin()+j*s,x.begin()+j*s+nb,model+j*N+begin);
+
+            for(size_t i=0; i<nb; i++)
+                presult[begin+i] = sqrt(cost[i]);
+
+        }
+
+    }
+
+    return result;
+
+}
+
+template class CBatchedLevenbergMarquardt<float>;
+template class CBatchedLevenbergMarquardt<double>;
+
+}
@@ -0,0 +1,136 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef R4RBATCHLM_H_
+#define R4RBATCHLM_H_
+
+#include <vector>
+
+#include "darray.h"
+
+namespace R4R {
+
+/*! \brief interface for a batch of small, independent least-squares problems of equal shape
+ *
+ * The model parameters of all problems are stored as structure of arrays, i.e., the \f$j\f$-th
+ * parameter of the \f$i\f$-th problem is at \f$(i,j)\f$ of the column-major array returned by
+ * Get(). All other quantities exchanged with CBatchedLevenbergMarquardt follow the same layout
+ * with a given stride \f$s\f$. In particular, the normal matrix \f$J^{\top}J\f$ is stored as
+ * packed lower triangle, its entry \f$(k,l)\f$, \f$k\geq l\f$, of the \f$i\f$-th problem in a
+ * range starting at \f$b\f$ is at position \f$(\frac{k(k+1)}{2}+l)s+i-b\f$.
+ *
+ */
+template<typename T>
+class CBatchedLeastSquaresProblem {
+
+public:
+
+    /*! \brief Constructor.
+     *
+     * \param[in] nproblems number of problems
+     * \param[in] noparams number of model parameters of each problem
+     *
+     */
+    CBatchedLeastSquaresProblem(size_t nproblems, size_t noparams);
+
+    /*! \brief Computes squared residual norm, gradient and normal matrix of the problems \f$[b,e)\f$.
+     *
+     * This is called concurrently for disjoint ranges.
+     *
+     * \param[in] begin first problem
+     * \param[in] end one past the last problem
+     * \param[in] stride stride between two parameters of a problem
+     * \param[in] x model parameters
+     * \param[out] cost squared residual norms \f$\|r\|^2\f$
+     * \param[out] g gradients \f$J^{\top}r\f$
+     * \param[out] H packed normal matrices \f$J^{\top}J\f$
+     *
+     */
+    virtual void ComputeNormalEquations(size_t begin, size_t end, size_t stride, const T* x, T* cost, T* g, T* H) const = 0;
+
+    //! Computes the squared residual norms of the problems \f$[b,e)\f$, cf. ComputeNormalEquations().
+    virtual void ComputeCost(size_t begin, size_t end, size_t stride, const T* x, T* cost) const = 0;
+
+    //! Access to the model parameters of all problems.
+    CDenseArray<T>& Get() { return m_model; }
+
+    //! Access to #m_nproblems.
+    size_t GetNumberOfProblems() const { return m_nproblems; }
+
+    //! Access to #m_noparams.
+    size_t GetNumberOfModelParameters() const { return m_noparams; }
+
+protected:
+
+    size_t m_nproblems;                         //!< number of problems
+    size_t m_noparams;                          //!< number of parameters per problem
+    CDenseArray<T> m_model;                     //!< model parameters, one column per parameter
+
+};
+
+/*! \brief Levenberg-Marquardt algorithm for a batch of independent problems
+ *
+ * Problems are processed in chunks whose data fits into the cache, concurrently over all
+ * threads. Within a chunk, the damped normal equations are solved by Cholesky decomposition,
+ * and damping, acceptance and convergence tests are applied to all problems at once, such that
+ * the inner loops run over problems and vectorize. Converged problems are masked out.
+ *
+ */
+template<typename T>
+class CBatchedLevenbergMarquardt {
+
+public:
+
+    /*! \brief Constructor.
+     *
+     * \param[in] problem batch of least-squares problems
+     * \param[in] tau initial damping relative to the largest diagonal entry of \f$J^{\top}J\f$
+     *
+     */
+    CBatchedLevenbergMarquardt(CBatchedLeastSquaresProblem<T>& problem, T tau = 1e-3);
+
+    /*! Triggers execution of Levenberg-Marquardt steps.
+     *
+     * \param[in] n maximum number of steps
+     * \param[in] epsilon1 bound on the gradient of the objective functional
+     * \param[in] epsilon2 bound on step size
+     * \returns residual norms of all problems
+     *
+     */
+    CDenseVector<T> Iterate(size_t n, T epsilon1, T epsilon2);
+
+    //! Flags which problems have met one of the convergence criteria in the last call of Iterate().
+    const std::vector<unsigned char>& GetConverged() const { return m_converged; }
+
+protected:
+
+    CBatchedLeastSquaresProblem<T>& m_problem;          //!< batch of problems
+    T m_tau;                                            //!< initial damping parameter weight
+    std::vector<unsigned char> m_converged;             //!< convergence flags
+    static const size_t m_chunk;                        //!< number of problems processed by one task
+
+};
+
+}
+
+#endif /* R4RBATCHLM_H_ */
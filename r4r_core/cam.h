@@ -138,6 +138,34 @@ public:
     //! \copydoc CAbstractCamera::Project(const CVector<T,3>&,CVector<T,2>&,CDenseArray<T>&) const
     void Project(const CVector<T,3>& x, CVector<T,2>& u, CDenseArray<T>& J) const;
 
+    /*! \brief Projects a point given in a different scalar type into the image plane.
+     *
+     * Same as Project(const CVector<T,3>&) const but for any scalar type U, e.g., CDual, which
+     * yields the exact Jacobian of the projection including lens distortion.
+     *
+     */
+    template<typename U> CVector<U,2> Project(const CVector<U,3>& x) const {
+
+        U xn0 = x.Get(0)/x.Get(2);
+        U xn1 = x.Get(1)/x.Get(2);
+
+        // radial and tangential distortion
+        U r2 = xn0*xn0 + xn1*xn1;
+        U dx0 = U(2*m_k[2])*xn0*xn1 + U(m_k[3])*(r2 + U(2)*xn0*xn0);
+        U dx1 = U(m_k[2])*(r2 + U(2)*xn1*xn1) + U(2*m_k[3])*xn0*xn1;
+        U fac = U(1) + U(m_k[0])*r2 + U(m_k[1])*r2*r2 + U(m_k[4])*r2*r2*r2;
+        U xd0 = xn0*fac + dx0;
+        U xd1 = xn1*fac + dx1;
+
+        // transform to pixel coordinates
+        CVector<U,2> xp;
+        xp(0) = U(m_f[0])*(xd0 + U(m_alpha)*xd1) + U(m_c[0]);
+        xp(1) = U(m_f[1])*xd1 + U(m_c[1]);
+
+        return xp;
+
+    }
+
     //! \copydoc CAbstractCamera::Normalize(const CVector<T,2>&)
     CVector<T,3> Normalize(const CVector<T,2>& u) const;
 
@@ -1529,6 +1529,30 @@ CDenseVector<T> CDenseArray<T>::operator*(const CDenseVector<T>& vector) const {
 
 }
 
+template <typename T>
+void CDenseArray<T>::Multiply(const CDenseArray<T>& x, CDenseArray<T>& y) const {
+
+    assert(m_ncols==x.m_nrows && m_nrows==y.m_nrows && x.m_ncols==y.m_ncols && !y.m_transpose);
+
+    T* py = y.m_data.get();
+
+    for(size_t j=0; j<x.m_ncols; j++) {
+
+        for(size_t i=0; i<m_nrows; i++) {
+
+            T sum = 0;
+
+            for(size_t k=0; k<m_ncols; k++)
+                sum += Get(i,k)*(x.Get(k,j));
+
+            py[m_nrows*j + i] = sum;
+
+        }
+
+    }
+
+}
+
 /*template<typename T>
 template<class Array> Array CDenseArray<T>::operator*(const Array& array) const {
 
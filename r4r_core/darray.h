@@ -258,6 +258,14 @@ public:
     //! Matrix-vector multiplication.
     template<u_int n> CVector<T,n> operator*(const CVector<T,n>& vector) const;
 
+    /*! \brief Computes the product \f$y=Ax\f$ without allocating memory.
+     *
+     * \details The result overwrites the data of \f$y\f$, which must be of the correct size
+     * and must not share its memory with \f$x\f$.
+     *
+     */
+    void Multiply(const CDenseArray<T>& x, CDenseArray<T>& y) const;
+
 	//! Computes the standard inner product.
     static double InnerProduct(const CDenseArray<T>& x, const CDenseArray<T>& y);
 
@@ -0,0 +1,260 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef R4RDUAL_H_
+#define R4RDUAL_H_
+
+#include <math.h>
+#include <algorithm>
+#include <iostream>
+
+namespace R4R {
+
+/*! \brief dual numbers for forward-mode automatic differentiation
+ *
+ * Represents \f$a+\sum_{i=1}^N b_i\varepsilon_i\f$ with \f$\varepsilon_i\varepsilon_j=0\f$, i.e., a value
+ * together with its gradient w.r.t. \f$N\f$ independent variables. The derivative width is a
+ * compile-time constant, and all operations are fixed-length loops over a plain array which the
+ * compiler can unroll and vectorize. Generic code which only relies on arithmetic and the
+ * elementary functions below can be evaluated on dual numbers to obtain exact derivatives,
+ * e.g., CVector, CRotation<T,3>::Rodrigues(), or CPinholeCam::Project() with a dual-valued
+ * argument.
+ *
+ */
+template<typename T,u_int N>
+class CDual {
+
+public:
+
+    //! Standard constructor.
+    CDual():m_x(0) { std::fill_n(m_d,N,T(0)); }
+
+    //! Constructor for constants.
+    CDual(T x):m_x(x) { std::fill_n(m_d,N,T(0)); }
+
+    /*! \brief Constructor for independent variables.
+     *
+     * \param[in] x value
+     * \param[in] i index of the variable, i.e., the derivative is the \f$i\f$-th unit vector
+     *
+     */
+    CDual(T x, u_int i):m_x(x) { std::fill_n(m_d,N,T(0)); m_d[i] = 1; }
+
+    //! Access to the value.
+    T Get() const { return m_x; }
+
+    //! Access to the \f$i\f$-th partial derivative.
+    T GetDerivative(u_int i) const { return m_d[i]; }
+
+    //! Read-write access to the \f$i\f$-th partial derivative.
+    T& operator()(u_int i) { return m_d[i]; }
+
+    //! Low-level access to the derivatives.
+    const T* Derivatives() const { return m_d; }
+
+    //! Explicit conversion to the value type, discards the derivatives.
+    explicit operator T() const { return m_x; }
+
+    //! Checks whether the value is non-zero.
+    explicit operator bool() const { return m_x!=0; }
+
+    //! In-place addition.
+    CDual<T,N>& operator+=(const CDual<T,N>& y) { m_x += y.m_x; for(u_int i=0; i<N; i++) m_d[i] += y.m_d[i]; return *this; }
+
+    //! In-place subtraction.
+    CDual<T,N>& operator-=(const CDual<T,N>& y) { m_x -= y.m_x; for(u_int i=0; i<N; i++) m_d[i] -= y.m_d[i]; return *this; }
+
+    //! In-place multiplication.
+    CDual<T,N>& operator*=(const CDual<T,N>& y) { *this = *this*y; return *this; }
+
+    //! In-place division.
+    CDual<T,N>& operator/=(const CDual<T,N>& y) { *this = *this/y; return *this; }
+
+    //! Negation.
+    friend CDual<T,N> operator-(const CDual<T,N>& x) { return Chain(x,-x.m_x,T(-1)); }
+
+    //! Addition.
+    friend CDual<T,N> operator+(const CDual<T,N>& x, const CDual<T,N>& y) { CDual<T,N> z(x); z += y; return z; }
+
+    //! Subtraction.
+    friend CDual<T,N> operator-(const CDual<T,N>& x, const CDual<T,N>& y) { CDual<T,N> z(x); z -= y; return z; }
+
+    //! Multiplication.
+    friend CDual<T,N> operator*(const CDual<T,N>& x, const CDual<T,N>& y) {
+
+        CDual<T,N> z(x.m_x*y.m_x);
+
+        for(u_int i=0; i<N; i++)
+            z.m_d[i] = x.m_d[i]*y.m_x + x.m_x*y.m_d[i];
+
+        return z;
+
+    }
+
+    //! Division.
+    friend CDual<T,N> operator/(const CDual<T,N>& x, const CDual<T,N>& y) {
+
+        T yinv = T(1)/y.m_x;
+        CDual<T,N> z(x.m_x*yinv);
+
+        for(u_int i=0; i<N; i++)
+            z.m_d[i] = (x.m_d[i] - z.m_x*y.m_d[i])*yinv;
+
+        return z;
+
+    }
+
+    //! Adds a constant.
+    friend CDual<T,N> operator+(const CDual<T,N>& x, T y) { CDual<T,N> z(x); z.m_x += y; return z; }
+
+    //! Adds a constant.
+    friend CDual<T,N> operator+(T y, const CDual<T,N>& x) { return x + y; }
+
+    //! Subtracts a constant.
+    friend CDual<T,N> operator-(const CDual<T,N>& x, T y) { CDual<T,N> z(x); z.m_x -= y; return z; }
+
+    //! Subtracts from a constant.
+    friend CDual<T,N> operator-(T y, const CDual<T,N>& x) { return Chain(x,y-x.m_x,T(-1)); }
+
+    //! Multiplies by a constant.
+    friend CDual<T,N> operator*(const CDual<T,N>& x, T y) { return Chain(x,x.m_x*y,y); }
+
+    //! Multiplies by a constant.
+    friend CDual<T,N> operator*(T y, const CDual<T,N>& x) { return Chain(x,x.m_x*y,y); }
+
+    //! Divides by a constant.
+    friend CDual<T,N> operator/(const CDual<T,N>& x, T y) { return x*(T(1)/y); }
+
+    //! Divides a constant.
+    friend CDual<T,N> operator/(T y, const CDual<T,N>& x) { T xinv = T(1)/x.m_x; return Chain(x,y*xinv,-y*xinv*xinv); }
+
+    //! Comparisons only involve the values.
+    friend bool operator==(const CDual<T,N>& x, const CDual<T,N>& y) { return x.m_x==y.m_x; }
+    friend bool operator!=(const CDual<T,N>& x, const CDual<T,N>& y) { return x.m_x!=y.m_x; }
+    friend bool operator<(const CDual<T,N>& x, const CDual<T,N>& y) { return x.m_x<y.m_x; }
+    friend bool operator>(const CDual<T,N>& x, const CDual<T,N>& y) { return x.m_x>y.m_x; }
+    friend bool operator<=(const CDual<T,N>& x, const CDual<T,N>& y) { return x.m_x<=y.m_x; }
+    friend bool operator>=(const CDual<T,N>& x, const CDual<T,N>& y) { return x.m_x>=y.m_x; }
+
+    //! Square root.
+    friend CDual<T,N> sqrt(const CDual<T,N>& x) { T y = sqrt(x.m_x); return Chain(x,y,T(0.5)/y); }
+
+    //! Exponential.
+    friend CDual<T,N> exp(const CDual<T,N>& x) { T y = exp(x.m_x); return Chain(x,y,y); }
+
+    //! Natural logarithm.
+    friend CDual<T,N> log(const CDual<T,N>& x) { return Chain(x,log(x.m_x),T(1)/x.m_x); }
+
+    //! Sine.
+    friend CDual<T,N> sin(const CDual<T,N>& x) { return Chain(x,sin(x.m_x),cos(x.m_x)); }
+
+    //! Cosine.
+    friend CDual<T,N> cos(const CDual<T,N>& x) { return Chain(x,cos(x.m_x),-sin(x.m_x)); }
+
+    //! Tangent.
+    friend CDual<T,N> tan(const CDual<T,N>& x) { T y = tan(x.m_x); return Chain(x,y,1+y*y); }
+
+    //! Arc sine.
+    friend CDual<T,N> asin(const CDual<T,N>& x) { return Chain(x,asin(x.m_x),T(1)/sqrt(1-x.m_x*x.m_x)); }
+
+    //! Arc cosine.
+    friend CDual<T,N> acos(const CDual<T,N>& x) { return Chain(x,acos(x.m_x),-T(1)/sqrt(1-x.m_x*x.m_x)); }
+
+    //! Arc tangent.
+    friend CDual<T,N> atan(const CDual<T,N>& x) { return Chain(x,atan(x.m_x),T(1)/(1+x.m_x*x.m_x)); }
+
+    //! Two-argument arc tangent.
+    friend CDual<T,N> atan2(const CDual<T,N>& y, const CDual<T,N>& x) {
+
+        T s = T(1)/(x.m_x*x.m_x + y.m_x*y.m_x);
+        CDual<T,N> z(atan2(y.m_x,x.m_x));
+
+        for(u_int i=0; i<N; i++)
+            z.m_d[i] = (x.m_x*y.m_d[i] - y.m_x*x.m_d[i])*s;
+
+        return z;
+
+    }
+
+    //! Hyperbolic tangent.
+    friend CDual<T,N> tanh(const CDual<T,N>& x) { T y = tanh(x.m_x); return Chain(x,y,1-y*y); }
+
+    //! Power with constant exponent.
+    friend CDual<T,N> pow(const CDual<T,N>& x, T p) { T y = pow(x.m_x,p-1); return Chain(x,y*x.m_x,p*y); }
+
+    //! Power with dual exponent \f$x^p=\exp(p\log x)\f$.
+    friend CDual<T,N> pow(const CDual<T,N>& x, const CDual<T,N>& p) { return exp(p*log(x)); }
+
+    //! Absolute value.
+    friend CDual<T,N> fabs(const CDual<T,N>& x) { return (x.m_x<0) ? -x : x; }
+
+    //! Absolute value.
+    friend CDual<T,N> abs(const CDual<T,N>& x) { return fabs(x); }
+
+    //! Writes value and derivatives to a stream.
+    friend std::ostream& operator << (std::ostream& os, const CDual<T,N>& x) {
+
+        os << x.m_x << " [ ";
+
+        for(u_int i=0; i<N; i++)
+            os << x.m_d[i] << " ";
+
+        os << "]";
+
+        return os;
+
+    }
+
+    //! Reads a value from a stream, the derivatives are set to zero.
+    friend std::istream& operator >> (std::istream& is, CDual<T,N>& x) {
+
+        T val;
+        is >> val;
+        x = CDual<T,N>(val);
+
+        return is;
+
+    }
+
+private:
+
+    T m_x;                  //!< value
+    T m_d[N];               //!< partial derivatives
+
+    //! Chain rule \f$f(x)\f$ with \f$f(x_0)=y\f$ and \f$f'(x_0)=\f$ dy.
+    static CDual<T,N> Chain(const CDual<T,N>& x, T y, T dy) {
+
+        CDual<T,N> z(y);
+
+        for(u_int i=0; i<N; i++)
+            z.m_d[i] = dy*x.m_d[i];
+
+        return z;
+
+    }
+
+};
+
+}
+
+#endif /* R4RDUAL_H_ */
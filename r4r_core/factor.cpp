@@ -23,6 +23,7 @@
 
 #include "factor.h"
 #include <iostream>
+#include <math.h>
 
 extern "C" void dgesvd_(char* jobu, char* jobvt, int* m, int* n, double* a, int* lda, double* s, double* u, int* ldu, double* vt, int* ldvt, double* work, int* lwork, int* info);
 extern "C" void sgesvd_(char* jobu, char* jobvt, int* m, int* n, float* a, int* lda, float* s, float* u, int* ldu, float* vt, int* ldvt, float* work, int* lwork, int* info);
@@ -211,6 +212,66 @@ bool CMatrixFactorization<double>::InvertSymmetric(CDenseArray<double>& A) {
 
 }
 
+template<class T>
+bool CMatrixFactorization<T>::Cholesky(T* a, size_t n) {
+
+    for(size_t j=0; j<n; j++) {
+
+        T d = a[j+n*j];
+
+        for(size_t k=0; k<j; k++)
+            d -= a[j+n*k]*a[j+n*k];
+
+        if(d<=0)
+            return false;
+
+        d = sqrt(d);
+        a[j+n*j] = d;
+
+        for(size_t i=j+1; i<n; i++) {
+
+            T sum = a[i+n*j];
+
+            for(size_t k=0; k<j; k++)
+                sum -= a[i+n*k]*a[j+n*k];
+
+            a[i+n*j] = sum/d;
+
+        }
+
+    }
+
+    return true;
+
+}
+
+template<class T>
+void CMatrixFactorization<T>::CholeskySolve(const T* l, T* x, size_t n) {
+
+    for(size_t i=0; i<n; i++) {
+
+        T sum = x[i];
+
+        for(size_t k=0; k<i; k++)
+            sum -= l[i+n*k]*x[k];
+
+        x[i] = sum/l[i+n*i];
+
+    }
+
+    for(size_t i=n; i-->0; ) {
+
+        T sum = x[i];
+
+        for(size_t k=i+1; k<n; k++)
+            sum -= l[k+n*i]*x[k];
+
+        x[i] = sum/l[i+n*i];
+
+    }
+
+}
+
 template class CMatrixFactorization<double>;
 template class CMatrixFactorization<float>;
 
@@ -54,6 +54,19 @@ public:
 	//! Rank of matrix.
     static size_t Rank(const CDenseArray<T>& A, T tol);
 
+    /*! \brief In-place Cholesky decomposition of a small column-major matrix.
+     *
+     * Does not require LAPACK. Only the lower triangle is referenced and overwritten by the
+     * factor \f$L\f$.
+     *
+     * \returns false if the matrix is not positive definite
+     *
+     */
+    static bool Cholesky(T* a, size_t n);
+
+    //! Solves \f$LL^{\top}x=y\f$ in the memory of \f$y\f$, cf. Cholesky(T*,size_t).
+    static void CholeskySolve(const T* l, T* x, size_t n);
+
 private:
 
 };
@@ -0,0 +1,876 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "fft.h"
+
+#include <math.h>
+#include <algorithm>
+#include <limits>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <memory>
+#include <tuple>
+#include <stdlib.h>
+
+using namespace std;
+
+namespace R4R {
+
+CFastFourierTransform::CFastFourierTransform(size_t n):
+    m_n(n),
+    m_m(1),
+    m_bitrev(),
+    m_twiddle(),
+    m_chirp(),
+    m_fchirp() {
+
+    // Bluestein needs a linear convolution of length 2n-1 without wrap-around
+    bool pow2 = n>0 && (n&(n-1))==0;
+    size_t mmin = pow2 ? n : 2*n - 1;
+
+    size_t logm = 0;
+    while(m_m<mmin) {
+
+        m_m <<= 1;
+        logm++;
+
+    }
+
+    m_bitrev.resize(m_m);
+    for(size_t i=0; i<m_m; i++) {
+
+        size_t r = 0;
+
+        for(size_t b=0; b<logm; b++)
+            r |= ((i>>b)&1)<<(logm-1-b);
+
+        m_bitrev[i] = r;
+
+    }
+
+    m_twiddle.resize(m_m/2);
+    for(size_t k=0; k<m_m/2; k++)
+        m_twiddle[k] = polar(1.0,-2.0*M_PI*k/m_m);
+
+    if(pow2)
+        return;
+
+    // chirp, reduce the exponent modulo 2n to keep the argument small
+    m_chirp.resize(n);
+    for(size_t k=0; k<n; k++)
+        m_chirp[k] = polar(1.0,M_PI*((k*k)%(2*n))/n);
+
+    m_fchirp.assign(m_m,complex<double>(0,0));
+    m_fchirp[0] = m_chirp[0];
+    for(size_t k=1; k<n; k++) {
+
+        m_fchirp[k] = m_chirp[k];
+        m_fchirp[m_m-k] = m_chirp[k];
+
+    }
+
+    this->Radix2(m_fchirp.data(),false);
+
+}
+
+void CFastFourierTransform::Radix2(complex<double>* x, bool inverse) const {
+
+    for(size_t i=0; i<m_m; i++) {
+
+        size_t j = m_bitrev[i];
+
+        if(i<j)
+            swap(x[i],x[j]);
+
+    }
+
+    for(size_t len=2; len<=m_m; len<<=1) {
+
+        size_t half = len/2;
+        size_t step = m_m/len;
+
+        for(size_t i=0; i<m_m; i+=len) {
+
+            for(size_t k=0; k<half; k++) {
+
+                complex<double> w = inverse ? conj(m_twiddle[k*step]) : m_twiddle[k*step];
+                complex<double> u = x[i+k];
+                complex<double> v = x[i+k+half]*w;
+
+                x[i+k] = u + v;
+                x[i+k+half] = u - v;
+
+            }
+
+        }
+
+    }
+
+}
+
+void CFastFourierTransform::Transform(complex<double>* x, bool inverse) const {
+
+    if(m_m==m_n) {
+
+        this->Radix2(x,inverse);
+        return;
+
+    }
+
+    // inverse by conjugation of the forward transform
+    if(inverse) {
+
+        for(size_t k=0; k<m_n; k++)
+            x[k] = conj(x[k]);
+
+    }
+
+    vector<complex<double> > a(m_m,complex<double>(0,0));
+
+    for(size_t k=0; k<m_n; k++)
+        a[k] = x[k]*conj(m_chirp[k]);
+
+    this->Radix2(a.data(),false);
+
+    for(size_t k=0; k<m_m; k++)
+        a[k] *= m_fchirp[k];
+
+    this->Radix2(a.data(),true);
+
+    for(size_t k=0; k<m_n; k++) {
+
+        x[k] = conj(m_chirp[k])*a[k]/double(m_m);
+
+        if(inverse)
+            x[k] = conj(x[k]);
+
+    }
+
+}
+
+//! Aligned memory owned by a single thread.
+class CAlignedBuffer {
+
+public:
+
+    //! Constructor.
+    CAlignedBuffer():m_data(nullptr),m_size(0) {}
+
+    //! Destructor.
+    ~CAlignedBuffer() { free(m_data); }
+
+    //! Grows the buffer if necessary.
+    complex<double>* Get(size_t n) {
+
+        if(n>m_size) {
+
+            free(m_data);
+            m_data = nullptr;
+            m_size = 0;
+
+            void* ptr = nullptr;
+            if(posix_memalign(&ptr,64,n*sizeof(complex<double>))!=0)
+                return nullptr;
+
+            m_data = (complex<double>*)ptr;
+            m_size = n;
+
+        }
+
+        return m_data;
+
+    }
+
+private:
+
+    complex<double>* m_data;                                //!< data
+    size_t m_size;                                          //!< capacity
+
+};
+
+static thread_local CAlignedBuffer scratch;                 // handed out by CFourierPlanCache::Scratch()
+static thread_local CAlignedBuffer work;                    // used internally by CFourierPlanCache::Transform()
+static mutex planner_mutex;
+static bool planner_measure = false;
+
+#ifdef HAVE_FFTW
+
+static map<tuple<size_t,size_t,size_t,bool>,fftw_plan> plans;
+
+//! Looks up a plan and creates it if necessary.
+static fftw_plan GetPlan(size_t nrows, size_t ncols, size_t howmany, bool inverse) {
+
+    lock_guard<mutex> lock(planner_mutex);
+
+    tuple<size_t,size_t,size_t,bool> key(nrows,ncols,howmany,inverse);
+    map<tuple<size_t,size_t,size_t,bool>,fftw_plan>::iterator it = plans.find(key);
+
+    if(it!=plans.end())
+        return it->second;
+
+    // plan on a dummy array such that measuring does not destroy any data
+    size_t dist = nrows*ncols;
+    fftw_complex* tmp = (fftw_complex*)fftw_malloc(sizeof(fftw_complex)*dist*howmany);
+
+    int n[2] = { int(nrows), int(ncols) };
+    int rank = nrows>1 ? 2 : 1;
+
+    fftw_plan p = fftw_plan_many_dft(rank,
+                                     n+2-rank,
+                                     int(howmany),
+                                     tmp,
+                                     nullptr,
+                                     1,
+                                     int(dist),
+                                     tmp,
+                                     nullptr,
+                                     1,
+                                     int(dist),
+                                     inverse ? FFTW_BACKWARD : FFTW_FORWARD,
+                                     planner_measure ? FFTW_MEASURE : FFTW_ESTIMATE);
+
+    fftw_free(tmp);
+
+    plans[key] = p;
+
+    return p;
+
+}
+
+#else
+
+static map<size_t,shared_ptr<CFastFourierTransform> > transforms;
+
+//! Looks up a transform and creates it if necessary.
+static shared_ptr<CFastFourierTransform> GetTransform(size_t n) {
+
+    lock_guard<mutex> lock(planner_mutex);
+
+    shared_ptr<CFastFourierTransform>& fft = transforms[n];
+
+    if(!fft)
+        fft = shared_ptr<CFastFourierTransform>(new CFastFourierTransform(n));
+
+    return fft;
+
+}
+
+#endif // HAVE_FFTW
+
+const size_t CFourierPlanCache::BATCH;
+
+void CFourierPlanCache::Transform(complex<double>* data, size_t nrows, size_t ncols, size_t howmany, bool inverse) {
+
+    size_t dist = nrows*ncols;
+
+    if(dist==0 || howmany==0)
+        return;
+
+#ifdef HAVE_FFTW
+
+    // get all plans before going parallel
+    size_t nbatches = (howmany + BATCH - 1)/BATCH;
+    size_t rest = howmany%BATCH;
+    fftw_plan full = howmany>=BATCH ? GetPlan(nrows,ncols,BATCH,inverse) : nullptr;
+    fftw_plan last = rest>0 ? GetPlan(nrows,ncols,rest,inverse) : nullptr;
+
+    #pragma omp parallel for
+    for(int b=0; b<int(nbatches); b++) {
+
+        size_t count = min(BATCH,howmany - b*BATCH);
+        fftw_plan p = count==BATCH ? full : last;
+        complex<double>* x = data + b*BATCH*dist;
+
+        // plans are only valid for arrays aligned like the one they were created for
+        if(fftw_alignment_of((double*)x)==0)
+            fftw_execute_dft(p,(fftw_complex*)x,(fftw_complex*)x);
+        else {
+
+            complex<double>* y = work.Get(count*dist);
+            copy(x,x+count*dist,y);
+            fftw_execute_dft(p,(fftw_complex*)y,(fftw_complex*)y);
+            copy(y,y+count*dist,x);
+
+        }
+
+    }
+
+#else
+
+    shared_ptr<CFastFourierTransform> frows = GetTransform(ncols);
+    shared_ptr<CFastFourierTransform> fcols;
+
+    if(nrows>1)
+        fcols = GetTransform(nrows);
+
+    #pragma omp parallel for
+    for(int k=0; k<int(howmany); k++) {
+
+        complex<double>* x = data + k*dist;
+
+        for(size_t i=0; i<nrows; i++)
+            frows->Transform(x+i*ncols,inverse);
+
+        if(!fcols)
+            continue;
+
+        complex<double>* y = work.Get(nrows);
+
+        for(size_t j=0; j<ncols; j++) {
+
+            for(size_t i=0; i<nrows; i++)
+                y[i] = x[i*ncols+j];
+
+            fcols->Transform(y,inverse);
+
+            for(size_t i=0; i<nrows; i++)
+                x[i*ncols+j] = y[i];
+
+        }
+
+    }
+
+#endif // HAVE_FFTW
+
+}
+
+complex<double>* CFourierPlanCache::Scratch(size_t n) {
+
+    return scratch.Get(n);
+
+}
+
+void CFourierPlanCache::SetMeasure(bool measure) {
+
+    lock_guard<mutex> lock(planner_mutex);
+
+    planner_measure = measure;
+
+}
+
+bool CFourierPlanCache::ImportWisdom(const char* filename) {
+
+#ifdef HAVE_FFTW
+    lock_guard<mutex> lock(planner_mutex);
+
+    return fftw_import_wisdom_from_filename(filename)!=0;
+#else
+    return false;
+#endif // HAVE_FFTW
+
+}
+
+bool CFourierPlanCache::ExportWisdom(const char* filename) {
+
+#ifdef HAVE_FFTW
+    lock_guard<mutex> lock(planner_mutex);
+
+    return fftw_export_wisdom_to_filename(filename)!=0;
+#else
+    return false;
+#endif // HAVE_FFTW
+
+}
+
+void CFourierPlanCache::Clear() {
+
+    lock_guard<mutex> lock(planner_mutex);
+
+#ifdef HAVE_FFTW
+    map<tuple<size_t,size_t,size_t,bool>,fftw_plan>::iterator it;
+
+    for(it=plans.begin(); it!=plans.end(); it++)
+        fftw_destroy_plan(it->second);
+
+    plans.clear();
+#else
+    transforms.clear();
+#endif // HAVE_FFTW
+
+}
+
+#ifdef HAVE_FFTW
+
+CDiscreteCosineTransform::CDiscreteCosineTransform(size_t nrows, size_t ncols):
+    m_nrows(nrows),
+    m_ncols(ncols),
+    m_data((double*)fftw_malloc(sizeof(double)*nrows*ncols)) {
+
+    // the planner is shared with CFourierPlanCache
+    lock_guard<mutex> lock(planner_mutex);
+
+    // FFTW expects row-major order, i.e., the column index runs slowest
+    m_forward = fftw_plan_r2r_2d(m_ncols,m_nrows,m_data,m_data,FFTW_REDFT10,FFTW_REDFT10,FFTW_MEASURE);
+    m_inverse = fftw_plan_r2r_2d(m_ncols,m_nrows,m_data,m_data,FFTW_REDFT01,FFTW_REDFT01,FFTW_MEASURE);
+
+    fill_n(m_data,m_nrows*m_ncols,0.0);
+
+}
+
+CDiscreteCosineTransform::~CDiscreteCosineTransform() {
+
+    lock_guard<mutex> lock(planner_mutex);
+
+    fftw_destroy_plan(m_forward);
+    fftw_destroy_plan(m_inverse);
+    fftw_free(m_data);
+
+}
+
+void CDiscreteCosineTransform::Forward() {
+
+    fftw_execute(m_forward);
+
+}
+
+void CDiscreteCosineTransform::Inverse() {
+
+    fftw_execute(m_inverse);
+
+}
+
+#else
+
+CDiscreteCosineTransform::CDiscreteCosineTransform(size_t nrows, size_t ncols):
+    m_nrows(nrows),
+    m_ncols(ncols),
+    m_data(new double[nrows*ncols]),
+    m_fftrows(nrows),
+    m_fftcols(ncols),
+    m_shiftrows(nrows),
+    m_shiftcols(ncols) {
+
+    fill_n(m_data,m_nrows*m_ncols,0.0);
+
+    for(size_t k=0; k<m_nrows; k++)
+        m_shiftrows[k] = polar(1.0,-M_PI*k/(2.0*m_nrows));
+
+    for(size_t k=0; k<m_ncols; k++)
+        m_shiftcols[k] = polar(1.0,-M_PI*k/(2.0*m_ncols));
+
+}
+
+CDiscreteCosineTransform::~CDiscreteCosineTransform() {
+
+    delete [] m_data;
+
+}
+
+void CDiscreteCosineTransform::Forward() {
+
+    this->TransformLines(m_fftrows,m_shiftrows,m_ncols,1,m_nrows,false);
+    this->TransformLines(m_fftcols,m_shiftcols,m_nrows,m_nrows,1,false);
+
+}
+
+void CDiscreteCosineTransform::Inverse() {
+
+    this->TransformLines(m_fftcols,m_shiftcols,m_nrows,m_nrows,1,true);
+    this->TransformLines(m_fftrows,m_shiftrows,m_ncols,1,m_nrows,true);
+
+}
+
+/* The DCT-II of a real sequence is obtained from a complex FFT of the same length by Makhoul's
+ * reordering of even and odd samples, and the DCT-III by the reverse procedure. Two sequences
+ * are packed into real and imaginary part of a single FFT. */
+void CDiscreteCosineTransform::TransformLines(const CFastFourierTransform& fft, const vector<complex<double> >& shift, size_t nlines, size_t stride, size_t dist, bool inverse) {
+
+    const size_t n = fft.Size();
+    const complex<double> I(0,1);
+
+    #pragma omp parallel
+    {
+
+        vector<complex<double> > z(n);
+
+        #pragma omp for
+        for(size_t p=0; p<(nlines+1)/2; p++) {
+
+            double* xa = m_data + 2*p*dist;
+            double* xb = (2*p+1<nlines) ? xa + dist : nullptr;
+
+            if(!inverse) {
+
+                for(size_t k=0; 2*k<n; k++)
+                    z[k] = complex<double>(xa[2*k*stride],xb ? xb[2*k*stride] : 0);
+
+                for(size_t k=0; 2*k+1<n; k++)
+                    z[n-1-k] = complex<double>(xa[(2*k+1)*stride],xb ? xb[(2*k+1)*stride] : 0);
+
+                fft.Transform(z.data(),false);
+
+                for(size_t k=0; k<n; k++) {
+
+                    complex<double> zk = z[k];
+                    complex<double> zc = conj(z[(n-k)%n]);
+
+                    xa[k*stride] = (shift[k]*(zk + zc)).real();
+
+                    if(xb)
+                        xb[k*stride] = (shift[k]*(zk - zc)*(-I)).real();
+
+                }
+
+            }
+            else {
+
+                for(size_t k=0; k<n; k++) {
+
+                    double xak = xa[k*stride];
+                    double xan = (k>0) ? xa[(n-k)*stride] : 0;
+                    complex<double> va = conj(shift[k])*complex<double>(xak,-xan);
+                    complex<double> vb(0,0);
+
+                    if(xb) {
+
+                        double xbk = xb[k*stride];
+                        double xbn = (k>0) ? xb[(n-k)*stride] : 0;
+                        vb = conj(shift[k])*complex<double>(xbk,-xbn);
+
+                    }
+
+                    z[k] = va + I*vb;
+
+                }
+
+                fft.Transform(z.data(),true);
+
+                for(size_t k=0; 2*k<n; k++) {
+
+                    xa[2*k*stride] = z[k].real();
+
+                    if(xb)
+                        xb[2*k*stride] = z[k].imag();
+
+                }
+
+                for(size_t k=0; 2*k+1<n; k++) {
+
+                    xa[(2*k+1)*stride] = z[n-1-k].real();
+
+                    if(xb)
+                        xb[(2*k+1)*stride] = z[n-1-k].imag();
+
+                }
+
+            }
+
+        }
+
+    }
+
+}
+
+#endif // HAVE_FFTW
+
+vector<double> CDiscreteCosineTransform::LaplacianEigenvalues(size_t n) {
+
+    vector<double> result(n);
+
+    for(size_t k=0; k<n; k++)
+        result[k] = 2.0 - 2.0*cos(M_PI*k/n);
+
+    return result;
+
+}
+
+template<typename T>
+CScreenedPoissonSolver<T>::CScreenedPoissonSolver(const CPreconditioner<CLinearOperator<T>,T>& M, size_t nrows, size_t ncols, size_t n, double eps, bool silent):
+    CIterativeLinearSolver<CLinearOperator<T>,T>(M,n,eps,silent),
+    m_nrows(nrows),
+    m_ncols(ncols),
+    m_dct(new CDiscreteCosineTransform(nrows,ncols)),
+    m_eigrows(CDiscreteCosineTransform::LaplacianEigenvalues(nrows)),
+    m_eigcols(CDiscreteCosineTransform::LaplacianEigenvalues(ncols)),
+    m_op(),
+    m_transpose(false),
+    m_recognized(false),
+    m_alpha(0),
+    m_beta(0) {
+
+}
+
+template<typename T>
+void CScreenedPoissonSolver<T>::Laplacian(const T* x, T* y) const {
+
+    const size_t h = m_nrows;
+    const size_t w = m_ncols;
+
+    #pragma omp parallel for
+    for(size_t j=0; j<w; j++) {
+
+        for(size_t i=0; i<h; i++) {
+
+            size_t k = j*h + i;
+            T sum = 0;
+
+            if(i>0)
+                sum += x[k] - x[k-1];
+
+            if(i<h-1)
+                sum += x[k] - x[k+1];
+
+            if(j>0)
+                sum += x[k] - x[k-h];
+
+            if(j<w-1)
+                sum += x[k] - x[k+h];
+
+            y[k] = sum;
+
+        }
+
+    }
+
+}
+
+template<typename T>
+bool CScreenedPoissonSolver<T>::Recognize(const CLinearOperator<T>& A, double& alpha, double& beta) const {
+
+    const size_t h = m_nrows;
+    const size_t w = m_ncols;
+    const size_t n = h*w;
+
+    if(A.NCols()!=n || n==0)
+        return false;
+
+    const CLinearOperator<T> At = CLinearOperator<T>::Transpose(A);
+
+    CDenseVector<T> x(n), Ax(A.NRows()), y(n);
+
+    // column of the normal operator at a pixel with as many neighbors as possible
+    size_t i0 = min(size_t(1),h-1);
+    size_t j0 = min(size_t(1),w-1);
+    size_t k0 = j0*h + i0;
+
+    x(k0) = 1;
+    A.Multiply(x,Ax);
+    At.Multiply(Ax,y);
+
+    size_t degree = (i0>0) + (i0<h-1) + (j0>0) + (j0<w-1);
+
+    if(i0>0)
+        beta = -y.Get(k0-1);
+    else if(j0>0)
+        beta = -y.Get(k0-h);
+    else
+        beta = 0;
+
+    alpha = y.Get(k0) - degree*beta;
+
+    if(alpha<0 || beta<0 || alpha+beta<=0)
+        return false;
+
+    // verify with a pseudo-random vector
+    for(size_t k=0; k<n; k++)
+        x(k) = T((k*7919)%1031)/T(1031) - T(0.5);
+
+    A.Multiply(x,Ax);
+    At.Multiply(Ax,y);
+
+    CDenseVector<T> z(n);
+    this->Laplacian(x.Data().get(),z.Data().get());
+
+    double err = 0;
+    double norm = 0;
+
+    for(size_t k=0; k<n; k++) {
+
+        double d = y.Get(k) - alpha*x.Get(k) - beta*z.Get(k);
+        err += d*d;
+        norm += double(y.Get(k))*double(y.Get(k));
+
+    }
+
+    return sqrt(err)<=sqrt(numeric_limits<T>::epsilon())*sqrt(norm);
+
+}
+
+template<typename T>
+bool CScreenedPoissonSolver<T>::RecognizeCached(const CLinearOperator<T>& A, double& alpha, double& beta) const {
+
+    // the weak pointer expires with the operator, so a new one at the same address is probed again
+    shared_ptr<const CAbstractLinearOperator<T> > op = m_op.lock();
+
+    if(!op || op!=A.GetOperator() || m_transpose!=A.IsTransposed()) {
+
+        m_recognized = this->Recognize(A,m_alpha,m_beta);
+        m_op = A.GetOperator();
+        m_transpose = A.IsTransposed();
+
+    }
+
+    alpha = m_alpha;
+    beta = m_beta;
+
+    return m_recognized;
+
+}
+
+template<typename T>
+static double Residual(const CLinearOperator<T>& A, const CDenseVector<T>& b, const CDenseVector<T>& x) {
+
+    CDenseVector<T> r(A.NRows());
+    A.Multiply(x,r);
+
+    double sum = 0;
+
+    for(size_t i=0; i<r.NRows(); i++) {
+
+        double d = r.Get(i) - b.Get(i);
+        sum += d*d;
+
+    }
+
+    return sqrt(sum);
+
+}
+
+template<typename T>
+vector<double> CScreenedPoissonSolver<T>::Iterate(const CLinearOperator<T>& A, const CDenseVector<T>& b, CDenseVector<T>& x) const {
+
+    const size_t h = m_nrows;
+    const size_t w = m_ncols;
+
+    if(!(A.NCols()==x.NRows() && A.NRows()==b.NRows() && x.NRows()==h*w)) {
+
+        cerr << "ERROR: Check matrix dimensions!" << endl;
+        return vector<double>();
+
+    }
+
+    double alpha, beta;
+
+    if(!RecognizeCached(A,alpha,beta)) {
+
+        if(m_n>0) {
+
+            CConjugateGradientMethodLeastSquares<CLinearOperator<T>,T> solver(m_M,m_n,m_eps,m_silent);
+            return solver.Iterate(A,b,x);
+
+        }
+
+        cerr << "ERROR: Normal operator is not a screened Laplacian." << endl;
+        return vector<double>();
+
+    }
+
+    vector<double> result;
+    result.push_back(Residual(A,b,x));
+
+    // right-hand side of the normal equation
+    CDenseVector<T> rhs(h*w);
+    CLinearOperator<T>::Transpose(A).Multiply(b,rhs);
+
+    double* data = m_dct->Data();
+    const T* prhs = rhs.Data().get();
+
+    #pragma omp parallel for
+    for(size_t k=0; k<h*w; k++)
+        data[k] = prhs[k];
+
+    m_dct->Forward();
+
+    // divide by eigenvalues including the normalization of the transform pair
+    double scale = 4.0*h*w;
+
+    #pragma omp parallel for
+    for(size_t j=0; j<w; j++) {
+
+        for(size_t i=0; i<h; i++) {
+
+            double lambda = scale*(alpha + beta*(m_eigrows[i] + m_eigcols[j]));
+            data[j*h+i] = (lambda>0) ? data[j*h+i]/lambda : 0;
+
+        }
+
+    }
+
+    m_dct->Inverse();
+
+    T* px = x.Data().get();
+
+    #pragma omp parallel for
+    for(size_t k=0; k<h*w; k++)
+        px[k] = T(data[k]);
+
+    result.push_back(Residual(A,b,x));
+
+    if(!m_silent)
+        cout << "Direct solve: " << result.front() << " -> " << result.back() << endl;
+
+    return result;
+
+}
+
+template<typename T>
+vector<double> CScreenedPoissonSolver<T>::Iterate(const CLinearOperator<T>& A, const CDenseArray<T>& B, CDenseArray<T>& X) const {
+
+    if(!(A.NCols()==X.NRows() && A.NRows()==B.NRows() && X.NCols()==B.NCols())) {
+
+        cerr << "ERROR: Check matrix dimensions!" << endl;
+        return vector<double>();
+
+    }
+
+    size_t m = B.NRows();
+    size_t n = X.NRows();
+    vector<double> result;
+
+    // solve column by column, accumulate squared residuals
+    for(size_t j=0; j<X.NCols(); j++) {
+
+        CDenseVector<T> b(m), x(n);
+        copy(B.Data().get()+j*m,B.Data().get()+(j+1)*m,b.Data().get());
+        copy(X.Data().get()+j*n,X.Data().get()+(j+1)*n,x.Data().get());
+
+        vector<double> res = this->Iterate(A,b,x);
+
+        if(res.empty())
+            return res;
+
+        copy(x.Data().get(),x.Data().get()+n,X.Data().get()+j*n);
+
+        result.resize(max(result.size(),res.size()),0);
+
+        for(size_t k=0; k<result.size(); k++) {
+
+            double r = (k<res.size()) ? res[k] : res.back();
+            result[k] += r*r;
+
+        }
+
+    }
+
+    for(size_t k=0; k<result.size(); k++)
+        result[k] = sqrt(result[k]);
+
+    return result;
+
+}
+
+template class CScreenedPoissonSolver<float>;
+template class CScreenedPoissonSolver<double>;
+
+}
@@ -0,0 +1,287 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef R4RFFT_H_
+#define R4RFFT_H_
+
+#ifdef HAVE_FFTW
+#include <fftw3.h>
+#endif // HAVE_FFTW
+
+#include <complex>
+#include <vector>
+
+#include "iter.h"
+#include "linop.h"
+
+namespace R4R {
+
+/*! \brief built-in complex FFT of fixed length
+ *
+ * Powers of two are transformed by an iterative radix-2 algorithm. All other lengths are
+ * reduced to a circular convolution of power-of-two length by Bluestein's chirp-z algorithm.
+ * Bit-reversal permutation, twiddle factors, and the transformed chirp are computed once in
+ * the constructor. Like FFTW, neither direction is normalized.
+ *
+ */
+class CFastFourierTransform {
+
+public:
+
+    //! Constructor.
+    CFastFourierTransform(size_t n);
+
+    //! Length of the transform.
+    size_t Size() const { return m_n; }
+
+    /*! \brief Transforms a sequence in place.
+     *
+     * \param[in,out] x sequence of length #m_n
+     * \param[in] inverse direction of the transform
+     *
+     * This method is thread-safe.
+     *
+     */
+    void Transform(std::complex<double>* x, bool inverse = false) const;
+
+private:
+
+    size_t m_n;                                             //!< length
+    size_t m_m;                                             //!< power-of-two length of the radix-2 transform
+    std::vector<size_t> m_bitrev;                           //!< bit-reversal permutation
+    std::vector<std::complex<double> > m_twiddle;           //!< twiddle factors for length #m_m
+    std::vector<std::complex<double> > m_chirp;             //!< chirp \f$e^{i\pi k^2/n}\f$
+    std::vector<std::complex<double> > m_fchirp;            //!< transform of the zero-padded chirp
+
+    //! In-place radix-2 transform of length #m_m.
+    void Radix2(std::complex<double>* x, bool inverse) const;
+
+};
+
+/*! \brief cache of FFT plans shared by all threads
+ *
+ * Transforms small complex arrays, possibly many at once, without planning anew in every call.
+ * With FFTW, plans for batches of up to #BATCH arrays are created once per size, direction, and
+ * batch size by fftw_plan_many_dft, guarded by a mutex because the planner is not thread-safe.
+ * Executing a cached plan is. Planning results can be saved to and restored from a wisdom file
+ * for fast startup. Without FFTW, one CFastFourierTransform per length is cached instead, and
+ * two-dimensional transforms are computed along rows and then along columns.
+ *
+ */
+class CFourierPlanCache {
+
+public:
+
+    //! Number of arrays that are transformed by a single plan.
+    static const size_t BATCH = 32;
+
+    /*! \brief Transforms a batch of arrays in place.
+     *
+     * \param[in,out] data arrays of size \f$m\times n\f$ in row-major order, stored one after another
+     * \param[in] nrows number of rows \f$m\f$, one for one-dimensional transforms
+     * \param[in] ncols number of columns \f$n\f$
+     * \param[in] howmany number of arrays
+     * \param[in] inverse direction of the transform
+     *
+     * Like FFTW, neither direction is normalized. Batches are transformed in parallel. This
+     * method is thread-safe.
+     *
+     */
+    static void Transform(std::complex<double>* data, size_t nrows, size_t ncols, size_t howmany = 1, bool inverse = false);
+
+    /*! \brief Scratch memory of the calling thread.
+     *
+     * \param[in] n minimal number of elements
+     * \returns aligned buffer, valid until the next call from the same thread
+     *
+     */
+    static std::complex<double>* Scratch(size_t n);
+
+    //! Selects between fast (default) and thorough planning, the latter pays off with wisdom.
+    static void SetMeasure(bool measure);
+
+    //! Imports FFTW wisdom from a file. Returns false without FFTW.
+    static bool ImportWisdom(const char* filename);
+
+    //! Exports FFTW wisdom to a file. Returns false without FFTW.
+    static bool ExportWisdom(const char* filename);
+
+    //! Destroys all cached plans. Must not be called while transforms are running.
+    static void Clear();
+
+};
+
+/*! \brief two-dimensional discrete cosine transform
+ *
+ * Transforms a column-major array of fixed size with the DCT-II, and back with the DCT-III.
+ * The normalization is that of FFTW's REDFT10 and REDFT01, i.e., a forward-inverse pair
+ * amounts to multiplication by \f$4mn\f$. The DCT-II diagonalizes the Laplacian with
+ * homogeneous Neumann boundary conditions as discretized by CGradientOperator. If FFTW is
+ * available, its plans are created once in the constructor, else the transforms along rows
+ * and columns are computed by CFastFourierTransform, two real sequences at a time.
+ *
+ */
+class CDiscreteCosineTransform {
+
+public:
+
+    /*! \brief Constructor.
+     *
+     * \param[in] nrows number of rows
+     * \param[in] ncols number of columns
+     *
+     * With FFTW, this calls the planner, which is serialized with CFourierPlanCache.
+     *
+     */
+    CDiscreteCosineTransform(size_t nrows, size_t ncols);
+
+    //! Destructor.
+    ~CDiscreteCosineTransform();
+
+    //! Deleted copy constructor.
+    CDiscreteCosineTransform(const CDiscreteCosineTransform& dct) = delete;
+
+    //! Deleted assignment operator.
+    CDiscreteCosineTransform& operator=(const CDiscreteCosineTransform& dct) = delete;
+
+    //! Access to the data that is transformed in place.
+    double* Data() { return m_data; }
+
+    //! Forward transform (DCT-II).
+    void Forward();
+
+    //! Inverse transform (DCT-III).
+    void Inverse();
+
+    /*! \brief Eigenvalues of the negative second difference along one axis.
+     *
+     * \param[in] n number of samples
+     * \returns \f$2-2\cos\frac{\pi k}{n}\f$ for \f$k=0,\dots,n-1\f$
+     *
+     */
+    static std::vector<double> LaplacianEigenvalues(size_t n);
+
+private:
+
+    size_t m_nrows;                                         //!< number of rows
+    size_t m_ncols;                                         //!< number of columns
+    double* m_data;                                         //!< data
+
+#ifdef HAVE_FFTW
+    fftw_plan m_forward;                                    //!< plan of forward transform
+    fftw_plan m_inverse;                                    //!< plan of inverse transform
+#else
+    CFastFourierTransform m_fftrows;                        //!< FFT along columns, i.e., of length #m_nrows
+    CFastFourierTransform m_fftcols;                        //!< FFT along rows, i.e., of length #m_ncols
+    std::vector<std::complex<double> > m_shiftrows;         //!< half-sample shifts \f$e^{-i\frac{\pi k}{2m}}\f$
+    std::vector<std::complex<double> > m_shiftcols;         //!< half-sample shifts \f$e^{-i\frac{\pi k}{2n}}\f$
+
+    //! Transforms the lines of the array in one direction.
+    void TransformLines(const CFastFourierTransform& fft, const std::vector<std::complex<double> >& shift, size_t nlines, size_t stride, size_t dist, bool inverse);
+#endif // HAVE_FFTW
+
+};
+
+/*! \brief direct solver for screened Poisson equations on image grids
+ *
+ * Solves least-squares problems \f$\min_x\|Ax-b\|_2\f$ whose normal operator is of the form
+ * \f$A^{\top}A=\alpha I+\beta\nabla^{\top}\nabla\f$ with the gradient \f$\nabla\f$ of
+ * CGradientOperator on a fixed grid. This is the case for the \f$u\f$-subproblem of
+ * CSplitBregman in denoising, where \f$A\f$ stacks \f$\mu I\f$ and \f$-\lambda\nabla\f$.
+ * The normal equation is then diagonal in the basis of the DCT-II, see
+ * CDiscreteCosineTransform. The coefficients \f$\alpha,\beta\f$ are recognized automatically
+ * by probing the operator. This happens once per operator, i.e., as long as Iterate() is called
+ * with copies of the same handle, the result is re-used, so the operator must not change while
+ * it is alive. If it does not have the required form, the solver falls back to
+ * CConjugateGradientMethodLeastSquares with the given preconditioner and number of iterations.
+ *
+ * Transforms and eigenvalues are cached, so concurrent calls of Iterate() are not allowed.
+ *
+ */
+template<typename T>
+class CScreenedPoissonSolver: public CIterativeLinearSolver<CLinearOperator<T>,T> {
+
+public:
+
+    /*! \brief Constructor.
+     *
+     * \param[in] M preconditioner for the fallback solver
+     * \param[in] nrows number of rows of the grid
+     * \param[in] ncols number of columns of the grid
+     * \param[in] n number of fallback iterations, none if zero
+     * \param[in] eps tolerance of the fallback solver
+     * \param[in] silent verbosity flag
+     *
+     */
+    CScreenedPoissonSolver(const CPreconditioner<CLinearOperator<T>,T>& M, size_t nrows, size_t ncols, size_t n = 0, double eps = 1e-10, bool silent = true);
+
+    //! Deleted standard constructor.
+    CScreenedPoissonSolver() = delete;
+
+    //! \copydoc CIterativeLinearSolver::Iterate(const Matrix&,const CDenseArray<T>&,CDenseArray<T>&)
+    std::vector<double> Iterate(const CLinearOperator<T>& A, const CDenseArray<T>& B, CDenseArray<T>& X) const;
+
+    //! \copydoc CIterativeLinearSolver::Iterate(const Matrix&,const CDenseVector<T>&,CDenseVector<T>&)
+    std::vector<double> Iterate(const CLinearOperator<T>& A, const CDenseVector<T>& b, CDenseVector<T>& x) const;
+
+    /*! \brief Checks whether the normal operator is a screened Laplacian.
+     *
+     * \param[in] A operator
+     * \param[out] alpha coefficient of the identity
+     * \param[out] beta coefficient of the Laplacian
+     *
+     * The coefficients are read off the normal operator applied to a unit vector, and then
+     * verified with a pseudo-random vector.
+     *
+     */
+    bool Recognize(const CLinearOperator<T>& A, double& alpha, double& beta) const;
+
+private:
+
+    using CIterativeLinearSolver<CLinearOperator<T>,T>::m_M;
+    using CIterativeLinearSolver<CLinearOperator<T>,T>::m_n;
+    using CIterativeLinearSolver<CLinearOperator<T>,T>::m_eps;
+    using CIterativeLinearSolver<CLinearOperator<T>,T>::m_silent;
+
+    size_t m_nrows;                                         //!< number of rows of the grid
+    size_t m_ncols;                                         //!< number of columns of the grid
+    std::shared_ptr<CDiscreteCosineTransform> m_dct;        //!< cached transform
+    std::vector<double> m_eigrows;                          //!< eigenvalues of the second difference along columns
+    std::vector<double> m_eigcols;                          //!< eigenvalues of the second difference along rows
+    mutable std::weak_ptr<const CAbstractLinearOperator<T> > m_op;     //!< operator probed last
+    mutable bool m_transpose;                               //!< transposition flag of #m_op
+    mutable bool m_recognized;                              //!< whether #m_op is a screened Laplacian
+    mutable double m_alpha;                                 //!< coefficient of the identity for #m_op
+    mutable double m_beta;                                  //!< coefficient of the Laplacian for #m_op
+
+    //! Applies the Laplacian \f$\nabla^{\top}\nabla\f$ to \f$x\f$.
+    void Laplacian(const T* x, T* y) const;
+
+    //! Calls Recognize() unless the result for the operator is cached.
+    bool RecognizeCached(const CLinearOperator<T>& A, double& alpha, double& beta) const;
+
+};
+
+}
+
+#endif /* R4RFFT_H_ */
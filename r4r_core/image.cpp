@@ -23,6 +23,11 @@
 
 #include "image.h"
 #include <string.h>
+#include <algorithm>
+
+#ifdef __SSE4_1__
+#include <smmintrin.h>
+#endif
 
 using namespace std;
 
@@ -220,108 +225,198 @@ CRGBImage CRGBImage::Clone(CRectangle<T> roi) {
 }*/
 
 
+//! Adds a run of values to another one.
 template<typename T>
-CIntImage<T>::CIntImage(size_t width, size_t height):
-    CDenseArray<T>::CDenseArray(height,width) {}
+static inline void AccumulateRun(T* dst, const T* src, size_t n) {
+
+    for(size_t k=0; k<n; k++)
+        dst[k] += src[k];
 
+}
+
+//! Computes the inclusive prefix sum of a run of values.
 template<typename T>
-void CIntImage<T>::Compute() {
+static inline void ScanRun(T* p, size_t n) {
+
+    for(size_t k=1; k<n; k++)
+        p[k] += p[k-1];
+
+}
 
-    if(this->NCols()>=this->NRows()) {
+#ifdef __SSE4_1__
+template<>
+inline void AccumulateRun<float>(float* dst, const float* src, size_t n) {
 
-        for(size_t d=1; d<this->NRows(); d++) {
+    size_t k = 0;
 
-            // process the quadratic part of the matrix
-            for(size_t i=0; i<d; i++) {
+    for(; k+4<=n; k+=4)
+        _mm_storeu_ps(dst+k,_mm_add_ps(_mm_loadu_ps(dst+k),_mm_loadu_ps(src+k)));
 
-                if(i==0) {
+    for(; k<n; k++)
+        dst[k] += src[k];
 
-                    // column above (d+d)
-                    this->operator ()(d,i) += this->Get(d-1,i);
+}
 
-                    // row left of (d+d)
-                    this->operator ()(i,d) += this->Get(i,d-1);
+template<>
+inline void AccumulateRun<double>(double* dst, const double* src, size_t n) {
 
-                }
-                else {
+    size_t k = 0;
 
-                    // column above (d+d)
-                    this->operator ()(d,i) += this->Get(d,i-1) + this->Get(d-1,i) - this->Get(d-1,i-1);
+    for(; k+2<=n; k+=2)
+        _mm_storeu_pd(dst+k,_mm_add_pd(_mm_loadu_pd(dst+k),_mm_loadu_pd(src+k)));
 
-                    // row left of (d+d)
-                    this->operator ()(i,d) += this->Get(i,d-1) + this->Get(i-1,d) - this->Get(i-1,d-1);
+    for(; k<n; k++)
+        dst[k] += src[k];
 
-                }
+}
 
-            }
+template<>
+inline void AccumulateRun<int>(int* dst, const int* src, size_t n) {
 
-            // value at (d+d)
-            this->operator ()(d,d) += this->Get(d,d-1) + this->Get(d-1,d) - this->Get(d-1,d-1);
+    size_t k = 0;
 
-        }
+    for(; k+4<=n; k+=4) {
 
-        // process the remaining columns
-        for(size_t j=this->NRows(); j<this->NCols(); j++) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(dst+k));
+        __m128i b = _mm_loadu_si128((const __m128i*)(src+k));
+        _mm_storeu_si128((__m128i*)(dst+k),_mm_add_epi32(a,b));
 
-            for(size_t i=0; i<this->NRows(); i++) {
+    }
 
-                if(i==0)
-                    this->operator ()(i,j) += this->Get(i,j-1);
-                else
-                    this->operator ()(i,j) += this->Get(i,j-1) + this->Get(i-1,j) - this->Get(i-1,j-1);
+    for(; k<n; k++)
+        dst[k] += src[k];
 
-            }
+}
 
-        }
+template<>
+inline void AccumulateRun<size_t>(size_t* dst, const size_t* src, size_t n) {
+
+    size_t k = 0;
+
+    for(; k+2<=n; k+=2) {
+
+        __m128i a = _mm_loadu_si128((const __m128i*)(dst+k));
+        __m128i b = _mm_loadu_si128((const __m128i*)(src+k));
+        _mm_storeu_si128((__m128i*)(dst+k),_mm_add_epi64(a,b));
 
     }
-    else {
 
-        for(size_t d=1; d<this->NCols(); d++) {
+    for(; k<n; k++)
+        dst[k] += src[k];
+
+}
 
-            for(size_t i=0; i<d; i++) {
+template<>
+inline void ScanRun<float>(float* p, size_t n) {
 
-                if(i==0) {
+    __m128 carry = _mm_setzero_ps();
+    size_t k = 0;
 
-                    // column above (d+d)
-                    this->operator ()(d,i) += this->Get(d-1,i);
+    // prefix sum within a register by two shifted additions, then add the carry from the left
+    for(; k+4<=n; k+=4) {
 
-                    // row left of (d+d)
-                    this->operator ()(i,d) += this->Get(i,d-1);
+        __m128 x = _mm_loadu_ps(p+k);
+        x = _mm_add_ps(x,_mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x),4)));
+        x = _mm_add_ps(x,_mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x),8)));
+        x = _mm_add_ps(x,carry);
+        _mm_storeu_ps(p+k,x);
+        carry = _mm_shuffle_ps(x,x,_MM_SHUFFLE(3,3,3,3));
 
-                }
-                else {
+    }
 
-                    // column above (d+d)
-                    this->operator ()(d,i) += this->Get(d,i-1) + this->Get(d-1,i) - this->Get(d-1,i-1);
+    float last = k>0 ? p[k-1] : 0;
 
-                    // row left of (d+d)
-                    this->operator ()(i,d) += this->Get(i,d-1) + this->Get(i-1,d) - this->Get(i-1,d-1);
+    for(; k<n; k++) {
 
-                }
+        p[k] += last;
+        last = p[k];
 
+    }
 
-            }
+}
 
-            // value at (d+d)
-            this->operator ()(d,d) += this->Get(d,d-1) + this->Get(d-1,d) - this->Get(d-1,d-1);
+template<>
+inline void ScanRun<int>(int* p, size_t n) {
 
-        }
+    __m128i carry = _mm_setzero_si128();
+    size_t k = 0;
 
-        // process the remaining row
-        for(size_t i=this->NCols(); i<this->NRows(); i++) {
+    for(; k+4<=n; k+=4) {
 
-            for(size_t j=0; j<this->NCols(); j++) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(p+k));
+        x = _mm_add_epi32(x,_mm_slli_si128(x,4));
+        x = _mm_add_epi32(x,_mm_slli_si128(x,8));
+        x = _mm_add_epi32(x,carry);
+        _mm_storeu_si128((__m128i*)(p+k),x);
+        carry = _mm_shuffle_epi32(x,_MM_SHUFFLE(3,3,3,3));
 
-                if(j==0)
-                    this->operator ()(i,j) += this->Get(i-1,j);
-                else
-                    this->operator ()(i,j) += this->Get(i,j-1) + this->Get(i-1,j) - this->Get(i-1,j-1);
+    }
 
+    int last = k>0 ? p[k-1] : 0;
 
-            }
+    for(; k<n; k++) {
 
-        }
+        p[k] += last;
+        last = p[k];
+
+    }
+
+}
+#endif
+
+template<typename T>
+CIntImage<T>::CIntImage(size_t width, size_t height):
+    CDenseArray<T>::CDenseArray(height,width) {}
+
+template<typename T>
+void CIntImage<T>::Reset(size_t width, size_t height) {
+
+    if(this->NCols()!=width || this->NRows()!=height)
+        CDenseArray<T>::operator=(CDenseArray<T>(height,width));
+    else
+        Clear();
+
+}
+
+template<typename T>
+void CIntImage<T>::Clear() {
+
+    std::fill_n(this->m_data.get(),this->NElems(),T(0));
+
+}
+
+template<typename T>
+void CIntImage<T>::Compute() {
+
+    // data is stored in runs along columns, or along rows if the array is transposed
+    size_t n = this->m_transpose ? this->NCols() : this->NRows();
+    size_t m = this->m_transpose ? this->NRows() : this->NCols();
+
+    if(n==0 || m==0)
+        return;
+
+    T* pdata = this->m_data.get();
+
+    // small images are not worth the threading overhead
+    const size_t minparallel = 1<<16;
+    const size_t tile = 1024;
+
+    // prefix sum along each run
+    #pragma omp parallel for if(n*m>=minparallel)
+    for(int r=0; r<int(m); r++)
+        ScanRun(pdata+r*n,n);
+
+    // running sum of runs, each thread owns a tile of rows so that it reads its own results
+    size_t ntiles = (n + tile - 1)/tile;
+
+    #pragma omp parallel for if(n*m>=minparallel)
+    for(int t=0; t<int(ntiles); t++) {
+
+        size_t k0 = t*tile;
+        size_t len = std::min(tile,n-k0);
+
+        for(size_t r=1; r<m; r++)
+            AccumulateRun(pdata+r*n+k0,pdata+(r-1)*n+k0,len);
 
     }
 
@@ -334,9 +429,58 @@ void CIntImage<T>::AddMass(size_t i, size_t j, T val) {
 
 }
 
+template<typename T>
+void CIntImage<T>::AddMassToIntegral(size_t i, size_t j, T val) {
+
+    UpdateQuadrant(i,j,val,true);
+
+}
+
+template<typename T>
+void CIntImage<T>::RemoveMassFromIntegral(size_t i, size_t j, T val) {
+
+    UpdateQuadrant(i,j,val,false);
+
+}
+
+template<typename T>
+void CIntImage<T>::UpdateQuadrant(size_t i, size_t j, T val, bool add) {
+
+    if(i>=this->NRows() || j>=this->NCols())
+        return;
+
+    size_t n = this->m_transpose ? this->NCols() : this->NRows();
+    size_t m = this->m_transpose ? this->NRows() : this->NCols();
+    size_t r0 = this->m_transpose ? i : j;
+    size_t k0 = this->m_transpose ? j : i;
+
+    T* pdata = this->m_data.get();
+
+    for(size_t r=r0; r<m; r++) {
+
+        T* p = pdata + r*n;
+
+        if(add) {
+
+            for(size_t k=k0; k<n; k++)
+                p[k] += val;
+
+        }
+        else {
+
+            for(size_t k=k0; k<n; k++)
+                p[k] -= val;
+
+        }
+
+    }
+
+}
+
 template class CIntImage<size_t>;
 template class CIntImage<double>;
 template class CIntImage<float>;
+template class CIntImage<int>;
 
 
 } // end of namespace
@@ -133,7 +133,11 @@ private:
 
 /*! \brief integral image
  *
- *
+ * \details The integral is computed in two passes over contiguous memory, a prefix sum along
+ * each column followed by a running sum of columns. Both passes are vectorized and distributed
+ * among threads. For counting, CIntImage<int> is preferable over CIntImage<size_t> because its
+ * kernels process four instead of two entries at a time. This is safe as long as the total mass
+ * stays below \f$2^{31}\f$.
  *
  */
 template<typename T>
@@ -144,6 +148,16 @@ public:
     //! Constructor.
     CIntImage(size_t width, size_t height);
 
+    /*! \brief Prepares the image for a new frame.
+     *
+     * \details Memory is only reallocated if the size changes, otherwise the image is cleared.
+     *
+     */
+    void Reset(size_t width, size_t height);
+
+    //! Sets all values to zero.
+    void Clear();
+
     //! Computes the integral.
     void Compute();
 
@@ -186,6 +200,25 @@ public:
      */
     void AddMass(size_t i, size_t j, T val);
 
+    /*! \brief Adds mass to a point after the integral has been computed.
+     *
+     * \param[in] i row index
+     * \param[in] j column index
+     * \param[in] val amount of mass to add
+     *
+     * \details Only the quadrant below and right of the point is updated. This is cheaper than
+     * calling Compute() again when only a few points change.
+     *
+     */
+    void AddMassToIntegral(size_t i, size_t j, T val);
+
+    /*! \brief Removes mass from a point after the integral has been computed.
+     *
+     * \copydetails AddMassToIntegral(size_t,size_t,T)
+     *
+     */
+    void RemoveMassFromIntegral(size_t i, size_t j, T val);
+
     /*! \brief Evaluates the integral image at corners of a rectangular window around a location.
      *
      * \param[in] x center of the integration domain
@@ -226,6 +259,8 @@ public:
 
 private:
 
+    //! Adds or subtracts a value in the quadrant below and right of a point.
+    void UpdateQuadrant(size_t i, size_t j, T val, bool add);
 
 };
 
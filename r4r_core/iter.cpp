@@ -29,11 +29,101 @@
 #include <stdio.h>
 #include <assert.h>
 #include <iostream>
+#include <limits>
+#include <algorithm>
 
 namespace R4R {
 
 using namespace std;
 
+template<typename T>
+bool CSolverWorkspace<T>::Reserve(size_t k, size_t n, size_t s) {
+
+    size_t size = k*Stride(n) + s;
+
+    if(size<=m_size && m_data)
+        return false;
+
+#ifndef __SSE4_1__
+    m_data.reset(new T[size],CDenseMatrixDeallocator<T>());
+#else
+    m_data.reset((T*)_mm_malloc(size*sizeof(T),16),CDenseMatrixDeallocator<T>());
+#endif
+
+    fill_n(m_data.get(),size,T(0));
+    m_size = size;
+
+    return true;
+
+}
+
+template class CSolverWorkspace<double>;
+template class CSolverWorkspace<float>;
+
+//! Inner product of two blocks of raw memory.
+template<typename T>
+static double Dot(const T* x, const T* y, size_t n) {
+
+    double sum = 0;
+
+    #pragma omp parallel for reduction(+:sum)
+    for(size_t i=0; i<n; i++)
+        sum += (double)x[i]*(double)y[i];
+
+    return sum;
+
+}
+
+//! Computes \f$y=y+ax\f$ on blocks of raw memory.
+template<typename T>
+static void Axpy(T a, const T* x, T* y, size_t n) {
+
+    #pragma omp parallel for
+    for(size_t i=0; i<n; i++)
+        y[i] += a*x[i];
+
+}
+
+//! Solves a multi-column system column by column with a single right-hand side solver.
+template<class Solver,class Matrix,typename T>
+static vector<double> IterateColumnwise(const Solver& solver, const Matrix& A, const CDenseArray<T>& B, CDenseArray<T>& X) {
+
+    vector<double> res;
+
+    for(size_t j=0; j<B.NCols(); j++) {
+
+        CDenseVector<T> b = B.GetColumn(j);
+        CDenseVector<T> x = X.GetColumn(j);
+
+        vector<double> resj = solver.Iterate(A,b,x);
+
+        // might not be a view
+        X.SetColumn(j,x);
+
+        // a solver that did not record anything does not contribute
+        if(resj.empty())
+            continue;
+
+        // accumulate Frobenius norm of the residual
+        if(resj.size()>res.size())
+            res.resize(resj.size(),res.empty() ? 0 : res.back());
+
+        for(size_t k=0; k<res.size(); k++) {
+
+            double rk = k<resj.size() ? resj[k] : resj.back();
+            res[k] += rk*rk;
+
+        }
+
+    }
+
+    for(size_t k=0; k<res.size(); k++)
+        res[k] = sqrt(res[k]);
+
+    return res;
+
+}
+
 template<class Matrix,typename T>
 CConjugateGradientMethod<Matrix,T>::CConjugateGradientMethod(const CPreconditioner<Matrix,T>& M, size_t n, double eps, bool silent):
     CIterativeLinearSolver<Matrix,T>::CIterativeLinearSolver(M,n,eps,silent) {}
@@ -49,46 +139,68 @@ vector<double> CConjugateGradientMethod<Matrix,T>::Iterate(const Matrix& A, cons
 
     }
 
+    size_t m = X.NRows();
+    size_t d = X.NCols();
+    size_t nelems = X.NElems();
+
+    // residual, preconditioned residual, descent direction, product, one inner product per column
+    m_workspace.Reserve(4,nelems,d);
+    CDenseArray<T> R = m_workspace.GetArray(0,nelems,m,d);
+    CDenseArray<T> Z = m_workspace.GetArray(1,nelems,m,d);
+    CDenseArray<T> P = m_workspace.GetArray(2,nelems,m,d);
+    CDenseArray<T> Q = m_workspace.GetArray(3,nelems,m,d);
+    T* pdelta = m_workspace.GetScalars(4,nelems);
+
+    T* px = X.Data().get();
+    const T* pb = B.Data().get();
+    T* pr = R.Data().get();
+    T* pp = P.Data().get();
+    const T* pq = Q.Data().get();
+
     // init iteration index
     size_t k = 0;
 
     // compute residual
-    CDenseArray<T> R = B - A*X;
+    A.Multiply(X,R);
+
+    #pragma omp parallel for
+    for(size_t i=0; i<nelems; i++)
+        pr[i] = pb[i] - pr[i];
 
     // residual norm
     vector<double> res;
-    res.push_back(R.Norm2());
+    res.push_back(sqrt(Dot(pr,pr,nelems)));
 
     if(!m_silent)
         cout << "k=" << k << ": " << res.back() << endl;
 
-    // make a copy for the temporary variable used in pre-conditioning
-    CDenseArray<T> Z = R.Clone();
-
-    // apply preconditioner
+    // apply preconditioner (the identity only re-directs the header of Z)
     m_M.Solve(Z,R);
+    const T* pz = Z.Data().get();
 
-    CDenseVector<T> deltan = CDenseArray<T>::ColumwiseInnerProduct(Z,R);
+    for(size_t j=0; j<d; j++)
+        pdelta[j] = Dot(pz+j*m,pr+j*m,m);
 
     // init descent direction
-    CDenseArray<T> P = Z.Clone();
+    copy(pz,pz+nelems,pp);
 
     while(k<m_n) {
 
-        CDenseArray<T> Q = A*P;
+        A.Multiply(P,Q);
 
-        CDenseVector<T> pq =  CDenseArray<T>::ColumwiseInnerProduct(P,Q);
-        CDenseVector<T> alpha = deltan/pq;
+        // column-wise descent step and residual update
+        for(size_t j=0; j<d; j++) {
 
-        // descent step
-        X = X + P.ScaleColumns(alpha);
+            T pqj = Dot(pp+j*m,pq+j*m,m);
+            T alpha = pqj!=0 ? pdelta[j]/pqj : 0;
 
-        // update residual
-        Q = Q.ScaleColumns(alpha);
-        R = R - Q;
+            Axpy(alpha,pp+j*m,px+j*m,m);
+            Axpy(-alpha,pq+j*m,pr+j*m,m);
+
+        }
 
         // check convergence
-        res.push_back(R.Norm2());
+        res.push_back(sqrt(Dot(pr,pr,nelems)));
 
         k++;
 
@@ -100,18 +212,23 @@ vector<double> CConjugateGradientMethod<Matrix,T>::Iterate(const Matrix& A, cons
 
         // apply pre-conditioner
         m_M.Solve(Z,R);
+        pz = Z.Data().get();
+
+        // update descent direction
+        for(size_t j=0; j<d; j++) {
 
-        // make a copy of deltan
-        CDenseVector<T> deltao = deltan.Clone();
+            T deltan = Dot(pz+j*m,pr+j*m,m);
+            T beta = pdelta[j]!=0 ? deltan/pdelta[j] : 0;
+            pdelta[j] = deltan;
 
-        // column-wise inner product
-        deltan = CDenseVector<T>::ColumwiseInnerProduct(Z,R);
+            T* ppj = pp + j*m;
+            const T* pzj = pz + j*m;
 
-        // component-wise division
-        CDenseVector<T> beta = deltan/deltao;
+            #pragma omp parallel for
+            for(size_t i=0; i<m; i++)
+                ppj[i] = pzj[i] + beta*ppj[i];
 
-        // update descent direction
-        P = Z + P.ScaleColumns(beta);
+        }
 
     }
 
@@ -130,37 +247,53 @@ vector<double> CConjugateGradientMethod<Matrix,T>::Iterate(const Matrix& A, cons
 
     }
 
+    size_t n = x.NElems();
+
+    // residual, preconditioned residual, descent direction, product
+    m_workspace.Reserve(4,n);
+    CDenseVector<T> r = m_workspace.GetVector(0,n);
+    CDenseVector<T> z = m_workspace.GetVector(1,n);
+    CDenseVector<T> p = m_workspace.GetVector(2,n);
+    CDenseVector<T> q = m_workspace.GetVector(3,n);
+
+    T* px = x.Data().get();
+    const T* pb = b.Data().get();
+    T* pr = r.Data().get();
+    T* pp = p.Data().get();
+    const T* pq = q.Data().get();
+
     // init
     size_t k = 0;
 
-    CDenseVector<T> r = b - A*x;
+    A.Multiply(x,r);
+
+    #pragma omp parallel for
+    for(size_t i=0; i<n; i++)
+        pr[i] = pb[i] - pr[i];
 
     vector<double> res;
-    res.push_back(r.Norm2());
+    res.push_back(sqrt(Dot(pr,pr,n)));
 
     if(!m_silent)
         cout << "k=" << k << ": " << res.back() << endl;
 
-    CDenseVector<T> z = r.Clone();
-
     m_M.Solve(z,r);
+    const T* pz = z.Data().get();
 
-    T deltao = CDenseArray<T>::InnerProduct(z,r);
+    T deltao = Dot(pz,pr,n);
 
-    CDenseVector<T> p = z.Clone();
+    copy(pz,pz+n,pp);
 
     while(k<m_n) {
 
-        CDenseVector<T> q = A*p;
+        A.Multiply(p,q);
 
-        T alpha = deltao/CDenseArray<T>::InnerProduct(p,q);
+        T alpha = deltao/Dot(pp,pq,n);
 
-        x = x + p*alpha;
+        Axpy(alpha,pp,px,n);
+        Axpy(-alpha,pq,pr,n);
 
-        q.Scale(alpha);
-        r = r - q;
-
-        res.push_back(r.Norm2());
+        res.push_back(sqrt(Dot(pr,pr,n)));
 
         k++;
 
@@ -170,16 +303,16 @@ vector<double> CConjugateGradientMethod<Matrix,T>::Iterate(const Matrix& A, cons
         if(res.back()<m_eps)
             break;
 
-
         m_M.Solve(z,r);
+        pz = z.Data().get();
 
-        T deltan = CDenseArray<T>::InnerProduct(z,r);
+        T deltan = Dot(pz,pr,n);
 
         T beta = deltan/deltao;
 
-        p.Scale(beta);
-
-        p = z + p;
+        #pragma omp parallel for
+        for(size_t i=0; i<n; i++)
+            pp[i] = pz[i] + beta*pp[i];
 
         deltao = deltan;
 
@@ -195,6 +328,8 @@ template class CConjugateGradientMethod<CDenseArray<float>,float>;
 template class CConjugateGradientMethod<CSparseArray<float>,float>;
 template class CConjugateGradientMethod<CSymmetricCSRMatrix<float,size_t>,float>;
 template class CConjugateGradientMethod<CSymmetricCSRMatrix<double,size_t>,double>;
+template class CConjugateGradientMethod<CLinearOperator<double>,double>;
+template class CConjugateGradientMethod<CLinearOperator<float>,float>;
 
 template<class Matrix,typename T>
 CConjugateGradientMethodLeastSquares<Matrix,T>::CConjugateGradientMethodLeastSquares(const CPreconditioner<Matrix,T>& M, size_t n, double eps, bool silent):
@@ -212,33 +347,59 @@ vector<double> CConjugateGradientMethodLeastSquares<Matrix,T>::Iterate(const Mat
 
     /* Get a transposed copy of the input matrix. This way we can keep the input reference
      * constant (would not work for in-place back and forth transposition). The overhead is
-     * minimal for the dense matrix structure because smart pointers are used. Need to introduce
-     * same structure to sparse matrix classes.
+     * minimal because all matrix classes share their data among shallow copies, and only
+     * the transposition flag is flipped.
      *
      */
-    Matrix At = Matrix::Transpose(A);
+    const Matrix At = Matrix::Transpose(A);
+
+    size_t m = A.NRows();
+    size_t n = A.NCols();
+    size_t d = X.NCols();
+    size_t nelems = max(m,n)*d;
+
+    // residuals of the non-square system and normal equation, preconditioned residual, direction, product
+    m_workspace.Reserve(5,nelems,d);
+    CDenseArray<T> R = m_workspace.GetArray(0,nelems,m,d);
+    CDenseArray<T> Rnormal = m_workspace.GetArray(1,nelems,n,d);
+    CDenseArray<T> Z = m_workspace.GetArray(2,nelems,n,d);
+    CDenseArray<T> P = m_workspace.GetArray(3,nelems,n,d);
+    CDenseArray<T> Q = m_workspace.GetArray(4,nelems,m,d);
+    T* pdelta = m_workspace.GetScalars(5,nelems);
+
+    T* px = X.Data().get();
+    const T* pb = B.Data().get();
+    T* pr = R.Data().get();
+    const T* prn = Rnormal.Data().get();
+    T* pp = P.Data().get();
+    const T* pq = Q.Data().get();
 
     // init
     size_t k = 0;
 
     // residual of the non-square system
-    CDenseArray<T> R = B - A*X;
+    A.Multiply(X,R);
+
+    #pragma omp parallel for
+    for(size_t i=0; i<m*d; i++)
+        pr[i] = pb[i] - pr[i];
 
     // strore it
     vector<double> res;
-    res.push_back(R.Norm2());
+    res.push_back(sqrt(Dot(pr,pr,m*d)));
 
     // residual of the normal equation
-    CDenseArray<T> Rnormal = At*R;
+    At.Multiply(R,Rnormal);
 
     // preconditioning
-    CDenseArray<T> Z = Rnormal.Clone();
     m_M.Solve(Z,Rnormal);
+    const T* pz = Z.Data().get();
 
-    CDenseVector<T> deltao = CDenseArray<T>::ColumwiseInnerProduct(Z,Rnormal);
+    for(size_t j=0; j<d; j++)
+        pdelta[j] = Dot(pz+j*n,prn+j*n,n);
 
     // descent direction
-    CDenseArray<T> P = Z.Clone();
+    copy(pz,pz+n*d,pp);
 
     if(!m_silent)
         cout << "k=" << k << ": " << res.back() << endl;
@@ -249,20 +410,24 @@ vector<double> CConjugateGradientMethodLeastSquares<Matrix,T>::Iterate(const Mat
     while(k<m_n) {
 
         // need that later
-        CDenseArray<T> Q = A*P;
+        A.Multiply(P,Q);
 
-        // step siz
-        CDenseVector<T> qq = CDenseArray<T>::ColumwiseInnerProduct(Q,Q);
-        CDenseVector<T> alpha = deltao/qq;
+        for(size_t j=0; j<d; j++) {
 
-        // perform descent step
-        X = X + P.ScaleColumns(alpha);
+            // step size
+            T qq = Dot(pq+j*m,pq+j*m,m);
+            T alpha = qq!=0 ? pdelta[j]/qq : 0;
 
-        // update residual of non-square system
-        R = R - Q.ScaleColumns(alpha);
+            // perform descent step
+            Axpy(alpha,pp+j*n,px+j*n,n);
+
+            // update residual of non-square system
+            Axpy(-alpha,pq+j*m,pr+j*m,m);
+
+        }
 
         // check convergence
-        res.push_back(R.Norm2());
+        res.push_back(sqrt(Dot(pr,pr,m*d)));
 
         k++;
 
@@ -274,18 +439,28 @@ vector<double> CConjugateGradientMethodLeastSquares<Matrix,T>::Iterate(const Mat
             break;
 
         // update residual of normal equation
-        Rnormal = At*R;
+        At.Multiply(R,Rnormal);
 
         // apply preconditioner
         m_M.Solve(Z,Rnormal);
+        pz = Z.Data().get();
 
-        // update beta
-        CDenseVector<T> deltan = CDenseArray<T>::ColumwiseInnerProduct(Z,Rnormal);
-        CDenseVector<T> beta = deltan/deltao;
-        deltao = deltan;
+        for(size_t j=0; j<d; j++) {
 
-        // update direction
-        P = Z + P.ScaleColumns(beta);
+            // update beta
+            T deltan = Dot(pz+j*n,prn+j*n,n);
+            T beta = pdelta[j]!=0 ? deltan/pdelta[j] : 0;
+            pdelta[j] = deltan;
+
+            // update direction
+            T* ppj = pp + j*n;
+            const T* pzj = pz + j*n;
+
+            #pragma omp parallel for
+            for(size_t i=0; i<n; i++)
+                ppj[i] = pzj[i] + beta*ppj[i];
+
+        }
 
     }
 
@@ -303,36 +478,60 @@ vector<double> CConjugateGradientMethodLeastSquares<Matrix,T>::Iterate(const Mat
 
     }
 
-    /* Get a transposed copy of the input matrix. This way we can keep the input reference
-     * constant (would not work for in-place back and forth transposition). The overhead is
-     * minimal for the dense matrix structure because smart pointers are used. Need to introduce
-     * same structure to sparse matrix classes.
-     *
-     */
-    Matrix At = Matrix::Transpose(A);
+    // see above
+    const Matrix At = Matrix::Transpose(A);
+
+    size_t m = A.NRows();
+    size_t n = A.NCols();
+    size_t nmax = max(m,n);
+
+    // residuals of the non-square system, regularization, and normal equation, preconditioned residual, direction, product
+    m_workspace.Reserve(6,nmax);
+    CDenseVector<T> r = m_workspace.GetVector(0,nmax,m);
+    CDenseVector<T> rlambda = m_workspace.GetVector(1,nmax,n);
+    CDenseVector<T> rnormal = m_workspace.GetVector(2,nmax,n);
+    CDenseVector<T> z = m_workspace.GetVector(3,nmax,n);
+    CDenseVector<T> p = m_workspace.GetVector(4,nmax,n);
+    CDenseVector<T> q = m_workspace.GetVector(5,nmax,m);
+
+    T* px = x.Data().get();
+    const T* pb = b.Data().get();
+    T* pr = r.Data().get();
+    T* prl = rlambda.Data().get();
+    T* prn = rnormal.Data().get();
+    T* pp = p.Data().get();
+    const T* pq = q.Data().get();
 
     // init
     size_t k = 0;
 
     // residual of the non-square system
-    CDenseVector<T> r = b - A*x;
-    CDenseVector<T> rlambda = x*(-m_lambda);
+    A.Multiply(x,r);
+
+    #pragma omp parallel for
+    for(size_t i=0; i<m; i++)
+        pr[i] = pb[i] - pr[i];
+
+    #pragma omp parallel for
+    for(size_t i=0; i<n; i++)
+        prl[i] = -m_lambda*px[i];
 
     // residuals
     vector<double> res;
-    res.push_back(r.Norm2()+rlambda.Norm2());
+    res.push_back(sqrt(Dot(pr,pr,m))+sqrt(Dot(prl,prl,n)));
 
     // residual of the normal equation
-    CDenseVector<T> rnormal = At*r + rlambda*m_lambda;
+    At.Multiply(r,rnormal);
+    Axpy(m_lambda,prl,prn,n);
 
     // preconditioning
-    CDenseVector<T> z = rnormal.Clone();
     m_M.Solve(z,rnormal);
+    const T* pz = z.Data().get();
 
     // descent direction
-    CDenseVector<T> p = z.Clone();
+    copy(pz,pz+n,pp);
 
-    T deltao = CDenseArray<T>::InnerProduct(z,rnormal);
+    T deltao = Dot(pz,prn,n);
 
     if(!m_silent)
         cout << "k=" << k << ": " << res.back() << endl;
@@ -340,19 +539,19 @@ vector<double> CConjugateGradientMethodLeastSquares<Matrix,T>::Iterate(const Mat
     while(k<m_n) {
 
         // need that later
-        CDenseVector<T> q = A*p;
+        A.Multiply(p,q);
 
         // step size (recycle deltao for computation of beta)
-        T alpha = deltao/(CDenseArray<T>::InnerProduct(q,q) + m_lambda*m_lambda*CDenseArray<T>::InnerProduct(p,p));
+        T alpha = deltao/(Dot(pq,pq,m) + m_lambda*m_lambda*Dot(pp,pp,n));
 
         // perform descent step
-        x = x + p*alpha;
+        Axpy(alpha,pp,px,n);
 
-        q.Scale(alpha);
-        r = r - q;				// update residual of non-square system
-        rlambda = rlambda - p*(m_lambda*alpha);
+        // update residual of non-square system
+        Axpy(-alpha,pq,pr,m);
+        Axpy(-m_lambda*alpha,pp,prl,n);
 
-        res.push_back(r.Norm2()+rlambda.Norm2());
+        res.push_back(sqrt(Dot(pr,pr,m))+sqrt(Dot(prl,prl,n)));
 
         k++;
 
@@ -363,19 +562,22 @@ vector<double> CConjugateGradientMethodLeastSquares<Matrix,T>::Iterate(const Mat
             break;
 
         // update residual of normal equation
-        rnormal = At*r + rlambda*m_lambda;
+        At.Multiply(r,rnormal);
+        Axpy(m_lambda,prl,prn,n);
 
         // apply preconditioner
         m_M.Solve(z,rnormal);
+        pz = z.Data().get();
 
         // update beta
-        T deltan = CDenseArray<T>::InnerProduct(z,rnormal);
+        T deltan = Dot(pz,prn,n);
         T beta = deltan/deltao;
         deltao = deltan;
 
         // update direction
-        p.Scale(beta);
-        p = z + p;
+        #pragma omp parallel for
+        for(size_t i=0; i<n; i++)
+            pp[i] = pz[i] + beta*pp[i];
 
     }
 
@@ -389,5 +591,828 @@ template class CConjugateGradientMethodLeastSquares<CDenseArray<float>,float>;
 template class CConjugateGradientMethodLeastSquares<CSparseArray<float>,float>;
 template class CConjugateGradientMethodLeastSquares<CCSRMatrix<double,size_t>,double>;
 template class CConjugateGradientMethodLeastSquares<CCSRMatrix<float,size_t>,float>;
+template class CConjugateGradientMethodLeastSquares<CLinearOperator<double>,double>;
+template class CConjugateGradientMethodLeastSquares<CLinearOperator<float>,float>;
+
+template<class Matrix,typename T>
+CChebyshevIteration<Matrix,T>::CChebyshevIteration(const CPreconditioner<Matrix,T>& M, size_t n, double eps, bool silent, size_t nlanczos, size_t ncheck):
+    CIterativeLinearSolver<Matrix,T>::CIterativeLinearSolver(M,n,eps,silent),
+    m_lmin(0),
+    m_lmax(0),
+    m_nlanczos(nlanczos),
+    m_ncheck(ncheck>0 ? ncheck : 1) {}
+
+template<class Matrix,typename T>
+bool CChebyshevIteration<Matrix,T>::GetSpectralBounds(const Matrix& A, bool normal, T& lmin, T& lmax) const {
+
+    if(m_lmax>0) {
+
+        lmin = m_lmin;
+        lmax = m_lmax;
+
+    }
+    else {
+
+        CSpectrumEstimator<Matrix,T> estimator(m_nlanczos,normal,m_lambda);
+        estimator.Estimate(A,lmin,lmax,&m_M);
+
+        /* The largest Ritz value approaches the spectrum from inside, and the iteration
+         * diverges for eigenvalues beyond the upper bound, so add a safety margin. Eigenvalues
+         * below the lower bound only slow down convergence.
+         */
+        lmax *= 1.1;
+
+    }
+
+    if(!(lmin>0 && lmax>=lmin)) {
+
+        cerr << "ERROR: Invalid spectral bounds [" << lmin << "," << lmax << "]." << endl;
+        return false;
+
+    }
+
+    return true;
+
+}
+
+template<class Matrix,typename T>
+template<class Array>
+vector<double> CChebyshevIteration<Matrix,T>::Solve(const Matrix& A, const Array& B, Array& X) const {
+
+    T lmin, lmax;
+    if(!GetSpectralBounds(A,false,lmin,lmax))
+        return vector<double>();
+
+    // center and half-width of the spectral interval
+    T theta = 0.5*(lmax+lmin);
+    T delta = max<T>(0.5*(lmax-lmin),numeric_limits<T>::epsilon()*theta);
+    T sigma = theta/delta;
+    T rho = 1/sigma;
+
+    size_t nelems = X.NElems();
+
+    // residual, preconditioned residual, correction, product
+    m_workspace.Reserve(4,nelems);
+    Array R = m_workspace.GetLike(0,nelems,X);
+    Array Z = m_workspace.GetLike(1,nelems,X);
+    Array D = m_workspace.GetLike(2,nelems,X);
+    Array Q = m_workspace.GetLike(3,nelems,X);
+
+    T* px = X.Data().get();
+    const T* pb = B.Data().get();
+    T* pr = R.Data().get();
+    T* pd = D.Data().get();
+    const T* pq = Q.Data().get();
+
+    // init
+    size_t k = 0;
+
+    A.Multiply(X,R);
+
+    #pragma omp parallel for
+    for(size_t i=0; i<nelems; i++)
+        pr[i] = pb[i] - pr[i];
+
+    vector<double> res;
+    res.push_back(R.Norm2());
+
+    if(!m_silent)
+        cout << "k=" << k << ": " << res.back() << endl;
+
+    if(res.back()<m_eps)
+        return res;
+
+    // the identity preconditioner only re-directs the header of Z
+    m_M.Solve(Z,R);
+    const T* pz = Z.Data().get();
+
+    // first correction
+    #pragma omp parallel for
+    for(size_t i=0; i<nelems; i++)
+        pd[i] = pz[i]/theta;
+
+    while(k<m_n) {
+
+        #pragma omp parallel for
+        for(size_t i=0; i<nelems; i++)
+            px[i] += pd[i];
+
+        A.Multiply(D,Q);
+
+        #pragma omp parallel for
+        for(size_t i=0; i<nelems; i++)
+            pr[i] -= pq[i];
+
+        k++;
+
+        // only synchronization point of the iteration
+        if(k%m_ncheck==0 || k==m_n) {
+
+            res.push_back(R.Norm2());
+
+            if(!m_silent)
+                cout << "k=" << k << ": " << res.back() << endl;
+
+            if(res.back()<m_eps)
+                break;
+
+        }
+
+        m_M.Solve(Z,R);
+        pz = Z.Data().get();
+
+        // three-term recurrence for the update
+        T rhon = 1/(2*sigma-rho);
+        T c1 = rhon*rho;
+        T c2 = 2*rhon/delta;
+
+        #pragma omp parallel for
+        for(size_t i=0; i<nelems; i++)
+            pd[i] = c1*pd[i] + c2*pz[i];
+
+        rho = rhon;
+
+    }
+
+    return res;
+
+}
+
+template<class Matrix,typename T>
+vector<double> CChebyshevIteration<Matrix,T>::Iterate(const Matrix& A, const CDenseArray<T>& B, CDenseArray<T>& X) const {
+
+    // check dimensions
+    if(!(A.NCols()==X.NRows() && X.NRows()==B.NRows() && X.NCols()==B.NCols())) {
+
+        cerr << "ERROR: Check matrix dimensions!" << endl;
+        return vector<double>();
+
+    }
+
+    return Solve(A,B,X);
+
+}
+
+template<class Matrix,typename T>
+vector<double> CChebyshevIteration<Matrix,T>::Iterate(const Matrix& A, const CDenseVector<T>& b, CDenseVector<T>& x) const {
+
+    // check dimensions
+    if(!(A.NCols()==x.NRows() && x.NRows()==b.NRows())) {
+
+        cerr << "ERROR: Check matrix dimensions!" << endl;
+        return vector<double>();
+
+    }
+
+    return Solve(A,b,x);
+
+}
+
+template class CChebyshevIteration<CDenseArray<double>,double>;
+template class CChebyshevIteration<CSparseArray<double>,double>;
+template class CChebyshevIteration<CDenseArray<float>,float>;
+template class CChebyshevIteration<CSparseArray<float>,float>;
+template class CChebyshevIteration<CSymmetricCSRMatrix<float,size_t>,float>;
+template class CChebyshevIteration<CSymmetricCSRMatrix<double,size_t>,double>;
+template class CChebyshevIteration<CCSRMatrix<double,size_t>,double>;
+template class CChebyshevIteration<CCSRMatrix<float,size_t>,float>;
+template class CChebyshevIteration<CLinearOperator<double>,double>;
+template class CChebyshevIteration<CLinearOperator<float>,float>;
+
+template<class Matrix,typename T>
+CChebyshevIterationLeastSquares<Matrix,T>::CChebyshevIterationLeastSquares(const CPreconditioner<Matrix,T>& M, size_t n, double eps, bool silent, size_t nlanczos, size_t ncheck):
+    CChebyshevIteration<Matrix,T>::CChebyshevIteration(M,n,eps,silent,nlanczos,ncheck) {}
+
+template<class Matrix,typename T>
+template<class Array>
+vector<double> CChebyshevIterationLeastSquares<Matrix,T>::Solve(const Matrix& A, const Array& B, Array& X) const {
+
+    T lmin, lmax;
+    if(!this->GetSpectralBounds(A,true,lmin,lmax))
+        return vector<double>();
+
+    T theta = 0.5*(lmax+lmin);
+    T delta = max<T>(0.5*(lmax-lmin),numeric_limits<T>::epsilon()*theta);
+    T sigma = theta/delta;
+    T rho = 1/sigma;
+
+    // see CConjugateGradientMethodLeastSquares::Iterate
+    const Matrix At = Matrix::Transpose(A);
+
+    size_t nelems = X.NElems();
+    size_t nelemsr = B.NElems();
+    size_t nmax = max(nelems,nelemsr);
+
+    // residuals of the non-square system, the regularization, and the normal equation,
+    // preconditioned residual, correction, product
+    m_workspace.Reserve(6,nmax);
+    Array R = m_workspace.GetLike(0,nmax,B);
+    Array Rlambda = m_workspace.GetLike(1,nmax,X);
+    Array Rnormal = m_workspace.GetLike(2,nmax,X);
+    Array Z = m_workspace.GetLike(3,nmax,X);
+    Array D = m_workspace.GetLike(4,nmax,X);
+    Array Q = m_workspace.GetLike(5,nmax,B);
+
+    T* px = X.Data().get();
+    const T* pb = B.Data().get();
+    T* pr = R.Data().get();
+    T* prl = Rlambda.Data().get();
+    T* prn = Rnormal.Data().get();
+    T* pd = D.Data().get();
+    const T* pq = Q.Data().get();
+
+    // init
+    size_t k = 0;
+
+    A.Multiply(X,R);
+
+    #pragma omp parallel for
+    for(size_t i=0; i<nelemsr; i++)
+        pr[i] = pb[i] - pr[i];
+
+    #pragma omp parallel for
+    for(size_t i=0; i<nelems; i++)
+        prl[i] = -m_lambda*px[i];
+
+    vector<double> res;
+    res.push_back(R.Norm2()+Rlambda.Norm2());
+
+    if(!m_silent)
+        cout << "k=" << k << ": " << res.back() << endl;
+
+    if(res.back()<m_eps)
+        return res;
+
+    // residual of the normal equation
+    At.Multiply(R,Rnormal);
+
+    #pragma omp parallel for
+    for(size_t i=0; i<nelems; i++)
+        prn[i] += m_lambda*prl[i];
+
+    m_M.Solve(Z,Rnormal);
+    const T* pz = Z.Data().get();
+
+    #pragma omp parallel for
+    for(size_t i=0; i<nelems; i++)
+        pd[i] = pz[i]/theta;
+
+    while(k<m_n) {
+
+        #pragma omp parallel for
+        for(size_t i=0; i<nelems; i++) {
+
+            px[i] += pd[i];
+            prl[i] -= m_lambda*pd[i];
+
+        }
+
+        A.Multiply(D,Q);
+
+        #pragma omp parallel for
+        for(size_t i=0; i<nelemsr; i++)
+            pr[i] -= pq[i];
+
+        k++;
+
+        if(k%m_ncheck==0 || k==m_n) {
+
+            res.push_back(R.Norm2()+Rlambda.Norm2());
+
+            if(!m_silent)
+                cout << "k=" << k << ": " << res.back() << endl;
+
+            if(fabs(res.at(res.size()-2)-res.back())<m_eps || res.back()<m_eps)
+                break;
+
+        }
+
+        // update residual of normal equation
+        At.Multiply(R,Rnormal);
+
+        #pragma omp parallel for
+        for(size_t i=0; i<nelems; i++)
+            prn[i] += m_lambda*prl[i];
+
+        m_M.Solve(Z,Rnormal);
+        pz = Z.Data().get();
+
+        T rhon = 1/(2*sigma-rho);
+        T c1 = rhon*rho;
+        T c2 = 2*rhon/delta;
+
+        #pragma omp parallel for
+        for(size_t i=0; i<nelems; i++)
+            pd[i] = c1*pd[i] + c2*pz[i];
+
+        rho = rhon;
+
+    }
+
+    return res;
+
+}
+
+template<class Matrix,typename T>
+vector<double> CChebyshevIterationLeastSquares<Matrix,T>::Iterate(const Matrix& A, const CDenseArray<T>& B, CDenseArray<T>& X) const {
+
+    if(!(A.NCols()==X.NRows() && A.NRows()==B.NRows() && X.NCols()==B.NCols())) {
+
+        cerr << "ERROR: Check matrix dimensions!" << endl;
+        return vector<double>();
+
+    }
+
+    return Solve(A,B,X);
+
+}
+
+template<class Matrix,typename T>
+vector<double> CChebyshevIterationLeastSquares<Matrix,T>::Iterate(const Matrix& A, const CDenseVector<T>& b, CDenseVector<T>& x) const {
+
+    if(!(A.NCols()==x.NRows() && A.NRows()==b.NRows())) {
+
+        cerr << "ERROR: Check matrix dimensions!" << endl;
+        return vector<double>();
+
+    }
+
+    return Solve(A,b,x);
+
+}
+
+template class CChebyshevIterationLeastSquares<CDenseArray<double>,double>;
+template class CChebyshevIterationLeastSquares<CSparseArray<double>,double>;
+template class CChebyshevIterationLeastSquares<CDenseArray<float>,float>;
+template class CChebyshevIterationLeastSquares<CSparseArray<float>,float>;
+template class CChebyshevIterationLeastSquares<CCSRMatrix<double,size_t>,double>;
+template class CChebyshevIterationLeastSquares<CCSRMatrix<float,size_t>,float>;
+template class CChebyshevIterationLeastSquares<CLinearOperator<double>,double>;
+template class CChebyshevIterationLeastSquares<CLinearOperator<float>,float>;
+
+template<class Matrix,typename T>
+CGeneralizedMinimalResidualMethod<Matrix,T>::CGeneralizedMinimalResidualMethod(const CPreconditioner<Matrix,T>& M, size_t n, double eps, bool silent, size_t m):
+    CIterativeLinearSolver<Matrix,T>::CIterativeLinearSolver(M,n,eps,silent),
+    m_m(m>0 ? m : 1) {}
+
+template<class Matrix,typename T>
+vector<double> CGeneralizedMinimalResidualMethod<Matrix,T>::Iterate(const Matrix& A, const CDenseArray<T>& B, CDenseArray<T>& X) const {
+
+    if(!(A.NCols()==X.NRows() && A.NRows()==B.NRows() && X.NCols()==B.NCols())) {
+
+        cerr << "ERROR: Check matrix dimensions!" << endl;
+        return vector<double>();
+
+    }
+
+    return IterateColumnwise(*this,A,B,X);
+
+}
+
+template<class Matrix,typename T>
+vector<double> CGeneralizedMinimalResidualMethod<Matrix,T>::Iterate(const Matrix& A, const CDenseVector<T>& b, CDenseVector<T>& x) const {
+
+    if(!(A.NCols()==x.NRows() && A.NRows()==b.NRows() && A.NRows()==A.NCols())) {
+
+        cerr << "ERROR: Check matrix dimensions!" << endl;
+        return vector<double>();
+
+    }
+
+    size_t n = x.NElems();
+    size_t m = m_m;
+
+    /* arena layout: m+1 basis vectors, one vector for preconditioning, then the
+     * Hessenberg matrix (col-major, (m+1) x m), the rotations and the rhs of the
+     * least-squares problem
+     */
+    m_workspace.Reserve(m+2,n,(m+1)*m+2*m+2*(m+1));
+    T* pH = m_workspace.GetScalars(m+2,n);
+    T* pc = pH + (m+1)*m;
+    T* ps = pc + m;
+    T* pg = ps + m;
+    T* py = pg + m+1;
+
+    CDenseVector<T> z = m_workspace.GetVector(m+1,n);
+
+    // init
+    size_t k = 0;
+
+    // the residual is computed in the memory of the first basis vector
+    CDenseVector<T> v0 = m_workspace.GetVector(0,n);
+    T* pv0 = v0.Data().get();
+    const T* pb = b.Data().get();
+
+    A.Multiply(x,v0);
+
+    #pragma omp parallel for
+    for(size_t i=0; i<n; i++)
+        pv0[i] = pb[i] - pv0[i];
+
+    double beta = sqrt(Dot(pv0,pv0,n));
+
+    vector<double> res;
+    res.push_back(beta);
+
+    if(!m_silent)
+        cout << "k=" << k << ": " << res.back() << endl;
+
+    while(k<m_n && beta>=m_eps) {
+
+        // first basis vector
+        T betainv = 1/beta;
+
+        #pragma omp parallel for
+        for(size_t i=0; i<n; i++)
+            pv0[i] *= betainv;
+
+        fill_n(pg,m+1,T(0));
+        pg[0] = beta;
+
+        size_t j = 0;
+
+        while(j<m && k<m_n) {
+
+            // w = A*M^{-1}*v_j
+            CDenseVector<T> vj = m_workspace.GetVector(j,n);
+            CDenseVector<T> zj = z;
+            m_M.Solve(zj,vj);
+            CDenseVector<T> w = m_workspace.GetVector(j+1,n);
+            A.Multiply(zj,w);
+
+            T* pw = w.Data().get();
+
+            // modified Gram-Schmidt
+            T* ph = pH + j*(m+1);
+
+            for(size_t i=0; i<=j; i++) {
+
+                const T* pvi = m_workspace.Get(i,n);
+
+                ph[i] = Dot(pw,pvi,n);
+                Axpy(-ph[i],pvi,pw,n);
+
+            }
+
+            ph[j+1] = sqrt(Dot(pw,pw,n));
+
+            if(ph[j+1]!=0) {
+
+                T scale = 1/ph[j+1];
+
+                #pragma omp parallel for
+                for(size_t i=0; i<n; i++)
+                    pw[i] *= scale;
+
+            }
+
+            // apply previous rotations to the new column
+            for(size_t i=0; i<j; i++) {
+
+                T temp = pc[i]*ph[i] + ps[i]*ph[i+1];
+                ph[i+1] = -ps[i]*ph[i] + pc[i]*ph[i+1];
+                ph[i] = temp;
+
+            }
+
+            // compute new rotation that annihilates the subdiagonal element
+            T denom = sqrt(ph[j]*ph[j]+ph[j+1]*ph[j+1]);
+
+            if(denom==0) {
+
+                pc[j] = 1;
+                ps[j] = 0;
+
+            }
+            else {
+
+                pc[j] = ph[j]/denom;
+                ps[j] = ph[j+1]/denom;
+
+            }
+
+            ph[j] = pc[j]*ph[j] + ps[j]*ph[j+1];
+            ph[j+1] = 0;
+
+            pg[j+1] = -ps[j]*pg[j];
+            pg[j] = pc[j]*pg[j];
+
+            j++;
+            k++;
+
+            // residual norm of the least-squares problem equals the one of the linear system
+            res.push_back(fabs(pg[j]));
+
+            if(!m_silent)
+                cout << "k=" << k << ": " << res.back() << endl;
+
+            if(res.back()<m_eps || denom==0)
+                break;
+
+        }
+
+        // back substitution
+        for(size_t i=j; i-->0; ) {
+
+            T sum = pg[i];
+
+            for(size_t l=i+1; l<j; l++)
+                sum -= pH[l*(m+1)+i]*py[l];
+
+            py[i] = pH[i*(m+1)+i]!=0 ? sum/pH[i*(m+1)+i] : 0;
+
+        }
+
+        // x = x + M^{-1}*V*y, collect V*y in the last basis vector which is not needed anymore
+        T* pu = m_workspace.Get(m,n);
+        fill_n(pu,n,T(0));
+
+        for(size_t i=0; i<j; i++)
+            Axpy(py[i],m_workspace.Get(i,n),pu,n);
+
+        CDenseVector<T> u = m_workspace.GetVector(m,n);
+        CDenseVector<T> zu = z;
+        m_M.Solve(zu,u);
+
+        const T* pzu = zu.Data().get();
+        T* px = x.Data().get();
+
+        #pragma omp parallel for
+        for(size_t i=0; i<n; i++)
+            px[i] += pzu[i];
+
+        if(res.back()<m_eps)
+            break;
+
+        // true residual for restart
+        A.Multiply(x,v0);
+
+        #pragma omp parallel for
+        for(size_t i=0; i<n; i++)
+            pv0[i] = pb[i] - pv0[i];
+
+        beta = sqrt(Dot(pv0,pv0,n));
+
+    }
+
+    return res;
+
+}
+
+template class CGeneralizedMinimalResidualMethod<CDenseArray<double>,double>;
+template class CGeneralizedMinimalResidualMethod<CDenseArray<float>,float>;
+template class CGeneralizedMinimalResidualMethod<CSparseArray<double>,double>;
+template class CGeneralizedMinimalResidualMethod<CSparseArray<float>,float>;
+template class CGeneralizedMinimalResidualMethod<CCSRMatrix<double,size_t>,double>;
+template class CGeneralizedMinimalResidualMethod<CCSRMatrix<float,size_t>,float>;
+template class CGeneralizedMinimalResidualMethod<CLinearOperator<double>,double>;
+template class CGeneralizedMinimalResidualMethod<CLinearOperator<float>,float>;
+
+template<class Matrix,typename T>
+CBiConjugateGradientStabilizedMethod<Matrix,T>::CBiConjugateGradientStabilizedMethod(const CPreconditioner<Matrix,T>& M, size_t n, double eps, bool silent, size_t l):
+    CIterativeLinearSolver<Matrix,T>::CIterativeLinearSolver(M,n,eps,silent),
+    m_l(l>0 ? l : 1) {}
+
+template<class Matrix,typename T>
+void CBiConjugateGradientStabilizedMethod<Matrix,T>::Apply(const Matrix& A, size_t in, size_t out, size_t n) const {
+
+    CDenseVector<T> v = m_workspace.GetVector(in,n);
+    CDenseVector<T> z = m_workspace.GetVector(2*m_l+4,n);
+
+    m_M.Solve(z,v);
+
+    CDenseVector<T> w = m_workspace.GetVector(out,n);
+    A.Multiply(z,w);
+
+}
+
+template<class Matrix,typename T>
+vector<double> CBiConjugateGradientStabilizedMethod<Matrix,T>::Iterate(const Matrix& A, const CDenseArray<T>& B, CDenseArray<T>& X) const {
+
+    if(!(A.NCols()==X.NRows() && A.NRows()==B.NRows() && X.NCols()==B.NCols())) {
+
+        cerr << "ERROR: Check matrix dimensions!" << endl;
+        return vector<double>();
+
+    }
+
+    return IterateColumnwise(*this,A,B,X);
+
+}
+
+template<class Matrix,typename T>
+vector<double> CBiConjugateGradientStabilizedMethod<Matrix,T>::Iterate(const Matrix& A, const CDenseVector<T>& b, CDenseVector<T>& x) const {
+
+    if(!(A.NCols()==x.NRows() && A.NRows()==b.NRows() && A.NRows()==A.NCols())) {
+
+        cerr << "ERROR: Check matrix dimensions!" << endl;
+        return vector<double>();
+
+    }
+
+    size_t n = x.NElems();
+    size_t l = m_l;
+
+    /* arena layout: r_0,...,r_l, u_0,...,u_l, shadow residual, correction, one vector
+     * for preconditioning, then tau (l+1)x(l+1), sigma, gamma', gamma, gamma''
+     */
+    m_workspace.Reserve(2*l+5,n,(l+1)*(l+1)+4*(l+1));
+    T* ptau = m_workspace.GetScalars(2*l+5,n);
+    T* psigma = ptau + (l+1)*(l+1);
+    T* pgp = psigma + l+1;
+    T* pg = pgp + l+1;
+    T* pgpp = pg + l+1;
+
+    // block indices
+    size_t ir = 0;
+    size_t iu = l+1;
+    size_t ishadow = 2*l+2;
+    size_t ic = 2*l+3;
+
+    // init
+    size_t k = 0;
+
+    CDenseVector<T> r = m_workspace.GetVector(ir,n);
+    T* pr = r.Data().get();
+    const T* pb = b.Data().get();
+
+    A.Multiply(x,r);
+
+    #pragma omp parallel for
+    for(size_t i=0; i<n; i++)
+        pr[i] = pb[i] - pr[i];
+
+    copy(pr,pr+n,m_workspace.Get(ishadow,n));
+    fill_n(m_workspace.Get(iu,n),n,T(0));
+    fill_n(m_workspace.Get(ic,n),n,T(0));
+
+    const T* pshadow = m_workspace.Get(ishadow,n);
+    T* pc = m_workspace.Get(ic,n);
+
+    vector<double> res;
+    res.push_back(sqrt(Dot(m_workspace.Get(ir,n),m_workspace.Get(ir,n),n)));
+
+    if(!m_silent)
+        cout << "k=" << k << ": " << res.back() << endl;
+
+    T rho0 = 1;
+    T alpha = 0;
+    T omega = 1;
+    bool breakdown = false;
+
+    while(k<m_n && res.back()>=m_eps && !breakdown) {
+
+        rho0 = -omega*rho0;
+
+        // BiCG part
+        for(size_t j=0; j<l; j++) {
+
+            T rho1 = Dot(m_workspace.Get(ir+j,n),pshadow,n);
+
+            if(rho0==0) {
+
+                breakdown = true;
+                break;
+
+            }
+
+            T beta = alpha*rho1/rho0;
+            rho0 = rho1;
+
+            for(size_t i=0; i<=j; i++) {
+
+                T* pui = m_workspace.Get(iu+i,n);
+                const T* pri = m_workspace.Get(ir+i,n);
+
+                #pragma omp parallel for
+                for(size_t s=0; s<n; s++)
+                    pui[s] = pri[s] - beta*pui[s];
+
+            }
+
+            Apply(A,iu+j,iu+j+1,n);
+
+            T gamma = Dot(m_workspace.Get(iu+j+1,n),pshadow,n);
+
+            if(gamma==0) {
+
+                breakdown = true;
+                break;
+
+            }
+
+            alpha = rho0/gamma;
+
+            for(size_t i=0; i<=j; i++)
+                Axpy(-alpha,m_workspace.Get(iu+i+1,n),m_workspace.Get(ir+i,n),n);
+
+            Apply(A,ir+j,ir+j+1,n);
+
+            Axpy(alpha,m_workspace.Get(iu,n),pc,n);
+
+        }
+
+        if(breakdown)
+            break;
+
+        // minimal-residual part (modified Gram-Schmidt)
+        for(size_t j=1; j<=l; j++) {
+
+            T* prj = m_workspace.Get(ir+j,n);
+
+            for(size_t i=1; i<j; i++) {
+
+                const T* pri = m_workspace.Get(ir+i,n);
+
+                ptau[i*(l+1)+j] = Dot(prj,pri,n)/psigma[i];
+                Axpy(-ptau[i*(l+1)+j],pri,prj,n);
+
+            }
+
+            psigma[j] = Dot(prj,prj,n);
+
+            if(psigma[j]==0) {
+
+                breakdown = true;
+                break;
+
+            }
+
+            pgp[j] = Dot(m_workspace.Get(ir,n),prj,n)/psigma[j];
+
+        }
+
+        if(breakdown)
+            break;
+
+        pg[l] = pgp[l];
+        omega = pg[l];
+
+        for(size_t j=l-1; j>=1; j--) {
+
+            T sum = 0;
+
+            for(size_t i=j+1; i<=l; i++)
+                sum += ptau[j*(l+1)+i]*pg[i];
+
+            pg[j] = pgp[j] - sum;
+
+        }
+
+        for(size_t j=1; j<l; j++) {
+
+            T sum = 0;
+
+            for(size_t i=j+1; i<l; i++)
+                sum += ptau[j*(l+1)+i]*pg[i+1];
+
+            pgpp[j] = pg[j+1] + sum;
+
+        }
+
+        // update
+        Axpy(pg[1],m_workspace.Get(ir,n),pc,n);
+        Axpy(-pgp[l],m_workspace.Get(ir+l,n),m_workspace.Get(ir,n),n);
+        Axpy(-pg[l],m_workspace.Get(iu+l,n),m_workspace.Get(iu,n),n);
+
+        for(size_t j=1; j<l; j++) {
+
+            Axpy(-pg[j],m_workspace.Get(iu+j,n),m_workspace.Get(iu,n),n);
+            Axpy(pgpp[j],m_workspace.Get(ir+j,n),pc,n);
+            Axpy(-pgp[j],m_workspace.Get(ir+j,n),m_workspace.Get(ir,n),n);
+
+        }
+
+        k++;
+
+        res.push_back(sqrt(Dot(m_workspace.Get(ir,n),m_workspace.Get(ir,n),n)));
+
+        if(!m_silent)
+            cout << "k=" << k << ": " << res.back() << endl;
+
+    }
+
+    if(breakdown && !m_silent)
+        cout << "WARNING: BiCGStab breakdown." << endl;
+
+    // x = x + M^{-1}*c
+    CDenseVector<T> c = m_workspace.GetVector(ic,n);
+    CDenseVector<T> z = m_workspace.GetVector(2*l+4,n);
+    m_M.Solve(z,c);
+
+    Axpy(T(1),z.Data().get(),x.Data().get(),n);
+
+    return res;
+
+}
+
+template class CBiConjugateGradientStabilizedMethod<CDenseArray<double>,double>;
+template class CBiConjugateGradientStabilizedMethod<CDenseArray<float>,float>;
+template class CBiConjugateGradientStabilizedMethod<CSparseArray<double>,double>;
+template class CBiConjugateGradientStabilizedMethod<CSparseArray<float>,float>;
+template class CBiConjugateGradientStabilizedMethod<CCSRMatrix<double,size_t>,double>;
+template class CBiConjugateGradientStabilizedMethod<CCSRMatrix<float,size_t>,float>;
+template class CBiConjugateGradientStabilizedMethod<CLinearOperator<double>,double>;
+template class CBiConjugateGradientStabilizedMethod<CLinearOperator<float>,float>;
 
 }
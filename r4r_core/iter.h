@@ -29,12 +29,72 @@
 #include "sarray.h"
 #include  "darray.h"
 #include "precond.h"
+#include "spectrum.h"
 
 namespace R4R {
 
-/*! \brief iterative linear solver interface
+/*! \brief contiguous memory arena for the work vectors of iterative solvers
+ *
+ * All vectors are stored in a single 16-byte aligned block which is only re-allocated
+ * if a larger one is requested. Vector headers returned by GetVector() share the arena
+ * memory, so handing them out does not cause heap allocations.
  *
+ */
+template<typename T>
+class CSolverWorkspace {
+
+public:
+
+    //! Constructor.
+    CSolverWorkspace():m_data(),m_size(0) {}
+
+    /*! \brief Makes sure the arena holds at least \f$k\f$ blocks of length \f$n\f$ plus \f$s\f$ scalars.
+     *
+     * \returns true if memory had to be (re-)allocated
+     *
+     */
+    bool Reserve(size_t k, size_t n, size_t s = 0);
+
+    //! Distance between two blocks of length \f$n\f$ that preserves alignment.
+    static size_t Stride(size_t n) { return (n+3)&~size_t(3); }
+
+    //! Pointer to the \f$i\f$-th block of length \f$n\f$.
+    T* Get(size_t i, size_t n) { return m_data.get()+i*Stride(n); }
+
+    //! Pointer to the scalars behind the first \f$k\f$ blocks.
+    T* GetScalars(size_t k, size_t n) { return m_data.get()+k*Stride(n); }
+
+    //! Vector header for the \f$i\f$-th block of length \f$n\f$.
+    CDenseVector<T> GetVector(size_t i, size_t n) { return GetVector(i,n,n); }
+
+    //! Vector header of length \f$l\leq n\f$ for the \f$i\f$-th block of length \f$n\f$.
+    CDenseVector<T> GetVector(size_t i, size_t n, size_t l) { return CDenseVector<T>(l,std::shared_ptr<T>(m_data,Get(i,n))); }
+
+    //! Column-major array header with \f$m\cdot d\leq n\f$ elements for the \f$i\f$-th block of length \f$n\f$.
+    CDenseArray<T> GetArray(size_t i, size_t n, size_t m, size_t d) { return CDenseArray<T>(m,d,GetVector(i,n,m*d)); }
+
+    //! Array header of the same shape as \f$x\f$ for the \f$i\f$-th block of length \f$n\f$.
+    CDenseArray<T> GetLike(size_t i, size_t n, const CDenseArray<T>& x) { return GetArray(i,n,x.NRows(),x.NCols()); }
+
+    //! Vector header of the same length as \f$x\f$ for the \f$i\f$-th block of length \f$n\f$.
+    CDenseVector<T> GetLike(size_t i, size_t n, const CDenseVector<T>& x) { return GetVector(i,n,x.NElems()); }
+
+    //! Access to the size of the arena.
+    size_t Size() const { return m_size; }
+
+private:
+
+    std::shared_ptr<T> m_data;                      //!< arena
+    size_t m_size;                                  //!< number of elements in the arena
+
+};
+
+/*! \brief iterative linear solver interface
  *
+ * Work vectors are kept in #m_workspace, which grows to the required size on the first
+ * call of Iterate() and is re-used afterwards. Hence, repeated solves of systems of the
+ * same size, e.g., inside a nonlinear solver, do not touch the heap. As a consequence,
+ * a solver object must not be used by several threads at the same time.
  *
  */
 template<class Matrix,typename T>
@@ -51,7 +111,7 @@ protected:
      * This class has pure virtual functions. Block direct creation.
      *
      */
-    CIterativeLinearSolver(const CPreconditioner<Matrix,T>& M, size_t n, double eps, bool silent = true, T lambda = 0):m_M(M),m_n(n),m_eps(eps),m_silent(silent),m_lambda(lambda) {}
+    CIterativeLinearSolver(const CPreconditioner<Matrix,T>& M, size_t n, double eps, bool silent = true, T lambda = 0):m_M(M),m_n(n),m_eps(eps),m_silent(silent),m_lambda(lambda),m_workspace() {}
 
     //! Standard constructor (deleted).
     CIterativeLinearSolver() = delete;
@@ -104,6 +164,7 @@ protected:
     double m_eps;                               	//!< absolute accuracy
     bool m_silent;                                  //!< flag that determines whether messages are displayed
     T m_lambda;                                     //!< regularization parameter for solving LS problems
+    mutable CSolverWorkspace<T> m_workspace;        //!< work vectors, re-used across calls of Iterate()
 
 };
 
@@ -134,6 +195,7 @@ private:
     using CIterativeLinearSolver<Matrix,T>::m_n;
     using CIterativeLinearSolver<Matrix,T>::m_eps;
     using CIterativeLinearSolver<Matrix,T>::m_silent;
+    using CIterativeLinearSolver<Matrix,T>::m_workspace;
 
 };
 
@@ -167,9 +229,204 @@ private:
     using CIterativeLinearSolver<Matrix,T>::m_eps;
     using CIterativeLinearSolver<Matrix,T>::m_silent;
     using CIterativeLinearSolver<Matrix,T>::m_lambda;
+    using CIterativeLinearSolver<Matrix,T>::m_workspace;
 
 };
 
+/*! \brief Chebyshev semi-iterative method.
+ *
+ * Implements the preconditioned Chebyshev iteration, cf. [Saad2003], for symmetric positive-definite
+ * matrices \f$A\f$. Opposed to the CG method, the iteration needs no inner products, only bounds
+ * \f$\lambda_{\min},\lambda_{\max}\f$ on the spectrum of \f$M^{-1}A\f$. Every step is a sequence of
+ * matrix-vector products and vector updates which do not have to be synchronized. If no bounds are set,
+ * they are estimated by a few Lanczos steps, see CSpectrumEstimator. Since the residual norm is only
+ * needed for the stopping criterion, it is evaluated every #m_ncheck steps.
+ *
+ */
+template<class Matrix,typename T>
+class CChebyshevIteration: public CIterativeLinearSolver<Matrix,T> {
+
+public:
+
+    /*! \brief Constructor.
+     *
+     * \param[in] M preconditioner
+     * \param[in] n maximum number of iterations
+     * \param[in] eps absolute residual at which to terminate
+     * \param[in] silent verbosity flag
+     * \param[in] nlanczos number of Lanczos steps used to estimate the spectral bounds
+     * \param[in] ncheck number of steps between two evaluations of the residual norm
+     *
+     */
+    CChebyshevIteration(const CPreconditioner<Matrix,T>& M, size_t n, double eps, bool silent = true, size_t nlanczos = 20, size_t ncheck = 10);
+    CChebyshevIteration() = delete;
+
+    /*! \brief Fixes the spectral bounds.
+     *
+     * This switches off the Lanczos estimation. Passing \f$\lambda_{\max}\leq 0\f$ switches it on again.
+     *
+     */
+    void SetSpectralBounds(T lmin, T lmax) { m_lmin = lmin; m_lmax = lmax; }
+
+    //! \copydoc CIterativeLinearSolver::Iterate(const Matrix&,const CDenseArray<T>&,CDenseArray<T>&)
+    std::vector<double> Iterate(const Matrix& A, const CDenseArray<T>& B, CDenseArray<T>& X) const;
+
+    //! \copydoc CIterativeLinearSolver::Iterate(const Matrix&,const CDenseVector<T>&,CDenseVector<T>&)
+    std::vector<double> Iterate(const Matrix& A, const CDenseVector<T>& b, CDenseVector<T>& x) const;
+
+protected:
+
+    using CIterativeLinearSolver<Matrix,T>::m_M;
+    using CIterativeLinearSolver<Matrix,T>::m_n;
+    using CIterativeLinearSolver<Matrix,T>::m_eps;
+    using CIterativeLinearSolver<Matrix,T>::m_silent;
+    using CIterativeLinearSolver<Matrix,T>::m_lambda;
+    using CIterativeLinearSolver<Matrix,T>::m_workspace;
+
+    T m_lmin;                                       //!< lower bound of the spectrum
+    T m_lmax;                                       //!< upper bound of the spectrum
+    size_t m_nlanczos;                              //!< number of Lanczos steps for bound estimation
+    size_t m_ncheck;                                //!< number of steps between residual evaluations
+
+    //! Returns fixed spectral bounds or estimates them for the given operator.
+    bool GetSpectralBounds(const Matrix& A, bool normal, T& lmin, T& lmax) const;
+
+private:
+
+    //! Implementation for both single and multiple right-hand sides.
+    template<class Array> std::vector<double> Solve(const Matrix& A, const Array& B, Array& X) const;
+
+};
+
+/*! \brief Chebyshev semi-iterative method for least-squares problems.
+ *
+ * Applies the Chebyshev iteration to the normal equation \f$(A^{\top}A+\lambda^2I)x=A^{\top}b\f$
+ * without forming it explicitly, analogously to CConjugateGradientMethodLeastSquares. Spectral bounds
+ * hence refer to the (preconditioned) normal operator.
+ *
+ */
+template<class Matrix,typename T>
+class CChebyshevIterationLeastSquares: public CChebyshevIteration<Matrix,T> {
+
+public:
+
+    //! \copydoc CChebyshevIteration::CChebyshevIteration(const CPreconditioner<Matrix,T>&,size_t,double,bool,size_t,size_t)
+    CChebyshevIterationLeastSquares(const CPreconditioner<Matrix,T>& M, size_t n, double eps, bool silent = true, size_t nlanczos = 20, size_t ncheck = 10);
+    CChebyshevIterationLeastSquares() = delete;
+
+    //! \copydoc CIterativeLinearSolver::Iterate(const Matrix&,const CDenseArray<T>&,CDenseArray<T>&)
+    std::vector<double> Iterate(const Matrix& A, const CDenseArray<T>& B, CDenseArray<T>& X) const;
+
+    //! \copydoc CIterativeLinearSolver::Iterate(const Matrix&,const CDenseVector<T>&,CDenseVector<T>&)
+    std::vector<double> Iterate(const Matrix& A, const CDenseVector<T>& b, CDenseVector<T>& x) const;
+
+private:
+
+    using CChebyshevIteration<Matrix,T>::m_M;
+    using CChebyshevIteration<Matrix,T>::m_n;
+    using CChebyshevIteration<Matrix,T>::m_eps;
+    using CChebyshevIteration<Matrix,T>::m_silent;
+    using CChebyshevIteration<Matrix,T>::m_lambda;
+    using CChebyshevIteration<Matrix,T>::m_ncheck;
+    using CChebyshevIteration<Matrix,T>::m_workspace;
+
+    //! Implementation for both single and multiple right-hand sides.
+    template<class Array> std::vector<double> Solve(const Matrix& A, const Array& B, Array& X) const;
+
+};
+
+/*! \brief Restarted generalized minimal residual method.
+ *
+ * Implements GMRES(m), cf. [Saad1986], with right preconditioning for square, possibly non-symmetric
+ * matrices. The Krylov basis, the Hessenberg matrix and the Givens rotations are kept in a contiguous
+ * arena which is allocated on the first call of Iterate() and re-used afterwards. Every iteration
+ * counts one matrix-vector product.
+ *
+ */
+template<class Matrix,typename T>
+class CGeneralizedMinimalResidualMethod: public CIterativeLinearSolver<Matrix,T> {
+
+public:
+
+    /*! \brief Constructor.
+     *
+     * \param[in] M preconditioner
+     * \param[in] n maximum number of iterations
+     * \param[in] eps absolute residual at which to terminate
+     * \param[in] silent verbosity flag
+     * \param[in] m restart length
+     *
+     */
+    CGeneralizedMinimalResidualMethod(const CPreconditioner<Matrix,T>& M, size_t n, double eps, bool silent = true, size_t m = 30);
+    CGeneralizedMinimalResidualMethod() = delete;
+
+    //! Access to the restart length.
+    void SetRestart(size_t m) { m_m = m>0 ? m : 1; }
+
+    //! \copydoc CIterativeLinearSolver::Iterate(const Matrix&,const CDenseArray<T>&,CDenseArray<T>&)
+    std::vector<double> Iterate(const Matrix& A, const CDenseArray<T>& B, CDenseArray<T>& X) const;
+
+    //! \copydoc CIterativeLinearSolver::Iterate(const Matrix&,const CDenseVector<T>&,CDenseVector<T>&)
+    std::vector<double> Iterate(const Matrix& A, const CDenseVector<T>& b, CDenseVector<T>& x) const;
+
+private:
+
+    using CIterativeLinearSolver<Matrix,T>::m_M;
+    using CIterativeLinearSolver<Matrix,T>::m_n;
+    using CIterativeLinearSolver<Matrix,T>::m_eps;
+    using CIterativeLinearSolver<Matrix,T>::m_silent;
+    using CIterativeLinearSolver<Matrix,T>::m_workspace;
+
+    size_t m_m;                                     //!< restart length
+
+};
+
+/*! \brief Stabilized bi-conjugate gradient method.
+ *
+ * Implements BiCGStab(\f$\ell\f$), cf. [Sleijpen1993], with right preconditioning for square, possibly
+ * non-symmetric matrices. For \f$\ell=1\f$, the method reduces to BiCGStab [vanderVorst1992]. Larger
+ * values of \f$\ell\f$ improve robustness for operators with complex spectra, e.g., advection-dominated
+ * problems. One iteration comprises a full BiCG and minimal-residual cycle, i.e., \f$2\ell\f$
+ * matrix-vector products. All work vectors live in a contiguous arena which is allocated once.
+ *
+ */
+template<class Matrix,typename T>
+class CBiConjugateGradientStabilizedMethod: public CIterativeLinearSolver<Matrix,T> {
+
+public:
+
+    /*! \brief Constructor.
+     *
+     * \param[in] M preconditioner
+     * \param[in] n maximum number of iterations
+     * \param[in] eps absolute residual at which to terminate
+     * \param[in] silent verbosity flag
+     * \param[in] l degree \f$\ell\f$ of the minimal-residual polynomial
+     *
+     */
+    CBiConjugateGradientStabilizedMethod(const CPreconditioner<Matrix,T>& M, size_t n, double eps, bool silent = true, size_t l = 2);
+    CBiConjugateGradientStabilizedMethod() = delete;
+
+    //! \copydoc CIterativeLinearSolver::Iterate(const Matrix&,const CDenseArray<T>&,CDenseArray<T>&)
+    std::vector<double> Iterate(const Matrix& A, const CDenseArray<T>& B, CDenseArray<T>& X) const;
+
+    //! \copydoc CIterativeLinearSolver::Iterate(const Matrix&,const CDenseVector<T>&,CDenseVector<T>&)
+    std::vector<double> Iterate(const Matrix& A, const CDenseVector<T>& b, CDenseVector<T>& x) const;
+
+private:
+
+    using CIterativeLinearSolver<Matrix,T>::m_M;
+    using CIterativeLinearSolver<Matrix,T>::m_n;
+    using CIterativeLinearSolver<Matrix,T>::m_eps;
+    using CIterativeLinearSolver<Matrix,T>::m_silent;
+    using CIterativeLinearSolver<Matrix,T>::m_workspace;
+
+    size_t m_l;                                     //!< degree of the minimal-residual polynomial
+
+    //! Applies the right-preconditioned operator \f$AM^{-1}\f$.
+    void Apply(const Matrix& A, size_t in, size_t out, size_t n) const;
+
+};
 
 }
 
@@ -24,7 +24,11 @@
 #ifndef R4RKFILTER_H_
 #define R4RKFILTER_H_
 
+#include <vector>
+#include <limits>
+
 #include "darray.h"
+#include "matn.h"
 
 namespace R4R {
 
@@ -78,6 +82,655 @@ protected:
 
 };
 
+/*! \brief Kalman filter with dimensions fixed at compile time
+ *
+ * \details All matrices are of type CMatrix, so there is neither dynamic memory nor a generic
+ * inverse involved. The covariance is updated in Joseph form
+ * \f$P=(I-KC)P(I-KC)^{\top}+KRK^{\top}\f$ which preserves its symmetry and
+ * positive-definiteness in finite precision. The gain is obtained from a Cholesky
+ * decomposition of the innovation covariance.
+ *
+ * \tparam N dimension of the state
+ * \tparam M dimension of the measurement
+ * \tparam K dimension of the control input
+ *
+ */
+template<typename T,u_int N,u_int M,u_int K = 1>
+class CFixedKalmanFilter {
+
+public:
+
+    //! Constructor.
+    CFixedKalmanFilter(const CMatrix<T,N,N>& A, const CMatrix<T,N,K>& B, const CMatrix<T,M,N>& C, const CMatrix<T,N,N>& Q, const CMatrix<T,M,M>& R, const CVector<T,N>& x0 = CVector<T,N>(), const CMatrix<T,N,N>& P0 = CMatrix<T,N,N>()):
+        m_x(x0),
+        m_P(P0),
+        m_A(A),
+        m_At(A.Transpose()),
+        m_B(B),
+        m_C(C),
+        m_Ct(C.Transpose()),
+        m_Q(Q),
+        m_R(R) {}
+
+    //! Predicts new state without control input.
+    void Predict() {
+
+        m_x = m_A*m_x;
+        m_P = m_A*m_P*m_At + m_Q;
+
+    }
+
+    //! Predicts new state.
+    void Predict(const CVector<T,K>& u) {
+
+        m_x = m_A*m_x + m_B*u;
+        m_P = m_A*m_P*m_At + m_Q;
+
+    }
+
+    /*! \brief Updates state given a measurement.
+     *
+     * \returns false if the innovation covariance is not positive definite
+     *
+     */
+    bool Update(const CVector<T,M>& y) {
+
+        CMatrix<T,N,M> PCt = m_P*m_Ct;
+        CMatrix<T,M,M> S = m_C*PCt + m_R;
+        CMatrix<T,M,M> L;
+
+        if(!S.Cholesky(L))
+            return false;
+
+        // transposed gain K^T = S^{-1}CP
+        CMatrix<T,M,N> Kt = PCt.Transpose();
+        CMatrix<T,M,M>::CholeskySolve(L,Kt);
+        CMatrix<T,N,M> Kg = Kt.Transpose();
+
+        m_x = m_x + Kg*(y - m_C*m_x);
+
+        CMatrix<T,N,N> F;
+        F.Eye();
+        F -= Kg*m_C;
+
+        m_P = F*m_P*F.Transpose() + Kg*m_R*Kt;
+
+        return true;
+
+    }
+
+    //! Access to state.
+    const CVector<T,N>& GetState() const { return m_x; }
+
+    //! Access to covariance.
+    const CMatrix<T,N,N>& GetCovariance() const { return m_P; }
+
+protected:
+
+    CVector<T,N> m_x;                   //!< state
+    CMatrix<T,N,N> m_P;                 //!< state covariance matrix
+
+    CMatrix<T,N,N> m_A;                 //!< system matrix
+    CMatrix<T,N,N> m_At;                //!< transpose of system matrix
+    CMatrix<T,N,K> m_B;                 //!< input matrix
+    CMatrix<T,M,N> m_C;                 //!< measurement matrix
+    CMatrix<T,N,M> m_Ct;                //!< transpose of measurement matrix
+
+    CMatrix<T,N,N> m_Q;                 //!< system noise covariance matrix
+    CMatrix<T,M,M> m_R;                 //!< measurement noise covariance matrix
+
+};
+
+/*! \brief bank of Kalman filters sharing the same model
+ *
+ * \details Meant for smoothing many tracks at once. States and covariances of all filters are
+ * stored as structure of arrays, one array per state component and per entry of the lower
+ * triangle of the covariance. Predict() and Update() process the filters in blocks of
+ * #BLOCK which are distributed over threads. Within a block, every operation of the
+ * Joseph-form update is a loop over the filters with the model coefficients held constant,
+ * which compilers turn into SIMD code.
+ *
+ */
+template<typename T,u_int N,u_int M>
+class CKalmanFilterBank {
+
+public:
+
+    //! Number of filters processed together.
+    static const size_t BLOCK = 64;
+
+    //! Constructor.
+    CKalmanFilterBank(const CMatrix<T,N,N>& A, const CMatrix<T,M,N>& C, const CMatrix<T,N,N>& Q, const CMatrix<T,M,M>& R):
+        m_A(A),
+        m_C(C),
+        m_Q(Q),
+        m_R(R),
+        m_size(0) {}
+
+    //! Number of filters.
+    size_t Size() const { return m_size; }
+
+    /*! \brief Adds a filter.
+     *
+     * \returns index of the new filter
+     *
+     */
+    size_t Add(const CVector<T,N>& x0, const CMatrix<T,N,N>& P0);
+
+    /*! \brief Removes a filter.
+     *
+     * To keep the storage contiguous, the last filter is moved into the slot that becomes
+     * vacant.
+     *
+     * \returns former index of the moved filter, which equals the new size if the last one was removed,
+     * or the unchanged size if the index is out of range
+     *
+     */
+    size_t Remove(size_t i);
+
+    //! Predicts new states of all filters.
+    void Predict();
+
+    /*! \brief Updates all filters given their measurements.
+     *
+     * \param[in] y measurements, one row per filter, rows containing NaN are skipped
+     *
+     */
+    void Update(const CDenseArray<T>& y);
+
+    //! Access to state of the \f$i\f$-th filter.
+    CVector<T,N> GetState(size_t i) const;
+
+    //! Access to covariance of the \f$i\f$-th filter.
+    CMatrix<T,N,N> GetCovariance(size_t i) const;
+
+protected:
+
+    CMatrix<T,N,N> m_A;                 //!< system matrix
+    CMatrix<T,M,N> m_C;                 //!< measurement matrix
+    CMatrix<T,N,N> m_Q;                 //!< system noise covariance matrix
+    CMatrix<T,M,M> m_R;                 //!< measurement noise covariance matrix
+
+    size_t m_size;                      //!< number of filters
+    std::vector<T> m_x[N];              //!< states, one array per component
+    std::vector<T> m_P[N*(N+1)/2];      //!< covariances, one array per entry of the lower triangle
+
+    //! Index of a covariance entry in #m_P.
+    static u_int Packed(u_int i, u_int j) { return (i>=j) ? i*(i+1)/2 + j : j*(j+1)/2 + i; }
+
+    //! Copies a block of filters to local memory.
+    void Load(size_t begin, size_t nb, T x[N][BLOCK], T P[N][N][BLOCK]) const;
+
+    //! Writes a block of filters back, lanes for which a flag is false are left untouched.
+    void Store(size_t begin, size_t nb, const T x[N][BLOCK], const T P[N][N][BLOCK], const bool* flags = nullptr);
+
+};
+
+template<typename T,u_int N,u_int M>
+size_t CKalmanFilterBank<T,N,M>::Add(const CVector<T,N>& x0, const CMatrix<T,N,N>& P0) {
+
+    for(u_int i=0; i<N; i++)
+        m_x[i].push_back(x0.Get(i));
+
+    for(u_int i=0; i<N; i++) {
+
+        for(u_int j=0; j<=i; j++)
+            m_P[Packed(i,j)].push_back(P0.Get(i,j));
+
+    }
+
+    return m_size++;
+
+}
+
+template<typename T,u_int N,u_int M>
+size_t CKalmanFilterBank<T,N,M>::Remove(size_t i) {
+
+    // also catches the empty bank, where m_size-1 would wrap around
+    if(i>=m_size) {
+
+        std::cerr << "ERROR: Filter index out of range." << std::endl;
+        return m_size;
+
+    }
+
+    m_size--;
+
+    for(u_int k=0; k<N; k++) {
+
+        m_x[k][i] = m_x[k][m_size];
+        m_x[k].pop_back();
+
+    }
+
+    for(u_int k=0; k<N*(N+1)/2; k++) {
+
+        m_P[k][i] = m_P[k][m_size];
+        m_P[k].pop_back();
+
+    }
+
+    return m_size;
+
+}
+
+template<typename T,u_int N,u_int M>
+CVector<T,N> CKalmanFilterBank<T,N,M>::GetState(size_t i) const {
+
+    CVector<T,N> x;
+
+    for(u_int k=0; k<N; k++)
+        x(k) = m_x[k][i];
+
+    return x;
+
+}
+
+template<typename T,u_int N,u_int M>
+CMatrix<T,N,N> CKalmanFilterBank<T,N,M>::GetCovariance(size_t i) const {
+
+    CMatrix<T,N,N> P;
+
+    for(u_int k=0; k<N; k++) {
+
+        for(u_int l=0; l<N; l++)
+            P(k,l) = m_P[Packed(k,l)][i];
+
+    }
+
+    return P;
+
+}
+
+template<typename T,u_int N,u_int M>
+void CKalmanFilterBank<T,N,M>::Load(size_t begin, size_t nb, T x[N][BLOCK], T P[N][N][BLOCK]) const {
+
+    for(u_int k=0; k<N; k++) {
+
+        const T* px = m_x[k].data() + begin;
+
+        for(size_t b=0; b<nb; b++)
+            x[k][b] = px[b];
+
+    }
+
+    for(u_int k=0; k<N; k++) {
+
+        for(u_int l=0; l<=k; l++) {
+
+            const T* pp = m_P[Packed(k,l)].data() + begin;
+
+            for(size_t b=0; b<nb; b++) {
+
+                P[k][l][b] = pp[b];
+                P[l][k][b] = pp[b];
+
+            }
+
+        }
+
+    }
+
+}
+
+template<typename T,u_int N,u_int M>
+void CKalmanFilterBank<T,N,M>::Store(size_t begin, size_t nb, const T x[N][BLOCK], const T P[N][N][BLOCK], const bool* flags) {
+
+    for(u_int k=0; k<N; k++) {
+
+        T* px = m_x[k].data() + begin;
+
+        for(size_t b=0; b<nb; b++)
+            px[b] = (!flags || flags[b]) ? x[k][b] : px[b];
+
+    }
+
+    for(u_int k=0; k<N; k++) {
+
+        for(u_int l=0; l<=k; l++) {
+
+            T* pp = m_P[Packed(k,l)].data() + begin;
+
+            for(size_t b=0; b<nb; b++)
+                pp[b] = (!flags || flags[b]) ? P[k][l][b] : pp[b];
+
+        }
+
+    }
+
+}
+
+template<typename T,u_int N,u_int M>
+void CKalmanFilterBank<T,N,M>::Predict() {
+
+    size_t nblocks = (m_size + BLOCK - 1)/BLOCK;
+
+    #pragma omp parallel for
+    for(size_t s=0; s<nblocks; s++) {
+
+        size_t begin = s*BLOCK;
+        size_t nb = (m_size - begin<BLOCK) ? m_size - begin : BLOCK;
+
+        T x[N][BLOCK], P[N][N][BLOCK], xn[N][BLOCK], AP[N][N][BLOCK];
+
+        this->Load(begin,nb,x,P);
+
+        // x = Ax
+        for(u_int r=0; r<N; r++) {
+
+            for(size_t b=0; b<nb; b++)
+                xn[r][b] = 0;
+
+            for(u_int c=0; c<N; c++) {
+
+                T a = m_A.Get(r,c);
+
+                for(size_t b=0; b<nb; b++)
+                    xn[r][b] += a*x[c][b];
+
+            }
+
+        }
+
+        // P = APA^T + Q, only the lower triangle
+        for(u_int r=0; r<N; r++) {
+
+            for(u_int c=0; c<N; c++) {
+
+                for(size_t b=0; b<nb; b++)
+                    AP[r][c][b] = 0;
+
+                for(u_int l=0; l<N; l++) {
+
+                    T a = m_A.Get(r,l);
+
+                    for(size_t b=0; b<nb; b++)
+                        AP[r][c][b] += a*P[l][c][b];
+
+                }
+
+            }
+
+        }
+
+        for(u_int r=0; r<N; r++) {
+
+            for(u_int c=0; c<=r; c++) {
+
+                T q = m_Q.Get(r,c);
+
+                for(size_t b=0; b<nb; b++)
+                    P[r][c][b] = q;
+
+                for(u_int l=0; l<N; l++) {
+
+                    T a = m_A.Get(c,l);
+
+                    for(size_t b=0; b<nb; b++)
+                        P[r][c][b] += AP[r][l][b]*a;
+
+                }
+
+            }
+
+        }
+
+        this->Store(begin,nb,xn,P);
+
+    }
+
+}
+
+template<typename T,u_int N,u_int M>
+void CKalmanFilterBank<T,N,M>::Update(const CDenseArray<T>& y) {
+
+    if(y.NRows()!=m_size || y.NCols()!=M) {
+
+        std::cerr << "ERROR: Check matrix dimensions!" << std::endl;
+        return;
+
+    }
+
+    size_t nblocks = (m_size + BLOCK - 1)/BLOCK;
+
+    #pragma omp parallel for
+    for(size_t s=0; s<nblocks; s++) {
+
+        size_t begin = s*BLOCK;
+        size_t nb = (m_size - begin<BLOCK) ? m_size - begin : BLOCK;
+
+        T x[N][BLOCK], P[N][N][BLOCK];
+        T PCt[N][M][BLOCK], L[M][M][BLOCK], Kt[M][N][BLOCK], nu[M][BLOCK];
+        T F[N][N][BLOCK], FP[N][N][BLOCK];
+        bool valid[BLOCK];
+
+        this->Load(begin,nb,x,P);
+
+        for(size_t b=0; b<nb; b++)
+            valid[b] = true;
+
+        // innovation, missing measurements are marked by NaN
+        for(u_int j=0; j<M; j++) {
+
+            const T* py = y.Data().get() + j*m_size + begin;
+
+            for(size_t b=0; b<nb; b++) {
+
+                valid[b] = valid[b] && (py[b]==py[b]);
+                nu[j][b] = py[b];
+
+            }
+
+            for(u_int c=0; c<N; c++) {
+
+                T cc = m_C.Get(j,c);
+
+                for(size_t b=0; b<nb; b++)
+                    nu[j][b] -= cc*x[c][b];
+
+            }
+
+        }
+
+        // PC^T
+        for(u_int r=0; r<N; r++) {
+
+            for(u_int j=0; j<M; j++) {
+
+                for(size_t b=0; b<nb; b++)
+                    PCt[r][j][b] = 0;
+
+                for(u_int c=0; c<N; c++) {
+
+                    T cc = m_C.Get(j,c);
+
+                    for(size_t b=0; b<nb; b++)
+                        PCt[r][j][b] += P[r][c][b]*cc;
+
+                }
+
+            }
+
+        }
+
+        // S = CPC^T + R, lower triangle, and its Cholesky factor in the same place
+        for(u_int j=0; j<M; j++) {
+
+            for(u_int k=0; k<=j; k++) {
+
+                T rr = m_R.Get(j,k);
+
+                for(size_t b=0; b<nb; b++)
+                    L[j][k][b] = rr;
+
+                for(u_int r=0; r<N; r++) {
+
+                    T cc = m_C.Get(j,r);
+
+                    for(size_t b=0; b<nb; b++)
+                        L[j][k][b] += cc*PCt[r][k][b];
+
+                }
+
+            }
+
+        }
+
+        for(u_int j=0; j<M; j++) {
+
+            for(u_int l=0; l<j; l++) {
+
+                for(size_t b=0; b<nb; b++)
+                    L[j][j][b] -= L[j][l][b]*L[j][l][b];
+
+            }
+
+            for(size_t b=0; b<nb; b++) {
+
+                bool pd = L[j][j][b]>0;
+                valid[b] = valid[b] && pd;
+                L[j][j][b] = pd ? sqrt(L[j][j][b]) : T(1);
+
+            }
+
+            for(u_int i=j+1; i<M; i++) {
+
+                for(u_int l=0; l<j; l++) {
+
+                    for(size_t b=0; b<nb; b++)
+                        L[i][j][b] -= L[i][l][b]*L[j][l][b];
+
+                }
+
+                for(size_t b=0; b<nb; b++)
+                    L[i][j][b] /= L[j][j][b];
+
+            }
+
+        }
+
+        // transposed gain K^T = S^{-1}CP by forward and backward substitution
+        for(u_int r=0; r<N; r++) {
+
+            for(u_int i=0; i<M; i++) {
+
+                for(size_t b=0; b<nb; b++)
+                    Kt[i][r][b] = PCt[r][i][b];
+
+                for(u_int l=0; l<i; l++) {
+
+                    for(size_t b=0; b<nb; b++)
+                        Kt[i][r][b] -= L[i][l][b]*Kt[l][r][b];
+
+                }
+
+                for(size_t b=0; b<nb; b++)
+                    Kt[i][r][b] /= L[i][i][b];
+
+            }
+
+            for(u_int i=M; i-->0; ) {
+
+                for(u_int l=i+1; l<M; l++) {
+
+                    for(size_t b=0; b<nb; b++)
+                        Kt[i][r][b] -= L[l][i][b]*Kt[l][r][b];
+
+                }
+
+                for(size_t b=0; b<nb; b++)
+                    Kt[i][r][b] /= L[i][i][b];
+
+            }
+
+        }
+
+        // state update and F = I - KC
+        for(u_int r=0; r<N; r++) {
+
+            for(u_int j=0; j<M; j++) {
+
+                for(size_t b=0; b<nb; b++)
+                    x[r][b] += Kt[j][r][b]*nu[j][b];
+
+            }
+
+            for(u_int c=0; c<N; c++) {
+
+                T delta = (r==c) ? 1 : 0;
+
+                for(size_t b=0; b<nb; b++)
+                    F[r][c][b] = delta;
+
+                for(u_int j=0; j<M; j++) {
+
+                    T cc = m_C.Get(j,c);
+
+                    for(size_t b=0; b<nb; b++)
+                        F[r][c][b] -= Kt[j][r][b]*cc;
+
+                }
+
+            }
+
+        }
+
+        // Joseph form P = FPF^T + KRK^T, only the lower triangle
+        for(u_int r=0; r<N; r++) {
+
+            for(u_int c=0; c<N; c++) {
+
+                for(size_t b=0; b<nb; b++)
+                    FP[r][c][b] = 0;
+
+                for(u_int l=0; l<N; l++) {
+
+                    for(size_t b=0; b<nb; b++)
+                        FP[r][c][b] += F[r][l][b]*P[l][c][b];
+
+                }
+
+            }
+
+        }
+
+        for(u_int r=0; r<N; r++) {
+
+            for(u_int c=0; c<=r; c++) {
+
+                for(size_t b=0; b<nb; b++)
+                    P[r][c][b] = 0;
+
+                for(u_int l=0; l<N; l++) {
+
+                    for(size_t b=0; b<nb; b++)
+                        P[r][c][b] += FP[r][l][b]*F[c][l][b];
+
+                }
+
+                for(u_int j=0; j<M; j++) {
+
+                    for(u_int k=0; k<M; k++) {
+
+                        T rr = m_R.Get(j,k);
+
+                        for(size_t b=0; b<nb; b++)
+                            P[r][c][b] += Kt[j][r][b]*rr*Kt[k][c][b];
+
+                    }
+
+                }
+
+            }
+
+        }
+
+        this->Store(begin,nb,x,P,valid);
+
+    }
+
+}
+
 }
 
 
@@ -0,0 +1,520 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "linop.h"
+
+#include <iostream>
+#include <assert.h>
+
+using namespace std;
+
+namespace R4R {
+
+template<typename T>
+CLinearOperator<T>::CLinearOperator():
+    m_nrows(0),
+    m_ncols(0),
+    m_transpose(false),
+    m_op() {}
+
+template<typename T>
+CLinearOperator<T>::CLinearOperator(size_t nrows, size_t ncols):
+    m_nrows(nrows),
+    m_ncols(ncols),
+    m_transpose(false),
+    m_op() {}
+
+template<typename T>
+CLinearOperator<T>::CLinearOperator(const shared_ptr<const CAbstractLinearOperator<T> >& op):
+    m_nrows(op->NRows()),
+    m_ncols(op->NCols()),
+    m_transpose(false),
+    m_op(op) {}
+
+template<typename T>
+void CLinearOperator<T>::Multiply(const CDenseArray<T>& x, CDenseArray<T>& y) const {
+
+    assert(this->NCols()==x.NRows() && this->NRows()==y.NRows() && x.NCols()==y.NCols());
+
+    if(!m_op) {
+
+        cerr << "ERROR: No operator attached to handle." << endl;
+        return;
+
+    }
+
+    if(!m_transpose)
+        m_op->Apply(x,y);
+    else
+        m_op->ApplyTranspose(x,y);
+
+}
+
+template<typename T>
+template<class Matrix>
+Matrix CLinearOperator<T>::operator*(const Matrix& array) const {
+
+    Matrix result(this->NRows(),array.NCols());
+
+    this->Multiply(array,result);
+
+    return result;
+
+}
+
+template CDenseArray<double> CLinearOperator<double>::operator*(const CDenseArray<double>& array) const;
+template CDenseVector<double> CLinearOperator<double>::operator*(const CDenseVector<double>& array) const;
+template CDenseArray<float> CLinearOperator<float>::operator*(const CDenseArray<float>& array) const;
+template CDenseVector<float> CLinearOperator<float>::operator*(const CDenseVector<float>& array) const;
+
+template<typename T>
+CDenseVector<T> CLinearOperator<T>::Diagonal(bool normal) const {
+
+    if(!m_op) {
+
+        cerr << "ERROR: No operator attached to handle." << endl;
+        return CDenseVector<T>();
+
+    }
+
+    // the diagonal of A does not change under transposition, but the normal operator does
+    if(normal && m_transpose) {
+
+        cerr << "ERROR: Diagonal of AA' is not available." << endl;
+        return CDenseVector<T>();
+
+    }
+
+    return m_op->Diagonal(normal);
+
+}
+
+template<typename T>
+CLinearOperator<T> CLinearOperator<T>::Transpose(const CLinearOperator<T>& x) {
+
+    CLinearOperator<T> result(x);
+    result.m_transpose = !x.m_transpose;
+    return result;
+
+}
+
+template class CLinearOperator<float>;
+template class CLinearOperator<double>;
+
+template<typename T>
+CGradientOperator<T>::CGradientOperator(size_t height, size_t width):
+    m_height(height),
+    m_width(width) {}
+
+template<typename T>
+void CGradientOperator<T>::Apply(const CDenseArray<T>& x, CDenseArray<T>& y) const {
+
+    assert(x.NRows()==NCols() && y.NRows()==NRows() && x.NCols()==y.NCols());
+
+    size_t npts = m_height*m_width;
+
+    for(size_t k=0; k<x.NCols(); k++) {
+
+        const T* pu = x.Data().get() + k*npts;
+        T* pdx = y.Data().get() + k*2*npts;
+        T* pdy = pdx + npts;
+
+        #pragma omp parallel for
+        for(size_t j=0; j<m_width; j++) {
+
+            for(size_t i=0; i<m_height; i++) {
+
+                size_t row = j*m_height + i;
+
+                pdx[row] = j<m_width-1 ? pu[row+m_height] - pu[row] : 0;
+                pdy[row] = i<m_height-1 ? pu[row+1] - pu[row] : 0;
+
+            }
+
+        }
+
+    }
+
+}
+
+template<typename T>
+void CGradientOperator<T>::ApplyTranspose(const CDenseArray<T>& x, CDenseArray<T>& y) const {
+
+    assert(x.NRows()==NRows() && y.NRows()==NCols() && x.NCols()==y.NCols());
+
+    size_t npts = m_height*m_width;
+
+    for(size_t k=0; k<x.NCols(); k++) {
+
+        const T* pdx = x.Data().get() + k*2*npts;
+        const T* pdy = pdx + npts;
+        T* pu = y.Data().get() + k*npts;
+
+        // gather form of the negative divergence, so that columns can be processed in parallel
+        #pragma omp parallel for
+        for(size_t j=0; j<m_width; j++) {
+
+            for(size_t i=0; i<m_height; i++) {
+
+                size_t row = j*m_height + i;
+
+                T sum = 0;
+
+                if(j<m_width-1)
+                    sum -= pdx[row];
+
+                if(j>0)
+                    sum += pdx[row-m_height];
+
+                if(i<m_height-1)
+                    sum -= pdy[row];
+
+                if(i>0)
+                    sum += pdy[row-1];
+
+                pu[row] = sum;
+
+            }
+
+        }
+
+    }
+
+}
+
+template<typename T>
+CDenseVector<T> CGradientOperator<T>::Diagonal(bool normal) const {
+
+    // the first hw rows hold the x-derivatives
+    CDenseVector<T> result(NCols());
+
+    for(size_t j=0; j<m_width; j++) {
+
+        for(size_t i=0; i<m_height; i++) {
+
+            size_t row = j*m_height + i;
+
+            if(normal)
+                result(row) = T(j>0) + T(j<m_width-1) + T(i>0) + T(i<m_height-1);
+            else
+                result(row) = j<m_width-1 ? -1 : 0;
+
+        }
+
+    }
+
+    return result;
+
+}
+
+template class CGradientOperator<float>;
+template class CGradientOperator<double>;
+
+//! Computes \f$y=(\alpha A;\beta B)x\f$ by writing the products of the blocks into views of \f$y\f$.
+template<class Matrix,typename T>
+static void StackedMultiply(const Matrix& A, const Matrix& B, T alpha, T beta, const CDenseArray<T>& x, CDenseArray<T>& y) {
+
+    size_t ma = A.NRows();
+    size_t mb = B.NRows();
+    size_t n = A.NCols();
+
+    for(size_t k=0; k<x.NCols(); k++) {
+
+        CDenseArray<T> xk(n,1,shared_ptr<T>(x.Data(),x.Data().get()+k*n));
+        CDenseArray<T> ya(ma,1,shared_ptr<T>(y.Data(),y.Data().get()+k*(ma+mb)));
+        CDenseArray<T> yb(mb,1,shared_ptr<T>(y.Data(),y.Data().get()+k*(ma+mb)+ma));
+
+        A.Multiply(xk,ya);
+        B.Multiply(xk,yb);
+
+        T* pya = ya.Data().get();
+        T* pyb = yb.Data().get();
+
+        #pragma omp parallel for
+        for(size_t i=0; i<ma; i++)
+            pya[i] *= alpha;
+
+        #pragma omp parallel for
+        for(size_t i=0; i<mb; i++)
+            pyb[i] *= beta;
+
+    }
+
+}
+
+//! Computes \f$y=\alpha A^{\top}x_A+\beta B^{\top}x_B\f$ given the transposed blocks.
+template<class Matrix,typename T>
+static void StackedMultiplyTranspose(const Matrix& At, const Matrix& Bt, T alpha, T beta, const CDenseArray<T>& x, CDenseArray<T>& y) {
+
+    size_t ma = At.NCols();
+    size_t mb = Bt.NCols();
+    size_t n = At.NRows();
+
+    CDenseArray<T> temp(n,1);
+    T* ptemp = temp.Data().get();
+
+    for(size_t k=0; k<x.NCols(); k++) {
+
+        CDenseArray<T> xa(ma,1,shared_ptr<T>(x.Data(),x.Data().get()+k*(ma+mb)));
+        CDenseArray<T> xb(mb,1,shared_ptr<T>(x.Data(),x.Data().get()+k*(ma+mb)+ma));
+        CDenseArray<T> yk(n,1,shared_ptr<T>(y.Data(),y.Data().get()+k*n));
+
+        At.Multiply(xa,yk);
+        Bt.Multiply(xb,temp);
+
+        T* pyk = yk.Data().get();
+
+        #pragma omp parallel for
+        for(size_t i=0; i<n; i++)
+            pyk[i] = alpha*pyk[i] + beta*ptemp[i];
+
+    }
+
+}
+
+//! Fused product with two row-compressed blocks in a single parallel pass over all rows.
+template<typename T>
+static void StackedMultiply(const CCSRMatrix<T,size_t>& A, const CCSRMatrix<T,size_t>& B, T alpha, T beta, const CDenseArray<T>& x, CDenseArray<T>& y) {
+
+    if(A.IsTransposed() || B.IsTransposed()) {
+
+        StackedMultiply<CCSRMatrix<T,size_t>,T>(A,B,alpha,beta,x,y);
+        return;
+
+    }
+
+    size_t ma = A.NRows();
+    size_t mb = B.NRows();
+    size_t n = A.NCols();
+
+    const size_t* rowptra = A.GetRowPtr()->data();
+    const size_t* colsa = A.GetCols()->data();
+    const T* valsa = A.GetValues()->data();
+    const size_t* rowptrb = B.GetRowPtr()->data();
+    const size_t* colsb = B.GetCols()->data();
+    const T* valsb = B.GetValues()->data();
+
+    for(size_t k=0; k<x.NCols(); k++) {
+
+        const T* px = x.Data().get() + k*n;
+        T* py = y.Data().get() + k*(ma+mb);
+
+        #pragma omp parallel for
+        for(size_t i=0; i<ma+mb; i++) {
+
+            bool upper = i<ma;
+            size_t row = upper ? i : i - ma;
+            const size_t* rowptr = upper ? rowptra : rowptrb;
+            const size_t* cols = upper ? colsa : colsb;
+            const T* vals = upper ? valsa : valsb;
+
+            T sum = 0;
+
+            for(size_t j=rowptr[row]; j<rowptr[row+1]; j++)
+                sum += vals[j]*px[cols[j]];
+
+            py[i] = (upper ? alpha : beta)*sum;
+
+        }
+
+    }
+
+}
+
+//! Fused transposed product with two row-compressed blocks in a single pass over all rows.
+template<typename T>
+static void StackedMultiplyTranspose(const CCSRMatrix<T,size_t>& At, const CCSRMatrix<T,size_t>& Bt, T alpha, T beta, const CDenseArray<T>& x, CDenseArray<T>& y) {
+
+    if(!At.IsTransposed() || !Bt.IsTransposed()) {
+
+        StackedMultiplyTranspose<CCSRMatrix<T,size_t>,T>(At,Bt,alpha,beta,x,y);
+        return;
+
+    }
+
+    // the rows of the original blocks
+    size_t ma = At.NCols();
+    size_t mb = Bt.NCols();
+    size_t n = At.NRows();
+
+    const size_t* rowptra = At.GetRowPtr()->data();
+    const size_t* colsa = At.GetCols()->data();
+    const T* valsa = At.GetValues()->data();
+    const size_t* rowptrb = Bt.GetRowPtr()->data();
+    const size_t* colsb = Bt.GetCols()->data();
+    const T* valsb = Bt.GetValues()->data();
+
+    // scattering into the rows of y, so no parallelization here
+    y.Zeros();
+
+    for(size_t k=0; k<x.NCols(); k++) {
+
+        const T* px = x.Data().get() + k*(ma+mb);
+        T* py = y.Data().get() + k*n;
+
+        for(size_t i=0; i<ma; i++) {
+
+            T xi = alpha*px[i];
+
+            for(size_t j=rowptra[i]; j<rowptra[i+1]; j++)
+                py[colsa[j]] += valsa[j]*xi;
+
+        }
+
+        for(size_t i=0; i<mb; i++) {
+
+            T xi = beta*px[ma+i];
+
+            for(size_t j=rowptrb[i]; j<rowptrb[i+1]; j++)
+                py[colsb[j]] += valsb[j]*xi;
+
+        }
+
+    }
+
+}
+
+//! Diagonal of a stacked operator by probing with unit vectors.
+template<class Matrix,typename T>
+static CDenseVector<T> StackedDiagonal(const Matrix& A, const Matrix& B, T alpha, T beta, bool normal) {
+
+    size_t ma = A.NRows();
+    size_t mb = B.NRows();
+    size_t n = A.NCols();
+
+    CDenseVector<T> result(n), e(n), ca(ma), cb(mb);
+
+    for(size_t j=0; j<n; j++) {
+
+        e(j) = 1;
+
+        A.Multiply(e,ca);
+        B.Multiply(e,cb);
+
+        if(normal) {
+
+            T na = ca.Norm2();
+            T nb = cb.Norm2();
+            result(j) = alpha*alpha*na*na + beta*beta*nb*nb;
+
+        }
+        else if(j<ma)
+            result(j) = alpha*ca.Get(j);
+        else if(j<ma+mb)
+            result(j) = beta*cb.Get(j-ma);
+
+        e(j) = 0;
+
+    }
+
+    return result;
+
+}
+
+//! Diagonal of a stacked operator from two row-compressed blocks.
+template<typename T>
+static CDenseVector<T> StackedDiagonal(const CCSRMatrix<T,size_t>& A, const CCSRMatrix<T,size_t>& B, T alpha, T beta, bool normal) {
+
+    if(A.IsTransposed() || B.IsTransposed())
+        return StackedDiagonal<CCSRMatrix<T,size_t>,T>(A,B,alpha,beta,normal);
+
+    size_t n = A.NCols();
+    CDenseVector<T> result(n);
+    T* pd = result.Data().get();
+
+    const CCSRMatrix<T,size_t>* blocks[2] = { &A, &B };
+    T weights[2] = { alpha, beta };
+    size_t offset = 0;
+
+    for(u_int b=0; b<2; b++) {
+
+        const size_t* rowptr = blocks[b]->GetRowPtr()->data();
+        const size_t* cols = blocks[b]->GetCols()->data();
+        const T* vals = blocks[b]->GetValues()->data();
+        T w = weights[b];
+
+        for(size_t i=0; i<blocks[b]->NRows(); i++) {
+
+            for(size_t j=rowptr[i]; j<rowptr[i+1]; j++) {
+
+                if(normal)
+                    pd[cols[j]] += w*w*vals[j]*vals[j];
+                else if(cols[j]==offset+i)
+                    pd[cols[j]] += w*vals[j];
+
+            }
+
+        }
+
+        offset += blocks[b]->NRows();
+
+    }
+
+    return result;
+
+}
+
+template<class Matrix,typename T>
+CStackedOperator<Matrix,T>::CStackedOperator(const Matrix& A, const Matrix& B, T alpha, T beta):
+    m_A(A),
+    m_B(B),
+    m_At(Matrix::Transpose(A)),
+    m_Bt(Matrix::Transpose(B)),
+    m_alpha(alpha),
+    m_beta(beta) {
+
+    assert(A.NCols()==B.NCols());
+
+}
+
+template<class Matrix,typename T>
+void CStackedOperator<Matrix,T>::Apply(const CDenseArray<T>& x, CDenseArray<T>& y) const {
+
+    assert(x.NRows()==NCols() && y.NRows()==NRows() && x.NCols()==y.NCols());
+
+    StackedMultiply(m_A,m_B,m_alpha,m_beta,x,y);
+
+}
+
+template<class Matrix,typename T>
+void CStackedOperator<Matrix,T>::ApplyTranspose(const CDenseArray<T>& x, CDenseArray<T>& y) const {
+
+    assert(x.NRows()==NRows() && y.NRows()==NCols() && x.NCols()==y.NCols());
+
+    StackedMultiplyTranspose(m_At,m_Bt,m_alpha,m_beta,x,y);
+
+}
+
+template<class Matrix,typename T>
+CDenseVector<T> CStackedOperator<Matrix,T>::Diagonal(bool normal) const {
+
+    return StackedDiagonal(m_A,m_B,m_alpha,m_beta,normal);
+
+}
+
+template class CStackedOperator<CCSRMatrix<float,size_t>,float>;
+template class CStackedOperator<CCSRMatrix<double,size_t>,double>;
+template class CStackedOperator<CSparseArray<float>,float>;
+template class CStackedOperator<CSparseArray<double>,double>;
+
+}
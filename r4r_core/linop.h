@@ -0,0 +1,235 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef R4RLINOP_H_
+#define R4RLINOP_H_
+
+#include <memory>
+
+#include "darray.h"
+#include "sarray.h"
+
+namespace R4R {
+
+/*! \brief interface for matrix-free linear operators
+ *
+ * An operator \f$A\in\mathbb{R}^{m\times n}\f$ is only known through its action on dense arrays
+ * (whose columns are treated as individual vectors). Derive from this class to run the iterative
+ * solvers on stencils or other structured operators without ever assembling a sparse matrix. The
+ * solvers themselves access it through the value type CLinearOperator.
+ *
+ */
+template<typename T>
+class CAbstractLinearOperator {
+
+public:
+
+    //! Destructor.
+    virtual ~CAbstractLinearOperator() {}
+
+    //! Number of rows \f$m\f$.
+    virtual size_t NRows() const = 0;
+
+    //! Number of columns \f$n\f$.
+    virtual size_t NCols() const = 0;
+
+    /*! \brief Computes \f$y=Ax\f$.
+     *
+     * \param[in] x array with \f$n\f$ rows
+     * \param[out] y pre-allocated array with \f$m\f$ rows, whose data is overwritten
+     *
+     */
+    virtual void Apply(const CDenseArray<T>& x, CDenseArray<T>& y) const = 0;
+
+    //! Computes \f$y=A^{\top}x\f$, cf. Apply().
+    virtual void ApplyTranspose(const CDenseArray<T>& x, CDenseArray<T>& y) const = 0;
+
+    /*! \brief Diagonal of the operator.
+     *
+     * \param[in] normal if true, the diagonal of the normal operator \f$A^{\top}A\f$ is returned,
+     * i.e., the squared norms of the columns of \f$A\f$
+     *
+     */
+    virtual CDenseVector<T> Diagonal(bool normal = false) const = 0;
+
+};
+
+/*! \brief handle for matrix-free operators
+ *
+ * This class fulfills the matrix interface expected by the iterative solvers, preconditioners, and
+ * the Levenberg-Marquardt method, i.e., it can be used as their template argument Matrix. Copies
+ * are shallow, and transposition only flips a flag.
+ *
+ */
+template<typename T>
+class CLinearOperator {
+
+public:
+
+    //! Standard constructor.
+    CLinearOperator();
+
+    /*! \brief Constructor.
+     *
+     * Creates an empty handle of the given size. This is how CLevenbergMarquardt allocates its
+     * Jacobians. The actual operator is assigned later by the least-squares problem.
+     *
+     */
+    CLinearOperator(size_t nrows, size_t ncols);
+
+    //! Constructor.
+    CLinearOperator(const std::shared_ptr<const CAbstractLinearOperator<T> >& op);
+
+    //! Access number of rows.
+    size_t NRows() const { return m_transpose ? m_ncols : m_nrows; }
+
+    //! Access number of cols.
+    size_t NCols() const { return m_transpose ? m_nrows : m_ncols; }
+
+    //! Checks whether an operator is attached to the handle.
+    bool IsEmpty() const { return !m_op; }
+
+    //! Access to the operator, shared by all copies of the handle.
+    const std::shared_ptr<const CAbstractLinearOperator<T> >& GetOperator() const { return m_op; }
+
+    //! Checks whether the handle represents the transpose of the operator.
+    bool IsTransposed() const { return m_transpose; }
+
+    //! Computes \f$y=Ax\f$ in the memory of \f$y\f$, see CDenseArray::Multiply.
+    void Multiply(const CDenseArray<T>& x, CDenseArray<T>& y) const;
+
+    //! Multiplies the object with a dense array from the right.
+    template<class Matrix> Matrix operator*(const Matrix& array) const;
+
+    //! \copydoc CAbstractLinearOperator::Diagonal(bool)
+    CDenseVector<T> Diagonal(bool normal = false) const;
+
+    //! Transposition.
+    static CLinearOperator<T> Transpose(const CLinearOperator<T>& x);
+
+    //! In-place transpose.
+    void Transpose() { m_transpose = !m_transpose; }
+
+private:
+
+    size_t m_nrows;                                             //!< number of rows
+    size_t m_ncols;                                             //!< number of cols
+    bool m_transpose;                                           //!< transposition flag
+    std::shared_ptr<const CAbstractLinearOperator<T> > m_op;    //!< operator
+
+};
+
+/*! \brief forward-difference gradient of an image
+ *
+ * Maps an image \f$u\f$ of size \f$h\times w\f$, stored column-major as a vector of length \f$hw\f$,
+ * to the stacked partial derivatives \f$(\partial_xu,\partial_yu)\f$ with homogeneous Neumann boundary
+ * conditions. The layout of the result equals that of a gradient matrix with DIM::TWO as used by
+ * CSplitBregman. The adjoint is the negative divergence.
+ *
+ */
+template<typename T>
+class CGradientOperator:public CAbstractLinearOperator<T> {
+
+public:
+
+    /*! \brief Constructor.
+     *
+     * \param[in] height number of image rows
+     * \param[in] width number of image columns
+     *
+     */
+    CGradientOperator(size_t height, size_t width);
+
+    //! \copydoc CAbstractLinearOperator::NRows()
+    size_t NRows() const { return 2*m_height*m_width; }
+
+    //! \copydoc CAbstractLinearOperator::NCols()
+    size_t NCols() const { return m_height*m_width; }
+
+    //! \copydoc CAbstractLinearOperator::Apply(const CDenseArray<T>&,CDenseArray<T>&)
+    void Apply(const CDenseArray<T>& x, CDenseArray<T>& y) const;
+
+    //! \copydoc CAbstractLinearOperator::ApplyTranspose(const CDenseArray<T>&,CDenseArray<T>&)
+    void ApplyTranspose(const CDenseArray<T>& x, CDenseArray<T>& y) const;
+
+    //! \copydoc CAbstractLinearOperator::Diagonal(bool)
+    CDenseVector<T> Diagonal(bool normal = false) const;
+
+private:
+
+    size_t m_height;                    //!< image height
+    size_t m_width;                     //!< image width
+
+};
+
+/*! \brief lazy vertical concatenation of two scaled matrices
+ *
+ * Represents \f$\begin{pmatrix}\alpha A\\\beta B\end{pmatrix}\f$ without assembling it. For
+ * CCSRMatrix, both blocks are processed in one fused pass over their rows. The blocks are
+ * stored as shallow copies if Matrix supports it.
+ *
+ */
+template<class Matrix,typename T>
+class CStackedOperator:public CAbstractLinearOperator<T> {
+
+public:
+
+    /*! \brief Constructor.
+     *
+     * \param[in] A upper block
+     * \param[in] B lower block, with the same number of columns as \f$A\f$
+     * \param[in] alpha weight of \f$A\f$
+     * \param[in] beta weight of \f$B\f$
+     *
+     */
+    CStackedOperator(const Matrix& A, const Matrix& B, T alpha = 1, T beta = 1);
+
+    //! \copydoc CAbstractLinearOperator::NRows()
+    size_t NRows() const { return m_A.NRows() + m_B.NRows(); }
+
+    //! \copydoc CAbstractLinearOperator::NCols()
+    size_t NCols() const { return m_A.NCols(); }
+
+    //! \copydoc CAbstractLinearOperator::Apply(const CDenseArray<T>&,CDenseArray<T>&)
+    void Apply(const CDenseArray<T>& x, CDenseArray<T>& y) const;
+
+    //! \copydoc CAbstractLinearOperator::ApplyTranspose(const CDenseArray<T>&,CDenseArray<T>&)
+    void ApplyTranspose(const CDenseArray<T>& x, CDenseArray<T>& y) const;
+
+    //! \copydoc CAbstractLinearOperator::Diagonal(bool)
+    CDenseVector<T> Diagonal(bool normal = false) const;
+
+private:
+
+    Matrix m_A;                         //!< upper block
+    Matrix m_B;                         //!< lower block
+    Matrix m_At;                        //!< transpose of upper block
+    Matrix m_Bt;                        //!< transpose of lower block
+    T m_alpha;                          //!< weight of upper block
+    T m_beta;                           //!< weight of lower block
+
+};
+
+}
+
+#endif /* R4RLINOP_H_ */
@@ -29,6 +29,8 @@
 #include <assert.h>
 
 #include "rutils.h"
+#include "spectrum.h"
+#include "factor.h"
 
 
 using namespace std;
@@ -69,10 +71,48 @@ CDenseVector<T> CLeastSquaresProblem<Matrix,T>::ComputeDispersion(const CDenseVe
 
 }
 
+template <class Matrix,typename T>
+void CLeastSquaresProblem<Matrix,T>::PrepareJacobian(Matrix& /*J*/) const {}
+
+template <typename T>
+static void PrepareCSRJacobian(const CLeastSquaresProblem<CCSRMatrix<T>,T>& problem, CCSRMatrix<T>& J) {
+
+    size_t m = problem.GetNumberOfDataPoints();
+
+    shared_ptr<vector<size_t> > rowptr(new vector<size_t>(m+1));
+    (*rowptr)[0] = 0;
+
+    for(size_t i=0; i<m; i++)
+        (*rowptr)[i+1] = (*rowptr)[i] + problem.GetJacobianRowLength(i);
+
+    shared_ptr<vector<size_t> > cols(new vector<size_t>(rowptr->back()));
+    shared_ptr<vector<T> > vals(new vector<T>(rowptr->back()));
+
+    J = CCSRMatrix<T>(m,problem.GetNumberOfModelParameters(),rowptr,cols,vals);
+
+}
+
+template <>
+void CLeastSquaresProblem<CCSRMatrix<float>,float>::PrepareJacobian(CCSRMatrix<float>& J) const {
+
+    PrepareCSRJacobian(*this,J);
+
+}
+
+template <>
+void CLeastSquaresProblem<CCSRMatrix<double>,double>::PrepareJacobian(CCSRMatrix<double>& J) const {
+
+    PrepareCSRJacobian(*this,J);
+
+}
+
 template class CLeastSquaresProblem<mat,double>;
 template class CLeastSquaresProblem<smat,double>;
 template class CLeastSquaresProblem<smatf,float>;
 template class CLeastSquaresProblem<CCSRMatrix<float>,float>;
+template class CLeastSquaresProblem<CCSRMatrix<double>,double>;
+template class CLeastSquaresProblem<CLinearOperator<double>,double>;
+template class CLeastSquaresProblem<CLinearOperator<float>,float>;
 
 template<typename T>
 T CHuberWeightFunction<T>::operator()(const CDenseVector<T>& r, CDenseVector<T>& w) const {
@@ -130,8 +170,199 @@ T CBiSquareWeightFunction<T>::operator()(const CDenseVector<T>& r, CDenseVector<
 template class CBiSquareWeightFunction<float>;
 template class CBiSquareWeightFunction<double>;
 
+/*! \brief Assembles the normal equations \f$H=J^{\top}J\f$ and \f$g=J^{\top}r\f$.
+ *
+ * Generic version using one product with \f$J\f$ and \f$J^{\top}\f$ per column. Only the
+ * lower triangle of \f$H\f$ is required by the Cholesky decomposition.
+ *
+ */
+template <class Matrix,typename T>
+static void ComputeNormalEquations(Matrix& J, const CDenseVector<T>& r, T* H, CDenseVector<T>& g) {
+
+    size_t m = J.NRows();
+    size_t n = J.NCols();
+
+    CDenseVector<T> e(n), Je(m), h(n);
+
+    J.Transpose();
+    J.Multiply(r,g);
+    J.Transpose();
+
+    for(size_t j=0; j<n; j++) {
+
+        e.Zeros();
+        e(j) = 1;
+
+        J.Multiply(e,Je);
+        J.Transpose();
+        J.Multiply(Je,h);
+        J.Transpose();
+
+        copy(h.Data().get(),h.Data().get()+n,H+n*j);
+
+    }
+
+}
+
+//! Adds a partial sum of the normal equations to the total in a thread-safe manner.
+template <typename T>
+static void AccumulateNormalEquations(const vector<T>& Hl, const vector<T>& gl, T* H, T* g, size_t n) {
+
+#pragma omp critical
+    {
+
+        for(size_t i=0; i<n*n; i++)
+            H[i] += Hl[i];
+
+        for(size_t i=0; i<n; i++)
+            g[i] += gl[i];
+
+    }
+
+}
+
+//! Assembles the normal equations from a column-major dense Jacobian in one pass over its rows.
+template <typename T>
+static void ComputeNormalEquations(CDenseArray<T>& J, const CDenseVector<T>& r, T* H, CDenseVector<T>& g) {
+
+    size_t m = J.NRows();
+    size_t n = J.NCols();
+    const size_t chunk = 256;
+    size_t nchunks = (m + chunk - 1)/chunk;
+
+    const T* pj = J.Data().get();
+    const T* pr = r.Data().get();
+    T* pg = g.Data().get();
+
+    fill_n(H,n*n,0);
+    fill_n(pg,n,0);
+
+#pragma omp parallel if(nchunks>1)
+    {
+
+        vector<T> Hl(n*n,0), gl(n,0);
+
+        // a block of rows of all columns stays in cache
+#pragma omp for
+        for(size_t k=0; k<nchunks; k++) {
+
+            size_t begin = k*chunk;
+            size_t end = min(m,begin+chunk);
+
+            for(size_t j=0; j<n; j++) {
+
+                const T* cj = pj + m*j;
+
+                for(size_t i=begin; i<end; i++)
+                    gl[j] += cj[i]*pr[i];
+
+                for(size_t l=j; l<n; l++) {
+
+                    const T* cl = pj + m*l;
+                    T sum = 0;
+
+                    for(size_t i=begin; i<end; i++)
+                        sum += cj[i]*cl[i];
+
+                    Hl[l+n*j] += sum;
+
+                }
+
+            }
+
+        }
+
+        AccumulateNormalEquations(Hl,gl,H,pg,n);
+
+    }
+
+}
+
+//! Assembles the normal equations from a sparse Jacobian in one pass over its rows.
+template <typename T>
+static void ComputeNormalEquations(CCSRMatrix<T>& J, const CDenseVector<T>& r, T* H, CDenseVector<T>& g) {
+
+    // rows of a transposed matrix are not stored contiguously
+    if(J.IsTransposed()) {
+
+        ComputeNormalEquations<CCSRMatrix<T>,T>(J,r,H,g);
+        return;
+
+    }
+
+    size_t m = J.NRows();
+    size_t n = J.NCols();
+
+    const size_t* rowptr = J.GetRowPtr()->data();
+    const size_t* cols = J.GetCols()->data();
+    const T* vals = J.GetValues()->data();
+    const T* pr = r.Data().get();
+    T* pg = g.Data().get();
+
+    fill_n(H,n*n,0);
+    fill_n(pg,n,0);
+
+#pragma omp parallel if(m>256)
+    {
+
+        vector<T> Hl(n*n,0), gl(n,0);
+
+#pragma omp for schedule(static)
+        for(size_t i=0; i<m; i++) {
+
+            for(size_t a=rowptr[i]; a<rowptr[i+1]; a++) {
+
+                size_t ca = cols[a];
+                gl[ca] += vals[a]*pr[i];
+
+                for(size_t b=rowptr[i]; b<=a; b++) {
+
+                    size_t cb = cols[b];
+                    Hl[max(ca,cb)+n*min(ca,cb)] += vals[a]*vals[b];
+
+                }
+
+            }
+
+        }
+
+        AccumulateNormalEquations(Hl,gl,H,pg,n);
+
+    }
+
+}
+
+//! Computes the gradient \f$J^{\top}r\f$ and, if \f$H\f$ is not empty, the normal matrix.
 template <class Matrix,typename T>
-const T CLevenbergMarquardt<Matrix,T>::m_params[5] = { 0.25, 0.75 , 2, 1.0/3.0, 3.0 };
+static void ComputeGradient(Matrix& J, const CDenseVector<T>& r, vector<T>& H, CDenseVector<T>& g) {
+
+    if(!H.empty())
+        ComputeNormalEquations(J,r,H.data(),g);
+    else {
+
+        J.Transpose();
+        J.Multiply(r,g);
+        J.Transpose();
+
+    }
+
+}
+
+//! Cholesky decomposition of \f$H+\lambda I\f$ in the memory of \f$L\f$.
+template <typename T>
+static bool FactorizeNormalEquations(const vector<T>& H, vector<T>& L, size_t n, T lambda) {
+
+    copy(H.begin(),H.end(),L.begin());
+
+    for(size_t i=0; i<n; i++)
+        L[i+n*i] += lambda;
+
+    return CMatrixFactorization<T>::Cholesky(L.data(),n);
+
+}
+
+template <class Matrix,typename T>
+const T CLevenbergMarquardt<Matrix,T>::m_params[6] = { 0.25, 0.75 , 2, 1.0/3.0, 3.0, 3 };
 
 template <class Matrix,typename T>
 CLevenbergMarquardt<Matrix,T>::CLevenbergMarquardt(CLeastSquaresProblem<Matrix,T>& problem, CIterativeLinearSolver<Matrix,T>& solver, T tau):
@@ -139,127 +370,306 @@ CLevenbergMarquardt<Matrix,T>::CLevenbergMarquardt(CLeastSquaresProblem<Matrix,T
 	m_solver(solver),
 	m_tau(tau),
 	m_lambda(0),
-	m_residuals(0) {
+	m_residuals(0),
+	m_ndense(16),
+	m_strategy(LMSTRATEGY::DAMPING),
+	m_geodesic(false),
+	m_alpha(0.75),
+	m_nsteps(0),
+	m_nrejected(0),
+	m_nsolves(0),
+	m_nevals(0) {
+
+}
+
+template <class Matrix,typename T>
+const size_t CLevenbergMarquardt<Matrix,T>::m_chunk = 256;
+
+template <class Matrix,typename T>
+void CLevenbergMarquardt<Matrix,T>::ComputeResidualAndJacobian(CDenseVector<T>& r, Matrix& J) const {
+
+    // fall back to serial evaluation if row ranges are not supported
+    if(!m_problem.ComputeResidualAndJacobian(0,0,r,J)) {
+
+        m_problem.ComputeResidualAndJacobian(r,J);
+        return;
+
+    }
+
+    m_problem.PrepareJacobian(J);
+
+    size_t m = m_problem.GetNumberOfDataPoints();
+    size_t nchunks = (m + m_chunk - 1)/m_chunk;
+
+#pragma omp parallel for schedule(dynamic) if(nchunks>1)
+    for(size_t k=0; k<nchunks; k++)
+        m_problem.ComputeResidualAndJacobian(k*m_chunk,min(m,(k+1)*m_chunk),r,J);
+
+}
+
+template <class Matrix,typename T>
+void CLevenbergMarquardt<Matrix,T>::ComputeResidual(CDenseVector<T>& r) const {
+
+    if(!m_problem.ComputeResidual(0,0,r)) {
+
+        m_problem.ComputeResidual(r);
+        return;
+
+    }
+
+    size_t m = m_problem.GetNumberOfDataPoints();
+    size_t nchunks = (m + m_chunk - 1)/m_chunk;
+
+#pragma omp parallel for schedule(dynamic) if(nchunks>1)
+    for(size_t k=0; k<nchunks; k++)
+        m_problem.ComputeResidual(k*m_chunk,min(m,(k+1)*m_chunk),r);
 
 }
 
 template <class Matrix,typename T>
 CDenseVector<T> CLevenbergMarquardt<Matrix,T>::Iterate(size_t n, T epsilon1, T epsilon2, bool silent) {
 
-	// access to state
+    m_nsteps = 0;
+    m_nrejected = 0;
+    m_nsolves = 0;
+    m_nevals = 0;
+
+    if(m_strategy==LMSTRATEGY::DOGLEG)
+        return IterateDogleg(n,epsilon1,epsilon2,silent);
+
+    // access to state
     CDenseVector<T>& x = m_problem.Get();
+    size_t m = m_problem.GetNumberOfDataPoints();
+    size_t nparams = m_problem.GetNumberOfModelParameters();
 
-	// initial residual, Jacobian
-    CDenseVector<T> r(m_problem.GetNumberOfDataPoints());
-    Matrix J(m_problem.GetNumberOfDataPoints(),m_problem.GetNumberOfModelParameters());
-	m_problem.ComputeResidualAndJacobian(r,J);
+    // initial residual, Jacobian
+    CDenseVector<T> r(m);
+    Matrix J(m,nparams);
+    ComputeResidualAndJacobian(r,J);
+    m_nevals++;
 
     // initial value for lambda, TODO: do this depending on trace of J'*J
-	m_lambda = m_tau*1;
+    m_lambda = m_tau*1;
 
     // residual norm
     T res = r.Norm2();
     m_residuals.push_back(res);
 
-	// gradient norm
-	J.Transpose();
-    CDenseVector<T> grad = J*r;
-	J.Transpose();
+    // for few parameters, solve the normal equations directly
+    vector<T> H, L;
+
+    if(nparams<=m_ndense) {
+
+        H.resize(nparams*nparams);
+        L.resize(nparams*nparams);
+
+    }
+
+    // gradient norm
+    CDenseVector<T> grad(nparams);
+    ComputeGradient(J,r,H,grad);
     T normgrad = grad.Norm2();
 
-	// init other quantities
+    // init other quantities
     T nu = m_params[2];
-	size_t k = 0;
+    size_t k = 0;
 
-	// in verbose mode, print out initial residual, etc.
-	if(!silent) {
+    // buffers re-used in all steps
+    CDenseVector<T> step(nparams);
+    CDenseVector<T> xold(nparams);
+    CDenseVector<T> rt(m);
+    Matrix Jt(m,nparams);
 
-		cout.setf(ios::scientific,ios::floatfield);
+    // additional buffers for geodesic acceleration
+    CDenseVector<T> rvv, acc, total;
 
-		cout << "k\t f(x)\t ||grad f||\t ||h||\t lambda" << endl;
-		cout << k << "\t" << res << "\t" << normgrad << "\t" << 0.0000 << "\t" << m_lambda << endl;
+    if(m_geodesic) {
 
-	}
+        rvv = CDenseVector<T>(m);
+        acc = CDenseVector<T>(nparams);
+        total = CDenseVector<T>(nparams);
+
+    }
+
+    // whether the last step was rejected, in which case J and r are the same as before
+    bool rejected = false;
+
+    // in verbose mode, print out initial residual, etc.
+    if(!silent) {
+
+        cout.setf(ios::scientific,ios::floatfield);
+
+        cout << "k\t f(x)\t ||grad f||\t ||h||\t lambda" << endl;
+        cout << k << "\t" << res << "\t" << normgrad << "\t" << 0.0000 << "\t" << m_lambda << endl;
+
+    }
+
+    while(true) {
+
+        // solve damped normal equations by Cholesky decomposition
+        bool factored = !H.empty() && FactorizeNormalEquations(H,L,nparams,m_lambda);
+
+        if(factored) {
+
+            copy(grad.Data().get(),grad.Data().get()+nparams,step.Data().get());
+            CMatrixFactorization<T>::CholeskySolve(L.data(),step.Data().get(),nparams);
+
+        }
+        else {
+
+            /* Otherwise, solve linear system after setting lmbda in the CGLS solver. If the last
+             * step was rejected, only the damping has grown, and the old step is a good initial guess.
+             */
+            if(!rejected)
+                step.Zeros();
+
+            m_solver.SetLambda(sqrt(m_lambda));
+            m_solver.Iterate(J,r,step);
 
-	while(true) {
+        }
 
-        // solve linear system after setting lmbda in the CGLS solver
-        CDenseVector<T> step(m_problem.GetNumberOfModelParameters());
-        m_solver.SetLambda(sqrt(m_lambda));
-        m_solver.Iterate(J,r,step);
+        m_nsolves++;
 
         // save old state before advancing
-        CDenseVector<T> xold = x.Clone();
+        copy(x.Data().get(),x.Data().get()+x.NElems(),xold.Data().get());
+
+        T* px = x.Data().get();
+        const T* pxold = xold.Data().get();
+        const T* pstep = step.Data().get();
+
+        // the update is the step or, with geodesic acceleration, its second-order correction
+        CDenseVector<T>& dir = m_geodesic ? total : step;
+        bool admissible = true;
+
+        if(m_geodesic) {
+
+            // second directional derivative of the residual along the step by finite differences
+            const T h = 0.1;
+
+            for(size_t i=0; i<nparams; i++)
+                px[i] = pxold[i] - h*pstep[i];
+
+            // only the residual is needed, weighted like r
+            ComputeResidual(rt);
+            m_nevals++;
+
+            J.Multiply(step,rvv);
+
+            T* prvv = rvv.Data().get();
+            const T* prt = rt.Data().get();
+            const T* pr = r.Data().get();
+            const T* pw = m_problem.GetWeights().Data().get();
+
+            for(size_t i=0; i<m; i++)
+                prvv[i] = (2/h)*((pw[i]*prt[i] - pr[i])/h + prvv[i]);
 
-        // tentative point, everything is allocated so changing pointer is ok
-        x = x - step;
+            // acceleration from the same damped normal equations
+            if(factored) {
 
-        // compute tentative residual and Jacobian
-        CDenseVector<T> rt(m_problem.GetNumberOfDataPoints());
-        Matrix Jt(m_problem.GetNumberOfDataPoints(),m_problem.GetNumberOfModelParameters());
-        m_problem.ComputeResidualAndJacobian(rt,Jt);
+                J.Transpose();
+                J.Multiply(rvv,acc);
+                J.Transpose();
+                CMatrixFactorization<T>::CholeskySolve(L.data(),acc.Data().get(),nparams);
 
-        // residual norm
-        res = rt.Norm2();
+            }
+            else {
+
+                acc.Zeros();
+                m_solver.Iterate(J,rvv,acc);
+
+            }
+
+            m_nsolves++;
+
+            // reject steps where the second-order term dominates
+            admissible = 2*acc.Norm2()<=m_alpha*step.Norm2();
+
+            T* ptotal = total.Data().get();
+            const T* pacc = acc.Data().get();
+
+            for(size_t i=0; i<nparams; i++)
+                ptotal[i] = pstep[i] + 0.5*pacc[i];
+
+        }
 
-		// compute rho
         T normstep, descent, dres, dlres, rho;
-		dres = m_residuals.back() - res;
+        normstep = sqrt(CDenseVector<T>::InnerProduct(dir,dir));
+        rho = -1;
 
-        normstep = sqrt(CDenseVector<T>::InnerProduct(step,step));
-        descent = -CDenseVector<T>::InnerProduct(step,grad);
+        if(admissible) {
 
-        dlres = 0.5*(normstep*normstep*m_lambda - descent);
-		rho = dres/dlres;
+            // tentative point
+            const T* pdir = dir.Data().get();
 
-		// check step size criterion (lambda going to infinity)
-		if(normstep<epsilon2*xold.Norm2())
-            break;
+            for(size_t i=0; i<nparams; i++)
+                px[i] = pxold[i] - pdir[i];
+
+            // compute tentative residual and Jacobian
+            ComputeResidualAndJacobian(rt,Jt);
+            m_nevals++;
+
+            // residual norm
+            res = rt.Norm2();
+
+            // compute rho
+            // actual and predicted decrease of 1/2||r||^2
+            dres = 0.5*(m_residuals.back()*m_residuals.back() - res*res);
+            descent = -CDenseVector<T>::InnerProduct(dir,grad);
+            dlres = 0.5*(normstep*normstep*m_lambda - descent);
+            rho = dres/dlres;
+
+            // check step size criterion (lambda going to infinity)
+            if(normstep<epsilon2*xold.Norm2())
+                break;
 
-		// update state if a descent direction is found
+        }
+
+        // update state if a descent direction is found
         if(rho>0) {
 
-			// it ok now to store the residual norm
-			m_residuals.push_back(res);
+            // it ok now to store the residual norm
+            m_residuals.push_back(res);
 
-            // keep Jacobian and residual, should be ok to move pointers
-            r = rt;
-            J = Jt;
+            // keep Jacobian and residual, the old ones become the next buffers
+            swap(r,rt);
+            swap(J,Jt);
+            rejected = false;
 
             // update gradient norm, this contains step size parameter (but maybe it should not?)
-            J.Transpose();
-            grad = J*r;
-            J.Transpose();
-			normgrad = grad.Norm2();
+            ComputeGradient(J,r,H,grad);
+            normgrad = grad.Norm2();
 
-			// push lambda towards Gauss-Newton step
-			nu = m_params[2];
+            // push lambda towards Gauss-Newton step
+            nu = m_params[2];
             T factor = max(m_params[3],1-(m_params[2]-1)*pow(2*rho-1,m_params[5]));
             m_lambda *= factor;
 
-			k++;
+            k++;
+            m_nsteps++;
 
-			// print out current state of optimization
-			if(!silent)
+            // print out current state of optimization
+            if(!silent)
                 cout << k << "\t" << res << "\t" << normgrad << "\t" << normstep << "\t" << m_lambda << endl;
 
-			// check convergence criteria
+            // check convergence criteria
             if(normgrad<epsilon1 || k==n)
-				break;
+                break;
 
         }
-		else {
+        else {
 
-			// push towards gradient descent
-			if(m_lambda>0)
-				m_lambda *= nu;
-			else
-				m_lambda = 1e-12;
+            // push towards gradient descent
+            if(m_lambda>0)
+                m_lambda *= nu;
+            else
+                m_lambda = 1e-12;
 
-			nu *= 2;
+            nu *= 2;
 
-			// restore state because step was unsuccessful
-            x = xold;
+            // restore state because step was unsuccessful
+            copy(xold.Data().get(),xold.Data().get()+xold.NElems(),x.Data().get());
+            rejected = true;
+            m_nrejected++;
 
             // show how lambda develops
             if(!silent)
@@ -270,9 +680,212 @@ CDenseVector<T> CLevenbergMarquardt<Matrix,T>::Iterate(size_t n, T epsilon1, T e
         if(std::isinf(m_lambda))
             break;
 
-	}
+    }
 
-	return r;
+    if(!silent)
+        PrintStatistics();
+
+    return r;
+
+}
+
+template <class Matrix,typename T>
+CDenseVector<T> CLevenbergMarquardt<Matrix,T>::IterateDogleg(size_t n, T epsilon1, T epsilon2, bool silent) {
+
+    CDenseVector<T>& x = m_problem.Get();
+    size_t m = m_problem.GetNumberOfDataPoints();
+    size_t nparams = m_problem.GetNumberOfModelParameters();
+
+    CDenseVector<T> r(m);
+    Matrix J(m,nparams);
+    ComputeResidualAndJacobian(r,J);
+    m_nevals++;
+
+    T res = r.Norm2();
+    m_residuals.push_back(res);
+
+    vector<T> H, L;
+
+    if(nparams<=m_ndense) {
+
+        H.resize(nparams*nparams);
+        L.resize(nparams*nparams);
+
+    }
+
+    CDenseVector<T> grad(nparams);
+    ComputeGradient(J,r,H,grad);
+    T normgrad = grad.Norm2();
+
+    // initial trust-region radius
+    T delta = m_tau*max(T(1),T(x.Norm2()));
+
+    // Gauss-Newton step, tentative step, buffers
+    CDenseVector<T> hgn(nparams);
+    CDenseVector<T> step(nparams);
+    CDenseVector<T> xold(nparams);
+    CDenseVector<T> rt(m);
+    CDenseVector<T> Jv(m);
+    Matrix Jt(m,nparams);
+
+    T alpha = 0;
+    T normgn = 0;
+    size_t k = 0;
+
+    // whether the Gauss-Newton and steepest descent steps need to be recomputed
+    bool linearized = true;
+
+    if(!silent) {
+
+        cout.setf(ios::scientific,ios::floatfield);
+
+        cout << "k\t f(x)\t ||grad f||\t ||h||\t Delta" << endl;
+        cout << k << "\t" << res << "\t" << normgrad << "\t" << 0.0000 << "\t" << delta << endl;
+
+    }
+
+    while(normgrad>=epsilon1 && k<n) {
+
+        if(linearized) {
+
+            // minimizer of the linear model along the gradient
+            J.Multiply(grad,Jv);
+            T normjg = Jv.Norm2();
+            alpha = normgrad*normgrad/(normjg*normjg);
+
+            // Gauss-Newton step, re-used as long as only the radius changes
+            if(!H.empty() && FactorizeNormalEquations(H,L,nparams,T(0))) {
+
+                copy(grad.Data().get(),grad.Data().get()+nparams,hgn.Data().get());
+                CMatrixFactorization<T>::CholeskySolve(L.data(),hgn.Data().get(),nparams);
+
+            }
+            else {
+
+                hgn.Zeros();
+                m_solver.SetLambda(0);
+                m_solver.Iterate(J,r,hgn);
+
+            }
+
+            m_nsolves++;
+            normgn = hgn.Norm2();
+            linearized = false;
+
+        }
+
+        // dogleg step within the trust region
+        T* pstep = step.Data().get();
+        const T* pgn = hgn.Data().get();
+        const T* pgrad = grad.Data().get();
+
+        if(normgn<=delta)
+            copy(pgn,pgn+nparams,pstep);
+        else if(alpha*normgrad>=delta) {
+
+            for(size_t i=0; i<nparams; i++)
+                pstep[i] = (delta/normgrad)*pgrad[i];
+
+        }
+        else {
+
+            // find beta such that ||a+beta*(b-a)||=delta for a=alpha*g, b=hgn
+            T a2 = 0, c = 0, d2 = 0;
+
+            for(size_t i=0; i<nparams; i++) {
+
+                T ai = alpha*pgrad[i];
+                T di = pgn[i] - ai;
+                a2 += ai*ai;
+                c += ai*di;
+                d2 += di*di;
+
+            }
+
+            T q = sqrt(c*c + d2*(delta*delta - a2));
+            T beta = c<=0 ? (q - c)/d2 : (delta*delta - a2)/(c + q);
+
+            for(size_t i=0; i<nparams; i++)
+                pstep[i] = alpha*pgrad[i] + beta*(pgn[i] - alpha*pgrad[i]);
+
+        }
+
+        T normstep = step.Norm2();
+
+        // stop if the trust region collapses
+        if(normstep<=epsilon2*(x.Norm2() + epsilon2))
+            break;
+
+        // decrease of 1/2||r||^2 predicted by the linear model
+        J.Multiply(step,Jv);
+        T normjh = Jv.Norm2();
+        T pred = CDenseVector<T>::InnerProduct(step,grad) - 0.5*normjh*normjh;
+
+        // tentative point
+        copy(x.Data().get(),x.Data().get()+nparams,xold.Data().get());
+
+        T* px = x.Data().get();
+
+        for(size_t i=0; i<nparams; i++)
+            px[i] -= pstep[i];
+
+        ComputeResidualAndJacobian(rt,Jt);
+        m_nevals++;
+
+        T rest = rt.Norm2();
+        T rho = 0.5*(res*res - rest*rest)/pred;
+
+        if(rho>0) {
+
+            m_residuals.push_back(rest);
+            res = rest;
+
+            swap(r,rt);
+            swap(J,Jt);
+
+            ComputeGradient(J,r,H,grad);
+            normgrad = grad.Norm2();
+            linearized = true;
+
+            k++;
+            m_nsteps++;
+
+        }
+        else {
+
+            copy(xold.Data().get(),xold.Data().get()+nparams,x.Data().get());
+            m_nrejected++;
+
+        }
+
+        // grow or shrink trust region depending on the quality of the linear model
+        if(rho>m_params[1])
+            delta = max(delta,3*normstep);
+        else if(rho<m_params[0])
+            delta *= 0.5;
+
+        if(!silent) {
+
+            if(rho>0)
+                cout << k << "\t" << res << "\t" << normgrad << "\t" << normstep << "\t" << delta << endl;
+            else
+                cout << "Adjusting radius to " << delta << "." << endl;
+
+        }
+
+    }
+
+    if(!silent)
+        PrintStatistics();
+
+    return r;
+
+}
+
+template <class Matrix,typename T>
+void CLevenbergMarquardt<Matrix,T>::PrintStatistics() const {
+
+    cout << "Accepted steps: " << m_nsteps << ", rejected steps: " << m_nrejected << ", linear solves: " << m_nsolves << ", evaluations: " << m_nevals << "." << endl;
 
 }
 
@@ -283,7 +896,7 @@ CDenseVector<T> CLevenbergMarquardt<Matrix,T>::Iterate(size_t nouter, const CWei
     CDenseVector<T>& weights = m_problem.GetWeights();
     CDenseVector<T> r(m_problem.GetNumberOfDataPoints());
 
-    m_problem.ComputeResidual(r);
+    ComputeResidual(r);
     T res = r.Norm2();
 	residuals.push_back(res);
 
@@ -304,7 +917,7 @@ CDenseVector<T> CLevenbergMarquardt<Matrix,T>::Iterate(size_t nouter, const CWei
 		Iterate(ninner,1e-10,1e-10,silentinner);
 
         // compute weight function from unweighted (!) residual vector residual
-		m_problem.ComputeResidual(r);
+        ComputeResidual(r);
 
         // update weights used in inner iteration
         sinv = w(r,weights);
@@ -334,6 +947,20 @@ CDenseVector<T> CLevenbergMarquardt<Matrix,T>::Iterate(size_t nouter, const CWei
 
 }
 
+template <class Matrix,typename T>
+double CLevenbergMarquardt<Matrix,T>::EstimateConditionNumber(size_t n) const {
+
+    CDenseVector<T> r(m_problem.GetNumberOfDataPoints());
+    Matrix J(m_problem.GetNumberOfDataPoints(),m_problem.GetNumberOfModelParameters());
+    ComputeResidualAndJacobian(r,J);
+
+    // the linear solver sees the damping as regularization weight sqrt(lambda)
+    CSpectrumEstimator<Matrix,T> estimator(n,true,sqrt(m_lambda));
+
+    return estimator.ConditionNumber(J);
+
+}
+
 template <class Matrix,typename T>
 CDenseVector<T> CLevenbergMarquardt<Matrix,T>::BiSquareWeightFunction(const CDenseVector<T>& r, CDenseVector<T>& w) const {
 
@@ -383,16 +1010,20 @@ template class CLevenbergMarquardt<mat,double>;
 template class CLevenbergMarquardt<smat,double>;
 template class CLevenbergMarquardt<smatf,float>;
 template class CLevenbergMarquardt<CCSRMatrix<float>,float>;
+template class CLevenbergMarquardt<CCSRMatrix<double>,double>;
+template class CLevenbergMarquardt<CLinearOperator<double>,double>;
+template class CLevenbergMarquardt<CLinearOperator<float>,float>;
 
 template<class Matrix,typename T>
-CSplitBregman<Matrix,T>::CSplitBregman(const Matrix& A, const Matrix& nabla, const CDenseArray<T>& f, CDenseArray<T>& u, const DIM& dim, const CIterativeLinearSolver<Matrix,T>& solver, T mu, T lambda, double eps):
-    m_K(A.Clone()),
+CSplitBregman<Matrix,T>::CSplitBregman(const Matrix& A, const Matrix& nabla, const CDenseArray<T>& f, CDenseArray<T>& u, const DIM& dim, const CIterativeLinearSolver<CLinearOperator<T>,T>& solver, T mu, T lambda, double eps):
+    m_K(shared_ptr<const CAbstractLinearOperator<T> >(new CStackedOperator<Matrix,T>(A,nabla,mu,-lambda))),
     m_nabla(nabla),
     m_f(f),
     m_u(u),
     m_nablau(),
     m_b(nabla.NRows(),f.NCols()),
     m_d(nabla.NRows(),f.NCols()),
+    m_rhs(),
     m_dim_grad(dim),
     m_solver(solver),
     m_mu(mu),
@@ -404,14 +1035,15 @@ CSplitBregman<Matrix,T>::CSplitBregman(const Matrix& A, const Matrix& nabla, con
 
     assert(lambda>0);
 
-    // scale
-    m_K.Scale(-mu/lambda);
+    // right-hand side of the u-subproblem, its upper part is constant
+    m_rhs = CDenseArray<T>(m_K.NRows(),f.NCols());
 
-    // stack on top of m_Phi
-    m_K.Concatenate(nabla,0);
+    for(size_t i=0; i<f.NRows(); i++) {
 
-    // scale again
-    m_K.Scale(-lambda);
+        for(size_t j=0; j<f.NCols(); j++)
+            m_rhs.Set(i,j,f.Get(i,j)*mu);
+
+    }
 
     // nabla u and b
     m_nablau = m_nabla*m_u;
@@ -427,25 +1059,23 @@ void CSplitBregman<Matrix,T>::Iterate(size_t n) {
     // main loop
     do {
 
-        // create rhs
-        CDenseArray<T> rhs(m_K.NRows(),m_f.NCols());
-
-        // fill in m_f and b
-        for(size_t i=0; i<m_K.NRows(); i++) {
+        // fill in b-d below the (constant) data term
+        size_t nd = m_d.NRows();
 
-            for(size_t j=0; j<m_f.NCols(); j++) {
+        for(size_t j=0; j<m_f.NCols(); j++) {
 
-                if(i<m_f.NRows())
-                    rhs.Set(i,j,m_f.Get(i,j)*m_mu);
-                else
-                    rhs.Set(i,j,(m_b.Get(i-m_f.NRows(),j)-m_d.Get(i-m_f.NRows(),j))*m_lambda);
+            T* prhs = m_rhs.Data().get() + j*m_rhs.NRows() + m_f.NRows();
+            const T* pb = m_b.Data().get() + j*nd;
+            const T* pd = m_d.Data().get() + j*nd;
 
-            }
+            #pragma omp parallel for
+            for(size_t i=0; i<nd; i++)
+                prhs[i] = (pb[i] - pd[i])*m_lambda;
 
         }
 
         // get half residual of data term and constraint violation from linear solver
-        vector<double> rt = m_solver.Iterate(m_K,rhs,m_u);
+        vector<double> rt = m_solver.Iterate(m_K,m_rhs,m_u);
 
         // if k=0, we need compute the initial residual
         if(m_k==0) {
@@ -461,21 +1091,12 @@ void CSplitBregman<Matrix,T>::Iterate(size_t n) {
         }
 
         // update gradient
-        m_nablau = m_nabla*m_u;
-
-        // shrinkage
-        m_d = m_b + m_nablau;
-        //m_d.Shrink(1/m_lambda);
-        this->Shrink();
+        m_nabla.Multiply(m_u,m_nablau);
 
-        // constraint violation
-        CDenseArray<T> rphi = m_nablau - m_d;
+        // shrinkage, Bregman update, and constraint violation
+        double normrphi = this->Shrink();
 
-        // Bregman update
-        m_b = m_b + rphi;
-
-        // compute constraint violation
-        m_constraint_violation.push_back(rphi.Norm2());
+        m_constraint_violation.push_back(sqrt(normrphi));
 
         // total error
         double rtotal = rt.back()*rt.back(); //mu|Au-f|^2+\lambda\|nabla u-d\|^2
@@ -494,7 +1115,16 @@ void CSplitBregman<Matrix,T>::Iterate(size_t n) {
 }
 
 template<class Matrix,typename T>
-void CSplitBregman<Matrix,T>::Shrink() {
+double CSplitBregman<Matrix,T>::EstimateConditionNumber(size_t n) const {
+
+    CSpectrumEstimator<CLinearOperator<T>,T> estimator(n,true);
+
+    return estimator.ConditionNumber(m_K);
+
+}
+
+template<class Matrix,typename T>
+double CSplitBregman<Matrix,T>::Shrink() {
 
     u_int dim = u_int(m_dim_grad);
 
@@ -503,34 +1133,50 @@ void CSplitBregman<Matrix,T>::Shrink() {
     size_t npts = m_d.NRows()/dim;
 
     T li = 1/m_lambda;
+    double normrphi = 0;
 
     for(size_t j=0; j<m_d.NCols(); j++) {
 
+        T* pd = m_d.Data().get() + j*m_d.NRows();
+        T* pb = m_b.Data().get() + j*m_d.NRows();
+        const T* pnablau = m_nablau.Data().get() + j*m_d.NRows();
+
+        // the components of a gradient are npts apart, each point is independent
+        #pragma omp parallel for reduction(+:normrphi)
         for(size_t i=0; i<npts; i++) {
 
             T norm = 0;
 
-            for(u_int k=0; k<dim; k++)
-                norm += m_d.Get(i+k*npts,j)*m_d.Get(i+k*npts,j);
+            for(u_int k=0; k<dim; k++) {
+
+                T dk = pnablau[i+k*npts] + pb[i+k*npts];
+                norm += dk*dk;
+
+            }
 
             norm = sqrt(norm);
 
-            T factor;
-            if(norm<=li)
-                factor = 0;
-            else
-                factor = (norm - li)/norm;
+            T factor = norm<=li ? 0 : (norm - li)/norm;
+
+            for(u_int k=0; k<dim; k++) {
 
-            for(u_int k=0; k<dim; k++)
-                m_d(i+k*npts,j) *= factor;
+                size_t l = i + k*npts;
+                T dk = factor*(pnablau[l] + pb[l]);
+                T rphi = pnablau[l] - dk;
+
+                pd[l] = dk;
+                pb[l] += rphi;
+                normrphi += rphi*rphi;
+
+            }
 
         }
 
     }
 
-}
-
+    return normrphi;
 
+}
 
 template class CSplitBregman<smatf,float>;
 template class CSplitBregman<CCSRMatrix<float,size_t>,float>;
@@ -34,7 +34,11 @@ namespace R4R {
 
 /*! \brief interface for least-squares problems
  *
- *
+ * The Jacobian is of type Matrix, which can be an assembled matrix or, for problems too
+ * large to materialize it, a CLinearOperator. In the latter case, ComputeResidualAndJacobian()
+ * attaches an operator to \f$J\f$ which evaluates Jacobian-vector products \f$Jv\f$ and
+ * \f$J^{\top}v\f$. Such an operator should capture the linearization point because the
+ * Levenberg-Marquardt method keeps it while testing a tentative step.
  *
  */
 template<class Matrix,typename T>
@@ -53,12 +57,50 @@ public:
 	 */
 	CLeastSquaresProblem(size_t nopts, size_t noparams);
 
-    //! \brief Jointly computes the weighted (!) residual vector and Jacobian of the least-squares objective function.
+    /*! \brief Jointly computes the weighted (!) residual vector and Jacobian of the least-squares objective function.
+     *
+     * Row \f$i\f$ of \f$r\f$ and \f$J\f$ is the corresponding row of the unweighted residual and its
+     * Jacobian multiplied by the weight \f$w_i\f$ from GetWeights().
+     *
+     */
     virtual void ComputeResidualAndJacobian(CDenseVector<T>& r, Matrix& J) const = 0;
 
-    //! Computes the unwieghted (!) residual vector of the least-squares objective function.
+    /*! \brief Computes the unweighted (!) residual vector of the least-squares objective function.
+     *
+     * The result must have the same sign convention as ComputeResidualAndJacobian(), i.e., its
+     * entries multiplied by the weights \f$w_i\f$ are the weighted residuals. Geodesic acceleration
+     * and the robust outer iteration rely on this.
+     *
+     */
     virtual void ComputeResidual(CDenseVector<T>& r) const = 0;
 
+    /*! \brief Computes the rows \f$[b,e)\f$ of the weighted residual vector and the Jacobian.
+     *
+     * Override this in problems whose residuals can be evaluated independently of each other.
+     * CLevenbergMarquardt then calls it concurrently for disjoint row ranges, so an implementation
+     * must only write into the given rows of \f$r\f$ and \f$J\f$. A sparse Jacobian comes with
+     * its structure allocated by PrepareJacobian(). An empty range is used to query whether
+     * row ranges are supported at all.
+     *
+     * \returns false if row ranges are not supported, which is the default
+     *
+     */
+    virtual bool ComputeResidualAndJacobian(size_t /*begin*/, size_t /*end*/, CDenseVector<T>& /*r*/, Matrix& /*J*/) const { return false; }
+
+    //! Computes the rows \f$[b,e)\f$ of the unweighted residual vector with the sign convention of ComputeResidual(CDenseVector<T>&).
+    virtual bool ComputeResidual(size_t /*begin*/, size_t /*end*/, CDenseVector<T>& /*r*/) const { return false; }
+
+    //! Number of non-zero entries in a row of a sparse Jacobian.
+    virtual size_t GetJacobianRowLength(size_t /*i*/) const { return m_noparams; }
+
+    /*! \brief Allocates the structure of a Jacobian for evaluation by row ranges.
+     *
+     * For a CCSRMatrix, the row pointer is set up according to GetJacobianRowLength() and storage
+     * for column indices and values is allocated. Dense Jacobians are left untouched.
+     *
+     */
+    void PrepareJacobian(Matrix& J) const;
+
 	//! Access to the model parameters.
     CDenseVector<T>& Get() { return m_model; }
 
@@ -71,6 +113,18 @@ public:
 	//! Access to #m_noparams.
     size_t GetNumberOfModelParameters() const { return m_noparams; }
 
+    /*! \brief Declares a partition of the model parameters for CSchurComplementSolver.
+     *
+     * \param[out] nblocks number of leading parameter blocks which can be eliminated, i.e., every
+     * residual depends on at most one of them and the corresponding part of the normal equation
+     * is block-diagonal
+     * \param[out] blocksize number of parameters per block
+     *
+     * The default declares no such structure.
+     *
+     */
+    virtual void GetBlockPartition(size_t& nblocks, size_t& blocksize) const { nblocks = 0; blocksize = 1; }
+
     /*! \brief Computes scattering of residuals to normalize them for re-weighting and/or outlier detection.
      *
      * \details This function computes the inverse of a robust estimate of the variance of residuals, which are
@@ -119,7 +173,20 @@ public:
 
 };
 
+//! Globalization strategies of CLevenbergMarquardt.
+enum class LMSTRATEGY { DAMPING, DOGLEG };
+
 /*! \brief Levenberg-Marquardt algorithm to solve nonlinear least-squares problems
+ *
+ * If the number of model parameters does not exceed a threshold, cf. SetDenseThreshold(), the
+ * damped normal equations are assembled explicitly and solved by Cholesky decomposition. The
+ * iterative linear solver is then only used as a fallback.
+ *
+ * Besides the damping update of [Nielsen1999], Powell's dogleg method is available, cf.
+ * SetStrategy(). It needs only one Gauss-Newton step per linearization, no matter how often
+ * the trust region shrinks. The damped method optionally corrects each step by geodesic
+ * acceleration [Transtrum2012], cf. SetGeodesicAcceleration(), which costs one more residual
+ * evaluation and linear solve per step.
  *
  */
 template<class Matrix,typename T>
@@ -144,6 +211,43 @@ public:
 	//! Starts robust re-weighted Levenberg-Marquardt algorithm.
     CDenseVector<T> Iterate(size_t nouter,  const CWeightFunction<T>& w, size_t ninner, T epsilon, bool silentinner, bool silentouter);
 
+    /*! \brief Estimates the condition number of the damped normal equation at the current model.
+     *
+     * \param[in] n number of Lanczos steps
+     *
+     * Useful to diagnose slow convergence of the inner linear solver, see CSpectrumEstimator.
+     *
+     */
+    double EstimateConditionNumber(size_t n = 20) const;
+
+    //! Sets the maximum number of model parameters for which the normal equations are solved directly.
+    void SetDenseThreshold(size_t n) { m_ndense = n; }
+
+    //! Selects the globalization strategy.
+    void SetStrategy(LMSTRATEGY strategy) { m_strategy = strategy; }
+
+    /*! \brief Enables geodesic acceleration in the damped method.
+     *
+     * \param[in] alpha maximum ratio \f$2\frac{\|a\|}{\|v\|}\f$ of acceleration and velocity, larger steps are rejected
+     *
+     */
+    void SetGeodesicAcceleration(bool on, T alpha = 0.75) { m_geodesic = on; m_alpha = alpha; }
+
+    //! Access to the residual norms of all accepted steps.
+    const std::vector<T>& GetResiduals() const { return m_residuals; }
+
+    //! Number of accepted steps in the last call of Iterate().
+    size_t GetNumberOfSteps() const { return m_nsteps; }
+
+    //! Number of rejected steps in the last call of Iterate().
+    size_t GetNumberOfRejectedSteps() const { return m_nrejected; }
+
+    //! Number of linear solves in the last call of Iterate().
+    size_t GetNumberOfLinearSolves() const { return m_nsolves; }
+
+    //! Number of evaluations of residual and Jacobian in the last call of Iterate().
+    size_t GetNumberOfEvaluations() const { return m_nevals; }
+
 protected:
 
     CLeastSquaresProblem<Matrix,T>& m_problem;						//!< least-squares problem
@@ -151,7 +255,28 @@ protected:
     T m_tau;        												//!< initial damping parameter weight
     T m_lambda;             										//!< damping parameter
     std::vector<T> m_residuals;     								//!< residuals
-    static const T m_params[5];                                     //!< parameters \f$\rho_1,\rho_2,\beta,\frac{1}{\gamma},\tau,p\f$, cf. [Nielsen1999]
+    static const T m_params[6];                                     //!< parameters \f$\rho_1,\rho_2,\beta,\frac{1}{\gamma},\tau,p\f$, cf. [Nielsen1999]
+    static const size_t m_chunk;                                    //!< number of rows evaluated by one task
+    size_t m_ndense;                                                //!< maximum number of parameters for direct solution
+    LMSTRATEGY m_strategy;                                          //!< globalization strategy
+    bool m_geodesic;                                                //!< flag for geodesic acceleration
+    T m_alpha;                                                      //!< maximum ratio of acceleration and velocity
+    size_t m_nsteps;                                                //!< number of accepted steps
+    size_t m_nrejected;                                             //!< number of rejected steps
+    size_t m_nsolves;                                               //!< number of linear solves
+    size_t m_nevals;                                                //!< number of evaluations of residual and Jacobian
+
+    //! Powell's dogleg method, cf. Iterate(size_t,T,T,bool).
+    CDenseVector<T> IterateDogleg(size_t n, T epsilon1, T epsilon2, bool silent);
+
+    //! Prints statistics of the last run.
+    void PrintStatistics() const;
+
+    //! Evaluates residual and Jacobian, concurrently over row ranges if the problem supports it.
+    void ComputeResidualAndJacobian(CDenseVector<T>& r, Matrix& J) const;
+
+    //! Evaluates the unweighted residual, concurrently over row ranges if the problem supports it.
+    void ComputeResidual(CDenseVector<T>& r) const;
 
 	//! Computes weights based on bi-square function.
     CDenseVector<T> BiSquareWeightFunction(const CDenseVector<T>& r, CDenseVector<T>& w) const;
@@ -162,6 +287,9 @@ protected:
 };
 
 /*! \brief Split Bregman method
+ *
+ * The system matrix \f$(\mu A;-\lambda\nabla)\f$ of the \f$u\f$-subproblem is never assembled
+ * but represented by a CStackedOperator, so the linear solver operates on a CLinearOperator.
  *
  */
 template<class Matrix,typename T>
@@ -170,7 +298,7 @@ class CSplitBregman {
 public:
 
     //! Constructor.
-    CSplitBregman(const Matrix& A, const Matrix& nabla, const CDenseArray<T>& f, CDenseArray<T>& u, const DIM& dim, const CIterativeLinearSolver<Matrix,T>& solver, T mu, T lambda, double eps);
+    CSplitBregman(const Matrix& A, const Matrix& nabla, const CDenseArray<T>& f, CDenseArray<T>& u, const DIM& dim, const CIterativeLinearSolver<CLinearOperator<T>,T>& solver, T mu, T lambda, double eps);
 
     //! Deleted standard constructor.
     CSplitBregman() = delete;
@@ -188,17 +316,21 @@ public:
     //! Access to constraint violation.
     std::vector<double>& GetConstraintViolation() { return m_constraint_violation; }
 
+    //! Estimates the condition number of the normal equation of the \f$u\f$-subproblem, see CSpectrumEstimator.
+    double EstimateConditionNumber(size_t n = 20) const;
+
 private:
 
-    Matrix m_K;                                             //!< stack of two linear operators
+    CLinearOperator<T> m_K;                                 //!< stack of two linear operators
     const Matrix& m_nabla;                                  //!< gradient operator
     const CDenseArray<T>& m_f;                              //!< force vector
     CDenseArray<T>& m_u;                                    //!< solution vector
     CDenseArray<T> m_nablau;
     CDenseArray<T> m_d;
     CDenseArray<T> m_b;
+    CDenseArray<T> m_rhs;                                   //!< right-hand side of the \f$u\f$-subproblem
     DIM m_dim_grad;                                         //!< dimensionality of the gradient
-    const CIterativeLinearSolver<Matrix,T>& m_solver;       //!< linear solver
+    const CIterativeLinearSolver<CLinearOperator<T>,T>& m_solver;   //!< linear solver
     T m_mu;                                                 //!< \f$\mu\f$
     T m_lambda;                                             //!< \f$\lambda\f$
     double m_eps;                                           //!< tolerance
@@ -206,8 +338,14 @@ private:
     std::vector<double> m_total_error;                      //!< total error over time
     std::vector<double> m_constraint_violation;             //!< constraint violation over time
 
-    //! Dimensionality-specific shrinking operator.
-    void Shrink();
+    /*! \brief Dimensionality-specific shrinking operator, fused with the Bregman update.
+     *
+     * Computes \f$d=\mathrm{shrink}(\nabla u+b,\frac{1}{\lambda})\f$ and \f$b=b+\nabla u-d\f$.
+     *
+     * \returns squared constraint violation \f$\|\nabla u-d\|^2\f$
+     *
+     */
+    double Shrink();
 
 };
 
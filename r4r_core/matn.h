@@ -0,0 +1,264 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef R4RMATN_H
+#define R4RMATN_H
+
+#include <math.h>
+
+#include "vecn.h"
+
+namespace R4R {
+
+/*! \brief small matrices of size \f$m\times n\f$
+ *
+ * Entries are stored in column-major order like in CDenseArray, which also applies to the
+ * initializer list constructor. All operations are inline such that loops over the
+ * compile-time dimensions are unrolled.
+ *
+ */
+template<typename T,u_int m,u_int n>
+class CMatrix {
+
+private:
+
+    T m_data[m*n];
+
+public:
+
+    //! Constructor.
+    CMatrix() { std::fill_n(m_data,m*n,T(0)); }
+
+    //! Constructor.
+    CMatrix(T val) { std::fill_n(m_data,m*n,val); }
+
+    //! Initializer list constructor, column-major.
+    CMatrix(std::initializer_list<T> list) {
+
+        std::fill_n(m_data,m*n,T(0));
+        std::copy(list.begin(),list.begin()+std::min<size_t>(m*n,list.size()),m_data);
+
+    }
+
+    //! Number of rows.
+    static u_int NRows() { return m; }
+
+    //! Number of columns.
+    static u_int NCols() { return n; }
+
+    //! Read-write element access.
+    T& operator()(u_int i, u_int j) { assert(i<m && j<n); return m_data[j*m+i]; }
+
+    //! Read element access.
+    T Get(u_int i, u_int j) const { assert(i<m && j<n); return m_data[j*m+i]; }
+
+    //! Low-level access to the data.
+    const T* Data() const { return m_data; }
+
+    //! Low-level access to the data.
+    T* Data() { return m_data; }
+
+    //! Sets the matrix to the identity.
+    void Eye() {
+
+        std::fill_n(m_data,m*n,T(0));
+
+        for(u_int i=0; i<std::min(m,n); i++)
+            m_data[i*m+i] = 1;
+
+    }
+
+    //! Transposes the matrix.
+    CMatrix<T,n,m> Transpose() const {
+
+        CMatrix<T,n,m> result;
+
+        for(u_int j=0; j<n; j++) {
+
+            for(u_int i=0; i<m; i++)
+                result(j,i) = Get(i,j);
+
+        }
+
+        return result;
+
+    }
+
+    //! In-place addition.
+    void operator+=(const CMatrix<T,m,n>& x) { for(u_int i=0; i<m*n; i++) m_data[i] += x.m_data[i]; }
+
+    //! In-place subtraction.
+    void operator-=(const CMatrix<T,m,n>& x) { for(u_int i=0; i<m*n; i++) m_data[i] -= x.m_data[i]; }
+
+    //! Adds two matrices.
+    friend CMatrix<T,m,n> operator+(const CMatrix<T,m,n>& x, const CMatrix<T,m,n>& y) {
+
+        CMatrix<T,m,n> result(x);
+        result += y;
+
+        return result;
+
+    }
+
+    //! Subtracts two matrices.
+    friend CMatrix<T,m,n> operator-(const CMatrix<T,m,n>& x, const CMatrix<T,m,n>& y) {
+
+        CMatrix<T,m,n> result(x);
+        result -= y;
+
+        return result;
+
+    }
+
+    //! Multiplies two matrices.
+    template<u_int k>
+    friend CMatrix<T,m,k> operator*(const CMatrix<T,m,n>& x, const CMatrix<T,n,k>& y) {
+
+        CMatrix<T,m,k> result;
+
+        for(u_int j=0; j<k; j++) {
+
+            for(u_int l=0; l<n; l++) {
+
+                T ylj = y.Get(l,j);
+
+                for(u_int i=0; i<m; i++)
+                    result(i,j) += x.Get(i,l)*ylj;
+
+            }
+
+        }
+
+        return result;
+
+    }
+
+    //! Multiplies a matrix and a vector.
+    friend CVector<T,m> operator*(const CMatrix<T,m,n>& x, const CVector<T,n>& y) {
+
+        CVector<T,m> result;
+
+        for(u_int l=0; l<n; l++) {
+
+            for(u_int i=0; i<m; i++)
+                result(i) += x.Get(i,l)*y.Get(l);
+
+        }
+
+        return result;
+
+    }
+
+    //! Post-multiplies a matrix by a scalar.
+    friend CMatrix<T,m,n> operator*(const CMatrix<T,m,n>& x, const T& s) {
+
+        CMatrix<T,m,n> result;
+
+        for(u_int i=0; i<m*n; i++)
+            result.m_data[i] = x.m_data[i]*s;
+
+        return result;
+
+    }
+
+    /*! \brief Cholesky decomposition of a symmetric positive-definite matrix.
+     *
+     * \param[out] L lower-triangular factor with \f$LL^{\top}\f$ equal to the matrix
+     * \returns false if the matrix is not positive definite
+     *
+     */
+    bool Cholesky(CMatrix<T,m,m>& L) const {
+
+        L = CMatrix<T,m,m>();
+
+        for(u_int j=0; j<m; j++) {
+
+            T d = Get(j,j);
+
+            for(u_int l=0; l<j; l++)
+                d -= L.Get(j,l)*L.Get(j,l);
+
+            if(!(d>0))
+                return false;
+
+            L(j,j) = sqrt(d);
+
+            for(u_int i=j+1; i<m; i++) {
+
+                T s = Get(i,j);
+
+                for(u_int l=0; l<j; l++)
+                    s -= L.Get(i,l)*L.Get(j,l);
+
+                L(i,j) = s/L.Get(j,j);
+
+            }
+
+        }
+
+        return true;
+
+    }
+
+    /*! \brief Solves \f$LL^{\top}X=B\f$ in place for a Cholesky factor \f$L\f$.
+     *
+     * \param[in] L lower-triangular factor, see Cholesky()
+     * \param[in,out] B right-hand sides on input, solution on output
+     *
+     */
+    template<u_int k>
+    static void CholeskySolve(const CMatrix<T,m,m>& L, CMatrix<T,m,k>& B) {
+
+        for(u_int j=0; j<k; j++) {
+
+            for(u_int i=0; i<m; i++) {
+
+                T s = B.Get(i,j);
+
+                for(u_int l=0; l<i; l++)
+                    s -= L.Get(i,l)*B.Get(l,j);
+
+                B(i,j) = s/L.Get(i,i);
+
+            }
+
+            for(u_int i=m; i-->0; ) {
+
+                T s = B.Get(i,j);
+
+                for(u_int l=i+1; l<m; l++)
+                    s -= L.Get(l,i)*B.Get(l,j);
+
+                B(i,j) = s/L.Get(i,i);
+
+            }
+
+        }
+
+    }
+
+};
+
+}
+
+#endif // R4RMATN_H
@@ -28,6 +28,10 @@
 #include <assert.h>
 #include <math.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using namespace std;
 
 namespace R4R {
@@ -236,6 +240,328 @@ template ostream& operator<< (ostream& os, CPegasos<vec>& x);
 template ostream& operator<< (ostream& os, CPegasos<mat>& x);
 //template ostream& operator<< (ostream& os, CPegasos<smat>& x);
 
+/*! \brief Inner product of two arrays.
+ *
+ * Independent partial sums break the dependency chain of the accumulation. Opposed to
+ * CMercerKernel, no alignment is required.
+ *
+ */
+template<typename T>
+static double Dot(const T* x, const T* y, size_t n) {
+
+    T sum[4] = { 0, 0, 0, 0 };
+    size_t offset = n - n%4;
+
+    for(size_t i=0; i<offset; i+=4) {
+
+        sum[0] += x[i]*y[i];
+        sum[1] += x[i+1]*y[i+1];
+        sum[2] += x[i+2]*y[i+2];
+        sum[3] += x[i+3]*y[i+3];
+
+    }
+
+    for(size_t i=offset; i<n; i++)
+        sum[0] += x[i]*y[i];
+
+    return double(sum[0] + sum[1] + sum[2] + sum[3]);
+
+}
+
+#ifdef __SSE4_1__
+template<>
+double Dot(const float* x, const float* y, size_t n) {
+
+    __m128 sum0 = _mm_setzero_ps();
+    __m128 sum1 = _mm_setzero_ps();
+    size_t offset = n - n%8;
+
+    for(size_t i=0; i<offset; i+=8) {
+
+        sum0 = _mm_add_ps(sum0,_mm_mul_ps(_mm_loadu_ps(x+i),_mm_loadu_ps(y+i)));
+        sum1 = _mm_add_ps(sum1,_mm_mul_ps(_mm_loadu_ps(x+i+4),_mm_loadu_ps(y+i+4)));
+
+    }
+
+    float result[4];
+    _mm_storeu_ps(result,_mm_add_ps(sum0,sum1));
+
+    for(size_t i=offset; i<n; i++)
+        result[0] += x[i]*y[i];
+
+    return double(result[0] + result[1] + result[2] + result[3]);
+
+}
+#endif
+
+static int NumberOfThreads() {
+
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+
+}
+
+static int ThreadNumber() {
+
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+
+}
+
+template<typename T>
+CParallelPegasos<T>::CParallelPegasos(const CDenseArray<T>& features, const vector<int>& labels, double lambda, size_t k, unsigned int seed):
+    m_features(features),
+    m_labels(labels),
+    m_lambda(lambda),
+    m_k(k),
+    m_asynchronous(false),
+    m_ncheck(0),
+    m_i(0),
+    m_w(features.NRows()),
+    m_b(0),
+    m_res(),
+    m_rngs(),
+    m_grads(features.NRows(),NumberOfThreads()) {
+
+    if(labels.size()!=features.NCols())
+        cerr << "ERROR: Number of labels and features do not agree." << endl;
+
+    for(int t=0; t<NumberOfThreads(); t++)
+        m_rngs.push_back(mt19937(seed + 7919*t));
+
+    m_res.push_back(CalcResidual());
+
+}
+
+template<typename T>
+double CParallelPegasos<T>::CalcResidual() const {
+
+    size_t d = m_features.NRows();
+    size_t n = m_features.NCols();
+    const T* pw = m_w.Data().get();
+    const T* px = m_features.Data().get();
+
+    double loss = 0;
+
+    #pragma omp parallel for reduction(+:loss)
+    for(size_t i=0; i<n; i++)
+        loss += max<double>(0,1.0 - m_labels[i]*(Dot(pw,px+i*d,d) + m_b));
+
+    return 0.5*m_lambda*(Dot(pw,pw,d) + m_b*m_b) + loss/double(n);
+
+}
+
+template<typename T>
+double CParallelPegasos<T>::Classify(const T* x) const {
+
+    return Dot(m_w.Data().get(),x,m_w.NRows()) + m_b;
+
+}
+
+template<typename T>
+double CParallelPegasos<T>::Subgradient(const T* w, double b, size_t k, mt19937& rng, T* g) const {
+
+    size_t d = m_features.NRows();
+    const T* px = m_features.Data().get();
+
+    uniform_int_distribution<size_t> dist(0,m_features.NCols()-1);
+
+    double gb = 0;
+
+    for(size_t s=0; s<k; s++) {
+
+        size_t i = dist(rng);
+        const T* x = px + i*d;
+        int y = m_labels[i];
+
+        if(y*(Dot(w,x,d) + b)<1) {
+
+            for(size_t j=0; j<d; j++)
+                g[j] += y*x[j];
+
+            gb += y;
+
+        }
+
+    }
+
+    return gb;
+
+}
+
+template<typename T>
+void CParallelPegasos<T>::Step(T* w, double& b, const T* g, double gb, double eta) const {
+
+    size_t d = m_features.NRows();
+    T scale = T(1.0 - eta*m_lambda);
+    T c = T(eta/double(m_k));
+
+    for(size_t j=0; j<d; j++)
+        w[j] = scale*w[j] + c*g[j];
+
+    b = scale*b + c*gb;
+
+    // projection onto the ball of radius 1/sqrt(lambda)
+    double s = min<double>(1.0,1.0/(sqrt(Dot(w,w,d) + b*b)*sqrt(m_lambda)));
+
+    for(size_t j=0; j<d; j++)
+        w[j] *= T(s);
+
+    b *= s;
+
+}
+
+template<typename T>
+void CParallelPegasos<T>::TrainSynchronous(size_t n, bool silent) {
+
+    size_t d = m_features.NRows();
+    T* pw = m_w.Data().get();
+    T* pg = m_grads.Data().get();
+
+    for(size_t step=0; step<n; step++) {
+
+        m_i++;
+
+        double gb = 0;
+        int nthreads = 1;
+
+        /* the mini-batch is split evenly among threads, small batches are not worth it, there
+         * are no more threads than generators even if the default changed since construction */
+        #pragma omp parallel reduction(+:gb) if(m_k>=64) num_threads(int(m_rngs.size()))
+        {
+
+            int t = ThreadNumber();
+
+#ifdef _OPENMP
+            #pragma omp single
+            nthreads = omp_get_num_threads();
+#endif
+
+            T* g = pg + t*d;
+            fill_n(g,d,T(0));
+
+            size_t kt = m_k/nthreads + (size_t(t)<m_k%nthreads);
+
+            gb += Subgradient(pw,m_b,kt,m_rngs[t],g);
+
+        }
+
+        for(int t=1; t<nthreads; t++) {
+
+            for(size_t j=0; j<d; j++)
+                pg[j] += pg[t*d+j];
+
+        }
+
+        Step(pw,m_b,pg,gb,1.0/(m_lambda*m_i));
+
+        if(m_ncheck>0 && m_i%m_ncheck==0) {
+
+            m_res.push_back(CalcResidual());
+
+            if(!silent)
+                cout << m_i << "\t\t" << m_res.back() << endl;
+
+        }
+
+    }
+
+}
+
+template<typename T>
+void CParallelPegasos<T>::TrainAsynchronous(size_t n) {
+
+    size_t d = m_features.NRows();
+    T* pw = m_w.Data().get();
+    T* pg = m_grads.Data().get();
+    size_t end = m_i + n;
+    size_t next = m_i;
+
+    #pragma omp parallel num_threads(int(m_rngs.size()))
+    {
+
+        int t = ThreadNumber();
+        T* g = pg + t*d;
+
+        while(true) {
+
+            size_t i;
+
+            #pragma omp atomic capture
+            i = ++next;
+
+            if(i>end)
+                break;
+
+            fill_n(g,d,T(0));
+
+            // reads and writes of the shared normal are deliberately not synchronized
+            double gb = Subgradient(pw,m_b,m_k,m_rngs[t],g);
+            Step(pw,m_b,g,gb,1.0/(m_lambda*i));
+
+        }
+
+    }
+
+    m_i = end;
+
+}
+
+template<typename T>
+void CParallelPegasos<T>::Train(size_t n, bool silent) {
+
+    if(!silent)
+        cout << m_i << "\t\t" << m_res.back() << endl;
+
+    if(m_asynchronous) {
+
+        TrainAsynchronous(n);
+
+        if(m_ncheck>0) {
+
+            m_res.push_back(CalcResidual());
+
+            if(!silent)
+                cout << m_i << "\t\t" << m_res.back() << endl;
+
+        }
+
+    }
+    else
+        TrainSynchronous(n,silent);
+
+}
+
+template<typename T>
+bool CParallelPegasos<T>::SaveResidual(const char* filename) {
+
+    ofstream out(filename);
+
+    if(!out) {
+
+        cout << "ERROR: Could not open file.\n";
+        return 1;
+
+    }
+
+    for(size_t k=0;k<m_res.size();k++)
+        out << (int)k << " " << m_res[k] << endl;
+
+    out.close();
+
+    return 0;
+
+}
+
+template class CParallelPegasos<float>;
+template class CParallelPegasos<double>;
+
 template <class Vector>
 CPegasosMI<Vector>::CPegasosMI(vector<Vector>* features, vector<int>* labels, vector<int>* bags, Vector w, double lambda, size_t k, size_t I)
 	:CPegasos<Vector>(features,labels,w,lambda,k,I),
@@ -28,6 +28,7 @@
 #define ARMIJO_C 0.25
 
 #include <stdio.h>
+#include <random>
 
 #include "darray.h"
 
@@ -120,6 +121,100 @@ protected:
 
 };
 
+/*! \brief parallel PEGASOS solver for linear SVMs
+ *
+ * Opposed to CPegasos, the features are the columns of a single dense array, so that inner
+ * products run over contiguous memory. Each step draws a mini-batch of indices (not copies
+ * of the features) with one random number generator per thread and evaluates the subgradient
+ * of the hinge loss in parallel. The step size follows the learning rate
+ * \f$\frac{1}{\lambda t}\f$, which avoids evaluating the objective over the whole training
+ * set in every step.
+ *
+ * In asynchronous mode, threads perform steps independently and write to the shared normal
+ * without locking (Hogwild). This is not deterministic.
+ *
+ */
+template<typename T>
+class CParallelPegasos {
+
+public:
+
+    /*! \brief Constructor.
+     *
+     * \param[in] features features as columns
+     * \param[in] labels labels \f$\pm 1\f$
+     * \param[in] lambda regularization parameter
+     * \param[in] k size of mini-batches
+     * \param[in] seed seed of the random number generators
+     *
+     */
+    CParallelPegasos(const CDenseArray<T>& features, const std::vector<int>& labels, double lambda = 1.0, size_t k = 1, unsigned int seed = 0);
+
+    //! Enables lock-free asynchronous updates.
+    void SetAsynchronous(bool on) { m_asynchronous = on; }
+
+    //! Sets the number of steps between evaluations of the objective, none if zero.
+    void SetCheckInterval(size_t n) { m_ncheck = n; }
+
+    //! Triggers execution of a given number of descent steps.
+    void Train(size_t n, bool silent = true);
+
+    //! Calculates the objective function value.
+    double CalcResidual() const;
+
+    //! Saves the residual progression to a file.
+    bool SaveResidual(const char* filename);
+
+    //! Provides access to #m_w.
+    const CDenseVector<T>& GetW() const { return m_w; }
+
+    //! Provides access to #m_b.
+    double GetBias() const { return m_b; }
+
+    //! Provides access to the residual progression.
+    std::vector<double>& GetResidual() { return m_res; }
+
+    //! Classification with trained SVM.
+    double Classify(const T* x) const;
+
+private:
+
+    const CDenseArray<T>& m_features;           //!< features
+    const std::vector<int>& m_labels;           //!< labels
+    double m_lambda;                            //!< regularization parameter
+    size_t m_k;                                 //!< size of mini-batches
+    bool m_asynchronous;                        //!< flag for Hogwild mode
+    size_t m_ncheck;                            //!< steps between evaluations of the objective
+    size_t m_i;                                 //!< iteration index
+    CDenseVector<T> m_w;                        //!< normal of separating hyperplane
+    double m_b;                                 //!< bias term
+    std::vector<double> m_res;                  //!< residual values
+    std::vector<std::mt19937> m_rngs;           //!< one random number generator per thread
+    CDenseArray<T> m_grads;                     //!< one subgradient per thread
+
+    //! Synchronous mini-batch steps.
+    void TrainSynchronous(size_t n, bool silent);
+
+    //! Asynchronous lock-free steps.
+    void TrainAsynchronous(size_t n);
+
+    /*! \brief Accumulates the subgradient of the hinge loss over a random mini-batch.
+     *
+     * \param[in] w normal
+     * \param[in] b bias
+     * \param[in] k number of samples
+     * \param[in] rng random number generator
+     * \param[out] g sum of \f$y_ix_i\f$ over the samples violating the margin
+     * \returns sum of \f$y_i\f$ over the samples violating the margin
+     *
+     */
+    double Subgradient(const T* w, double b, size_t k, std::mt19937& rng, T* g) const;
+
+    //! Scaled descent step followed by projection onto the feasible ball.
+    void Step(T* w, double& b, const T* g, double gb, double eta) const;
+
+};
+
 /*! \brief PEGASOS stochastic subgradient SVM-MIL solver
  *
  *
@@ -22,10 +22,13 @@
 //////////////////////////////////////////////////////////////////////////////////
 
 #include "precond.h"
+#include "spectrum.h"
 
 #include <stdio.h>
 #include <iostream>
 #include <assert.h>
+#include <limits>
+#include <algorithm>
 
 using namespace std;
 
@@ -39,6 +42,8 @@ template class CPreconditioner<CSymmetricCSRMatrix<float,size_t>,float>;
 template class CPreconditioner<CSymmetricCSRMatrix<double,size_t>,double>;
 template class CPreconditioner<CCSRMatrix<float,size_t>,float>;
 template class CPreconditioner<CCSRMatrix<double,size_t>,double>;
+template class CPreconditioner<CLinearOperator<float>,float>;
+template class CPreconditioner<CLinearOperator<double>,double>;
 
 template<class Matrix,typename T>
 CSSORPreconditioner<Matrix,T>::CSSORPreconditioner(Matrix& A, T omega, bool lower):
@@ -105,6 +110,122 @@ template class CJacobiPreconditioner<CSparseArray<double>,double>;
 template class CJacobiPreconditioner<CDenseArray<float>,float>;
 template class CJacobiPreconditioner<CSparseArray<float>,float>;
 
+template<typename T>
+CJacobiPreconditioner<CLinearOperator<T>,T>::CJacobiPreconditioner(const CLinearOperator<T>& A, bool normal):
+    m_dinv(A.Diagonal(normal)) {
+
+    for(size_t i=0; i<m_dinv.NElems(); i++)
+        m_dinv(i) = m_dinv.Get(i)!=0 ? 1/m_dinv.Get(i) : 0;
+
+}
+
+template<typename T>
+void CJacobiPreconditioner<CLinearOperator<T>,T>::Solve(CDenseArray<T>& x, const CDenseArray<T>& y) const {
+
+    assert(y.NRows()==m_dinv.NElems());
+
+    // write into x if it has its own memory of the right size
+    if(x.NRows()!=y.NRows() || x.NCols()!=y.NCols() || x.Data()==y.Data())
+        x = CDenseArray<T>(y.NRows(),y.NCols());
+
+    for(size_t j=0; j<y.NCols(); j++) {
+
+        for(size_t i=0; i<y.NRows(); i++)
+            x(i,j) = m_dinv.Get(i)*y.Get(i,j);
+
+    }
+
+}
+
+template class CJacobiPreconditioner<CLinearOperator<double>,double>;
+template class CJacobiPreconditioner<CLinearOperator<float>,float>;
+
+template<class Matrix,typename T>
+CChebyshevPreconditioner<Matrix,T>::CChebyshevPreconditioner(const Matrix& A, size_t degree, bool normal, size_t nlanczos):
+    m_A(A),
+    m_At(Matrix::Transpose(A)),
+    m_degree(degree),
+    m_normal(normal),
+    m_lmin(0),
+    m_lmax(0) {
+
+    CSpectrumEstimator<Matrix,T> estimator(nlanczos,normal);
+    estimator.Estimate(A,m_lmin,m_lmax);
+
+    // safety margin, cf. CChebyshevIteration::GetSpectralBounds
+    m_lmax *= 1.1;
+
+}
+
+template<class Matrix,typename T>
+void CChebyshevPreconditioner<Matrix,T>::Solve(CDenseArray<T>& x, const CDenseArray<T>& y) const {
+
+    if(!(m_lmin>0 && m_lmax>=m_lmin) || m_degree==0) {
+
+        x = y;
+        return;
+
+    }
+
+    T theta = 0.5*(m_lmax+m_lmin);
+    T delta = max<T>(0.5*(m_lmax-m_lmin),numeric_limits<T>::epsilon()*theta);
+    T sigma = theta/delta;
+    T rho = 1/sigma;
+
+    // x might share its data with y, so work on fresh memory
+    CDenseArray<T> z(y.NRows(),y.NCols());
+    CDenseArray<T> r = y.Clone();
+    CDenseArray<T> d = y.Clone();
+    d.Scale(1/theta);
+
+    size_t nelems = z.NElems();
+    T* pz = z.Data().get();
+    T* pr = r.Data().get();
+    T* pd = d.Data().get();
+
+    for(size_t k=0; k<m_degree; k++) {
+
+        #pragma omp parallel for
+        for(size_t i=0; i<nelems; i++)
+            pz[i] += pd[i];
+
+        if(k+1==m_degree)
+            break;
+
+        CDenseArray<T> q = m_normal ? m_At*(m_A*d) : m_A*d;
+        const T* pq = q.Data().get();
+
+        T rhon = 1/(2*sigma-rho);
+        T c1 = rhon*rho;
+        T c2 = 2*rhon/delta;
+
+        #pragma omp parallel for
+        for(size_t i=0; i<nelems; i++) {
+
+            pr[i] -= pq[i];
+            pd[i] = c1*pd[i] + c2*pr[i];
+
+        }
+
+        rho = rhon;
+
+    }
+
+    x = z;
+
+}
+
+template class CChebyshevPreconditioner<CDenseArray<double>,double>;
+template class CChebyshevPreconditioner<CDenseArray<float>,float>;
+template class CChebyshevPreconditioner<CSparseArray<double>,double>;
+template class CChebyshevPreconditioner<CSparseArray<float>,float>;
+template class CChebyshevPreconditioner<CSymmetricCSRMatrix<double,size_t>,double>;
+template class CChebyshevPreconditioner<CSymmetricCSRMatrix<float,size_t>,float>;
+template class CChebyshevPreconditioner<CCSRMatrix<double,size_t>,double>;
+template class CChebyshevPreconditioner<CCSRMatrix<float,size_t>,float>;
+template class CChebyshevPreconditioner<CLinearOperator<double>,double>;
+template class CChebyshevPreconditioner<CLinearOperator<float>,float>;
+
 
 } // end of namespace
 
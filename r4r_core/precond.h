@@ -27,6 +27,7 @@
 
 #include "sarray.h"
 #include "darray.h"
+#include "linop.h"
 
 
 namespace R4R {
@@ -95,7 +96,69 @@ protected:
 
 };
 
+/*! \brief Jacobi preconditioner for matrix-free operators
+ *
+ * The diagonal is obtained from CLinearOperator::Diagonal(). For least-squares solvers, set
+ * the normal flag to scale by the diagonal of \f$A^{\top}A\f$ instead.
+ *
+ */
+template<typename T>
+class CJacobiPreconditioner<CLinearOperator<T>,T>:public CPreconditioner<CLinearOperator<T>,T> {
+
+public:
+
+    //! Constructor.
+    CJacobiPreconditioner(const CLinearOperator<T>& A, bool normal = false);
+
+    //! \copydoc CPreconditioner::Solve(Vector& x, Vector& y)
+    void Solve(CDenseArray<T>& x, const CDenseArray<T>& y) const;
+
+protected:
+
+    CDenseVector<T> m_dinv;                             //!< inverse of the diagonal (zero where it vanishes)
+
+};
+
+/*! \brief Chebyshev polynomial preconditioner
+ *
+ * Approximates \f$A^{-1}y\f$ by a fixed number of Chebyshev steps started from zero, i.e., by
+ * a polynomial in \f$A\f$ which only requires matrix-vector products and no inner products.
+ * For least-squares solvers, the normal operator \f$A^{\top}A\f$ is used instead of \f$A\f$.
+ * Unless set explicitly, spectral bounds are estimated once in the constructor by the Lanczos
+ * method.
+ *
+ */
+template<class Matrix,typename T>
+class CChebyshevPreconditioner:public CPreconditioner<Matrix,T> {
+
+public:
+
+    /*! \brief Constructor.
+     *
+     * \param[in] A matrix
+     * \param[in] degree degree of the polynomial
+     * \param[in] normal flag that selects the normal operator \f$A^{\top}A\f$
+     * \param[in] nlanczos number of Lanczos steps used to estimate the spectral bounds
+     *
+     */
+    CChebyshevPreconditioner(const Matrix& A, size_t degree, bool normal = false, size_t nlanczos = 20);
 
+    //! Overrides the estimated spectral bounds.
+    void SetSpectralBounds(T lmin, T lmax) { m_lmin = lmin; m_lmax = lmax; }
+
+    //! \copydoc CPreconditioner::Solve(Vector& x, Vector& y)
+    void Solve(CDenseArray<T>& x, const CDenseArray<T>& y) const;
+
+protected:
+
+    const Matrix m_A;                                   //!< matrix
+    const Matrix m_At;                                  //!< transpose of #m_A (only used for the normal operator)
+    size_t m_degree;                                    //!< polynomial degree
+    bool m_normal;                                      //!< normal-operator flag
+    T m_lmin;                                           //!< lower bound of the spectrum
+    T m_lmax;                                           //!< upper bound of the spectrum
+
+};
 
 }
 
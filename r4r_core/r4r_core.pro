@@ -21,7 +21,9 @@
 #
 ######################################################################################
 
-QMAKE_CXXFLAGS += -std=c++0x -O3 -msse4
+QMAKE_CXXFLAGS += -std=c++0x -O3 -msse4 -fopenmp
+
+LIBS += -fopenmp
 
 TARGET = r4r_core
 TEMPLATE = lib
@@ -47,7 +49,13 @@ SOURCES += \
     splinecurve.cpp \
     vecn.cpp \
     image.cpp \
-    types.cpp
+    types.cpp \
+    spectrum.cpp \
+    linop.cpp \
+    schur.cpp \
+    batchlm.cpp \
+    tv.cpp \
+    fft.cpp
 
 HEADERS += \
     types.h \
@@ -70,7 +78,16 @@ HEADERS += \
     vecn.h \
     image.h \
     rbuffer.h \
-    unionfind.h
+    unionfind.h \
+    spectrum.h \
+    linop.h \
+    schur.h \
+    dual.h \
+    autodiff.h \
+    batchlm.h \
+    tv.h \
+    fft.h \
+    matn.h
 
 unix:!symbian|win32 {
 
@@ -97,6 +114,15 @@ unix:!symbian|win32 {
 
     }
 
+    # find FFTW (optional)
+    packagesExist(fftw3) {
+        DEFINES += HAVE_FFTW
+        LIBS += -lfftw3
+    }
+    else {
+        warning("Optional dependency on FFTW could not be resolved.")
+    }
+
     # find OpenCV
     packagesExist(opencv) {
 
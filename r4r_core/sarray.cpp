@@ -130,8 +130,8 @@ CCSRMatrix<T,U>::CCSRMatrix(size_t m, size_t n, vector<CCSRTriple<T,U> >& data):
 
     while(!data.empty()) {
 
-        // row change?
-        if(data.front().i()>lastentry.i())
+        // row change? close all rows up to the current one, some of them may be empty
+        for(U k=lastentry.i(); k<data.front().i(); k++)
             m_rowptr->push_back(nnz);
 
         // check whether we have to add to the last element or insert a new one
@@ -304,6 +304,56 @@ template R4R::CDenseVector<double> CCSRMatrix<double,size_t>::operator*(const R4
 template R4R::CDenseArray<float> CCSRMatrix<float,size_t>::operator*(const R4R::CDenseArray<float>& array) const;
 template R4R::CDenseVector<float> CCSRMatrix<float,size_t>::operator*(const R4R::CDenseVector<float>& array) const;
 
+template<typename T, typename U>
+void CCSRMatrix<T,U>::Multiply(const CDenseArray<T>& x, CDenseArray<T>& y) const {
+
+    assert(this->NCols()==x.NRows() && this->NRows()==y.NRows() && x.NCols()==y.NCols());
+
+    const U* prowptr = m_rowptr->data();
+    const U* pcols = m_cols->data();
+    const T* pvals = m_vals->data();
+
+    if(!m_transpose) {
+
+        for(size_t k=0; k<x.NCols(); k++) {
+
+            #pragma omp parallel for
+            for(size_t i=0; i<m_nrows; i++) {
+
+                T sum = 0;
+
+                for(size_t j=prowptr[i]; j<prowptr[i+1]; j++)
+                    sum += pvals[j]*x.Get(pcols[j],k);
+
+                y(i,k) = sum;
+
+            }
+
+        }
+
+    }
+    else {
+
+        // scattering into the rows of y, so no parallelization here
+        y.Zeros();
+
+        for(size_t k=0; k<x.NCols(); k++) {
+
+            for(size_t i=0; i<m_nrows; i++) {
+
+                T xik = x.Get(i,k);
+
+                for(size_t j=prowptr[i]; j<prowptr[i+1]; j++)
+                    y(pcols[j],k) += pvals[j]*xik;
+
+            }
+
+        }
+
+    }
+
+}
+
 template<typename T, typename U>
 CCSRMatrix<T,U> CCSRMatrix<T,U>::Transpose(const CCSRMatrix<T,U>& x) {
 
@@ -528,6 +578,42 @@ template R4R::CDenseVector<double> CSymmetricCSRMatrix<double,size_t>::operator*
 template R4R::CDenseArray<float> CSymmetricCSRMatrix<float,size_t>::operator*(const R4R::CDenseArray<float>& array) const;
 template R4R::CDenseVector<float> CSymmetricCSRMatrix<float,size_t>::operator*(const R4R::CDenseVector<float>& array) const;
 
+template<typename T, typename U>
+void CSymmetricCSRMatrix<T,U>::Multiply(const CDenseArray<T>& x, CDenseArray<T>& y) const {
+
+    assert(this->NCols()==x.NRows() && this->NRows()==y.NRows() && x.NCols()==y.NCols());
+
+    y.Zeros();
+
+    const U* prowptr = m_rowptr->data();
+    const U* pcols = m_cols->data();
+    const T* pvals = m_vals->data();
+
+    for(size_t k=0; k<x.NCols(); k++) {
+
+        for(size_t i=0; i<m_size; i++) {
+
+            T sum = 0;
+            T xik = x.Get(i,k);
+
+            // columns before and including the diagonal
+            for(size_t j=prowptr[i]; j<prowptr[i+1]; j++) {
+
+                sum += pvals[j]*x.Get(pcols[j],k);
+
+                if(i!=pcols[j])
+                    y(pcols[j],k) += pvals[j]*xik;
+
+            }
+
+            y(i,k) += sum;
+
+        }
+
+    }
+
+}
+
 template class CSymmetricCSRMatrix<float,size_t>;
 template class CSymmetricCSRMatrix<double,size_t>;
 
@@ -1395,6 +1481,56 @@ template<class Matrix> Matrix CSparseArray<T>::operator*(const Matrix& array) co
 
 }
 
+template <class T>
+void CSparseArray<T>::Multiply(const CDenseArray<T>& x, CDenseArray<T>& y) const {
+
+    assert(m_ncols==x.NRows() && m_nrows==y.NRows() && x.NCols()==y.NCols());
+
+    y.Zeros();
+
+    if(!m_transpose) {
+
+        typename map<size_t,map<size_t,T> >::const_iterator it_row;
+        typename map<size_t,T>::const_iterator it_col;
+
+        for(it_row=m_data->begin(); it_row!=m_data->end(); it_row++) {
+
+            for(size_t j=0; j<x.NCols(); j++) {
+
+                T sum = 0;
+
+                for(it_col=it_row->second.begin(); it_col!=it_row->second.end(); it_col++)
+                    sum += (it_col->second)*x.Get(it_col->first,j);
+
+                y(it_row->first,j) = sum;
+
+            }
+
+        }
+
+    }
+    else {
+
+        typename map<size_t,map<size_t,T> >::const_iterator it_col;
+        typename map<size_t,T>::const_iterator it_row;
+
+        for(size_t j=0; j<x.NCols(); j++) {
+
+            for(it_col=m_data->begin(); it_col!=m_data->end(); it_col++) {
+
+                T xij = x.Get(it_col->first,j);
+
+                for(it_row=it_col->second.begin(); it_row!=it_col->second.end(); it_row++)
+                    y(it_row->first,j) += it_row->second*xij;
+
+            }
+
+        }
+
+    }
+
+}
+
 //template <class T>
 // CDenseVector<T> CSparseArray<T>::operator*(const CDenseVector<T>& vector) {
 
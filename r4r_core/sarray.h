@@ -164,9 +164,24 @@ public:
     //! Counts the number of non-zero entries.
     size_t NNz() const { return m_vals->size(); }
 
+    //! Access to the row pointer.
+    const std::shared_ptr<std::vector<U> >& GetRowPtr() const { return m_rowptr; }
+
+    //! Access to the column indices.
+    const std::shared_ptr<std::vector<U> >& GetCols() const { return m_cols; }
+
+    //! Access to the values.
+    const std::shared_ptr<std::vector<T> >& GetValues() const { return m_vals; }
+
+    //! Access to the transposition flag.
+    bool IsTransposed() const { return m_transpose; }
+
     //! Multiplies the object with a dense array from the right.
     template<class Matrix> Matrix operator*(const Matrix& array) const;
 
+    //! Computes \f$y=Ax\f$ in the memory of \f$y\f$, see CDenseArray::Multiply.
+    void Multiply(const CDenseArray<T>& x, CDenseArray<T>& y) const;
+
     //! Writes matrix to a stream.
     template<typename V,typename W> friend std::ostream& operator << (std::ostream& os, const CCSRMatrix<V,W>& x);
 
@@ -176,8 +191,7 @@ public:
     /*! Stacks the object on top of a given matrix.
      *
      * TODO: Remove argument for direction. This should not be supported by
-     * the CSR representation, but it is needed to comply with the interface
-     * required by the CSplitBregman.
+     * the CSR representation. Use CStackedOperator to avoid the copy altogether.
      *
      */
     void Concatenate(const CCSRMatrix<T,U>& x, bool direction);
@@ -226,9 +240,18 @@ public:
     //! Multiplies the object with a dense array from the right.
     template<class Matrix> Matrix operator*(const Matrix& array) const;
 
+    //! Computes \f$y=Ax\f$ in the memory of \f$y\f$, see CDenseArray::Multiply.
+    void Multiply(const CDenseArray<T>& x, CDenseArray<T>& y) const;
+
     //! Writes matrix to a stream.
     template<typename V,typename W> friend std::ostream& operator << (std::ostream& os, const CSymmetricCSRMatrix<V,W>& x);
 
+    //! Transposition (returns a shallow copy since the matrix is symmetric).
+    static CSymmetricCSRMatrix<T,U> Transpose(const CSymmetricCSRMatrix<T,U>& x) { return x; }
+
+    //! Method stump (transposition does nothing to symmetric matrices).
+    void Transpose() {}
+
 private:
 
     size_t m_size;                                          //!< number of rows and cols
@@ -430,6 +453,9 @@ public:
 	//! Multiplies the object with a dense array from the right.
     template<class Matrix> Matrix operator*(const Matrix& array) const;
 
+    //! Computes \f$y=Ax\f$ in the memory of \f$y\f$, see CDenseArray::Multiply.
+    void Multiply(const CDenseArray<T>& x, CDenseArray<T>& y) const;
+
     //! Computes the standard inner product.
     T static InnerProduct(const CSparseArray<T>& x, const CSparseArray<T>& y);
 
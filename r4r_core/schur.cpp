@@ -0,0 +1,503 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "schur.h"
+#include "factor.h"
+
+#include <math.h>
+#include <algorithm>
+
+using namespace std;
+
+namespace R4R {
+
+template<typename T>
+CSchurComplementSolver<T>::CSchurComplementSolver(const CLeastSquaresProblem<CCSRMatrix<T>,T>& problem, size_t n, double eps, bool silent):
+    CIterativeLinearSolver<CCSRMatrix<T>,T>::CIterativeLinearSolver(m_identity,n,eps,silent),
+    m_identity(),
+    m_problem(problem),
+    m_nblocks(0),
+    m_blocksize(1),
+    m_nreduced(0),
+    m_blockptr(),
+    m_blockrows(),
+    m_U(),
+    m_Y(),
+    m_ge(),
+    m_S(),
+    m_gr() {
+
+    m_problem.GetBlockPartition(m_nblocks,m_blocksize);
+
+    if(m_nblocks*m_blocksize>m_problem.GetNumberOfModelParameters()) {
+
+        cerr << "ERROR: Partition exceeds the number of parameters." << endl;
+        m_nblocks = 0;
+
+    }
+
+    m_nreduced = m_problem.GetNumberOfModelParameters() - m_nblocks*m_blocksize;
+
+}
+
+template<typename T>
+bool CSchurComplementSolver<T>::Factorize(const CCSRMatrix<T>& A) const {
+
+    const size_t bs = m_blocksize;
+    const size_t nb = m_nblocks;
+    const size_t ne = nb*bs;
+    const size_t nr = m_nreduced;
+    const size_t m = A.NRows();
+
+    if(A.IsTransposed() || A.NCols()!=ne+nr) {
+
+        cerr << "ERROR: Check matrix dimensions!" << endl;
+        return false;
+
+    }
+
+    const size_t* rowptr = A.GetRowPtr()->data();
+    const size_t* cols = A.GetCols()->data();
+    const T* vals = A.GetValues()->data();
+
+    // block which a row depends on, the reduced-only rows form group nb
+    auto block = [&](size_t row) {
+
+        size_t b = nb;
+
+        for(size_t k=rowptr[row]; k<rowptr[row+1]; k++) {
+
+            if(cols[k]<ne) {
+
+                size_t bk = cols[k]/bs;
+
+                if(b==nb)
+                    b = bk;
+                else if(b!=bk)
+                    return nb + 1;
+
+            }
+
+        }
+
+        return b;
+
+    };
+
+    // sort rows by block (counting sort)
+    m_blockptr.assign(nb+2,0);
+    m_blockrows.resize(m);
+
+    for(size_t i=0; i<m; i++) {
+
+        size_t b = block(i);
+
+        if(b>nb) {
+
+            cerr << "ERROR: Residual " << i << " couples two eliminated blocks." << endl;
+            return false;
+
+        }
+
+        m_blockptr[b+1]++;
+
+    }
+
+    for(size_t b=0; b<=nb; b++)
+        m_blockptr[b+1] += m_blockptr[b];
+
+    {
+
+        vector<size_t> next(m_blockptr.begin(),m_blockptr.end()-1);
+
+        for(size_t i=0; i<m; i++)
+            m_blockrows[next[block(i)]++] = i;
+
+    }
+
+    m_U.resize(nb*bs*bs);
+    m_Y.resize(nb*bs*nr);
+    m_ge.resize(ne);
+
+    if(m_S.NRows()!=nr || m_S.NCols()!=nr)
+        m_S = CDenseArray<T>(nr,nr);
+
+    m_S.Zeros();
+
+    if(m_gr.NElems()!=nr)
+        m_gr = CDenseVector<T>(nr);
+
+    const T lambda2 = m_lambda*m_lambda;
+    T* ps = m_S.Data().get();
+    bool success = true;
+
+#pragma omp parallel
+    {
+
+        // thread-local contribution to the reduced system
+        vector<T> S(nr*nr,0);
+        vector<T> W(bs*nr);
+        vector<T> e(bs);
+        vector<size_t> ridx;
+        vector<T> rval;
+
+#pragma omp for schedule(dynamic,64)
+        for(size_t b=0; b<=nb; b++) {
+
+            T* U = (b<nb) ? m_U.data() + b*bs*bs : nullptr;
+
+            if(b<nb) {
+
+                fill(U,U+bs*bs,0);
+                fill(W.begin(),W.end(),0);
+
+                for(size_t i=0; i<bs; i++)
+                    U[i+bs*i] = lambda2;
+
+            }
+
+            for(size_t l=m_blockptr[b]; l<m_blockptr[b+1]; l++) {
+
+                size_t row = m_blockrows[l];
+
+                // split row into eliminated and reduced parts
+                fill(e.begin(),e.end(),0);
+                ridx.clear();
+                rval.clear();
+
+                for(size_t k=rowptr[row]; k<rowptr[row+1]; k++) {
+
+                    if(cols[k]<ne)
+                        e[cols[k]-b*bs] += vals[k];
+                    else {
+
+                        ridx.push_back(cols[k]-ne);
+                        rval.push_back(vals[k]);
+
+                    }
+
+                }
+
+                // V += r*r'
+                for(size_t j=0; j<ridx.size(); j++) {
+
+                    for(size_t i=0; i<ridx.size(); i++)
+                        S[ridx[i]+nr*ridx[j]] += rval[i]*rval[j];
+
+                }
+
+                if(b==nb)
+                    continue;
+
+                // U += e*e', W += e*r'
+                for(size_t j=0; j<bs; j++) {
+
+                    for(size_t i=0; i<bs; i++)
+                        U[i+bs*j] += e[i]*e[j];
+
+                }
+
+                for(size_t j=0; j<ridx.size(); j++) {
+
+                    for(size_t i=0; i<bs; i++)
+                        W[i+bs*ridx[j]] += e[i]*rval[j];
+
+                }
+
+            }
+
+            if(b==nb)
+                continue;
+
+            if(!CMatrixFactorization<T>::Cholesky(U,bs)) {
+
+#pragma omp critical
+                success = false;
+                continue;
+
+            }
+
+            // Y = U^{-1}*W
+            T* Y = m_Y.data() + b*bs*nr;
+            copy(W.begin(),W.end(),Y);
+
+            for(size_t j=0; j<nr; j++)
+                CMatrixFactorization<T>::CholeskySolve(U,Y+bs*j,bs);
+
+            // S -= W'*Y
+            for(size_t j=0; j<nr; j++) {
+
+                for(size_t i=0; i<nr; i++) {
+
+                    T sum = 0;
+
+                    for(size_t k=0; k<bs; k++)
+                        sum += W[k+bs*i]*Y[k+bs*j];
+
+                    S[i+nr*j] -= sum;
+
+                }
+
+            }
+
+        }
+
+#pragma omp critical
+        {
+
+            for(size_t i=0; i<nr*nr; i++)
+                ps[i] += S[i];
+
+        }
+
+    }
+
+    if(!success) {
+
+        cerr << "ERROR: Diagonal block is not positive definite." << endl;
+        return false;
+
+    }
+
+    for(size_t i=0; i<nr; i++)
+        ps[i+nr*i] += lambda2;
+
+    if(m_n==0 && !CMatrixFactorization<T>::Cholesky(ps,nr)) {
+
+        cerr << "ERROR: Reduced system is not positive definite." << endl;
+        return false;
+
+    }
+
+    return true;
+
+}
+
+template<typename T>
+vector<double> CSchurComplementSolver<T>::Solve(const CCSRMatrix<T>& A, const T* b, T* x) const {
+
+    const size_t bs = m_blocksize;
+    const size_t nb = m_nblocks;
+    const size_t ne = nb*bs;
+    const size_t nr = m_nreduced;
+
+    const size_t* rowptr = A.GetRowPtr()->data();
+    const size_t* cols = A.GetCols()->data();
+    const T* vals = A.GetValues()->data();
+
+    T* pgr = m_gr.Data().get();
+    fill(pgr,pgr+nr,0);
+
+#pragma omp parallel
+    {
+
+        vector<T> gr(nr,0);
+
+#pragma omp for schedule(dynamic,64)
+        for(size_t k=0; k<=nb; k++) {
+
+            T* ge = (k<nb) ? m_ge.data() + k*bs : nullptr;
+
+            if(k<nb)
+                fill(ge,ge+bs,0);
+
+            // g = A'*b
+            for(size_t l=m_blockptr[k]; l<m_blockptr[k+1]; l++) {
+
+                size_t row = m_blockrows[l];
+
+                for(size_t i=rowptr[row]; i<rowptr[row+1]; i++) {
+
+                    if(cols[i]<ne)
+                        ge[cols[i]-k*bs] += vals[i]*b[row];
+                    else
+                        gr[cols[i]-ne] += vals[i]*b[row];
+
+                }
+
+            }
+
+            if(k==nb)
+                continue;
+
+            // gr -= Y'*ge, ge <- U^{-1}*ge
+            const T* Y = m_Y.data() + k*bs*nr;
+
+            for(size_t j=0; j<nr; j++) {
+
+                T sum = 0;
+
+                for(size_t i=0; i<bs; i++)
+                    sum += Y[i+bs*j]*ge[i];
+
+                gr[j] -= sum;
+
+            }
+
+            CMatrixFactorization<T>::CholeskySolve(m_U.data()+k*bs*bs,ge,bs);
+
+        }
+
+#pragma omp critical
+        {
+
+            for(size_t i=0; i<nr; i++)
+                pgr[i] += gr[i];
+
+        }
+
+    }
+
+    // reduced system
+    T* xr = x + ne;
+    vector<double> residual;
+
+    if(m_n==0) {
+
+        copy(pgr,pgr+nr,xr);
+        CMatrixFactorization<T>::CholeskySolve(m_S.Data().get(),xr,nr);
+
+        // residual of the reduced system from the factor
+        const T* l = m_S.Data().get();
+        vector<T> z(nr);
+
+        for(size_t i=0; i<nr; i++) {
+
+            T sum = 0;
+
+            for(size_t k=i; k<nr; k++)
+                sum += l[k+nr*i]*xr[k];
+
+            z[i] = sum;
+
+        }
+
+        double res = 0;
+
+        for(size_t i=0; i<nr; i++) {
+
+            T sum = 0;
+
+            for(size_t k=0; k<=i; k++)
+                sum += l[i+nr*k]*z[k];
+
+            res += (pgr[i]-sum)*(pgr[i]-sum);
+
+        }
+
+        residual.push_back(sqrt(res));
+
+    }
+    else {
+
+        CDenseVector<T> y(nr);
+        copy(xr,xr+nr,y.Data().get());
+
+        CJacobiPreconditioner<CDenseArray<T>,T> M(m_S);
+        CConjugateGradientMethod<CDenseArray<T>,T> solver(M,m_n,m_eps,m_silent);
+        residual = solver.Iterate(m_S,m_gr,y);
+
+        copy(y.Data().get(),y.Data().get()+nr,xr);
+
+    }
+
+    // back-substitution xe = U^{-1}*ge - Y*xr
+#pragma omp parallel for
+    for(size_t k=0; k<nb; k++) {
+
+        const T* Y = m_Y.data() + k*bs*nr;
+        const T* ge = m_ge.data() + k*bs;
+        T* xe = x + k*bs;
+
+        for(size_t i=0; i<bs; i++) {
+
+            T sum = ge[i];
+
+            for(size_t j=0; j<nr; j++)
+                sum -= Y[i+bs*j]*xr[j];
+
+            xe[i] = sum;
+
+        }
+
+    }
+
+    if(!m_silent)
+        cout << "Schur complement: " << nb << " blocks eliminated, reduced system of size " << nr << ", residual " << (residual.empty() ? 0 : residual.back()) << endl;
+
+    return residual;
+
+}
+
+template<typename T>
+vector<double> CSchurComplementSolver<T>::Iterate(const CCSRMatrix<T>& A, const CDenseArray<T>& B, CDenseArray<T>& X) const {
+
+    if(!(A.NCols()==X.NRows() && A.NRows()==B.NRows() && X.NCols()==B.NCols())) {
+
+        cerr << "ERROR: Check matrix dimensions!" << endl;
+        return vector<double>();
+
+    }
+
+    if(!Factorize(A))
+        return vector<double>();
+
+    const size_t m = B.NRows();
+    const size_t n = X.NRows();
+    const T* pb = B.Data().get();
+    T* px = X.Data().get();
+
+    vector<double> residual;
+
+    for(size_t j=0; j<X.NCols(); j++) {
+
+        vector<double> res = Solve(A,pb+j*m,px+j*n);
+        residual.insert(residual.end(),res.begin(),res.end());
+
+    }
+
+    return residual;
+
+}
+
+template<typename T>
+vector<double> CSchurComplementSolver<T>::Iterate(const CCSRMatrix<T>& A, const CDenseVector<T>& b, CDenseVector<T>& x) const {
+
+    if(!(A.NCols()==x.NElems() && A.NRows()==b.NElems())) {
+
+        cerr << "ERROR: Check matrix dimensions!" << endl;
+        return vector<double>();
+
+    }
+
+    if(!Factorize(A))
+        return vector<double>();
+
+    return Solve(A,b.Data().get(),x.Data().get());
+
+}
+
+template class CSchurComplementSolver<float>;
+template class CSchurComplementSolver<double>;
+
+}
@@ -0,0 +1,103 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef R4RSCHUR_H_
+#define R4RSCHUR_H_
+
+#include <vector>
+
+#include "lm.h"
+#include "sarray.h"
+
+namespace R4R {
+
+/*! \brief Schur-complement solver for least-squares problems with block structure
+ *
+ * Solves the damped normal equation \f$(A^{\top}A+\lambda^2I)x=A^{\top}b\f$ for problems whose
+ * leading parameters fall into small groups that do not interact with each other, e.g., one
+ * depth per correspondence in structure-from-motion, as declared by
+ * CLeastSquaresProblem::GetBlockPartition(). Splitting \f$x=(x_e,x_r)\f$, the upper-left block
+ * \f$U\f$ of the normal matrix is block-diagonal, and the blocks are eliminated independently
+ * (in parallel) which leaves the reduced system
+ * \f[(V-W^{\top}U^{-1}W)x_r=g_r-W^{\top}U^{-1}g_e\f]
+ * in the remaining parameters. This is solved by a dense Cholesky decomposition or by PCG,
+ * and \f$x_e\f$ is recovered by back-substitution. The cost is linear in the number of blocks,
+ * so the solver is meant as a drop-in replacement for CConjugateGradientMethodLeastSquares in
+ * CLevenbergMarquardt.
+ *
+ */
+template<typename T>
+class CSchurComplementSolver:public CIterativeLinearSolver<CCSRMatrix<T>,T> {
+
+public:
+
+    /*! \brief Constructor.
+     *
+     * \param[in] problem least-squares problem which declares the partition of the parameters
+     * \param[in] n number of PCG steps for the reduced system, \f$0\f$ selects the Cholesky decomposition
+     * \param[in] eps absolute residual at which PCG terminates
+     * \param[in] silent verbosity flag
+     *
+     */
+    CSchurComplementSolver(const CLeastSquaresProblem<CCSRMatrix<T>,T>& problem, size_t n = 0, double eps = 0, bool silent = true);
+
+    //! Deleted standard constructor.
+    CSchurComplementSolver() = delete;
+
+    //! \copydoc CIterativeLinearSolver::Iterate(const Matrix&,const CDenseArray<T>&,CDenseArray<T>&)
+    std::vector<double> Iterate(const CCSRMatrix<T>& A, const CDenseArray<T>& B, CDenseArray<T>& X) const;
+
+    //! \copydoc CIterativeLinearSolver::Iterate(const Matrix&,const CDenseVector<T>&,CDenseVector<T>&)
+    std::vector<double> Iterate(const CCSRMatrix<T>& A, const CDenseVector<T>& b, CDenseVector<T>& x) const;
+
+private:
+
+    using CIterativeLinearSolver<CCSRMatrix<T>,T>::m_n;
+    using CIterativeLinearSolver<CCSRMatrix<T>,T>::m_eps;
+    using CIterativeLinearSolver<CCSRMatrix<T>,T>::m_silent;
+    using CIterativeLinearSolver<CCSRMatrix<T>,T>::m_lambda;
+
+    CPreconditioner<CCSRMatrix<T>,T> m_identity;                //!< dummy preconditioner required by the base class
+    const CLeastSquaresProblem<CCSRMatrix<T>,T>& m_problem;      //!< least-squares problem
+    size_t m_nblocks;                                           //!< number of eliminated blocks
+    size_t m_blocksize;                                         //!< block size
+    size_t m_nreduced;                                          //!< number of parameters in the reduced system
+    mutable std::vector<size_t> m_blockptr;                     //!< beginning of the rows of a block in #m_blockrows
+    mutable std::vector<size_t> m_blockrows;                    //!< row indices sorted by block, the last group only involves reduced parameters
+    mutable std::vector<T> m_U;                                 //!< Cholesky factors of the diagonal blocks
+    mutable std::vector<T> m_Y;                                 //!< \f$U^{-1}W\f$ for every block
+    mutable std::vector<T> m_ge;                                //!< right-hand side of the eliminated parameters
+    mutable CDenseArray<T> m_S;                                 //!< reduced system or its Cholesky factor
+    mutable CDenseVector<T> m_gr;                               //!< right-hand side of the reduced system
+
+    //! Sorts the rows by block and forms the reduced system.
+    bool Factorize(const CCSRMatrix<T>& A) const;
+
+    //! Solves for a single right-hand side after Factorize().
+    std::vector<double> Solve(const CCSRMatrix<T>& A, const T* b, T* x) const;
+
+};
+
+}
+
+#endif /* R4RSCHUR_H_ */
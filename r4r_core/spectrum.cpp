@@ -0,0 +1,259 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "spectrum.h"
+
+#include <math.h>
+#include <limits>
+#include <algorithm>
+
+using namespace std;
+
+namespace R4R {
+
+template<class Matrix,typename T>
+CSpectrumEstimator<Matrix,T>::CSpectrumEstimator(size_t n, bool normal, T lambda):
+    m_n(n),
+    m_normal(normal),
+    m_lambda(lambda) {}
+
+template<class Matrix,typename T>
+size_t CSpectrumEstimator<Matrix,T>::Estimate(const Matrix& A, T& lmin, T& lmax, const CPreconditioner<Matrix,T>* M) const {
+
+    lmin = 0;
+    lmax = 0;
+
+    size_t n = A.NCols();
+
+    if(n==0 || m_n==0)
+        return 0;
+
+    if(!m_normal && A.NRows()!=n) {
+
+        cerr << "ERROR: Lanczos method requires a square matrix." << endl;
+        return 0;
+
+    }
+
+    // only needed for the normal operator, cheap for all sparse formats
+    const Matrix At = Matrix::Transpose(A);
+
+    // deterministic start vector without special structure (no constant vector)
+    CDenseVector<T> r(n);
+    for(size_t i=0; i<n; i++)
+        r(i) = 0.5 + fmod(0.6180339887498949*(i+1),1.0);
+
+    CDenseVector<T> z = r.Clone();
+    if(M!=nullptr)
+        M->Solve(z,r);
+
+    double beta = sqrt(max(0.0,CDenseArray<T>::InnerProduct(r,z)));
+
+    // Lanczos vectors in the domain (q) and range (p) of the preconditioner
+    CDenseVector<T> q(n), p(n), pold(n);
+
+    vector<double> alphas, betas;
+    alphas.reserve(m_n);
+    betas.reserve(m_n);
+
+    for(size_t k=0; k<m_n; k++) {
+
+        if(beta<=numeric_limits<T>::epsilon())
+            break;
+
+        if(k>0)
+            betas.push_back(beta);
+
+        for(size_t i=0; i<n; i++) {
+
+            q(i) = z.Get(i)/beta;
+            p(i) = r.Get(i)/beta;
+
+        }
+
+        // apply operator
+        CDenseVector<T> w = A*q;
+
+        if(m_normal) {
+
+            w = At*w;
+
+            if(m_lambda!=0) {
+
+                for(size_t i=0; i<n; i++)
+                    w(i) += m_lambda*m_lambda*q.Get(i);
+
+            }
+
+        }
+
+        double alpha = CDenseArray<T>::InnerProduct(q,w);
+        alphas.push_back(alpha);
+
+        // three-term recurrence
+        for(size_t i=0; i<n; i++)
+            r(i) = w.Get(i) - alpha*p.Get(i) - beta*pold.Get(i);
+
+        if(M!=nullptr)
+            M->Solve(z,r);
+        else
+            z = r.Clone();
+
+        beta = sqrt(max(0.0,CDenseArray<T>::InnerProduct(r,z)));
+
+        // invariant subspace found, Ritz values are exact
+        if(beta<=numeric_limits<T>::epsilon()*fabs(alpha))
+            break;
+
+        // keep range vector for the next step
+        CDenseVector<T> temp = pold;
+        pold = p;
+        p = temp;
+
+    }
+
+    if(alphas.empty())
+        return 0;
+
+    betas.resize(alphas.size()-1);
+
+    TridiagonalEigenvalues(alphas,betas,lmin,lmax);
+
+    return alphas.size();
+
+}
+
+template<class Matrix,typename T>
+double CSpectrumEstimator<Matrix,T>::ConditionNumber(const Matrix& A, const CPreconditioner<Matrix,T>* M) const {
+
+    T lmin, lmax;
+
+    if(Estimate(A,lmin,lmax,M)==0 || lmin<=0)
+        return numeric_limits<double>::infinity();
+
+    return (double)lmax/(double)lmin;
+
+}
+
+template<class Matrix,typename T>
+size_t CSpectrumEstimator<Matrix,T>::SturmCount(const vector<double>& alpha, const vector<double>& beta, double x) {
+
+    size_t count = 0;
+    double d = 1;
+
+    for(size_t i=0; i<alpha.size(); i++) {
+
+        double b2 = i>0 ? beta[i-1]*beta[i-1] : 0;
+
+        d = alpha[i] - x - b2/d;
+
+        // avoid division by zero in the next step
+        if(d==0)
+            d = -numeric_limits<double>::epsilon();
+
+        if(d<0)
+            count++;
+
+    }
+
+    return count;
+
+}
+
+template<class Matrix,typename T>
+void CSpectrumEstimator<Matrix,T>::TridiagonalEigenvalues(const vector<double>& alpha, const vector<double>& beta, T& lmin, T& lmax) {
+
+    size_t k = alpha.size();
+
+    if(k==0)
+        return;
+
+    // Gershgorin interval
+    double gl = numeric_limits<double>::max();
+    double gu = -numeric_limits<double>::max();
+
+    for(size_t i=0; i<k; i++) {
+
+        double radius = 0;
+
+        if(i>0)
+            radius += fabs(beta[i-1]);
+
+        if(i<k-1)
+            radius += fabs(beta[i]);
+
+        gl = min(gl,alpha[i]-radius);
+        gu = max(gu,alpha[i]+radius);
+
+    }
+
+    double tol = 1e-12*max(fabs(gl),fabs(gu)) + numeric_limits<double>::min();
+
+    // smallest eigenvalue: left-most point with at least one eigenvalue below
+    double lo = gl;
+    double hi = gu;
+
+    while(hi-lo>tol) {
+
+        double mid = 0.5*(lo+hi);
+
+        if(SturmCount(alpha,beta,mid)>=1)
+            hi = mid;
+        else
+            lo = mid;
+
+    }
+
+    lmin = T(0.5*(lo+hi));
+
+    // largest eigenvalue: left-most point with all eigenvalues below
+    lo = gl;
+    hi = gu;
+
+    while(hi-lo>tol) {
+
+        double mid = 0.5*(lo+hi);
+
+        if(SturmCount(alpha,beta,mid)>=k)
+            hi = mid;
+        else
+            lo = mid;
+
+    }
+
+    lmax = T(0.5*(lo+hi));
+
+}
+
+template class CSpectrumEstimator<CDenseArray<double>,double>;
+template class CSpectrumEstimator<CDenseArray<float>,float>;
+template class CSpectrumEstimator<CSparseArray<double>,double>;
+template class CSpectrumEstimator<CSparseArray<float>,float>;
+template class CSpectrumEstimator<CCSRMatrix<double,size_t>,double>;
+template class CSpectrumEstimator<CCSRMatrix<float,size_t>,float>;
+template class CSpectrumEstimator<CSymmetricCSRMatrix<double,size_t>,double>;
+template class CSpectrumEstimator<CSymmetricCSRMatrix<float,size_t>,float>;
+template class CSpectrumEstimator<CLinearOperator<double>,double>;
+template class CSpectrumEstimator<CLinearOperator<float>,float>;
+
+}
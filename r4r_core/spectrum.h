@@ -0,0 +1,110 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef R4RSPECTRUM_H_
+#define R4RSPECTRUM_H_
+
+#include <vector>
+
+#include "sarray.h"
+#include "darray.h"
+#include "precond.h"
+
+namespace R4R {
+
+/*! \brief Lanczos estimation of extremal eigenvalues
+ *
+ * Runs a small number of (preconditioned) Lanczos steps on a symmetric positive-definite
+ * operator and computes the extremal eigenvalues of the resulting tridiagonal matrix by
+ * bisection. The operator is either the matrix \f$A\f$ itself or, in least-squares mode,
+ * the normal matrix \f$A^{\top}A+\lambda^2I\f$, which is never formed explicitly. If a
+ * preconditioner \f$M\f$ is given, the spectrum of \f$M^{-1}A\f$ is approximated.
+ *
+ * The largest Ritz value converges to \f$\lambda_{\max}\f$ from below within a few steps,
+ * the smallest one approaches \f$\lambda_{\min}\f$ from above and much slower. Their
+ * quotient therefore is a lower bound for the spectral condition number, which is
+ * sufficient to diagnose slow convergence of CG-type methods in the LM and split-Bregman
+ * solvers.
+ *
+ */
+template<class Matrix,typename T>
+class CSpectrumEstimator {
+
+public:
+
+    /*! \brief Constructor.
+     *
+     * \param[in] n maximum number of Lanczos steps
+     * \param[in] normal flag that selects the normal operator \f$A^{\top}A+\lambda^2I\f$
+     * \param[in] lambda regularization weight \f$\lambda\f$ in the normal operator
+     *
+     */
+    CSpectrumEstimator(size_t n = 20, bool normal = false, T lambda = 0);
+
+    //! Access to maximum number of Lanczos steps.
+    void SetN(size_t n) { m_n = n; }
+
+    //! Set the regularization weight.
+    void SetLambda(T lambda) { m_lambda = lambda; }
+
+    /*! \brief Estimates the extremal eigenvalues.
+     *
+     * \param[in] A matrix
+     * \param[out] lmin smallest Ritz value
+     * \param[out] lmax largest Ritz value
+     * \param[in] M optional preconditioner
+     * \returns number of Lanczos steps performed
+     *
+     */
+    size_t Estimate(const Matrix& A, T& lmin, T& lmax, const CPreconditioner<Matrix,T>* M = nullptr) const;
+
+    //! Estimates the spectral condition number \f$\frac{\lambda_{\max}}{\lambda_{\min}}\f$.
+    double ConditionNumber(const Matrix& A, const CPreconditioner<Matrix,T>* M = nullptr) const;
+
+    /*! \brief Computes the extremal eigenvalues of a symmetric tridiagonal matrix.
+     *
+     * \param[in] alpha diagonal of length \f$k\f$
+     * \param[in] beta off-diagonal of length \f$k-1\f$
+     * \param[out] lmin smallest eigenvalue
+     * \param[out] lmax largest eigenvalue
+     *
+     * The eigenvalues are found by bisection on the Gershgorin interval using
+     * Sturm sequence counts.
+     *
+     */
+    static void TridiagonalEigenvalues(const std::vector<double>& alpha, const std::vector<double>& beta, T& lmin, T& lmax);
+
+private:
+
+    size_t m_n;                             //!< maximum number of Lanczos steps
+    bool m_normal;                          //!< flag indicating that the normal operator is used
+    T m_lambda;                             //!< regularization weight
+
+    //! Counts the number of eigenvalues of a tridiagonal matrix smaller than \f$x\f$.
+    static size_t SturmCount(const std::vector<double>& alpha, const std::vector<double>& beta, double x);
+
+};
+
+}
+
+#endif /* SPECTRUM_H_ */
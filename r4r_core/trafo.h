@@ -25,6 +25,8 @@
 #define R4RTRAFO_H_
 
 #include <vector>
+#include <limits>
+#include <math.h>
 
 #include "darray.h"
 
@@ -205,6 +207,42 @@ public:
     //! Rodrigues formula.
     static void Rodrigues(const T& o1, const T& o2, const T& o3, T* R);
 
+    /*! \brief Rodrigues formula for arbitrary scalar types.
+     *
+     * Evaluates \f$R=I+\frac{\sin\theta}{\theta}[\omega]_\times+\frac{1-\cos\theta}{\theta^2}[\omega]_\times^2\f$
+     * for a scalar type U like CDual. Close to the identity, the first-order expansion is used so
+     * that derivatives are correct there, too.
+     *
+     */
+    template<typename U> static void Rodrigues(const U& o1, const U& o2, const U& o3, U* R) {
+
+        using std::sin;
+        using std::cos;
+        using std::sqrt;
+
+        U theta2 = o1*o1 + o2*o2 + o3*o3;
+        U a, b;
+
+        if(theta2<U(std::numeric_limits<T>::epsilon())) {
+
+            a = U(1);
+            b = U(0.5);
+
+        }
+        else {
+
+            U theta = sqrt(theta2);
+            a = sin(theta)/theta;
+            b = (U(1) - cos(theta))/theta2;
+
+        }
+
+        R[0] = U(1) - b*(o2*o2 + o3*o3);  R[3] = -a*o3 + b*o1*o2;          R[6] = a*o2 + b*o1*o3;
+        R[1] = a*o3 + b*o1*o2;            R[4] = U(1) - b*(o3*o3 + o1*o1);  R[7] = -a*o1 + b*o2*o3;
+        R[2] = -a*o2 + b*o1*o3;           R[5] = a*o1 + b*o2*o3;            R[8] = U(1) - b*(o1*o1 + o2*o2);
+
+    }
+
     //! Logarithm.
     static void Log(const T* R, T& o1, T& o2, T& o3);
 
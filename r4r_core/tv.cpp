@@ -0,0 +1,343 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "tv.h"
+
+#include <math.h>
+#include <algorithm>
+#include <iostream>
+
+using namespace std;
+
+namespace R4R {
+
+template<typename T>
+CPrimalDualTV<T>::CPrimalDualTV(const CDenseArray<T>& f, CDenseArray<T>& u, T mu, FIDELITY fidelity, double eps):
+    m_f(f),
+    m_u(u),
+    m_uprev(u.Clone()),
+    m_px(u.NRows(),u.NCols()),
+    m_py(u.NRows(),u.NCols()),
+    m_mu(mu),
+    m_fidelity(fidelity),
+    m_eps(eps),
+    m_tau(1.0/sqrt(8.0)),
+    m_sigma(1.0/sqrt(8.0)),
+    m_theta(1),
+    m_rho(1),
+    m_adaptive(false),
+    m_k(0),
+    m_total_error(),
+    m_constraint_violation() {
+
+    if(f.NRows()!=u.NRows() || f.NCols()!=u.NCols())
+        cerr << "ERROR: Dimensions of noisy image and solution do not agree." << endl;
+
+}
+
+template<typename T>
+void CPrimalDualTV<T>::SetStepSizes(T tau, T sigma) {
+
+    if(8*tau*sigma>1)
+        cerr << "WARNING: Step sizes violate convergence condition." << endl;
+
+    m_tau = tau;
+    m_sigma = sigma;
+
+}
+
+template<typename T>
+void CPrimalDualTV<T>::SetOverRelaxation(T rho) {
+
+    if(rho<=0 || rho>=2) {
+
+        cerr << "ERROR: Relaxation parameter must be in (0,2)." << endl;
+        return;
+
+    }
+
+    if(m_adaptive && rho!=1) {
+
+        cerr << "ERROR: Relaxation is incompatible with adaptive step sizes." << endl;
+        return;
+
+    }
+
+    m_rho = rho;
+
+}
+
+template<typename T>
+void CPrimalDualTV<T>::SetAdaptiveStepSizes(bool on) {
+
+    if(on && m_fidelity!=FIDELITY::L2) {
+
+        cerr << "ERROR: Adaptive step sizes require a uniformly convex data term." << endl;
+        return;
+
+    }
+
+    if(on && m_rho!=1) {
+
+        cerr << "ERROR: Relaxation is incompatible with adaptive step sizes." << endl;
+        return;
+
+    }
+
+    m_adaptive = on;
+
+    if(!on)
+        m_theta = 1;
+
+}
+
+template<typename T>
+void CPrimalDualTV<T>::Iterate(size_t n, bool silent) {
+
+    if(!silent && m_k==0)
+        cout << "k" << "\t\t" << "Total error" << "\t\t" << "Gap" << endl;
+
+    for(size_t k=0; k<n; k++) {
+
+        double dual = this->PrimalStep();
+
+        // acceleration for uniformly convex data term
+        if(m_adaptive) {
+
+            m_theta = 1.0/sqrt(1.0 + 2.0*m_mu*m_tau);
+            m_tau *= m_theta;
+            m_sigma /= m_theta;
+
+        }
+
+        double primal = this->DualStep();
+
+        m_total_error.push_back(primal);
+        m_constraint_violation.push_back(primal - dual);
+
+        // increment
+        m_k++;
+
+        // plot errors
+        if(!silent)
+            cout << m_k << "\t\t" << m_total_error.back() << "\t\t" << m_constraint_violation.back() << endl;
+
+        if(m_constraint_violation.back()<=m_eps)
+            break;
+
+    }
+
+}
+
+/*! \brief Relaxation and proximal step of the data term for a single pixel.
+ *
+ * Also accumulates the quantities needed to evaluate the dual energy.
+ *
+ */
+template<typename T,bool L1>
+static inline void PrimalPixel(T ktp, T px, T py, T f, T& u, T& v, T tau, T mu, T rho, T& fk, T& kk, T& kmax, T& pmax) {
+
+    v += rho*(u - v);
+
+    T w = v - tau*ktp;
+
+    if(L1) {
+
+        T d = w - f;
+        T s = tau*mu;
+        u = f + ((d>s) ? d - s : ((d<-s) ? d + s : 0));
+
+    }
+    else
+        u = (w + tau*mu*f)/(1 + tau*mu);
+
+    fk += f*ktp;
+    kk += ktp*ktp;
+    kmax = max(kmax,T(fabs(ktp)));
+    pmax = max(pmax,px*px + py*py);
+
+}
+
+/*! \brief Primal step for column of an image.
+ *
+ * The adjoint of the gradient is the negative backward-difference divergence. The dual variable
+ * vanishes in the last column and row, so the stencil needs no boundary treatment other than
+ * for the first row.
+ *
+ */
+template<typename T,bool L1>
+static void PrimalColumn(size_t h, const T* px, const T* pxl, const T* py, const T* f, T* u, T* v, T tau, T mu, T rho, T& fk, T& kk, T& kmax, T& pmax) {
+
+    PrimalPixel<T,L1>(-(px[0] - pxl[0] + py[0]),px[0],py[0],f[0],u[0],v[0],tau,mu,rho,fk,kk,kmax,pmax);
+
+    for(size_t i=1; i<h; i++)
+        PrimalPixel<T,L1>(-(px[i] - pxl[i] + py[i] - py[i-1]),px[i],py[i],f[i],u[i],v[i],tau,mu,rho,fk,kk,kmax,pmax);
+
+}
+
+template<typename T>
+double CPrimalDualTV<T>::PrimalStep() {
+
+    const size_t h = m_u.NRows();
+    const size_t w = m_u.NCols();
+
+    // dual variable left of the first column
+    vector<T> zero(h,0);
+
+    double fk = 0;
+    double kk = 0;
+    T kmax = 0;
+    T pmax = 0;
+
+    #pragma omp parallel for schedule(static) reduction(+:fk,kk) reduction(max:kmax,pmax)
+    for(size_t j=0; j<w; j++) {
+
+        const T* px = m_px.Data().get() + j*h;
+        const T* pxl = (j>0) ? px - h : zero.data();
+        const T* py = m_py.Data().get() + j*h;
+        const T* f = m_f.Data().get() + j*h;
+        T* u = m_u.Data().get() + j*h;
+        T* v = m_uprev.Data().get() + j*h;
+
+        T fkj = 0;
+        T kkj = 0;
+        T kmaxj = 0;
+        T pmaxj = 0;
+
+        if(m_fidelity==FIDELITY::L1)
+            PrimalColumn<T,true>(h,px,pxl,py,f,u,v,m_tau,m_mu,m_rho,fkj,kkj,kmaxj,pmaxj);
+        else
+            PrimalColumn<T,false>(h,px,pxl,py,f,u,v,m_tau,m_mu,m_rho,fkj,kkj,kmaxj,pmaxj);
+
+        fk += fkj;
+        kk += kkj;
+        kmax = max(kmax,kmaxj);
+        pmax = max(pmax,pmaxj);
+
+    }
+
+    /* dual energy at the dual variable scaled into the feasible set, which is only left
+     * through over-relaxation for TV-L2 */
+    double s = (pmax>1) ? 1.0/sqrt(pmax) : 1.0;
+
+    if(m_fidelity==FIDELITY::L1)
+        return fk*min(s,(kmax>0) ? m_mu/kmax : 1.0);
+    else
+        return s*fk - 0.5*s*s*kk/m_mu;
+
+}
+
+/*! \brief Dual step for a single pixel.
+ *
+ * Also accumulates the energy of the primal iterate.
+ *
+ */
+template<typename T,bool L1>
+static inline void DualPixel(T u, T dx, T dy, T dbarx, T dbary, T f, T& px, T& py, T sigma, T mu, T rho, T& tv, T& data) {
+
+    tv += sqrt(dx*dx + dy*dy);
+
+    if(L1)
+        data += mu*fabs(u - f);
+    else
+        data += 0.5*mu*(u - f)*(u - f);
+
+    T qx = px + sigma*dbarx;
+    T qy = py + sigma*dbary;
+    T s = max(T(1),T(sqrt(qx*qx + qy*qy)));
+
+    px += rho*(qx/s - px);
+    py += rho*(qy/s - py);
+
+}
+
+/*! \brief Dual step for column of an image.
+ *
+ * The primal iterate is extrapolated on the fly. In the last column, pass the column itself as
+ * its right neighbor, which makes the \f$x\f$-derivative vanish.
+ *
+ */
+template<typename T,bool L1>
+static void DualColumn(size_t h, const T* u, const T* v, const T* ur, const T* vr, const T* f, T* px, T* py, T sigma, T theta, T mu, T rho, T& tv, T& data) {
+
+    // empty images have no pixels, and h-1 would wrap around
+    if(h==0)
+        return;
+
+    for(size_t i=0; i<h-1; i++) {
+
+        T ubar = u[i] + theta*(u[i] - v[i]);
+        T ubarr = ur[i] + theta*(ur[i] - vr[i]);
+        T ubard = u[i+1] + theta*(u[i+1] - v[i+1]);
+
+        DualPixel<T,L1>(u[i],ur[i]-u[i],u[i+1]-u[i],ubarr-ubar,ubard-ubar,f[i],px[i],py[i],sigma,mu,rho,tv,data);
+
+    }
+
+    size_t i = h - 1;
+    T ubar = u[i] + theta*(u[i] - v[i]);
+    T ubarr = ur[i] + theta*(ur[i] - vr[i]);
+
+    DualPixel<T,L1>(u[i],ur[i]-u[i],T(0),ubarr-ubar,T(0),f[i],px[i],py[i],sigma,mu,rho,tv,data);
+
+}
+
+template<typename T>
+double CPrimalDualTV<T>::DualStep() {
+
+    const size_t h = m_u.NRows();
+    const size_t w = m_u.NCols();
+
+    double energy = 0;
+
+    #pragma omp parallel for schedule(static) reduction(+:energy)
+    for(size_t j=0; j<w; j++) {
+
+        const T* u = m_u.Data().get() + j*h;
+        const T* v = m_uprev.Data().get() + j*h;
+        const T* ur = (j<w-1) ? u + h : u;
+        const T* vr = (j<w-1) ? v + h : v;
+        const T* f = m_f.Data().get() + j*h;
+        T* px = m_px.Data().get() + j*h;
+        T* py = m_py.Data().get() + j*h;
+
+        T tv = 0;
+        T data = 0;
+
+        if(m_fidelity==FIDELITY::L1)
+            DualColumn<T,true>(h,u,v,ur,vr,f,px,py,m_sigma,m_theta,m_mu,m_rho,tv,data);
+        else
+            DualColumn<T,false>(h,u,v,ur,vr,f,px,py,m_sigma,m_theta,m_mu,m_rho,tv,data);
+
+        energy += tv + data;
+
+    }
+
+    return energy;
+
+}
+
+template class CPrimalDualTV<float>;
+template class CPrimalDualTV<double>;
+
+}
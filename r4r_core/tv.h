@@ -0,0 +1,135 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef R4RTV_H_
+#define R4RTV_H_
+
+#include <vector>
+
+#include "darray.h"
+
+namespace R4R {
+
+//! data fidelity terms for TV regularization
+enum class FIDELITY { L2, L1 };
+
+/*! \brief matrix-free first-order primal-dual method for TV denoising
+ *
+ * Minimizes \f$\frac{\mu}{2}\|u-f\|_2^2+\|\nabla u\|_{2,1}\f$ (TV-L2) or
+ * \f$\mu\|u-f\|_1+\|\nabla u\|_{2,1}\f$ (TV-L1) over an image \f$u\f$ with the algorithm
+ * of Chambolle and Pock. The gradient \f$\nabla\f$ are forward differences with the same
+ * boundary conditions as CGradientOperator, its adjoint is evaluated as a backward-difference
+ * stencil. Neither operator is ever assembled. Each iteration consists of two sweeps over the
+ * columns of the image, which are distributed over threads in contiguous tiles.
+ *
+ * The primal step is taken first, the dual step uses the extrapolation
+ * \f$\bar{u}=\tilde{u}+\theta(\tilde{u}-u)\f$. Optionally, iterates can be over-relaxed, or,
+ * for TV-L2, step sizes can be adapted to the strong convexity of the data term.
+ *
+ */
+template<typename T>
+class CPrimalDualTV {
+
+public:
+
+    /*! \brief Constructor.
+     *
+     * \param[in] f noisy image
+     * \param[in] u initial guess and solution
+     * \param[in] mu weight \f$\mu\f$ of the data term
+     * \param[in] fidelity data term
+     * \param[in] eps tolerance on the primal-dual gap
+     *
+     */
+    CPrimalDualTV(const CDenseArray<T>& f, CDenseArray<T>& u, T mu, FIDELITY fidelity = FIDELITY::L2, double eps = 1e-6);
+
+    //! Deleted standard constructor.
+    CPrimalDualTV() = delete;
+
+    /*! \brief Iterate.
+     *
+     * \param[in] n maximum number of iterations
+     * \param[in] silent no output to the console
+     *
+     */
+    void Iterate(size_t n, bool silent = true);
+
+    //! Sets step sizes \f$\tau\f$ and \f$\sigma\f$, convergence requires \f$\tau\sigma\leq\frac{1}{8}\f$.
+    void SetStepSizes(T tau, T sigma);
+
+    //! Sets relaxation parameter \f$\rho\in(0,2)\f$, over-relaxation for \f$\rho>1\f$.
+    void SetOverRelaxation(T rho);
+
+    /*! \brief Enables accelerated step sizes.
+     *
+     * After each primal step, \f$\theta=(1+2\gamma\tau)^{-\frac{1}{2}}\f$, \f$\tau\leftarrow\theta\tau\f$,
+     * and \f$\sigma\leftarrow\frac{\sigma}{\theta}\f$ with \f$\gamma=\mu\f$. Only valid for TV-L2
+     * and without relaxation.
+     *
+     */
+    void SetAdaptiveStepSizes(bool on);
+
+    //! Access to energy.
+    std::vector<double>& GetTotalError() { return m_total_error; }
+
+    //! Access to primal-dual gap.
+    std::vector<double>& GetConstraintViolation() { return m_constraint_violation; }
+
+private:
+
+    const CDenseArray<T>& m_f;                              //!< noisy image
+    CDenseArray<T>& m_u;                                    //!< solution \f$\tilde{u}\f$
+    CDenseArray<T> m_uprev;                                 //!< relaxed primal iterate \f$u\f$
+    CDenseArray<T> m_px;                                    //!< dual variable, \f$x\f$-component
+    CDenseArray<T> m_py;                                    //!< dual variable, \f$y\f$-component
+    T m_mu;                                                 //!< \f$\mu\f$
+    FIDELITY m_fidelity;                                    //!< data term
+    double m_eps;                                           //!< tolerance
+    T m_tau;                                                //!< primal step size
+    T m_sigma;                                              //!< dual step size
+    T m_theta;                                              //!< extrapolation parameter
+    T m_rho;                                                //!< relaxation parameter
+    bool m_adaptive;                                        //!< flag for accelerated step sizes
+    size_t m_k;
+    std::vector<double> m_total_error;                      //!< energy over time
+    std::vector<double> m_constraint_violation;             //!< primal-dual gap over time
+
+    /*! \brief Relaxes the primal iterate and takes a primal step.
+     *
+     * \returns dual energy of the current dual variable
+     *
+     */
+    double PrimalStep();
+
+    /*! \brief Takes a dual step.
+     *
+     * \returns primal energy of the current primal iterate
+     *
+     */
+    double DualStep();
+
+};
+
+}
+
+#endif /* R4RTV_H_ */
@@ -34,20 +34,6 @@ using namespace std;
 
 namespace R4R {
 
-template <typename T, u_int n>
-CVector<T,n>::CVector() {
-
-    fill_n(m_data,n,0);
-
-}
-
-template <typename T, u_int n>
-CVector<T,n>::CVector(T val) {
-
-    fill_n(m_data,n,val);
-
-}
-
 template <typename T, u_int n>
 CVector<T,n>::CVector(const CDenseVector<T>& x) {
 
@@ -57,16 +43,6 @@ CVector<T,n>::CVector(const CDenseVector<T>& x) {
 
 }
 
-template <typename T, u_int n>
-CVector<T,n>::CVector(initializer_list<T> list) {
-
-    u_int i = 0;
-
-    for(auto it = list.begin(); it!=list.end(); i++, it++)
-        m_data[i] = *it;
-
-}
-
 template<typename T, u_int n>
 bool CVector<T,n>::IsZero() const {
 
@@ -82,40 +58,6 @@ bool CVector<T,n>::IsZero() const {
 }
 
 
-template <typename T, u_int n>
-T& CVector<T,n>::operator ()(u_int i) {
-
-    assert(i<n);
-
-    return m_data[i];
-
-}
-
-template <typename T,u_int n>
-void CVector<T,n>::operator +=(const CVector<T,n>& x) {
-
-    for(u_int i=0; i<n; i++)
-        m_data[i] += x.m_data[i];
-
-}
-
-template <typename T,u_int n>
-void CVector<T,n>::operator*=(const CVector<T,n>& x) {
-
-    for(u_int i=0; i<n; i++)
-        m_data[i] *= x.m_data[i];
-
-}
-
-template <typename T, u_int n>
-T CVector<T,n>::Get(u_int i) const {
-
-    assert(i<n);
-
-    return m_data[i];
-
-}
-
 template <typename T, u_int n>
 double CVector<T,n>::Norm(double p) const {
 
@@ -25,7 +25,10 @@
 #define R4RVECN_H
 
 #include <stdlib.h>
+#include <assert.h>
 #include <iostream>
+#include <algorithm>
+#include <initializer_list>
 
 #ifdef HAVE_EXR
 #include <half.h>
@@ -53,16 +56,16 @@ private:
 public:
 
     //! Constructor.
-    CVector();
+    CVector() { std::fill_n(m_data,n,T(0)); }
 
     //! Constructor.
-    CVector(T val);
+    CVector(T val) { std::fill_n(m_data,n,val); }
 
     //! Constructor.
     CVector(const CDenseVector<T>& x);
 
     //! Initializer list constructor.
-    CVector(std::initializer_list<T> list);
+    CVector(std::initializer_list<T> list) { std::copy(list.begin(),list.begin()+std::min<size_t>(n,list.size()),m_data); }
 
     //! Fast routine for checking whether the vector is zero.
     bool IsZero() const;
@@ -80,16 +83,16 @@ public:
     bool Normalize();
 
     //! Read-write element access.
-    T& operator()(u_int i);
+    T& operator()(u_int i) { assert(i<n); return m_data[i]; }
 
     //! In-place addition.
-    void operator+=(const CVector<T,n>& x);
+    void operator+=(const CVector<T,n>& x) { for(u_int i=0; i<n; i++) m_data[i] += x.m_data[i]; }
 
     //! In-place element-wise multiplication.
-    void operator*=(const CVector<T,n>& x);
+    void operator*=(const CVector<T,n>& x) { for(u_int i=0; i<n; i++) m_data[i] *= x.m_data[i]; }
 
     //! Read element access.
-    T Get(u_int i) const;
+    T Get(u_int i) const { assert(i<n); return m_data[i]; }
 
     //! Writes vector to a stream.
     template <class U,u_int m> friend std::ostream& operator << (std::ostream& os, const CVector<U,m>& x);
@@ -25,6 +25,10 @@
 #include "rect.h"
 #include "interp.h"
 
+#ifdef __POPCNT__
+#include <nmmintrin.h>
+#endif
+
 using namespace cv;
 using namespace std;
 
@@ -85,6 +89,35 @@ bool CIdentityDescriptor::Compute(const Mat &img) {
 
     }
 
+    ApplyNormalization();
+
+    return 0;
+
+}
+
+bool CIdentityDescriptor::Compute(const CPatchBuffer& patches, size_t k) {
+
+    if(m_container.NRows()!=m_container.NCols() || !patches.IsCompatible(m_container.NCols(),false))
+        return 1;
+
+    size_t n = patches.Size();
+    const float* patch = patches.GetIntensity(k);
+
+    for(size_t i=0; i<n; i++) {
+
+        for(size_t j=0; j<n; j++)
+            m_container(i,j) = patch[i*n+j];
+
+    }
+
+    ApplyNormalization();
+
+    return 0;
+
+}
+
+void CIdentityDescriptor::ApplyNormalization() {
+
     switch(m_method) {
 
     case 1:
@@ -101,8 +134,6 @@ bool CIdentityDescriptor::Compute(const Mat &img) {
 
     }
 
-    return 0;
-
 }
 
 void CIdentityDescriptor::Center() {
@@ -154,20 +185,17 @@ CIdentityGradientDescriptor::CIdentityGradientDescriptor(CRectangle<double> roi,
 
 }
 
-bool CIdentityGradientDescriptor::Compute(const Mat &img) {
+template<class Gradient>
+void CIdentityGradientDescriptor::Sample(const Gradient& gradient) {
 
     size_t h = m_container.NRows()/2;
-    double dx = 2.0/(double)(m_container.NCols()-1);
-    double dy = 2.0/(double)(h-1);
 
     for(size_t i=0; i<h; i++) {
 
         for(size_t j=0; j<m_container.NCols(); j++) {
 
-            vec2 pt = m_roi.TransformFrom(-1.0+j*dx,-1.0+i*dy);
-
-            m_container(i,j) = CImageInterpolation::Gradient(img,pt.Get(0),pt.Get(1),0);
-            m_container(h+i,j) = CImageInterpolation::Gradient(img,pt.Get(0),pt.Get(1),1);
+            m_container(i,j) = gradient(i,j,0);
+            m_container(h+i,j) = gradient(i,j,1);
 
         }
 
@@ -176,6 +204,42 @@ bool CIdentityGradientDescriptor::Compute(const Mat &img) {
     if(m_method>0)
         Normalize();
 
+}
+
+bool CIdentityGradientDescriptor::Compute(const Mat &img) {
+
+    // the transformation is affine, so the grid is spanned by two vectors
+    double a[6];
+    CPatchBuffer::Grid(m_roi,m_container.NCols(),a);
+
+    Sample([&img,&a](size_t i, size_t j, bool dir) { return CImageInterpolation::Gradient(img,a[0]+a[1]*j+a[2]*i,a[3]+a[4]*j+a[5]*i,dir); });
+
+    return 0;
+
+}
+
+bool CIdentityGradientDescriptor::Compute(const CGradientCache& cache) {
+
+    double a[6];
+    CPatchBuffer::Grid(m_roi,m_container.NCols(),a);
+
+    Sample([&cache,&a](size_t i, size_t j, bool dir) { return cache.Gradient(a[0]+a[1]*j+a[2]*i,a[3]+a[4]*j+a[5]*i,dir); });
+
+    return 0;
+
+}
+
+bool CIdentityGradientDescriptor::Compute(const CPatchBuffer& patches, size_t k) {
+
+    if(!patches.IsCompatible(m_container.NCols(),true))
+        return 1;
+
+    size_t n = patches.Size();
+    const float* gu = patches.GetGradientU(k);
+    const float* gv = patches.GetGradientV(k);
+
+    Sample([n,gu,gv](size_t i, size_t j, bool dir) { return double(dir ? gu[i*n+j] : gv[i*n+j]); });
+
     return 0;
 
 }
@@ -266,6 +330,37 @@ bool CCurvatureDescriptor::Compute(const Mat &img) {
     // compute gradient field
     CIdentityGradientDescriptor::Compute(img);
 
+    ComputeCurvature();
+
+    return 0;
+
+}
+
+bool CCurvatureDescriptor::Compute(const CGradientCache& cache) {
+
+    // compute gradient field
+    CIdentityGradientDescriptor::Compute(cache);
+
+    ComputeCurvature();
+
+    return 0;
+
+}
+
+bool CCurvatureDescriptor::Compute(const CPatchBuffer& patches, size_t k) {
+
+    // compute gradient field
+    if(CIdentityGradientDescriptor::Compute(patches,k))
+        return 1;
+
+    ComputeCurvature();
+
+    return 0;
+
+}
+
+void CCurvatureDescriptor::ComputeCurvature() {
+
     // normalize
     Normalize();
 
@@ -284,8 +379,6 @@ bool CCurvatureDescriptor::Compute(const Mat &img) {
 
     }
 
-    return 0;
-
 }
 
 double CCurvatureDescriptor::Distance(const CCurvatureDescriptor& desc) const {
@@ -394,6 +487,255 @@ void CBRIEF::PrintSamplePoints() {
 
 }
 
+CBRIEFPattern::CBRIEFPattern(double hsize, size_t norientations):
+    m_norientations(max<size_t>(norientations,1)),
+    m_radius(0),
+    m_offsets(4*BITSET_LENGTH*m_norientations) {
+
+    for(size_t k=0; k<m_norientations; k++) {
+
+        double phi = 2*M_PI*double(k)/double(m_norientations);
+        double cphi = cos(phi);
+        double sphi = sin(phi);
+        float* offsets = &m_offsets[4*BITSET_LENGTH*k];
+
+        for(size_t i=0; i<BITSET_LENGTH; i++) {
+
+            // same transformation as in CRectangle::TransformFrom
+            const vec2& x = CBRIEF::m_pts_0[i];
+            const vec2& y = CBRIEF::m_pts_1[i];
+
+            offsets[4*i] = float(hsize*(cphi*x.Get(0) - sphi*x.Get(1)));
+            offsets[4*i+1] = float(hsize*(sphi*x.Get(0) + cphi*x.Get(1)));
+            offsets[4*i+2] = float(hsize*(cphi*y.Get(0) - sphi*y.Get(1)));
+            offsets[4*i+3] = float(hsize*(sphi*y.Get(0) + cphi*y.Get(1)));
+
+            for(size_t j=0; j<4; j++)
+                m_radius = max(m_radius,float(fabs(offsets[4*i+j])));
+
+        }
+
+    }
+
+}
+
+size_t CBRIEFPattern::GetBin(double phi) const {
+
+    double t = phi/(2*M_PI);
+    t -= floor(t);
+
+    return size_t(t*m_norientations + 0.5)%m_norientations;
+
+}
+
+CPackedBRIEF::CPackedBRIEF(CRectangle<double> roi):
+    m_roi(roi) {
+
+    fill_n(m_bits,BITSET_LENGTH/64,0);
+
+}
+
+/*! \brief Bilinear interpolation of an 8-bit image.
+ *
+ * \details If the sample is known to lie inside the image, bounds checks are skipped. Otherwise,
+ * the image is continued by zero.
+ *
+ */
+template<bool inside>
+static inline float SampleBilinear(const Mat& img, float x, float y) {
+
+    int i = inside ? (int)y : (int)floor(y);
+    int j = inside ? (int)x : (int)floor(x);
+
+    if(!inside && (i<0 || i>=img.rows-1 || j<0 || j>=img.cols-1))
+        return 0;
+
+    float a = x - j;
+    float b = y - i;
+    const uchar* r0 = img.ptr<uchar>(i) + j;
+    const uchar* r1 = img.ptr<uchar>(i+1) + j;
+
+    return (1-b)*((1-a)*r0[0] + a*r0[1]) + b*((1-a)*r1[0] + a*r1[1]);
+
+}
+
+bool CPackedBRIEF::Compute(const Mat& img) {
+
+    if(img.type()!=CV_8UC1) {
+
+        cerr << "ERROR: BRIEF requires an 8-bit gray-scale image." << endl;
+        return 1;
+
+    }
+
+    fill_n(m_bits,BITSET_LENGTH/64,0);
+
+    for(size_t i=0; i<BITSET_LENGTH; i++) {
+
+        vec2 x = m_roi.TransformFrom(CBRIEF::m_pts_0[i]);
+        vec2 y = m_roi.TransformFrom(CBRIEF::m_pts_1[i]);
+
+        if(SampleBilinear<false>(img,y.Get(0),y.Get(1))>SampleBilinear<false>(img,x.Get(0),x.Get(1)))
+            m_bits[i/64] |= uint64_t(1)<<(i%64);
+
+    }
+
+    return 0;
+
+}
+
+void CPackedBRIEF::Compute(const Mat& img, const CBRIEFPattern& pattern, const vector<vec2f>& locations, vector<shared_ptr<CPackedBRIEF> >& descriptors, double sigma, const vector<float>& angles) {
+
+    if(img.type()!=CV_8UC1) {
+
+        cerr << "ERROR: BRIEF requires an 8-bit gray-scale image." << endl;
+        return;
+
+    }
+
+    size_t n = locations.size();
+
+    descriptors.resize(n);
+
+    for(size_t k=0; k<n; k++) {
+
+        if(!descriptors[k])
+            descriptors[k] = shared_ptr<CPackedBRIEF>(new CPackedBRIEF());
+
+    }
+
+    // integer sampling requires smoothing
+    bool integer = sigma>0;
+    Mat smooth;
+
+    if(integer) {
+
+        GaussianBlur(img,smooth,Size(0,0),sigma);
+
+    }
+
+    const Mat& src = integer ? smooth : img;
+
+    // integer offsets into the image buffer
+    vector<int> ioffsets;
+
+    if(integer) {
+
+        ioffsets.resize(2*BITSET_LENGTH*pattern.NOrientations());
+
+        for(size_t b=0; b<pattern.NOrientations(); b++) {
+
+            const float* offsets = pattern.GetOffsets(b);
+
+            for(size_t i=0; i<2*BITSET_LENGTH; i++)
+                ioffsets[2*BITSET_LENGTH*b+i] = cvRound(offsets[2*i+1])*int(src.step) + cvRound(offsets[2*i]);
+
+        }
+
+    }
+
+    int r = int(ceil(pattern.GetRadius())) + 1;
+
+    #pragma omp parallel for
+    for(size_t k=0; k<n; k++) {
+
+        size_t b = angles.size()==n ? pattern.GetBin(angles[k]) : 0;
+        const float* offsets = pattern.GetOffsets(b);
+        float u = locations[k].Get(0);
+        float v = locations[k].Get(1);
+        uint64_t* bits = descriptors[k]->m_bits;
+
+        fill_n(bits,BITSET_LENGTH/64,0);
+
+        // check whether all samples are inside the image
+        int cj = cvRound(u);
+        int ci = cvRound(v);
+        bool inside = cj-r>=0 && cj+r<src.cols-1 && ci-r>=0 && ci+r<src.rows-1;
+
+        if(integer && inside) {
+
+            const uchar* center = src.ptr<uchar>(ci) + cj;
+            const int* io = &ioffsets[2*BITSET_LENGTH*b];
+
+            for(size_t i=0; i<BITSET_LENGTH; i++)
+                bits[i/64] |= uint64_t(center[io[2*i+1]]>center[io[2*i]])<<(i%64);
+
+        }
+        else if(inside) {
+
+            for(size_t i=0; i<BITSET_LENGTH; i++) {
+
+                float I0 = SampleBilinear<true>(src,u+offsets[4*i],v+offsets[4*i+1]);
+                float I1 = SampleBilinear<true>(src,u+offsets[4*i+2],v+offsets[4*i+3]);
+
+                bits[i/64] |= uint64_t(I1>I0)<<(i%64);
+
+            }
+
+        }
+        else {
+
+            for(size_t i=0; i<BITSET_LENGTH; i++) {
+
+                float I0 = SampleBilinear<false>(src,u+offsets[4*i],v+offsets[4*i+1]);
+                float I1 = SampleBilinear<false>(src,u+offsets[4*i+2],v+offsets[4*i+3]);
+
+                bits[i/64] |= uint64_t(I1>I0)<<(i%64);
+
+            }
+
+        }
+
+    }
+
+}
+
+u_int CPackedBRIEF::Distance(const CPackedBRIEF& desc) const {
+
+    u_int result = 0;
+
+    for(size_t i=0; i<BITSET_LENGTH/64; i++) {
+
+#ifdef __POPCNT__
+        result += (u_int)_mm_popcnt_u64(m_bits[i]^desc.m_bits[i]);
+#else
+        result += (u_int)__builtin_popcountll(m_bits[i]^desc.m_bits[i]);
+#endif
+
+    }
+
+    return result;
+
+}
+
+void CPackedBRIEF::Write(ofstream& os) {
+
+    // same format as CDenseArray<size_t>
+    os << NRows() << " " << NCols() << " " << int(GetType()) << endl;
+    os.write((char*)m_bits,sizeof(m_bits));
+
+}
+
+void CPackedBRIEF::Read(ifstream& is) {
+
+    size_t nrows, ncols;
+    int type;
+    is >> nrows;
+    is >> ncols;
+    is >> type;
+    is.get();
+
+    if(nrows*ncols!=NElems() || ETYPE(type)!=GetType()) {
+
+        cerr << "ERROR: Data is not a packed BRIEF descriptor." << endl;
+        return;
+
+    }
+
+    is.read((char*)m_bits,sizeof(m_bits));
+
+}
+
 /*
 CFBDDescriptor::CFBDDescriptor(CRectangle<double> roi, size_t length):
     CNeighborhoodDescriptor(roi),
@@ -28,11 +28,16 @@
 
 #include "types.h"
 #include "feature.h"
+#include "gcache.h"
+#include "patch.h"
 #include <opencv2/opencv.hpp>
 #include <iostream>
 #include <fstream>
 #include <bitset>
 #include <string>
+#include <vector>
+#include <memory>
+#include <stdint.h>
 
 namespace R4R {
 
@@ -143,6 +148,25 @@ public:
     //! Access to the region of interest.
     const Rect& GetRoI() const { return m_roi; }
 
+    using CDescriptor<Array>::Compute;
+
+    /*! \brief Computes the descriptor from the data cached for a pyramid level.
+     *
+     * \details Descriptors that do not need derivatives fall back to the image.
+     *
+     */
+    virtual bool Compute(const CGradientCache& cache) { return this->Compute(cache.GetImage()); }
+
+    /*! \brief Computes the descriptor from a batch of warped patches.
+     *
+     * \param[in] patches patches of all regions of interest at a pyramid level
+     * \param[in] k index of the patch that belongs to this descriptor
+     *
+     * \details Descriptors that do not sample on a regular grid do not support patches.
+     *
+     */
+    virtual bool Compute(const CPatchBuffer& patches, size_t k) { std::cerr << "ERROR: Descriptor cannot be computed from patches." << std::endl; return 1; }
+
 protected:
 
     Rect m_roi;										//!< region of interest
@@ -164,9 +188,14 @@ public:
     //! Constructor.
     CIdentityDescriptor(CRectangle<double> roi, size_t method, size_t hsize = 7);
 
+    using CNeighborhoodDescriptor<CRectangle<double>,matf>::Compute;
+
     //! \copydoc CDescriptor::Compute(cv::Mat&)
     bool Compute(const cv::Mat& img);
 
+    //! \copydoc CNeighborhoodDescriptor::Compute(const CPatchBuffer&,size_t)
+    bool Compute(const CPatchBuffer& patches, size_t k);
+
     //! Normalizes the image patch by subtracting the mean and dividing by the standard deviation.
     void Normalize();
 
@@ -183,6 +212,9 @@ private:
 
     size_t m_method;								//! flag indicating which normalization method to use
 
+    //! Applies the normalization selected by #m_method.
+    void ApplyNormalization();
+
 
 };
 
@@ -196,6 +228,12 @@ public:
     //! \copydoc CDescriptor::Compute(cv::Mat&)
     bool Compute(const cv::Mat& img);
 
+    //! \copydoc CNeighborhoodDescriptor::Compute(const CGradientCache&)
+    bool Compute(const CGradientCache& cache);
+
+    //! \copydoc CNeighborhoodDescriptor::Compute(const CPatchBuffer&,size_t)
+    bool Compute(const CPatchBuffer& patches, size_t k);
+
     /*! \brief Distance between two descriptors.
      *
      * \details Forms the scalar product of the gradient in one descriptor with the dual gradient of the other. If both
@@ -216,6 +254,13 @@ protected:
     //! Weighting function depending on norm of gradient.
     double WeightingFunction(double gnorm);
 
+    /*! \brief Samples a gradient field on the grid of the region of interest.
+     *
+     * \details The functor returns the derivative in a given direction at a pair of grid indices.
+     *
+     */
+    template<class Gradient> void Sample(const Gradient& gradient);
+
     double m_alpha; 								//! normalization threshold
     size_t m_method;								//! flag indicating which normalization method to use
 
@@ -232,6 +277,12 @@ public:
     //! \copydoc CDescriptor::Compute(cv::Mat&)
     bool Compute(const cv::Mat& img);
 
+    //! \copydoc CNeighborhoodDescriptor::Compute(const CGradientCache&)
+    bool Compute(const CGradientCache& cache);
+
+    //! \copydoc CNeighborhoodDescriptor::Compute(const CPatchBuffer&,size_t)
+    bool Compute(const CPatchBuffer& patches, size_t k);
+
     //! Distance between two curvature  descriptors.
     double Distance(const CCurvatureDescriptor& desc) const;
 
@@ -239,6 +290,9 @@ private:
 
     mat m_kappa;                        // container for
 
+    //! Computes the curvature from the normalized gradient field.
+    void ComputeCurvature();
+
 };
 
 
@@ -273,11 +327,16 @@ private:
  */
 class CBRIEF:public CNeighborhoodDescriptor<CRectangle<double>,CDenseVector<bool> > {
 
+    friend class CBRIEFPattern;
+    friend class CPackedBRIEF;
+
 public:
 
     //! Constructor.
     CBRIEF(CRectangle<double> roi);
 
+    using CNeighborhoodDescriptor<CRectangle<double>,CDenseVector<bool> >::Compute;
+
     //! \copydoc CDescriptor::Compute(cv::Mat&)
     bool Compute(const cv::Mat& img);
 
@@ -297,6 +356,104 @@ protected:
 
 };
 
+/*! \brief BRIEF sampling pattern at fixed scale
+ *
+ * \details The sample points of CBRIEF are scaled and rotated once for a set of equidistant
+ * orientations. CBRIEF::GenerateSamplePoints() must have been called before.
+ *
+ */
+class CBRIEFPattern {
+
+public:
+
+    /*! \brief Constructor.
+     *
+     * \param[in] hsize half size of the region of interest
+     * \param[in] norientations number of discrete orientations
+     *
+     */
+    CBRIEFPattern(double hsize, size_t norientations = 1);
+
+    //! Sample offsets \f$(x_0,y_0,x_1,y_1)\f$ of all tests for an orientation bin.
+    const float* GetOffsets(size_t k) const { return &m_offsets[4*BITSET_LENGTH*k]; }
+
+    //! Orientation bin of an angle.
+    size_t GetBin(double phi) const;
+
+    //! Maximal distance of a sample point from the center.
+    float GetRadius() const { return m_radius; }
+
+    //! Number of orientation bins.
+    size_t NOrientations() const { return m_norientations; }
+
+private:
+
+    size_t m_norientations;                 //!< number of orientation bins
+    float m_radius;                         //!< radius of the pattern
+    std::vector<float> m_offsets;           //!< sample offsets
+
+};
+
+/*! \brief bit-packed BRIEF descriptor
+ *
+ * \details Tests are the same as in CBRIEF but the results occupy four 64-bit words, and the
+ * Hamming distance is evaluated by population count. On disk, the descriptor looks like an array
+ * of type \c size_t.
+ *
+ */
+class CPackedBRIEF:public CAbstractDescriptor {
+
+public:
+
+    //! Constructor.
+    CPackedBRIEF(CRectangle<double> roi = CRectangle<double>());
+
+    //! \copydoc CDescriptor::Compute(cv::Mat&)
+    bool Compute(const cv::Mat& img);
+
+    /*! \brief Computes descriptors for all features in an image.
+     *
+     * \param[in] img 8-bit gray-scale image
+     * \param[in] pattern sampling pattern matching the scale of the image
+     * \param[in] locations feature locations
+     * \param[out] descriptors result, allocated if necessary
+     * \param[in] sigma if positive, the image is smoothed and sampled at integer locations instead of bilinear interpolation
+     * \param[in] angles feature orientations, if empty all features are assumed upright
+     *
+     */
+    static void Compute(const cv::Mat& img, const CBRIEFPattern& pattern, const std::vector<vec2f>& locations, std::vector<std::shared_ptr<CPackedBRIEF> >& descriptors, double sigma = 0, const std::vector<float>& angles = std::vector<float>());
+
+    //! Hamming distance between two BRIEF descriptors.
+    u_int Distance(const CPackedBRIEF& desc) const;
+
+    //! \copydoc CAbstractDescriptor::Write(std::ofstream&)
+    void Write(std::ofstream& os);
+
+    //! \copydoc CAbstractDescriptor::Read(std::ifstream&)
+    void Read(std::ifstream& is);
+
+    //! \copydoc CAbstractDescriptor::NRows()
+    size_t NRows() { return BITSET_LENGTH/64; }
+
+    //! \copydoc CAbstractDescriptor::NCols()
+    size_t NCols() { return 1; }
+
+    //! \copydoc CAbstractDescriptor::NElems()
+    size_t NElems() { return BITSET_LENGTH/64; }
+
+    //! \copydoc CAbstractDescriptor::GetType()
+    ETYPE GetType() { return ETYPE::L8U; }
+
+    //! \copydoc CAbstractDescriptor::GetData()
+    void* GetData() { return m_bits; }
+
+protected:
+
+    CRectangle<double> m_roi;                       //!< region of interest
+    uint64_t m_bits[BITSET_LENGTH/64];              //!< test results
+
+};
+
 
 }
 
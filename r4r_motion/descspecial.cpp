@@ -25,69 +25,117 @@
 #include "interp.h"
 
 #include <limits>
+#include <iostream>
 
 using namespace cv;
+using namespace std;
 
 namespace R4R {
 
-#ifdef HAVE_FFTW
-
 CFourierModulusDescriptor::CFourierModulusDescriptor(CRectangle<double> roi, size_t hsize):
     CNeighborhoodDescriptor(mat(2*hsize+1,2*hsize+1),roi) {}
 
-
-bool CFourierModulusDescriptor::Compute(const Mat &img) {
-
-    fftw_complex* fft = (fftw_complex*)fftw_malloc(sizeof(fftw_complex)*m_container.NElems());
-
-    double dx = 2.0/(double)(m_container.NCols()-1);
-    double dy = 2.0/(double)(m_container.NRows()-1);
+template<class Intensity>
+void CFourierModulusDescriptor::Sample(const Intensity& intensity, complex<double>* fft) const {
 
     for(size_t i=0; i<m_container.NRows(); i++) {
 
         for(size_t j=0; j<m_container.NCols(); j++) {
 
-            vec2 pt = m_roi.TransformFrom(-1.0+j*dx,-1.0+i*dy);
-
             // row major
-            fft[i*m_container.NCols() + j][0] = CImageInterpolation::Bilinear(img,pt.Get(0),pt.Get(1));
-            fft[i*m_container.NCols() + j][1] = 0;
+            fft[i*m_container.NCols() + j] = complex<double>(intensity(i,j),0);
 
         }
 
     }
 
-    // create plan
-    fftw_plan p = fftw_plan_dft_2d(m_container.NRows(),
-                                   m_container.NCols(),
-                                   fft,
-                                   fft,
-                                   FFTW_FORWARD,
-                                   FFTW_ESTIMATE);
+}
 
-    // run it
-    fftw_execute(p);
+void CFourierModulusDescriptor::Modulus(const complex<double>* fft) {
 
-    // compute the modulus
     for(size_t i=0; i<m_container.NRows(); i++) {
 
-        for(size_t j=0; j<m_container.NCols(); j++) {
+        for(size_t j=0; j<m_container.NCols(); j++)
+            m_container(i,j) = abs(fft[i*m_container.NCols() + j]);
 
-            m_container(i,j) = sqrt(fft[i*m_container.NCols() + j][0]*fft[i*m_container.NCols() + j][0]+fft[i*m_container.NCols() + j][1]*fft[i*m_container.NCols() + j][1]);
+    }
 
-        }
+}
 
-    }
+bool CFourierModulusDescriptor::Compute(const Mat &img) {
+
+    double a[6];
+    CPatchBuffer::Grid(m_roi,m_container.NCols(),a);
+
+    complex<double>* fft = CFourierPlanCache::Scratch(m_container.NElems());
+
+    Sample([&img,&a](size_t i, size_t j) { return CImageInterpolation::Bilinear(img,a[0]+a[1]*j+a[2]*i,a[3]+a[4]*j+a[5]*i); },fft);
+
+    CFourierPlanCache::Transform(fft,m_container.NRows(),m_container.NCols());
+
+    Modulus(fft);
+
+    return 0;
+
+}
 
-    // tidy up
-    fftw_destroy_plan(p);
-    fftw_free(fft);
+bool CFourierModulusDescriptor::Compute(const CPatchBuffer& patches, size_t k) {
+
+    if(!patches.IsCompatible(m_container.NCols(),false))
+        return 1;
+
+    size_t n = patches.Size();
+    const float* patch = patches.GetIntensity(k);
+    complex<double>* fft = CFourierPlanCache::Scratch(m_container.NElems());
+
+    Sample([n,patch](size_t i, size_t j) { return double(patch[i*n+j]); },fft);
+
+    CFourierPlanCache::Transform(fft,n,n);
+
+    Modulus(fft);
 
     return 0;
 
 }
 
-#endif
+bool CFourierModulusDescriptor::Compute(const CPatchBuffer& patches, vector<shared_ptr<CFourierModulusDescriptor> >& descriptors) {
+
+    if(descriptors.size()!=patches.NPatches()) {
+
+        cerr << "ERROR: Number of descriptors and patches does not match." << endl;
+        return 1;
+
+    }
+
+    for(size_t k=0; k<descriptors.size(); k++) {
+
+        if(!patches.IsCompatible(descriptors[k]->m_container.NCols(),false))
+            return 1;
+
+    }
+
+    size_t n = patches.Size();
+    size_t n2 = n*n;
+    complex<double>* fft = CFourierPlanCache::Scratch(n2*descriptors.size());
+
+    #pragma omp parallel for
+    for(int k=0; k<int(descriptors.size()); k++) {
+
+        const float* patch = patches.GetIntensity(k);
+        descriptors[k]->Sample([n,patch](size_t i, size_t j) { return double(patch[i*n+j]); },fft+k*n2);
+
+    }
+
+    // all patches of the frame at once
+    CFourierPlanCache::Transform(fft,n,n,descriptors.size());
+
+    #pragma omp parallel for
+    for(int k=0; k<int(descriptors.size()); k++)
+        descriptors[k]->Modulus(fft+k*n2);
+
+    return 0;
+
+}
 
 CHistogramOfGradients::CHistogramOfGradients(CRectangle<double> roi):
     CNeighborhoodDescriptor(vecf(81),roi),
@@ -109,11 +157,11 @@ CHistogramOfGradients::CHistogramOfGradients(CRectangle<double> roi, size_t no_c
 
 }
 
-bool CHistogramOfGradients::Compute(const Mat &img) {
+template<class Gradient>
+void CHistogramOfGradients::Accumulate(const Gradient& gradient) {
 
     // number of pixels in patch
     size_t n = m_no_cells*m_cell_size;
-    double h = 2.0/(double)(n-1);
 
     // size of histogram bins
     double ho = 0;
@@ -127,27 +175,24 @@ bool CHistogramOfGradients::Compute(const Mat &img) {
 
         for(size_t j=0; j<n; j++) {
 
-            // interpolate point
-            vec2 pt = m_roi.TransformFrom(-1.0+j*h,-1.0+i*h);
-
-            // compute gradient
+            // compute gradient, the flag selects the derivative w.r.t. the column index
             double Ix, Iy;
-            Ix = CImageInterpolation::Gradient(img,pt.Get(0),pt.Get(1),0);
-            Iy = CImageInterpolation::Gradient(img,pt.Get(0),pt.Get(1),1);
+            Ix = gradient(i,j,1);
+            Iy = gradient(i,j,0);
 
-            // compute signed/unsigned orientation
-            double ograd = 0;
+            // compute signed/unsigned orientation, quantized as in CGradientCache
+            double ograd = atan2(Iy,Ix);
 
             if(m_osigned)
-                ograd = atan2(Iy,Ix) + M_PI;
-            else
-                ograd = fabs(atan2(Iy,Ix));
+                ograd += M_PI;
+            else if(ograd<0)
+                ograd += M_PI;
 
             // compute the bin
-            size_t bin = (size_t)ograd/ho;
+            size_t bin = (size_t)(ograd/ho);
 
-            // 2pi ~ 0, pi ~ -pi
-            if(bin==m_container.NElems())
+            // 2pi ~ 0, pi ~ 0
+            if(bin>=m_no_bins)
                 bin = 0;
 
             // get the cell index
@@ -163,10 +208,135 @@ bool CHistogramOfGradients::Compute(const Mat &img) {
 
     }
 
+}
+
+bool CHistogramOfGradients::Compute(const Mat &img) {
+
+    // the transformation is affine, so the grid is spanned by two vectors
+    double a[6];
+    CPatchBuffer::Grid(m_roi,m_no_cells*m_cell_size,a);
+
+    Accumulate([&img,&a](size_t i, size_t j, bool dir) { return CImageInterpolation::Gradient(img,a[0]+a[1]*j+a[2]*i,a[3]+a[4]*j+a[5]*i,dir); });
+
+    return 0;
+
+}
+
+bool CHistogramOfGradients::Compute(const CGradientCache& cache) {
+
+    double a[6];
+    CPatchBuffer::Grid(m_roi,m_no_cells*m_cell_size,a);
+
+    Accumulate([&cache,&a](size_t i, size_t j, bool dir) { return cache.Gradient(a[0]+a[1]*j+a[2]*i,a[3]+a[4]*j+a[5]*i,dir); });
+
+    return 0;
+
+}
+
+bool CHistogramOfGradients::Compute(const CPatchBuffer& patches, size_t k) {
+
+    if(!patches.IsCompatible(m_no_cells*m_cell_size,true))
+        return 1;
+
+    size_t n = patches.Size();
+    const float* gu = patches.GetGradientU(k);
+    const float* gv = patches.GetGradientV(k);
+
+    Accumulate([n,gu,gv](size_t i, size_t j, bool dir) { return double(dir ? gu[i*n+j] : gv[i*n+j]); });
+
+    return 0;
+
+}
+
+bool CHistogramOfGradients::ComputeIntegral(const CGradientCache& cache) {
+
+    if(!cache.HasIntegralHistograms() || cache.NBins()!=m_no_bins || cache.IsSigned()!=m_osigned)
+        return Compute(cache);
+
+    // axis-aligned bounding box of the region, rotation is ignored
+    size_t n = m_no_cells*m_cell_size;
+    vec2 c = m_roi.Barycenter();
+    double hu = n>1 ? m_roi.Width()/double(n-1) : 0;
+    double hv = n>1 ? m_roi.Height()/double(n-1) : 0;
+    double u0 = c.Get(0) - 0.5*m_roi.Width();
+    double v0 = c.Get(1) - 0.5*m_roi.Height();
+
+    vector<double> hist(m_no_bins);
+
+    // cells extend half a grid spacing beyond their outermost samples
+    for(size_t I=0; I<m_no_cells; I++) {
+
+        int i0 = (int)floor(v0 + (I*m_cell_size - 0.5)*hv + 0.5);
+        int i1 = (int)floor(v0 + ((I+1)*m_cell_size - 0.5)*hv + 0.5);
+
+        for(size_t J=0; J<m_no_cells; J++) {
+
+            int j0 = (int)floor(u0 + (J*m_cell_size - 0.5)*hu + 0.5);
+            int j1 = (int)floor(u0 + ((J+1)*m_cell_size - 0.5)*hu + 0.5);
+
+            cache.Histogram(i0,j0,i1,j1,&hist[0]);
+
+            // the sampled descriptor sees m_cell_size^2 points per cell
+            double area = double(i1-i0)*double(j1-j0);
+            double weight = area>0 ? double(m_cell_size*m_cell_size)/area : 0;
+
+            size_t cindex = (J*m_no_cells + I)*(m_no_bins);
+
+            for(size_t b=0; b<m_no_bins; b++)
+                m_container(cindex+b) = float(weight*hist[b]);
+
+        }
+
+    }
+
     return 0;
 
 }
 
+size_t CHistogramOfGradients::ComputeDense(const CGradientCache& cache, size_t cell_size, size_t stride, matf& cells) {
+
+    if(!cache.HasIntegralHistograms()) {
+
+        cerr << "ERROR: Dense HoG requires integral histograms." << endl;
+        return 0;
+
+    }
+
+    int rows = cache.GetMagnitude().rows;
+    int cols = cache.GetMagnitude().cols;
+
+    if(cell_size==0 || stride==0 || int(cell_size)>rows || int(cell_size)>cols)
+        return 0;
+
+    size_t nrows = (rows - cell_size)/stride + 1;
+    size_t ncols = (cols - cell_size)/stride + 1;
+    size_t nbins = cache.NBins();
+
+    cells = matf(nrows*ncols,nbins);
+
+    #pragma omp parallel for
+    for(int r=0; r<int(nrows); r++) {
+
+        vector<double> hist(nbins);
+
+        for(size_t c=0; c<ncols; c++) {
+
+            int i0 = r*stride;
+            int j0 = c*stride;
+
+            cache.Histogram(i0,j0,i0+cell_size,j0+cell_size,&hist[0]);
+
+            for(size_t b=0; b<nbins; b++)
+                cells(r*ncols+c,b) = float(hist[b]);
+
+        }
+
+    }
+
+    return ncols;
+
+}
+
 void CHistogramOfGradients::Normalize(size_t method, double alpha) {
 
     float weight;
@@ -191,29 +361,19 @@ void CHistogramOfGradients::Normalize(size_t method, double alpha) {
 }
 
 
-#ifdef HAVE_FFTW
-
 CFMHoGDescriptor::CFMHoGDescriptor(CRectangle<double> roi, size_t hsize, size_t nbins):
     CNeighborhoodDescriptor(vecf(nbins),roi),
     m_hsize(hsize),
     m_no_bins(nbins) {}
 
-bool CFMHoGDescriptor::Compute(const Mat &img) {
-
-    // allocate space for histogram
-    fftw_complex* fft = (fftw_complex*)fftw_malloc(sizeof(fftw_complex)*m_container.NElems());
+template<class Gradient>
+void CFMHoGDescriptor::Accumulate(const Gradient& gradient, complex<double>* fft) const {
 
     // clear bins
-    for(size_t i=0; i<m_container.NElems(); i++) {
-
-        fft[i][0] = 0;
-        fft[i][1] = 0;
-
-    }
+    fill_n(fft,m_container.NElems(),complex<double>(0,0));
 
     // full patch sidelength
     size_t n = 2*m_hsize+1;
-    double h = 2.0/(double)(n-1);
 
     // size of each histogram bin
     double ho = 2*M_PI/(double)m_no_bins;
@@ -223,13 +383,10 @@ bool CFMHoGDescriptor::Compute(const Mat &img) {
 
         for(size_t j=0; j<n; j++) {
 
-            // interpolate point
-            vec2 pt = m_roi.TransformFrom(-1.0+j*h,-1.0+i*h);
-
             // compute gradient
             double Ix, Iy;
-            Ix = CImageInterpolation::Gradient(img,pt.Get(0),pt.Get(1),0);
-            Iy = CImageInterpolation::Gradient(img,pt.Get(0),pt.Get(1),1);
+            Ix = gradient(i,j,0);
+            Iy = gradient(i,j,1);
 
             // compute signed orientation
             double ograd = atan2(Iy,Ix) + M_PI;
@@ -245,35 +402,128 @@ bool CFMHoGDescriptor::Compute(const Mat &img) {
             double norm = sqrt(Ix*Ix+Iy*Iy);
 
             if(norm>numeric_limits<double>::epsilon())
-                fft[bin][0]  += sqrt(Ix*Ix+Iy*Iy);
+                fft[bin] += norm;
 
         }
 
     }
 
-    // compute fft
-    fftw_plan p = fftw_plan_dft_1d(m_container.NElems(),
-                                   fft,
-                                   fft,
-                                   FFTW_FORWARD,
-                                   FFTW_ESTIMATE);
+}
 
-    fftw_execute(p);
+void CFMHoGDescriptor::Modulus(const complex<double>* fft) {
 
-    // compute modulus
     for(size_t i=0; i<m_container.NElems(); i++)
-        m_container(i) = (float)sqrt(fft[i][0]*fft[i][0]+fft[i][1]*fft[i][1]);
+        m_container(i) = (float)abs(fft[i]);
 
     m_container.Normalize();
 
-    // tidy up
-    fftw_destroy_plan(p);
-    fftw_free(fft);
+}
+
+bool CFMHoGDescriptor::Compute(const Mat &img) {
+
+    // the transformation is affine, so the grid is spanned by two vectors
+    double a[6];
+    CPatchBuffer::Grid(m_roi,2*m_hsize+1,a);
+
+    complex<double>* fft = CFourierPlanCache::Scratch(m_container.NElems());
+
+    Accumulate([&img,&a](size_t i, size_t j, bool dir) { return CImageInterpolation::Gradient(img,a[0]+a[1]*j+a[2]*i,a[3]+a[4]*j+a[5]*i,dir); },fft);
+
+    CFourierPlanCache::Transform(fft,1,m_container.NElems());
+
+    Modulus(fft);
+
+    return 0;
+
+}
+
+bool CFMHoGDescriptor::Compute(const CGradientCache& cache) {
+
+    double a[6];
+    CPatchBuffer::Grid(m_roi,2*m_hsize+1,a);
+
+    complex<double>* fft = CFourierPlanCache::Scratch(m_container.NElems());
+
+    Accumulate([&cache,&a](size_t i, size_t j, bool dir) { return cache.Gradient(a[0]+a[1]*j+a[2]*i,a[3]+a[4]*j+a[5]*i,dir); },fft);
+
+    CFourierPlanCache::Transform(fft,1,m_container.NElems());
+
+    Modulus(fft);
+
+    return 0;
+
+}
+
+bool CFMHoGDescriptor::Compute(const CPatchBuffer& patches, size_t k) {
+
+    if(!patches.IsCompatible(2*m_hsize+1,true))
+        return 1;
+
+    size_t n = patches.Size();
+    const float* gu = patches.GetGradientU(k);
+    const float* gv = patches.GetGradientV(k);
+    complex<double>* fft = CFourierPlanCache::Scratch(m_container.NElems());
+
+    Accumulate([n,gu,gv](size_t i, size_t j, bool dir) { return double(dir ? gu[i*n+j] : gv[i*n+j]); },fft);
+
+    CFourierPlanCache::Transform(fft,1,m_container.NElems());
+
+    Modulus(fft);
 
     return 0;
 
 }
 
-#endif
+bool CFMHoGDescriptor::Compute(const CPatchBuffer& patches, vector<shared_ptr<CFMHoGDescriptor> >& descriptors) {
+
+    if(descriptors.size()!=patches.NPatches()) {
+
+        cerr << "ERROR: Number of descriptors and patches does not match." << endl;
+        return 1;
+
+    }
+
+    if(descriptors.size()==0)
+        return 0;
+
+    // batched transforms require histograms of equal length
+    size_t nbins = descriptors[0]->m_no_bins;
+
+    for(size_t k=0; k<descriptors.size(); k++) {
+
+        if(!patches.IsCompatible(2*descriptors[k]->m_hsize+1,true))
+            return 1;
+
+        if(descriptors[k]->m_no_bins!=nbins) {
+
+            cerr << "ERROR: Descriptors in a batch must have the same number of bins." << endl;
+            return 1;
+
+        }
+
+    }
+
+    size_t n = patches.Size();
+    complex<double>* fft = CFourierPlanCache::Scratch(nbins*descriptors.size());
+
+    #pragma omp parallel for
+    for(int k=0; k<int(descriptors.size()); k++) {
+
+        const float* gu = patches.GetGradientU(k);
+        const float* gv = patches.GetGradientV(k);
+        descriptors[k]->Accumulate([n,gu,gv](size_t i, size_t j, bool dir) { return double(dir ? gu[i*n+j] : gv[i*n+j]); },fft+k*nbins);
+
+    }
+
+    // all histograms of the frame at once
+    CFourierPlanCache::Transform(fft,1,nbins,descriptors.size());
+
+    #pragma omp parallel for
+    for(int k=0; k<int(descriptors.size()); k++)
+        descriptors[k]->Modulus(fft+k*nbins);
+
+    return 0;
+
+}
 
 }
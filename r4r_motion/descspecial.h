@@ -24,21 +24,18 @@
 #ifndef R4RDESCSPECIAL_H
 #define R4RDESCSPECIAL_H
 
-#ifdef HAVE_FFTW
-#include <fftw3.h>
-#endif // HAVE_FFTW
+#include <complex>
 
 #include "descriptor.h"
 #include "rect.h"
+#include "fft.h"
 
 
 namespace R4R {
 
-#ifdef HAVE_FFTW
-
 /*! \brief modulus of the FFT of the patch
  *
- *
+ * \details Transforms are planned once and shared, see CFourierPlanCache.
  *
  */
 class CFourierModulusDescriptor:public CNeighborhoodDescriptor<CRectangle<double>,mat> {
@@ -48,12 +45,31 @@ public:
     //! Constructor.
     CFourierModulusDescriptor(CRectangle<double> roi, size_t hsize);
 
+    using CNeighborhoodDescriptor<CRectangle<double>,mat>::Compute;
+
     //! \copydoc CDescriptor::Compute(cv::Mat&)
     bool Compute(const cv::Mat& img);
 
-};
+    //! \copydoc CNeighborhoodDescriptor::Compute(const CPatchBuffer&,size_t)
+    bool Compute(const CPatchBuffer& patches, size_t k);
+
+    /*! \brief Computes the descriptors of all patches at once.
+     *
+     * \param[in] patches patches of all regions of interest at a pyramid level
+     * \param[in,out] descriptors one constructed descriptor per patch
+     *
+     */
+    static bool Compute(const CPatchBuffer& patches, std::vector<std::shared_ptr<CFourierModulusDescriptor> >& descriptors);
 
-#endif // HAVE_FFTW
+private:
+
+    //! Copies the intensity sampled on the grid of the region of interest into a transform buffer.
+    template<class Intensity> void Sample(const Intensity& intensity, std::complex<double>* fft) const;
+
+    //! Stores the modulus of the transform.
+    void Modulus(const std::complex<double>* fft);
+
+};
 
 class CHistogramOfGradients:public CNeighborhoodDescriptor<CRectangle<double>,vecf> {
 
@@ -68,6 +84,34 @@ public:
     //! \copydoc CDescriptor::Compute(cv::Mat&)
     bool Compute(const cv::Mat& img);
 
+    //! \copydoc CNeighborhoodDescriptor::Compute(const CGradientCache&)
+    bool Compute(const CGradientCache& cache);
+
+    //! \copydoc CNeighborhoodDescriptor::Compute(const CPatchBuffer&,size_t)
+    bool Compute(const CPatchBuffer& patches, size_t k);
+
+    /*! \brief Computes the descriptor from integral orientation histograms.
+     *
+     * \details Each cell is approximated by an axis-aligned rectangle, i.e., the rotation of the
+     * region of interest is ignored, and its histogram is obtained from four lookups per bin.
+     * Orientations are quantized as in CGradientCache, and the magnitudes are rescaled to the
+     * sampling density of #Compute(const cv::Mat&). If the cache does not provide integral
+     * histograms with matching bins, the descriptor is sampled instead.
+     *
+     */
+    bool ComputeIntegral(const CGradientCache& cache);
+
+    /*! \brief Computes cell histograms on a dense grid over an entire image.
+     *
+     * \param[in] cache gradient cache with integral histograms
+     * \param[in] cell_size number of pixels in each cell (per dimension)
+     * \param[in] stride distance between neighboring cells in pixels
+     * \param[out] cells one row per cell in row-major grid order, one column per bin
+     * \returns number of cells per grid row, zero if the grid is empty
+     *
+     */
+    static size_t ComputeDense(const CGradientCache& cache, size_t cell_size, size_t stride, matf& cells);
+
     //! Normalize.
     void Normalize(size_t method, double alpha);
 
@@ -79,11 +123,17 @@ private:
     bool m_osigned;                 //! flag indicating whether orientations are treated as signed or unsigned
     double m_sigma;                 //! variance of Gaussian windowing function, if zero no windowing is performed
 
-};
+    //! Accumulates a gradient field, given at pairs of grid indices, into the histograms.
+    template<class Gradient> void Accumulate(const Gradient& gradient);
 
+};
 
-#ifdef HAVE_FFTW
 
+/*! \brief modulus of the FFT of a signed orientation histogram
+ *
+ * \details Transforms are planned once and shared, see CFourierPlanCache.
+ *
+ */
 class CFMHoGDescriptor:public CNeighborhoodDescriptor<CRectangle<double>,vecf> {
 
 public:
@@ -94,14 +144,32 @@ public:
     //! \copydoc CDescriptor::Compute(cv::Mat&)
     bool Compute(const cv::Mat& img);
 
+    //! \copydoc CNeighborhoodDescriptor::Compute(const CGradientCache&)
+    bool Compute(const CGradientCache& cache);
+
+    //! \copydoc CNeighborhoodDescriptor::Compute(const CPatchBuffer&,size_t)
+    bool Compute(const CPatchBuffer& patches, size_t k);
+
+    /*! \brief Computes the descriptors of all patches at once.
+     *
+     * \param[in] patches patches of all regions of interest at a pyramid level, with derivatives
+     * \param[in,out] descriptors one constructed descriptor per patch, all with the same number of bins
+     *
+     */
+    static bool Compute(const CPatchBuffer& patches, std::vector<std::shared_ptr<CFMHoGDescriptor> >& descriptors);
+
 private:
 
     size_t m_hsize;                 //! size of the neighboorhood in which the descriptor is computed
     size_t m_no_bins;               //! number of histogram bins
 
-};
+    //! Bins a gradient field given at pairs of grid indices into a transform buffer.
+    template<class Gradient> void Accumulate(const Gradient& gradient, std::complex<double>* fft) const;
 
-#endif // HAVE_FFTW
+    //! Stores the normalized modulus of the transform.
+    void Modulus(const std::complex<double>* fft);
+
+};
 
 
 
@@ -0,0 +1,330 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "fast.h"
+
+#include <iostream>
+#include <algorithm>
+
+#ifdef __SSE4_1__
+#include <smmintrin.h>
+#endif
+
+using namespace std;
+using namespace cv;
+
+namespace R4R {
+
+//! Bresenham circle of radius 3 as column and row offsets, clockwise starting at the top.
+static const int FAST_CIRCLE[16][2] = { {0,-3}, {1,-3}, {2,-2}, {3,-1}, {3,0}, {3,1}, {2,2}, {1,3},
+                                        {0,3}, {-1,3}, {-2,2}, {-3,1}, {-3,0}, {-3,-1}, {-2,-2}, {-1,-3} };
+
+//! Number of rows processed by one thread at a time.
+static const int FAST_BAND = 32;
+
+CFASTDetector::CFASTDetector(int threshold, size_t arc):
+    m_threshold(threshold),
+    m_arc(arc),
+    m_scores(),
+    m_offsets(16) {
+
+    if(arc<9 || arc>12) {
+
+        cerr << "ERROR: Arc length must be between 9 and 12, using FAST-9." << endl;
+        m_arc = 9;
+
+    }
+
+}
+
+void CFASTDetector::ComputeOffsets(size_t step) {
+
+    for(size_t k=0; k<16; k++)
+        m_offsets[k] = FAST_CIRCLE[k][1]*int(step) + FAST_CIRCLE[k][0];
+
+}
+
+int CFASTDetector::Score(const uchar* p) const {
+
+    int t = min(max(m_threshold,0),255);
+    int hi = int(p[0]) + t;
+    int lo = int(p[0]) - t;
+
+    int v[16];
+    for(size_t k=0; k<16; k++)
+        v[k] = p[m_offsets[k]];
+
+    // segment test, the circle is traversed beyond its end to find arcs across the start
+    int nb = 0, nd = 0;
+    bool corner = false;
+
+    for(size_t k=0; k<16+m_arc-1 && !corner; k++) {
+
+        int x = v[k%16];
+
+        nb = x>hi ? nb + 1 : 0;
+        nd = x<lo ? nd + 1 : 0;
+
+        corner = size_t(nb)>=m_arc || size_t(nd)>=m_arc;
+
+    }
+
+    if(!corner)
+        return 0;
+
+    int sb = 0, sd = 0;
+
+    for(size_t k=0; k<16; k++) {
+
+        if(v[k]>hi)
+            sb += v[k] - hi;
+        else if(v[k]<lo)
+            sd += lo - v[k];
+
+    }
+
+    return max(sb,sd);
+
+}
+
+bool CFASTDetector::Detect(const Mat& img, vector<vec2f>& locations, vector<float>& responses) {
+
+    locations.clear();
+    responses.clear();
+
+    if(img.type()!=CV_8UC1) {
+
+        cerr << "ERROR: FAST requires an 8-bit gray-scale image." << endl;
+        return 1;
+
+    }
+
+    int height = img.rows;
+    int width = img.cols;
+
+    if(height<7 || width<7)
+        return 0;
+
+    ComputeOffsets(img.step);
+    m_scores.resize(size_t(width)*size_t(height));
+
+    int nbands = (height + FAST_BAND - 1)/FAST_BAND;
+
+    // segment test on row bands
+    #pragma omp parallel for
+    for(int b=0; b<nbands; b++) {
+
+#ifdef __SSE4_1__
+        int t = min(max(m_threshold,0),255);
+        const __m128i sign = _mm_set1_epi8((char)0x80);
+        const __m128i tv = _mm_set1_epi8((char)t);
+        const __m128i arc = _mm_set1_epi8((char)(m_arc-1));
+#endif
+
+        for(int i=b*FAST_BAND; i<min(height,(b+1)*FAST_BAND); i++) {
+
+            int* scores = &m_scores[size_t(i)*width];
+
+            fill_n(scores,width,0);
+
+            if(i<3 || i>=height-3)
+                continue;
+
+            const uchar* row = img.ptr<uchar>(i);
+            int j = 3;
+
+#ifdef __SSE4_1__
+            for(; j+16<=width-3; j+=16) {
+
+                const uchar* p = row + j;
+
+                __m128i c = _mm_loadu_si128((const __m128i*)p);
+                __m128i hi = _mm_xor_si128(_mm_adds_epu8(c,tv),sign);
+                __m128i lo = _mm_xor_si128(_mm_subs_epu8(c,tv),sign);
+
+                // an arc of at least nine pixels covers two neighboring compass points
+                __m128i x0 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(p+m_offsets[0])),sign);
+                __m128i x1 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(p+m_offsets[4])),sign);
+                __m128i x2 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(p+m_offsets[8])),sign);
+                __m128i x3 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(p+m_offsets[12])),sign);
+
+                __m128i b0 = _mm_cmpgt_epi8(x0,hi), b1 = _mm_cmpgt_epi8(x1,hi), b2 = _mm_cmpgt_epi8(x2,hi), b3 = _mm_cmpgt_epi8(x3,hi);
+                __m128i d0 = _mm_cmplt_epi8(x0,lo), d1 = _mm_cmplt_epi8(x1,lo), d2 = _mm_cmplt_epi8(x2,lo), d3 = _mm_cmplt_epi8(x3,lo);
+
+                __m128i mb = _mm_or_si128(_mm_or_si128(_mm_and_si128(b0,b1),_mm_and_si128(b1,b2)),_mm_or_si128(_mm_and_si128(b2,b3),_mm_and_si128(b3,b0)));
+                __m128i md = _mm_or_si128(_mm_or_si128(_mm_and_si128(d0,d1),_mm_and_si128(d1,d2)),_mm_or_si128(_mm_and_si128(d2,d3),_mm_and_si128(d3,d0)));
+
+                if(!_mm_movemask_epi8(_mm_or_si128(mb,md)))
+                    continue;
+
+                // lengths of the current and the longest arcs of brighter and darker pixels
+                __m128i cb = _mm_setzero_si128(), cd = _mm_setzero_si128();
+                __m128i lb = _mm_setzero_si128(), ld = _mm_setzero_si128();
+
+                for(size_t k=0; k<16+m_arc-1; k++) {
+
+                    __m128i x = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(p+m_offsets[k%16])),sign);
+                    __m128i bk = _mm_cmpgt_epi8(x,hi);
+                    __m128i dk = _mm_cmplt_epi8(x,lo);
+
+                    // masks are -1 where the test succeeds, so subtraction increments and the mask resets
+                    cb = _mm_and_si128(_mm_sub_epi8(cb,bk),bk);
+                    cd = _mm_and_si128(_mm_sub_epi8(cd,dk),dk);
+                    lb = _mm_max_epu8(lb,cb);
+                    ld = _mm_max_epu8(ld,cd);
+
+                }
+
+                int mask = _mm_movemask_epi8(_mm_cmpgt_epi8(_mm_max_epu8(lb,ld),arc));
+
+                while(mask) {
+
+                    int l = __builtin_ctz(mask);
+                    scores[j+l] = Score(p+l);
+                    mask &= mask - 1;
+
+                }
+
+            }
+#endif
+
+            for(; j<width-3; j++)
+                scores[j] = Score(row+j);
+
+        }
+
+    }
+
+    // non-maximum suppression, ties are resolved in favor of the first pixel in row-major order
+    vector<vector<vec2f> > blocations(nbands);
+    vector<vector<float> > bresponses(nbands);
+
+    #pragma omp parallel for
+    for(int b=0; b<nbands; b++) {
+
+        for(int i=max(3,b*FAST_BAND); i<min(height-3,(b+1)*FAST_BAND); i++) {
+
+            const int* r0 = &m_scores[size_t(i-1)*width];
+            const int* r1 = &m_scores[size_t(i)*width];
+            const int* r2 = &m_scores[size_t(i+1)*width];
+
+            for(int j=3; j<width-3; j++) {
+
+                int s = r1[j];
+
+                if(s==0)
+                    continue;
+
+                if(s>r0[j-1] && s>r0[j] && s>r0[j+1] && s>r1[j-1] &&
+                   s>=r1[j+1] && s>=r2[j-1] && s>=r2[j] && s>=r2[j+1]) {
+
+                    vec2f x = { float(j), float(i) };
+                    blocations[b].push_back(x);
+                    bresponses[b].push_back(float(s));
+
+                }
+
+            }
+
+        }
+
+    }
+
+    for(int b=0; b<nbands; b++) {
+
+        locations.insert(locations.end(),blocations[b].begin(),blocations[b].end());
+        responses.insert(responses.end(),bresponses[b].begin(),bresponses[b].end());
+
+    }
+
+    return 0;
+
+}
+
+bool CFASTDetector::Detect(const Mat& img, size_t cellsize, size_t k, vector<vec2f>& locations, vector<float>& responses) {
+
+    vector<vec2f> all;
+    vector<float> rall;
+
+    if(Detect(img,all,rall)) {
+
+        locations.clear();
+        responses.clear();
+        return 1;
+
+    }
+
+    cellsize = max<size_t>(cellsize,1);
+    size_t ncols = (size_t(img.cols) + cellsize - 1)/cellsize;
+    size_t nrows = (size_t(img.rows) + cellsize - 1)/cellsize;
+
+    // bucket corners by cell
+    vector<size_t> cells(all.size());
+    vector<size_t> start(ncols*nrows+1,0);
+
+    for(size_t l=0; l<all.size(); l++) {
+
+        cells[l] = (size_t(all[l].Get(1))/cellsize)*ncols + size_t(all[l].Get(0))/cellsize;
+        start[cells[l]+1]++;
+
+    }
+
+    for(size_t c=0; c<ncols*nrows; c++)
+        start[c+1] += start[c];
+
+    vector<size_t> order(all.size());
+    vector<size_t> pos(start.begin(),start.end()-1);
+
+    for(size_t l=0; l<all.size(); l++)
+        order[pos[cells[l]]++] = l;
+
+    // keep the k strongest per cell
+    locations.clear();
+    responses.clear();
+
+    for(size_t c=0; c<ncols*nrows; c++) {
+
+        vector<size_t>::iterator first = order.begin() + start[c];
+        vector<size_t>::iterator last = order.begin() + start[c+1];
+
+        if(k>0 && size_t(last-first)>k) {
+
+            nth_element(first,first+k,last,[&rall](size_t a, size_t b) { return rall[a]>rall[b] || (rall[a]==rall[b] && a<b); });
+            last = first + k;
+
+        }
+
+        for(vector<size_t>::iterator it=first; it!=last; it++) {
+
+            locations.push_back(all[*it]);
+            responses.push_back(rall[*it]);
+
+        }
+
+    }
+
+    return 0;
+
+}
+
+} // end of namespace
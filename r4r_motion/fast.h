@@ -0,0 +1,106 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef R4RFAST_H_
+#define R4RFAST_H_
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+#include "vecn.h"
+
+namespace R4R {
+
+/*! \brief FAST corner detector
+ *
+ * \details A pixel is a corner if at least #m_arc contiguous pixels on the Bresenham circle of
+ * radius 3 around it are all brighter or all darker than the center by more than the threshold.
+ * The segment test is evaluated for 16 pixels at a time. Image rows are split into bands that
+ * are processed in parallel. The response of a corner is the sum of absolute differences to the
+ * center, minus the threshold, over the brighter or darker part of the circle, whichever is
+ * larger. Corners that are not maximal in their \f$3\times 3\f$ neighborhood are suppressed.
+ *
+ */
+class CFASTDetector {
+
+public:
+
+    /*! \brief Constructor.
+     *
+     * \param[in] threshold minimal intensity difference between center and circle
+     * \param[in] arc minimal length of the contiguous arc, 9 for FAST-9 and 12 for FAST-12
+     *
+     */
+    CFASTDetector(int threshold = 10, size_t arc = 9);
+
+    /*! \brief Detects all corners in an 8-bit gray-scale image.
+     *
+     * \param[in] img input image
+     * \param[out] locations corner locations in row-major order
+     * \param[out] responses corner responses
+     * \returns true if the image type is not supported
+     *
+     */
+    bool Detect(const cv::Mat& img, std::vector<vec2f>& locations, std::vector<float>& responses);
+
+    /*! \brief Detects the strongest corners in each cell of a regular grid.
+     *
+     * \param[in] img input image
+     * \param[in] cellsize side length of the cells
+     * \param[in] k maximal number of corners to keep per cell, unlimited if zero
+     * \param[out] locations corner locations ordered by cell
+     * \param[out] responses corner responses
+     * \returns true if the image type is not supported
+     *
+     * \details Only the corners within each cell are ranked, there is no global sort.
+     *
+     */
+    bool Detect(const cv::Mat& img, size_t cellsize, size_t k, std::vector<vec2f>& locations, std::vector<float>& responses);
+
+    //! Sets the threshold.
+    void SetThreshold(int threshold) { m_threshold = threshold; }
+
+    //! Returns the threshold.
+    int GetThreshold() const { return m_threshold; }
+
+    //! Returns the minimal length of the contiguous arc.
+    size_t GetArc() const { return m_arc; }
+
+private:
+
+    int m_threshold;                    //!< intensity threshold
+    size_t m_arc;                       //!< minimal number of contiguous pixels on the circle
+    std::vector<int> m_scores;          //!< score map, kept between frames
+    std::vector<int> m_offsets;         //!< offsets of the circle in the current image
+
+    //! Computes the offsets of the circle pixels for a given row stride.
+    void ComputeOffsets(size_t step);
+
+    //! Segment test and response of a single pixel, returns zero if it is not a corner.
+    int Score(const uchar* p) const;
+
+};
+
+} // end of namespace
+
+#endif /* FAST_H_ */
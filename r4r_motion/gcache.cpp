@@ -0,0 +1,241 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "gcache.h"
+
+#include <math.h>
+#include <iostream>
+
+#ifdef __SSE4_1__
+#include <xmmintrin.h>
+#endif
+
+using namespace std;
+using namespace cv;
+
+namespace R4R {
+
+CGradientCache::CGradientCache(size_t nbins, bool osigned, bool integral):
+    m_nbins(nbins),
+    m_osigned(osigned),
+    m_integral(integral),
+    m_img(),
+    m_gu(),
+    m_gv(),
+    m_mag(),
+    m_bins(),
+    m_hist() {
+
+    if(nbins>256) {
+
+        cerr << "ERROR: Number of orientation bins must not exceed 256." << endl;
+        m_nbins = 256;
+
+    }
+
+    if(integral && nbins==0)
+        cerr << "ERROR: Integral histograms require orientation bins." << endl;
+
+}
+
+void CGradientCache::Compute(const Mat& img) {
+
+    m_img = img;
+
+    Mat gray;
+    if(img.channels()==3)
+        cvtColor(img,gray,COLOR_BGR2GRAY);
+    else
+        gray = img;
+
+    Mat I;
+    gray.convertTo(I,CV_32F);
+
+    int nrows = I.rows;
+    int ncols = I.cols;
+
+    m_gu = Mat(nrows,ncols,CV_32F);
+    m_gv = Mat(nrows,ncols,CV_32F);
+    m_mag = Mat(nrows,ncols,CV_32F);
+
+    if(m_nbins>0)
+        m_bins = Mat(nrows,ncols,CV_8U);
+
+    // zero rows to continue the image at the top and bottom
+    vector<float> zero(ncols,0);
+
+    double ho = (m_osigned ? 2*M_PI : M_PI)/double(max<size_t>(m_nbins,1));
+
+    #pragma omp parallel for
+    for(int i=0; i<nrows; i++) {
+
+        const float* r = I.ptr<float>(i);
+        const float* rp = i>0 ? I.ptr<float>(i-1) : &zero[0];
+        const float* rn = i<nrows-1 ? I.ptr<float>(i+1) : &zero[0];
+        float* gu = m_gu.ptr<float>(i);
+        float* gv = m_gv.ptr<float>(i);
+        float* mag = m_mag.ptr<float>(i);
+
+        int j = 0;
+
+#ifdef __SSE4_1__
+        __m128 half = _mm_set1_ps(0.5f);
+
+        // interior columns
+        for(j=1; j+4<=ncols-1; j+=4) {
+
+            __m128 du = _mm_mul_ps(half,_mm_sub_ps(_mm_loadu_ps(r+j+1),_mm_loadu_ps(r+j-1)));
+            __m128 dv = _mm_mul_ps(half,_mm_sub_ps(_mm_loadu_ps(rn+j),_mm_loadu_ps(rp+j)));
+            _mm_storeu_ps(gu+j,du);
+            _mm_storeu_ps(gv+j,dv);
+            _mm_storeu_ps(mag+j,_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(du,du),_mm_mul_ps(dv,dv))));
+
+        }
+#endif
+
+        for(int k=0; k<ncols; k++) {
+
+            // skip what has been done above
+            if(k>0 && k<j)
+                continue;
+
+            float left = k>0 ? r[k-1] : 0;
+            float right = k<ncols-1 ? r[k+1] : 0;
+            gu[k] = 0.5f*(right - left);
+            gv[k] = 0.5f*(rn[k] - rp[k]);
+            mag[k] = sqrt(gu[k]*gu[k] + gv[k]*gv[k]);
+
+        }
+
+        if(m_nbins>0) {
+
+            uchar* bins = m_bins.ptr<uchar>(i);
+
+            for(int k=0; k<ncols; k++) {
+
+                double phi = atan2(gv[k],gu[k]);
+
+                if(m_osigned)
+                    phi += M_PI;
+                else if(phi<0)
+                    phi += M_PI;
+
+                size_t bin = size_t(phi/ho);
+
+                // 2pi ~ 0, pi ~ 0
+                if(bin>=m_nbins)
+                    bin = 0;
+
+                bins[k] = uchar(bin);
+
+            }
+
+        }
+
+    }
+
+    if(m_integral && m_nbins>0) {
+
+        size_t stride = (ncols+1)*m_nbins;
+        m_hist.assign((nrows+1)*stride,0);
+
+        // prefix sums along the rows, each thread writes whole rows
+        #pragma omp parallel for
+        for(int i=0; i<nrows; i++) {
+
+            const float* mag = m_mag.ptr<float>(i);
+            const uchar* bins = m_bins.ptr<uchar>(i);
+            double* current = &m_hist[(i+1)*stride];
+
+            for(int k=0; k<ncols; k++) {
+
+                double* left = current + k*m_nbins;
+                double* right = left + m_nbins;
+
+                for(size_t b=0; b<m_nbins; b++)
+                    right[b] = left[b];
+
+                right[bins[k]] += mag[k];
+
+            }
+
+        }
+
+        // accumulate along the columns in contiguous blocks of a row
+        const size_t block = 64;
+
+        #pragma omp parallel for
+        for(size_t c0=0; c0<stride; c0+=block) {
+
+            size_t c1 = min(c0+block,stride);
+
+            for(int i=1; i<nrows; i++) {
+
+                const double* above = &m_hist[i*stride];
+                double* current = &m_hist[(i+1)*stride];
+
+                for(size_t c=c0; c<c1; c++)
+                    current[c] += above[c];
+
+            }
+
+        }
+
+    }
+    else
+        m_hist.clear();
+
+}
+
+void CGradientCache::Histogram(int i0, int j0, int i1, int j1, double* hist) const {
+
+    fill_n(hist,m_nbins,0);
+
+    if(m_hist.size()==0) {
+
+        cerr << "ERROR: Integral histograms have not been computed." << endl;
+        return;
+
+    }
+
+    // clip
+    i0 = max(i0,0);
+    j0 = max(j0,0);
+    i1 = min(i1,m_mag.rows);
+    j1 = min(j1,m_mag.cols);
+
+    if(i0>=i1 || j0>=j1)
+        return;
+
+    size_t stride = (m_mag.cols+1)*m_nbins;
+    const double* tl = &m_hist[i0*stride+j0*m_nbins];
+    const double* tr = &m_hist[i0*stride+j1*m_nbins];
+    const double* bl = &m_hist[i1*stride+j0*m_nbins];
+    const double* br = &m_hist[i1*stride+j1*m_nbins];
+
+    for(size_t b=0; b<m_nbins; b++)
+        hist[b] = br[b] - bl[b] - tr[b] + tl[b];
+
+}
+
+} // end of namespace
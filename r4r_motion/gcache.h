@@ -0,0 +1,148 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef R4RGCACHE_H_
+#define R4RGCACHE_H_
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include <math.h>
+
+namespace R4R {
+
+/*! \brief gradient and orientation data of a pyramid level
+ *
+ * \details The cache is computed once per frame and shared by all neighborhood descriptors
+ * attached to features at that level. Derivatives are central differences with the image
+ * continued by zero, so bilinear interpolation of the cached fields reproduces
+ * CImageInterpolation::Gradient(). Optionally, gradient magnitudes are binned by orientation
+ * and integrated, which allows to evaluate histograms over axis-aligned rectangles in constant
+ * time.
+ *
+ */
+class CGradientCache {
+
+public:
+
+    /*! \brief Constructor.
+     *
+     * \param[in] nbins number of orientation bins, if zero no orientations are computed
+     * \param[in] osigned flag indicating whether orientations are treated as signed or unsigned
+     * \param[in] integral flag indicating whether to compute integral orientation histograms
+     *
+     */
+    CGradientCache(size_t nbins = 0, bool osigned = false, bool integral = false);
+
+    //! Computes all fields from a gray-scale image.
+    void Compute(const cv::Mat& img);
+
+    //! Returns the image the cache was computed from.
+    const cv::Mat& GetImage() const { return m_img; }
+
+    //! Derivative w.r.t. the column index.
+    const cv::Mat& GetGradientU() const { return m_gu; }
+
+    //! Derivative w.r.t. the row index.
+    const cv::Mat& GetGradientV() const { return m_gv; }
+
+    //! Gradient magnitude.
+    const cv::Mat& GetMagnitude() const { return m_mag; }
+
+    //! Quantized orientation.
+    const cv::Mat& GetOrientation() const { return m_bins; }
+
+    //! Number of orientation bins.
+    size_t NBins() const { return m_nbins; }
+
+    //! Checks whether orientations are signed.
+    bool IsSigned() const { return m_osigned; }
+
+    //! Checks whether integral histograms are available.
+    bool HasIntegralHistograms() const { return m_hist.size()>0; }
+
+    //! Interpolates the gradient bilinearly, zero outside the image.
+    void Gradient(double u, double v, double& gu, double& gv) const { gu = Bilinear(m_gu,u,v); gv = Bilinear(m_gv,u,v); }
+
+    /*! \brief Interpolates one component of the gradient.
+     *
+     * \details The flag has the same meaning as in CImageInterpolation::Gradient().
+     *
+     */
+    double Gradient(double u, double v, bool dir) const { return dir ? Bilinear(m_gu,u,v) : Bilinear(m_gv,u,v); }
+
+    /*! \brief Sums gradient magnitude by orientation over a rectangle.
+     *
+     * \param[in] i0 first row
+     * \param[in] j0 first column
+     * \param[in] i1 row after the last
+     * \param[in] j1 column after the last
+     * \param[out] hist histogram with #m_nbins entries
+     *
+     * \details The rectangle is clipped against the image. Requires integral histograms.
+     *
+     */
+    void Histogram(int i0, int j0, int i1, int j1, double* hist) const;
+
+private:
+
+    size_t m_nbins;                         //!< number of orientation bins
+    bool m_osigned;                         //!< signed or unsigned orientations
+    bool m_integral;                        //!< flag for integral histograms
+    cv::Mat m_img;                          //!< input image
+    cv::Mat m_gu;                           //!< derivative w.r.t. column index
+    cv::Mat m_gv;                           //!< derivative w.r.t. row index
+    cv::Mat m_mag;                          //!< gradient magnitude
+    cv::Mat m_bins;                         //!< quantized orientation
+    std::vector<double> m_hist;             //!< integral histograms, bins of a pixel are contiguous
+
+    //! Bilinear interpolation of a single-precision field, zero outside.
+    static double Bilinear(const cv::Mat& field, double u, double v) {
+
+        int i = (int)floor(v);
+        int j = (int)floor(u);
+
+        if(i<0 || i>=field.rows || j<0 || j>=field.cols)
+            return 0;
+
+        double vd = v - i;
+        double ud = u - j;
+
+        const float* r0 = field.ptr<float>(i);
+        const float* r1 = i<field.rows-1 ? field.ptr<float>(i+1) : nullptr;
+        bool last = j==field.cols-1;
+
+        double I00, I01, I10, I11;
+        I00 = r0[j];
+        I01 = last ? 0 : r0[j+1];
+        I10 = r1 ? r1[j] : 0;
+        I11 = (r1 && !last) ? r1[j+1] : 0;
+
+        return (1-vd)*((1-ud)*I00 + ud*I01) + vd*((1-ud)*I10 + ud*I11);
+
+    }
+
+};
+
+} // end of namespace
+
+#endif /* GCACHE_H_ */
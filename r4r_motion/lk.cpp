@@ -25,6 +25,10 @@
 //#include <tbb/tbb.h>
 #include "interp.h"
 
+#ifdef __SSE4_1__
+#include <xmmintrin.h>
+#endif
+
 using namespace std;
 using namespace cv;
 //using namespace tbb;
@@ -72,6 +76,345 @@ void CLukasKanade::ComputeResidualAndJacobian(vec& r, mat& J) {
 
 }
 
+CPyramidalLukasKanade::CPyramidalLukasKanade(size_t hsize, size_t nlevels, size_t maxiter, double eps, double mineig):
+    m_hsize(hsize),
+    m_nlevels(nlevels),
+    m_maxiter(maxiter),
+    m_eps(eps),
+    m_mineig(mineig) {
+
+}
+
+void CPyramidalLukasKanade::BuildPyramid(const Mat& img, size_t nlevels, vector<Mat>& pyramid) {
+
+    pyramid.clear();
+    pyramid.reserve(nlevels+1);
+
+    Mat gray;
+    if(img.channels()==3)
+        cvtColor(img,gray,COLOR_BGR2GRAY);
+    else
+        gray = img;
+
+    Mat level;
+    gray.convertTo(level,CV_32F);
+    pyramid.push_back(level);
+
+    for(size_t l=1; l<=nlevels; l++) {
+
+        if(pyramid.back().rows<2 || pyramid.back().cols<2)
+            break;
+
+        Mat down;
+        pyrDown(pyramid.back(),down);
+        pyramid.push_back(down);
+
+    }
+
+}
+
+bool CPyramidalLukasKanade::Warp(const Mat& img, float x, float y, size_t size, float* patch) {
+
+    int j = (int)floor(x);
+    int i = (int)floor(y);
+
+    if(i<0 || j<0 || i+(int)size>=img.rows || j+(int)size>=img.cols)
+        return false;
+
+    float a = x - j;
+    float b = y - i;
+    float w00 = (1-a)*(1-b);
+    float w01 = a*(1-b);
+    float w10 = (1-a)*b;
+    float w11 = a*b;
+
+#ifdef __SSE4_1__
+    __m128 v00 = _mm_set1_ps(w00);
+    __m128 v01 = _mm_set1_ps(w01);
+    __m128 v10 = _mm_set1_ps(w10);
+    __m128 v11 = _mm_set1_ps(w11);
+#endif
+
+    for(size_t r=0; r<size; r++) {
+
+        const float* p0 = img.ptr<float>(i+r) + j;
+        const float* p1 = img.ptr<float>(i+r+1) + j;
+        float* out = patch + r*size;
+        size_t c = 0;
+
+#ifdef __SSE4_1__
+        for(; c+4<=size; c+=4) {
+
+            __m128 sum = _mm_mul_ps(v00,_mm_loadu_ps(p0+c));
+            sum = _mm_add_ps(sum,_mm_mul_ps(v01,_mm_loadu_ps(p0+c+1)));
+            sum = _mm_add_ps(sum,_mm_mul_ps(v10,_mm_loadu_ps(p1+c)));
+            sum = _mm_add_ps(sum,_mm_mul_ps(v11,_mm_loadu_ps(p1+c+1)));
+            _mm_storeu_ps(out+c,sum);
+
+        }
+#endif
+
+        for(; c<size; c++)
+            out[c] = w00*p0[c] + w01*p0[c+1] + w10*p1[c] + w11*p1[c+1];
+
+    }
+
+    return true;
+
+}
+
+/*! \brief Correlates the patch difference with the template gradient.
+ *
+ */
+static void Correlate(const float* gx, const float* gy, const float* t, const float* img, size_t n, float& b0, float& b1) {
+
+    size_t k = 0;
+    b0 = 0;
+    b1 = 0;
+
+#ifdef __SSE4_1__
+    __m128 s0 = _mm_setzero_ps();
+    __m128 s1 = _mm_setzero_ps();
+
+    for(; k+4<=n; k+=4) {
+
+        __m128 d = _mm_sub_ps(_mm_loadu_ps(img+k),_mm_loadu_ps(t+k));
+        s0 = _mm_add_ps(s0,_mm_mul_ps(_mm_loadu_ps(gx+k),d));
+        s1 = _mm_add_ps(s1,_mm_mul_ps(_mm_loadu_ps(gy+k),d));
+
+    }
+
+    float r0[4], r1[4];
+    _mm_storeu_ps(r0,s0);
+    _mm_storeu_ps(r1,s1);
+    b0 = r0[0] + r0[1] + r0[2] + r0[3];
+    b1 = r1[0] + r1[1] + r1[2] + r1[3];
+#endif
+
+    for(; k<n; k++) {
+
+        float d = img[k] - t[k];
+        b0 += gx[k]*d;
+        b1 += gy[k]*d;
+
+    }
+
+}
+
+bool CPyramidalLukasKanade::TrackPoint(const vector<Mat>& pyramid0, const vector<Mat>& pyramid1, const Point2f& u0, Point2f& u1, float& error, float* buffer) const {
+
+    size_t n = 2*m_hsize + 1;
+    size_t m = n + 2;
+    size_t npx = n*n;
+
+    // template with a one-pixel border for the gradient, template, gradient, and target patch
+    float* tb = buffer;
+    float* t = tb + m*m;
+    float* gx = t + npx;
+    float* gy = gx + npx;
+    float* img = gy + npx;
+
+    int nlevels = (int)min(pyramid0.size(),pyramid1.size());
+
+    if(nlevels==0)
+        return false;
+
+    Point2f guess = u1*(1.0f/float(1<<(nlevels-1)));
+
+    for(int l=nlevels-1; l>=0; l--) {
+
+        float scale = 1.0f/float(1<<l);
+        Point2f x0 = u0*scale;
+
+        // template, its gradient and the Hessian only depend on the first frame
+        if(!Warp(pyramid0[l],x0.x-m_hsize-1,x0.y-m_hsize-1,m,tb)) {
+
+            if(l==0)
+                return false;
+
+            guess = guess*2.0f;
+            continue;
+
+        }
+
+        float a11 = 0, a12 = 0, a22 = 0;
+
+        for(size_t r=0; r<n; r++) {
+
+            const float* row = tb + (r+1)*m + 1;
+
+            for(size_t c=0; c<n; c++) {
+
+                size_t k = r*n + c;
+                t[k] = row[c];
+                gx[k] = 0.5f*(row[c+1] - row[c-1]);
+                gy[k] = 0.5f*(row[c+m] - row[c-m]);
+                a11 += gx[k]*gx[k];
+                a12 += gx[k]*gy[k];
+                a22 += gy[k]*gy[k];
+
+            }
+
+        }
+
+        // normalized as in OpenCV, where gradients are computed by a Scharr filter
+        float det = a11*a22 - a12*a12;
+        float mineig = (a11 + a22 - sqrt((a11-a22)*(a11-a22) + 4*a12*a12))/(2048.0f*npx);
+
+        if(mineig<m_mineig || det<FLT_EPSILON) {
+
+            if(l==0)
+                return false;
+
+            guess = guess*2.0f;
+            continue;
+
+        }
+
+        float i11 = a22/det;
+        float i12 = -a12/det;
+        float i22 = a11/det;
+
+        for(size_t k=0; k<m_maxiter; k++) {
+
+            if(!Warp(pyramid1[l],guess.x-m_hsize,guess.y-m_hsize,n,img)) {
+
+                if(l==0)
+                    return false;
+
+                break;
+
+            }
+
+            float b0, b1;
+            Correlate(gx,gy,t,img,npx,b0,b1);
+
+            // inverse compositional update
+            float dx = i11*b0 + i12*b1;
+            float dy = i12*b0 + i22*b1;
+            guess.x -= dx;
+            guess.y -= dy;
+
+            if(dx*dx+dy*dy<=m_eps)
+                break;
+
+        }
+
+        if(l>0)
+            guess = guess*2.0f;
+
+    }
+
+    if(!Warp(pyramid1[0],guess.x-m_hsize,guess.y-m_hsize,n,img))
+        return false;
+
+    float sum = 0;
+    for(size_t k=0; k<npx; k++)
+        sum += fabs(img[k] - t[k]);
+
+    error = sum/float(npx);
+    u1 = guess;
+
+    return true;
+
+}
+
+void CPyramidalLukasKanade::Track(const Mat& img0, const Mat& img1, const vector<Point2f>& points0, vector<Point2f>& points1, vector<uchar>& status, vector<float>& error) const {
+
+    vector<Mat> pyramid0(1,img0), pyramid1(1,img1);
+    vector<vector<Point2f> > p0(1,points0), p1(1);
+    vector<vector<uchar> > st(1);
+    vector<vector<float> > err(1);
+
+    if(points1.size()==points0.size())
+        p1[0].swap(points1);
+
+    Track(pyramid0,pyramid1,p0,p1,st,err);
+
+    points1.swap(p1[0]);
+    status.swap(st[0]);
+    error.swap(err[0]);
+
+}
+
+void CPyramidalLukasKanade::Track(const vector<Mat>& pyramid0, const vector<Mat>& pyramid1, const vector<vector<Point2f> >& points0, vector<vector<Point2f> >& points1, vector<vector<uchar> >& status, vector<vector<float> >& error) const {
+
+    size_t nscales = min(min(pyramid0.size(),pyramid1.size()),points0.size());
+
+    points1.resize(points0.size());
+    status.resize(points0.size());
+    error.resize(points0.size());
+
+    // LK pyramids for all scales that carry features
+    vector<vector<Mat> > lk0(nscales), lk1(nscales);
+
+    #pragma omp parallel for schedule(dynamic)
+    for(size_t k=0; k<2*nscales; k++) {
+
+        size_t s = k/2;
+
+        if(points0[s].size()==0)
+            continue;
+
+        if(k%2==0)
+            BuildPyramid(pyramid0[s],m_nlevels,lk0[s]);
+        else
+            BuildPyramid(pyramid1[s],m_nlevels,lk1[s]);
+
+    }
+
+    // flatten work over scales and features
+    vector<pair<size_t,size_t> > tasks;
+
+    for(size_t s=0; s<points0.size(); s++) {
+
+        // points1 serves as initial guess if it matches points0
+        if(points1[s].size()!=points0[s].size())
+            points1[s] = points0[s];
+
+        status[s].assign(points0[s].size(),0);
+        error[s].assign(points0[s].size(),0);
+
+        if(s<nscales) {
+
+            for(size_t i=0; i<points0[s].size(); i++)
+                tasks.push_back(pair<size_t,size_t>(s,i));
+
+        }
+
+    }
+
+    size_t n = 2*m_hsize + 1;
+    size_t nbuffer = (n+2)*(n+2) + 4*n*n;
+
+    #pragma omp parallel
+    {
+
+        vector<float> buffer(nbuffer);
+
+        #pragma omp for schedule(dynamic,16)
+        for(size_t k=0; k<tasks.size(); k++) {
+
+            size_t s = tasks[k].first;
+            size_t i = tasks[k].second;
+
+            Point2f u1 = points1[s][i];
+            float err = 0;
+
+            if(TrackPoint(lk0[s],lk1[s],points0[s][i],u1,err,buffer.data())) {
+
+                points1[s][i] = u1;
+                status[s][i] = 1;
+                error[s][i] = err;
+
+            }
+
+        }
+
+    }
+
+}
+
 /*vec CLowLevelTracking::LukasKanade(vec& u0, vec& t0, size_t hsize, cv::Mat& img0, cv::Mat& img1, size_t maxiter, double eps, double lambda) {
 
 	CLukasKanade problem(u0,hsize,img0,img1);
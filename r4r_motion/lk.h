@@ -27,6 +27,7 @@
 
 
 #include <opencv2/opencv.hpp>
+#include <vector>
 #include "lm.h"
 
 //#include <tbb/blocked_range.h>
@@ -64,6 +65,73 @@ private:
 	const cv::Mat& m_img1;										//!< frame 1
 
 };
+/*! \brief inverse-compositional pyramidal Lukas-Kanade tracker
+ *
+ * \details Template patches, their gradients and the Gauss-Newton Hessian are computed once
+ * per feature and pyramid level. Only the target patch is re-interpolated in each iteration.
+ * Features of all scales are tracked in a single parallel loop with dynamic scheduling. The
+ * status and error outputs follow the conventions of \c cv::calcOpticalFlowPyrLK.
+ *
+ */
+class CPyramidalLukasKanade {
+
+public:
+
+    /*! \brief Constructor.
+     *
+     * \param[in] hsize half window size
+     * \param[in] nlevels number of pyramid levels above the input image
+     * \param[in] maxiter maximum number of Gauss-Newton iterations per level
+     * \param[in] eps threshold on the squared norm of the update
+     * \param[in] mineig threshold on the normalized minimal eigenvalue of the Hessian
+     *
+     */
+    CPyramidalLukasKanade(size_t hsize = 7, size_t nlevels = 3, size_t maxiter = 30, double eps = 0.01, double mineig = 1e-4);
+
+    /*! \brief Tracks points between two images.
+     *
+     * \param[in] img0 first frame
+     * \param[in] img1 second frame
+     * \param[in] points0 locations in the first frame
+     * \param[out] points1 locations in the second frame
+     * \param[out] status 1 if the point was found, 0 otherwise
+     * \param[out] error mean absolute intensity difference between the patches
+     *
+     */
+    void Track(const cv::Mat& img0, const cv::Mat& img1, const std::vector<cv::Point2f>& points0, std::vector<cv::Point2f>& points1, std::vector<uchar>& status, std::vector<float>& error) const;
+
+    /*! \brief Tracks points at several scales at once.
+     *
+     * \details The arguments are indexed by scale first. Points at scale \f$s\f$ are tracked
+     * between the images \f$s\f$ of both pyramids.
+     *
+     */
+    void Track(const std::vector<cv::Mat>& pyramid0, const std::vector<cv::Mat>& pyramid1, const std::vector<std::vector<cv::Point2f> >& points0, std::vector<std::vector<cv::Point2f> >& points1, std::vector<std::vector<uchar> >& status, std::vector<std::vector<float> >& error) const;
+
+    //! Builds a floating-point image pyramid of given height.
+    static void BuildPyramid(const cv::Mat& img, size_t nlevels, std::vector<cv::Mat>& pyramid);
+
+private:
+
+    size_t m_hsize;                                             //!< half window size
+    size_t m_nlevels;                                           //!< number of pyramid levels
+    size_t m_maxiter;                                           //!< maximum number of iterations
+    double m_eps;                                               //!< convergence threshold
+    double m_mineig;                                            //!< threshold on the minimal eigenvalue
+
+    //! Tracks a single point through a pair of floating-point pyramids.
+    bool TrackPoint(const std::vector<cv::Mat>& pyramid0, const std::vector<cv::Mat>& pyramid1, const cv::Point2f& u0, cv::Point2f& u1, float& error, float* buffer) const;
+
+    /*! \brief Bilinear interpolation of a square patch.
+     *
+     * \details Since the warp is a translation, all pixels share the same interpolation weights.
+     * Returns false if the patch is not entirely contained in the image.
+     *
+     */
+    static bool Warp(const cv::Mat& img, float x, float y, size_t size, float* patch);
+
+};
+
 /*
 class CLowLevelTracking {
 
@@ -68,32 +68,35 @@ void CMotionTracker::Update(const vector<Mat>& pyramid0, const vector<Mat>& pyra
         vector<vec2f> p0s, p1s, p1ss;
         vector<mytracklet*> trackletss2i, trackletsi2i;
 
-        list<shared_ptr<mytracklet> >::iterator it;
+        const vector<unsigned char>& alive = m_store.GetStatus();
 
         // collect image-to-image and scene-to-image correspondences
-        for(it=m_data.begin(); it!=m_data.end(); it++) {
+        for(size_t k=0; k<alive.size(); k++) {
 
-            vec2f p1 = (*it)->GetLatestLocationAtNativeScale();
+            if(!alive[k])
+                continue;
+
+            vec2f p1 = m_store.GetPastLocationAtNativeScale(k,0);
 
             // cast to special tracklet type
-            shared_ptr<CMotionTrackerTracklet> tracklet = static_pointer_cast<CMotionTrackerTracklet>(*it);
+            CMotionTrackerTracklet* tracklet = static_cast<CMotionTrackerTracklet*>(GetTracklet(k));
 
-            if((*it)->GetStatus() && tracklet->m_has_point) {
+            if(tracklet->m_has_point) {
 
                 // extract scene point
                 xs.push_back(tracklet->m_pmap_point->GetLocation());
                 p1ss.push_back(p1);
-                trackletss2i.push_back((*it).get());
+                trackletss2i.push_back(tracklet);
 
             } // only add more im2im correspondences at key frames
-            else if((*it)->GetStatus() && (*it)->GetLifetime()>(size_t)kfr) {
+            else if(m_store.GetLifetime(k)>(size_t)kfr) {
 
-                // check for the ringbuffer wether this is ok!!!
-                vec2f u0 = (*it)->GetPastLocationAtNativeScale((size_t)kfr);
+                // the history of the store is as long as the ring buffer of the tracklet
+                vec2f u0 = m_store.GetPastLocationAtNativeScale(k,(size_t)kfr);
 
                 p0s.push_back(u0);
                 p1s.push_back(p1);
-                trackletsi2i.push_back((*it).get());
+                trackletsi2i.push_back(tracklet);
 
             }
 
@@ -109,15 +112,12 @@ void CMotionTracker::Update(const vector<Mat>& pyramid0, const vector<Mat>& pyra
         pair<vector<vec2f>,vector<vec2f> > corri2i(p0s,p1s);
         pair<vector<vec3f>,vector<vec2f> > corrs2i(xs,p1ss);
 
-        // init linear solver
-        CPreconditioner<CCSRMatrix<float>,float> M;
-        CConjugateGradientMethodLeastSquares<CCSRMatrix<float>,float> solver(M,
-                                                                             m_params->GetIntParameter("CGLS_NITER"),                                                                                     m_params->GetDoubleParameter("CGLS_EPS"),
-                                                                             true);
-
         // init least-squares problem
         CMagicSfM problem(m_cam,corri2i,corrs2i,F0inv);
 
+        // init linear solver, the depths are eliminated and the motion is solved for directly
+        CSchurComplementSolver<float> solver(problem);
+
         // set up LM method
         CLevenbergMarquardt<CCSRMatrix<float>,float> lms(problem,solver,m_params->GetDoubleParameter("LM_LAMBDA"));
 
@@ -202,21 +202,20 @@ void CMotionTracker::Update(const vector<Mat>& pyramid0, const vector<Mat>& pyra
 
 void CMotionTracker::AddTracklets(const std::vector<Mat>& pyramid) {
 
-    // initialize pyramid of integral images
-    vector<CIntImage<size_t> > imgs;
+    int hsize = m_params->GetIntParameter("MINIMAL_FEATURE_HDISTANCE_INIT");
+
+    // adapt the occupancy grids to the pyramid, memory is kept from frame to frame
+    m_grids.resize(pyramid.size());
     for(u_int s=0; s<pyramid.size(); s++)
-        imgs.push_back(CIntImage<size_t>(pyramid[s].cols,pyramid[s].rows));
+        m_grids[s].Resize(pyramid[s].cols,pyramid[s].rows,2*hsize);
 
     // collect and count feature we already have per scale
-    vector<size_t> n = ComputeFeatureDensity(imgs);
+    vector<size_t> n = ComputeFeatureDensity(m_grids);
     size_t active = std::accumulate(n.begin(),n.end(),0);
 
     // only do something if we have too little tracks
     if(active<=size_t(m_params->GetIntParameter("MIN_NO_FEATURES"))) {
 
-        int hsize = m_params->GetIntParameter("MINIMAL_FEATURE_HDISTANCE_INIT");
-        vec2f hsize2 = { float(hsize), float(hsize) };
-
         for(u_int s = 0; s<pyramid.size(); s++) {
 
             // how many to add per scale
@@ -225,38 +224,29 @@ void CMotionTracker::AddTracklets(const std::vector<Mat>& pyramid) {
             // if we have enough, don't do anything
             if(ntoadd>0) {
 
-                // detect
-                vector<KeyPoint> keypoints;
-                m_detector.detect(pyramid[s],keypoints);
-
-                // only do something if there were detections at scale s
-                if(keypoints.size()>0) {
-
-                    // keep the best but no more than the number to add
-                    KeyPointsFilter::retainBest(keypoints,ntoadd);
+                // spread the new features evenly over the cells
+                size_t quota = (size_t(ntoadd) + m_grids[s].NCells() - 1)/m_grids[s].NCells();
 
-                    // add potential
-                    for(size_t i=0; i<keypoints.size(); i++)
-                        imgs[s].AddMass(keypoints[i].pt.y,keypoints[i].pt.x,1);
+                // detect the strongest corners per cell, with spares for those too close to existing tracks
+                vector<vec2f> locations;
+                vector<float> responses;
+                m_detector.Detect(pyramid[s],2*hsize,4*quota,locations,responses);
 
-                    // compute the integral image
-                    imgs[s].Compute();
-
-                    for(size_t i=0; i<keypoints.size(); i++) {
-
-                        vec2f loc = { float(keypoints[i].pt.x), float(keypoints[i].pt.y) };
+                // only do something if there were detections at scale s
+                if(locations.size()>0) {
 
-                        // only features that are separated from all other candidates and existing features are accepted
-                        if(imgs[s].EvaluateApproximately(loc,hsize2)==1) {
+                    // only features that are separated from all other candidates and existing features are accepted
+                    vector<size_t> accepted;
+                    m_grids[s].Select(locations,responses,float(hsize),size_t(ntoadd),quota,accepted);
 
-                            // create feature
-                            imfeature x(loc,s,0);
+                    for(size_t i=0; i<accepted.size(); i++) {
 
-                            // create new tracklet with feature, set the iterator to the end of the map
-                            CMotionTrackerTracklet* tracklet = new CMotionTrackerTracklet(m_global_t,x,m_params->GetIntParameter("BUFFER_LENGTH"));
-                            this->AddTracklet(tracklet);
+                        // create feature
+                        imfeature x(locations[accepted[i]],s,0);
 
-                        }
+                        // create new tracklet with feature, set the iterator to the end of the map
+                        CMotionTrackerTracklet* tracklet = new CMotionTrackerTracklet(m_global_t,x,m_params->GetIntParameter("BUFFER_LENGTH"));
+                        this->AddTracklet(tracklet);
 
                     }
 
@@ -266,34 +256,28 @@ void CMotionTracker::AddTracklets(const std::vector<Mat>& pyramid) {
 
         }
 
-    }
-    else {  // only compute integral images
-
-        for(u_int s = 0; s<pyramid.size(); s++)
-            imgs[s].Compute();
-
     }
 
-    // since we already have the integral images computed, we might as well
-    //  check whether two tracks got too close to each other
-    list<shared_ptr<mytracklet> >::iterator it;
+    // since the grids are up to date, we might as well check whether two
+    // tracks got too close to each other
+    const vector<vec2f>& x = m_store.GetLocations();
+    const vector<float>& scales = m_store.GetScales();
+    vector<unsigned char>& alive = m_store.GetStatus();
 
-    int hsize = m_params->GetIntParameter("MINIMAL_FEATURE_HDISTANCE_CLEAN");
-    vec2f hsize2 = { float(hsize), float(hsize) };
+    float hclean = float(m_params->GetIntParameter("MINIMAL_FEATURE_HDISTANCE_CLEAN"));
 
     // now go through all tracklets
-    for(it=m_data.begin(); it!=m_data.end(); it++) {
+    for(size_t k=0; k<alive.size(); k++) {
 
-        const imfeature& f = (*it)->GetLatestState();
-        const vec2f& x = f.GetLocation();
-        u_int s = u_int(f.GetScale());
+        u_int s = u_int(scales[k]);
 
-        // if feature is still alive and we have a integral image at its scale but
+        // if feature is still alive and we have a grid at its scale but
         // it violates the distance assumption, kill it
-        if((*it)->GetStatus() && s<imgs.size() && imgs[s].EvaluateApproximately<float>(x,hsize2)>1)
-            (*it)->SetStatus(false);
+        if(alive[k] && s<m_grids.size() && m_grids[s].Count(x[k],hclean)>1)
+            alive[k] = 0;
 
     }
+
 }
 
 CMagicSfM::CMagicSfM(CPinholeCam<float> cam, pair<vector<vec2f>,vector<vec2f> >& corri2i, pair<vector<vec3f>,vector<vec2f> >& corrs2i, CRigidMotion<float,3> F0inv):
@@ -307,6 +291,15 @@ CMagicSfM::CMagicSfM(CPinholeCam<float> cam, pair<vector<vec2f>,vector<vec2f> >&
 
 void CMagicSfM::ComputeResidual(vecf& r) const {
 
+    ComputeResidual(0,m_nopts,r);
+
+}
+
+bool CMagicSfM::ComputeResidual(size_t begin, size_t end, vecf& r) const {
+
+    if(begin>=end)
+        return true;
+
     size_t m = m_corri2i.first.size();
     size_t n = m_corrs2i.first.size();
 
@@ -318,57 +311,63 @@ void CMagicSfM::ComputeResidual(vecf& r) const {
                              m_model.Get(m+4),
                              m_model.Get(m+5));
 
-    // create second view
-    CView<float> view1(m_cam,F1);
+    // image-to-image correspondences, two rows each
+    for(size_t i=begin/2; i<m && 2*i<end; i++) {
 
-    // normalize pixel in first frame, keep this in Jacobian for flow
-    vector<vec3f> x = m_cam.CAbstractCam::Normalize(m_corri2i.first);
+        // normalize pixel in first frame, multiply by current depth, and transform to world coordinates
+        vec3f x = m_F0inv.Transform(m_cam.Normalize(m_corri2i.first[i])*m_model.Get(i));
 
-    // multiply by current depth
-    for(size_t i=0; i<x.size(); i++)
-        x[i] = x[i]*m_model.Get(i);
+        // projection error in second view
+        vec2f dp = m_cam.Project(F1.Transform(x)) - m_corri2i.second[i];
 
-    // transform to world coordinates
-    x = m_F0inv.Transform(x);
+        for(size_t c=0; c<2; c++) {
 
-    // second view
-    vector<vec2f> p1p = view1.Project(x);
+            size_t row = 2*i + c;
 
-    // enter error in residual vector
-    size_t row = 0;
-    for(size_t i=0; i<m; i++) {
+            if(row>=begin && row<end)
+                r(row) = dp.Get(c);
 
-        // projection error
-        vec2f dp = p1p[i] - m_corri2i.second[i];
-
-        // copy weighted error
-        r(row) = dp.Get(0);
-        row++;
-        r(row) = dp.Get(1);
-        row++;
+        }
 
     }
 
-    // project map points to second view, they are in world coordinates
-    p1p = view1.Project(m_corrs2i.first);
+    // scene-to-image correspondences, the map points are in world coordinates
+    for(size_t i=(std::max(begin,2*m)-2*m)/2; i<n && 2*(m+i)<end; i++) {
+
+        vec2f dp = m_cam.Project(F1.Transform(m_corrs2i.first[i])) - m_corrs2i.second[i];
 
-    // copy errors
-    for(size_t i=0; i<n; i++) {
+        for(size_t c=0; c<2; c++) {
 
-        vec2f dp = p1p[i] - m_corrs2i.second[i];
+            size_t row = 2*(m+i) + c;
 
-        // set residual
-        r(row) = dp.Get(0);
-        row++;
-        r(row) = dp.Get(1);
-        row++;
+            if(row>=begin && row<end)
+                r(row) = dp.Get(c);
+
+        }
 
     }
 
+    return true;
+
+}
+
+size_t CMagicSfM::GetJacobianRowLength(size_t i) const {
+
+    // one depth and six motion parameters for image-to-image correspondences, only motion otherwise
+    return (i<2*m_corri2i.first.size()) ? 7 : 6;
+
 }
 
 void CMagicSfM::ComputeResidualAndJacobian(vecf& r, CCSRMatrix<float> &J) const {
 
+    // the sizes are set by the calling LM routine
+    PrepareJacobian(J);
+    ComputeResidualAndJacobian(0,m_nopts,r,J);
+
+}
+
+bool CMagicSfM::ComputeResidualAndJacobian(size_t begin, size_t end, vecf& r, CCSRMatrix<float>& J) const {
+
     /* Jacobian w.r.t.
      * - rotation need backprojected point in world coordinates,
      * - depths need viewing directions of frame 0 in frame 1 coordinates,
@@ -377,14 +376,13 @@ void CMagicSfM::ComputeResidualAndJacobian(vecf& r, CCSRMatrix<float> &J) const
      *
     */
 
-    // init matrix data, the sizes are set by the calling LM routine
-    vector<size_t>* rowptr(new vector<size_t>());
-    vector<size_t>* cols(new vector<size_t>());
-    vector<float>* vals(new vector<float>());
+    if(begin>=end)
+        return true;
 
-    // nnz counter
-    size_t nnz = 0;
-    rowptr->push_back(nnz);
+    // the structure of J has been allocated according to GetJacobianRowLength()
+    const size_t* rowptr = J.GetRowPtr()->data();
+    size_t* cols = J.GetCols()->data();
+    float* vals = J.GetValues()->data();
 
     // get sizes for easier book-keeping of residual indices
     size_t m = m_corri2i.first.size();
@@ -413,117 +411,81 @@ void CMagicSfM::ComputeResidualAndJacobian(vecf& r, CCSRMatrix<float> &J) const
                                               DR1y.Data().get(),
                                               DR1z.Data().get());
 
-    // normalize pixel in first frame
-    vector<vec3f> x0n = m_cam.CAbstractCam::Normalize(m_corri2i.first);
+    // Jacobian of the projection, re-used for all points
+    matf Jpi(2,3);
 
-    // multiply by current depth
-    vector<vec3f> x0;
-    x0.reserve(x0n.size());
-    for(size_t i=0; i<x0n.size(); i++)
-        x0.push_back(x0n[i]*m_model.Get(i));
-
-    // transform point to world coordinates, keep this for Jacobian w.r.t. to rotation
-    x0 = m_F0inv.Transform(x0);
+    // projection error for image-to-image correspondences
+    for(size_t i=begin/2; i<m && 2*i<end; i++) {
 
-    // transform viewing direction from one frame to the other (depth derivative)
-    x0n = Fr.DifferentialTransform(x0n);
+        // normalize pixel in first frame
+        vec3f x0n = m_cam.Normalize(m_corri2i.first[i]);
 
-    // projection error for image-to-image correspondences
-    size_t row = 0;
-    size_t mp1, mp2, mp3, mp4, mp5;
-    mp1 = m + 1;
-    mp2 = m + 2;
-    mp3 = m + 3;
-    mp4 = m + 4;
-    mp5 = m + 5;
+        // multiply by current depth and transform to world coordinates, keep this for Jacobian w.r.t. to rotation
+        vec3f x0 = m_F0inv.Transform(x0n*m_model.Get(i));
 
-    for(size_t i=0; i<m; i++) {
+        // transform viewing direction from one frame to the other (depth derivative)
+        vec3f dx0 = Fr.DifferentialTransform(x0n);
 
         // transform point into frame 1
-        vec3f x1 = F1.Transform(x0[i]);
+        vec3f x1 = F1.Transform(x0);
 
         // project and compute Jacobian
         vec2f p1p;
-        matf Jpi(2,3);
         m_cam.Project(x1,p1p,Jpi);
 
         // projection error
         vec2f dp = p1p - m_corri2i.second[i];
 
         // rotational derivatives
-        vec3f do1 = DR1x*x0[i];
-        vec3f do2 = DR1y*x0[i];
-        vec3f do3 = DR1z*x0[i];
-
-        // one row for the u coordinate
-        float wi = m_weights.Get(row);
-        r(row) = wi*dp.Get(0);
-
-        // depth derivatives
-        vals->push_back(wi*(Jpi.Get(0,0)*x0n[i].Get(0) + Jpi.Get(0,2)*x0n[i].Get(2)));
-        cols->push_back(i);
-
-        // translational derivative
-        vals->push_back(wi*Jpi.Get(0,0));
-        vals->push_back(wi*Jpi.Get(0,1));
-        vals->push_back(wi*Jpi.Get(0,2));
-        cols->push_back(m);
-        cols->push_back(mp1);
-        cols->push_back(mp2);
-
-        // rotational derivative
-        vals->push_back(wi*(Jpi.Get(0,0)*do1.Get(0) + Jpi.Get(0,2)*do1.Get(2)));
-        vals->push_back(wi*(Jpi.Get(0,0)*do2.Get(0) + Jpi.Get(0,2)*do2.Get(2)));
-        vals->push_back(wi*(Jpi.Get(0,0)*do3.Get(0) + Jpi.Get(0,2)*do3.Get(2)));
-        cols->push_back(mp3);
-        cols->push_back(mp4);
-        cols->push_back(mp5);
-
-        // increment row and nnz counter
-        row++;
-        nnz += 7;
-        rowptr->push_back(nnz);
-
-        // same procedure for the v coordinate
-        wi = m_weights.Get(row);
-        r(row) = wi*dp.Get(1);
-
-        // depth derivative
-        vals->push_back(wi*(Jpi.Get(1,1)*x0n[i].Get(1) + Jpi.Get(1,2)*x0n[i].Get(2)));
-        cols->push_back(i);
-
-        // translational derivative
-        vals->push_back(wi*Jpi(1,0));
-        vals->push_back(wi*Jpi(1,1));
-        vals->push_back(wi*Jpi(1,2));
-        cols->push_back(m);
-        cols->push_back(mp1);
-        cols->push_back(mp2);
-
-        // rotational derivative
-        vals->push_back(wi*(Jpi.Get(1,1)*do1.Get(1) + Jpi.Get(1,2)*do1.Get(2)));
-        vals->push_back(wi*(Jpi.Get(1,1)*do2.Get(1) + Jpi.Get(1,2)*do2.Get(2)));
-        vals->push_back(wi*(Jpi.Get(1,1)*do3.Get(1) + Jpi.Get(1,2)*do3.Get(2)));
-        cols->push_back(mp3);
-        cols->push_back(mp4);
-        cols->push_back(mp5);
-
-        // update counters
-        row++;
-        nnz += 7;
-        rowptr->push_back(nnz);
+        vec3f do1 = DR1x*x0;
+        vec3f do2 = DR1y*x0;
+        vec3f do3 = DR1z*x0;
+
+        // one row for the u and one for the v coordinate
+        for(size_t c=0; c<2; c++) {
+
+            size_t row = 2*i + c;
+
+            if(row<begin || row>=end)
+                continue;
+
+            float wi = m_weights.Get(row);
+            r(row) = wi*dp.Get(c);
+
+            size_t k = rowptr[row];
+
+            // depth derivative
+            vals[k] = wi*(Jpi.Get(c,c)*dx0.Get(c) + Jpi.Get(c,2)*dx0.Get(2));
+            cols[k] = i;
+
+            // translational derivative
+            for(size_t j=0; j<3; j++) {
+
+                vals[k+1+j] = wi*Jpi.Get(c,j);
+                cols[k+1+j] = m + j;
+
+            }
+
+            // rotational derivative
+            vals[k+4] = wi*(Jpi.Get(c,c)*do1.Get(c) + Jpi.Get(c,2)*do1.Get(2));
+            vals[k+5] = wi*(Jpi.Get(c,c)*do2.Get(c) + Jpi.Get(c,2)*do2.Get(2));
+            vals[k+6] = wi*(Jpi.Get(c,c)*do3.Get(c) + Jpi.Get(c,2)*do3.Get(2));
+            cols[k+4] = m + 3;
+            cols[k+5] = m + 4;
+            cols[k+6] = m + 5;
+
+        }
 
     }
 
     // scene-to-image correspondences
-    for(size_t i=0; i<n; i++) {
+    for(size_t i=(std::max(begin,2*m)-2*m)/2; i<n && 2*(m+i)<end; i++) {
 
         // transform map points to frame 1
         vec3f x1 = F1.Transform(m_corrs2i.first[i]);
 
         // projection into second image
         vec2f p1p;
-        matf Jpi(2,3);
         m_cam.Project(x1,p1p,Jpi);
 
         // projection error
@@ -534,59 +496,39 @@ void CMagicSfM::ComputeResidualAndJacobian(vecf& r, CCSRMatrix<float> &J) const
         vec3f do2 = DR1y*m_corrs2i.first[i];
         vec3f do3 = DR1z*m_corrs2i.first[i];
 
-        // first the u direction
-        float wi = m_weights.Get(row);
-        r(row) = wi*dp.Get(0);
+        for(size_t c=0; c<2; c++) {
 
-        // translational derivative
-        vals->push_back(wi*Jpi.Get(0,0));
-        vals->push_back(wi*Jpi.Get(0,1));
-        vals->push_back(wi*Jpi.Get(0,2));
-        cols->push_back(m);
-        cols->push_back(mp1);
-        cols->push_back(mp2);
+            size_t row = 2*(m+i) + c;
 
-        // rotational derivatives
-        vals->push_back(wi*(Jpi.Get(0,0)*do1.Get(0) + Jpi.Get(0,2)*do1.Get(2)));
-        vals->push_back(wi*(Jpi.Get(0,0)*do2.Get(0) + Jpi.Get(0,2)*do2.Get(2)));
-        vals->push_back(wi*(Jpi.Get(0,0)*do3.Get(0) + Jpi.Get(0,2)*do3.Get(2)));
-        cols->push_back(mp3);
-        cols->push_back(mp4);
-        cols->push_back(mp5);
-
-        // increment row and nnz counter
-        row++;
-        nnz += 6;
-        rowptr->push_back(nnz);
-
-        // now the v direction
-        wi = m_weights.Get(row);
-        r(row) = wi*dp.Get(1);
-
-        // translational derivative
-        vals->push_back(wi*Jpi.Get(1,0));
-        vals->push_back(wi*Jpi.Get(1,1));
-        vals->push_back(wi*Jpi.Get(1,2));
-        cols->push_back(m);
-        cols->push_back(mp1);
-        cols->push_back(mp2);
-
-        // rotational derivative
-        vals->push_back(wi*(Jpi.Get(1,1)*do1.Get(1) + Jpi.Get(1,2)*do1.Get(2)));
-        vals->push_back(wi*(Jpi.Get(1,1)*do2.Get(1) + Jpi.Get(1,2)*do2.Get(2)));
-        vals->push_back(wi*(Jpi.Get(1,1)*do3.Get(1) + Jpi.Get(1,2)*do3.Get(2)));
-        cols->push_back(mp3);
-        cols->push_back(mp4);
-        cols->push_back(mp5);
-
-        // increment row and nnz counter
-        row++;
-        nnz += 6;
-        rowptr->push_back(nnz);
+            if(row<begin || row>=end)
+                continue;
+
+            float wi = m_weights.Get(row);
+            r(row) = wi*dp.Get(c);
+
+            size_t k = rowptr[row];
+
+            // translational derivative
+            for(size_t j=0; j<3; j++) {
+
+                vals[k+j] = wi*Jpi.Get(c,j);
+                cols[k+j] = m + j;
+
+            }
+
+            // rotational derivatives
+            vals[k+3] = wi*(Jpi.Get(c,c)*do1.Get(c) + Jpi.Get(c,2)*do1.Get(2));
+            vals[k+4] = wi*(Jpi.Get(c,c)*do2.Get(c) + Jpi.Get(c,2)*do2.Get(2));
+            vals[k+5] = wi*(Jpi.Get(c,c)*do3.Get(c) + Jpi.Get(c,2)*do3.Get(2));
+            cols[k+3] = m + 3;
+            cols[k+4] = m + 4;
+            cols[k+5] = m + 5;
+
+        }
 
     }
 
-    J.SetData(rowptr,cols,vals);
+    return true;
 
 }
 
@@ -27,6 +27,7 @@
 #include "cam.h"
 #include "stracker.h"
 #include "lm.h"
+#include "schur.h"
 #include "pcl.h"
 
 namespace R4R {
@@ -116,9 +117,21 @@ public:
 	//! \copydoc CLeastSquaresProblem::ComputeResidualAndJacobian(vec&,Matrix&,const vec&)
     void ComputeResidualAndJacobian(vecf& r, CCSRMatrix<float>& J) const;
 
+    //! \copydoc CLeastSquaresProblem::ComputeResidual(size_t,size_t,CDenseVector<T>&)
+    bool ComputeResidual(size_t begin, size_t end, vecf& r) const;
+
+    //! \copydoc CLeastSquaresProblem::ComputeResidualAndJacobian(size_t,size_t,CDenseVector<T>&,Matrix&)
+    bool ComputeResidualAndJacobian(size_t begin, size_t end, vecf& r, CCSRMatrix<float>& J) const;
+
+    //! \copydoc CLeastSquaresProblem::GetJacobianRowLength(size_t)
+    size_t GetJacobianRowLength(size_t i) const;
+
+    //! Declares the depths as scalar blocks which are eliminated by CSchurComplementSolver.
+    void GetBlockPartition(size_t& nblocks, size_t& blocksize) const { nblocks = m_corri2i.first.size(); blocksize = 1; }
+
 protected:
 
-    CPinholeCam<float>& m_cam;											//!< intrinsic camera parameters
+    CPinholeCam<float> m_cam;											//!< intrinsic camera parameters
     std::pair<std::vector<vec2f>,std::vector<vec2f> >& m_corri2i;    	//!< image-to-image correspondences
     std::pair<std::vector<vec3f>,std::vector<vec2f> >& m_corrs2i;		//!< scene-to-image correspondences
     CRigidMotion<float,3> m_F0inv;										//!< transformation from first frame of image pair to world coordinates
@@ -0,0 +1,267 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "ogrid.h"
+
+#include <math.h>
+#include <algorithm>
+
+using namespace std;
+
+namespace R4R {
+
+COccupancyGrid::COccupancyGrid():
+    m_cellsize(1),
+    m_ncols(0),
+    m_nrows(0),
+    m_size(0),
+    m_head(),
+    m_count(),
+    m_location(),
+    m_cell(),
+    m_next(),
+    m_prev(),
+    m_free(-1) {}
+
+void COccupancyGrid::Resize(size_t width, size_t height, size_t cellsize) {
+
+    cellsize = max<size_t>(cellsize,1);
+    size_t ncols = max<size_t>((width + cellsize - 1)/cellsize,1);
+    size_t nrows = max<size_t>((height + cellsize - 1)/cellsize,1);
+
+    if(cellsize==m_cellsize && ncols==m_ncols && nrows==m_nrows) {
+
+        Clear();
+        return;
+
+    }
+
+    m_cellsize = cellsize;
+    m_ncols = ncols;
+    m_nrows = nrows;
+    m_head.assign(m_ncols*m_nrows,-1);
+    m_count.assign(m_ncols*m_nrows,0);
+    m_location.clear();
+    m_cell.clear();
+    m_next.clear();
+    m_prev.clear();
+    m_free = -1;
+    m_size = 0;
+
+}
+
+void COccupancyGrid::Clear() {
+
+    // only touch the cells that are occupied
+    for(size_t k=0; k<m_cell.size(); k++) {
+
+        if(m_cell[k]>=0) {
+
+            m_head[m_cell[k]] = -1;
+            m_count[m_cell[k]] = 0;
+
+        }
+
+    }
+
+    m_location.clear();
+    m_cell.clear();
+    m_next.clear();
+    m_prev.clear();
+    m_free = -1;
+    m_size = 0;
+
+}
+
+size_t COccupancyGrid::Cell(const vec2f& x) const {
+
+    int j = (int)floor(x.Get(0)/m_cellsize);
+    int i = (int)floor(x.Get(1)/m_cellsize);
+
+    j = min(max(j,0),int(m_ncols)-1);
+    i = min(max(i,0),int(m_nrows)-1);
+
+    return i*m_ncols + j;
+
+}
+
+void COccupancyGrid::Link(size_t handle, size_t cell) {
+
+    m_cell[handle] = int(cell);
+    m_prev[handle] = -1;
+    m_next[handle] = m_head[cell];
+
+    if(m_head[cell]>=0)
+        m_prev[m_head[cell]] = int(handle);
+
+    m_head[cell] = int(handle);
+    m_count[cell]++;
+
+}
+
+void COccupancyGrid::Unlink(size_t handle) {
+
+    int cell = m_cell[handle];
+
+    if(m_prev[handle]>=0)
+        m_next[m_prev[handle]] = m_next[handle];
+    else
+        m_head[cell] = m_next[handle];
+
+    if(m_next[handle]>=0)
+        m_prev[m_next[handle]] = m_prev[handle];
+
+    m_count[cell]--;
+
+}
+
+size_t COccupancyGrid::Insert(const vec2f& x) {
+
+    size_t handle;
+
+    if(m_free>=0) {
+
+        handle = size_t(m_free);
+        m_free = m_next[handle];
+        m_location[handle] = x;
+
+    }
+    else {
+
+        handle = m_location.size();
+        m_location.push_back(x);
+        m_cell.push_back(-1);
+        m_next.push_back(-1);
+        m_prev.push_back(-1);
+
+    }
+
+    Link(handle,Cell(x));
+    m_size++;
+
+    return handle;
+
+}
+
+void COccupancyGrid::Move(size_t handle, const vec2f& x) {
+
+    if(handle>=m_cell.size() || m_cell[handle]<0)
+        return;
+
+    m_location[handle] = x;
+
+    size_t cell = Cell(x);
+
+    if(int(cell)==m_cell[handle])
+        return;
+
+    Unlink(handle);
+    Link(handle,cell);
+
+}
+
+void COccupancyGrid::Remove(size_t handle) {
+
+    if(handle>=m_cell.size() || m_cell[handle]<0)
+        return;
+
+    Unlink(handle);
+
+    // put slot on the free list
+    m_cell[handle] = -1;
+    m_next[handle] = m_free;
+    m_free = int(handle);
+    m_size--;
+
+}
+
+size_t COccupancyGrid::Count(const vec2f& x, float hsize) const {
+
+    if(m_size==0)
+        return 0;
+
+    // range of cells overlapping the window
+    vec2f h = { hsize, hsize };
+    size_t tl = Cell(x - h);
+    size_t br = Cell(x + h);
+    size_t i0 = tl/m_ncols, j0 = tl%m_ncols;
+    size_t i1 = br/m_ncols, j1 = br%m_ncols;
+
+    size_t n = 0;
+
+    for(size_t i=i0; i<=i1; i++) {
+
+        for(size_t j=j0; j<=j1; j++) {
+
+            for(int k=m_head[i*m_ncols+j]; k>=0; k=m_next[k]) {
+
+                if(fabs(m_location[k].Get(0)-x.Get(0))<=hsize && fabs(m_location[k].Get(1)-x.Get(1))<=hsize)
+                    n++;
+
+            }
+
+        }
+
+    }
+
+    return n;
+
+}
+
+void COccupancyGrid::Select(const vector<vec2f>& candidates, const vector<float>& responses, float hsize, size_t nmax, size_t quota, vector<size_t>& accepted) {
+
+    accepted.clear();
+
+    vector<size_t> order(candidates.size());
+    for(size_t k=0; k<order.size(); k++)
+        order[k] = k;
+
+    // strongest first
+    if(responses.size()==candidates.size())
+        stable_sort(order.begin(),order.end(),[&responses](size_t a, size_t b) { return responses[a]>responses[b]; });
+
+    // the quota applies to new points only, existing ones just block their neighborhood
+    vector<size_t> naccepted(quota>0 ? NCells() : 0,0);
+
+    for(size_t k=0; k<order.size() && accepted.size()<nmax; k++) {
+
+        const vec2f& x = candidates[order[k]];
+        size_t cell = Cell(x);
+
+        if(quota>0 && naccepted[cell]>=quota)
+            continue;
+
+        if(Count(x,hsize)>0)
+            continue;
+
+        Insert(x);
+        accepted.push_back(order[k]);
+
+        if(quota>0)
+            naccepted[cell]++;
+
+    }
+
+}
+
+} // end of namespace
@@ -0,0 +1,130 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef R4ROGRID_H_
+#define R4ROGRID_H_
+
+#include <vector>
+
+#include "vecn.h"
+
+namespace R4R {
+
+/*! \brief spatial index of feature locations on a regular grid
+ *
+ * \details Each point is kept in a doubly-linked list of the cell it falls into, so that points
+ * can be inserted, moved, and removed in constant time. Counting the points in a window whose
+ * half-size is not larger than the cell size touches at most nine cells. Memory is kept from
+ * frame to frame, and clearing is proportional to the number of points, not to the number of
+ * pixels. This replaces integral images over Dirac impulses for seeding and cleaning tracks.
+ *
+ */
+class COccupancyGrid {
+
+public:
+
+    //! Constructor.
+    COccupancyGrid();
+
+    /*! \brief Adapts the grid to an image and removes all points.
+     *
+     * \param[in] width image width
+     * \param[in] height image height
+     * \param[in] cellsize side length of the cells in pixels
+     *
+     * \details Memory is only reallocated if the layout changes.
+     *
+     */
+    void Resize(size_t width, size_t height, size_t cellsize);
+
+    //! Removes all points.
+    void Clear();
+
+    //! Inserts a point and returns a handle to it.
+    size_t Insert(const vec2f& x);
+
+    //! Moves a point to a new location.
+    void Move(size_t handle, const vec2f& x);
+
+    //! Removes a point.
+    void Remove(size_t handle);
+
+    //! Number of points.
+    size_t Size() const { return m_size; }
+
+    //! Number of cells.
+    size_t NCells() const { return m_ncols*m_nrows; }
+
+    //! Number of points in the cell containing a location.
+    size_t CellCount(const vec2f& x) const { return m_count[Cell(x)]; }
+
+    /*! \brief Counts the points in a square window.
+     *
+     * \param[in] x center of the window
+     * \param[in] hsize half-size of the window, points on its boundary are counted
+     *
+     */
+    size_t Count(const vec2f& x, float hsize) const;
+
+    /*! \brief Greedily selects well-separated candidates.
+     *
+     * \param[in] candidates candidate locations
+     * \param[in] responses detector responses, candidates are visited in decreasing order, or in given order if empty
+     * \param[in] hsize minimal distance in maximum norm to points in the grid and to other accepted candidates
+     * \param[in] nmax maximal number of candidates to accept
+     * \param[in] quota maximal number of candidates to accept per cell, unlimited if zero
+     * \param[out] accepted indices of accepted candidates
+     *
+     * \details Accepted candidates are inserted into the grid.
+     *
+     */
+    void Select(const std::vector<vec2f>& candidates, const std::vector<float>& responses, float hsize, size_t nmax, size_t quota, std::vector<size_t>& accepted);
+
+private:
+
+    size_t m_cellsize;                  //!< side length of cells
+    size_t m_ncols;                     //!< number of cells per row
+    size_t m_nrows;                     //!< number of cells per column
+    size_t m_size;                      //!< number of points
+    std::vector<int> m_head;            //!< first point in each cell
+    std::vector<size_t> m_count;        //!< number of points in each cell
+    std::vector<vec2f> m_location;      //!< point locations
+    std::vector<int> m_cell;            //!< cell of each point, negative for free slots
+    std::vector<int> m_next;            //!< next point in the same cell, or next free slot
+    std::vector<int> m_prev;            //!< previous point in the same cell
+    int m_free;                         //!< first free slot
+
+    //! Cell index of a location, clamped to the grid.
+    size_t Cell(const vec2f& x) const;
+
+    //! Links a point into a cell.
+    void Link(size_t handle, size_t cell);
+
+    //! Unlinks a point from its cell.
+    void Unlink(size_t handle);
+
+};
+
+} // end of namespace
+
+#endif /* OGRID_H_ */
@@ -0,0 +1,279 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "patch.h"
+
+#include <math.h>
+#include <iostream>
+#include <algorithm>
+
+#ifdef __SSE4_1__
+#include <smmintrin.h>
+#endif
+
+using namespace std;
+using namespace cv;
+
+namespace R4R {
+
+//! Bilinear interpolation with the field continued by zero.
+template<typename T>
+static inline float Bilinear(const Mat& field, double u, double v) {
+
+    int i = (int)floor(v);
+    int j = (int)floor(u);
+
+    if(i<0 || i>=field.rows || j<0 || j>=field.cols)
+        return 0;
+
+    double vd = v - i;
+    double ud = u - j;
+
+    const T* r0 = field.ptr<T>(i);
+    const T* r1 = i<field.rows-1 ? field.ptr<T>(i+1) : nullptr;
+    bool last = j==field.cols-1;
+
+    double I00, I01, I10, I11;
+    I00 = r0[j];
+    I01 = last ? 0 : r0[j+1];
+    I10 = r1 ? r1[j] : 0;
+    I11 = (r1 && !last) ? r1[j+1] : 0;
+
+    return (1-vd)*((1-ud)*I00 + ud*I01) + vd*((1-ud)*I10 + ud*I11);
+
+}
+
+//! Warps a field onto the sampling grid of a single patch.
+template<typename T>
+static void Warp(const Mat& field, const double* a, size_t n, float* out) {
+
+    // corners of the grid decide whether there is any need for bounds checks
+    double umin = a[0], umax = a[0], vmin = a[3], vmax = a[3];
+
+    for(size_t c=1; c<4; c++) {
+
+        double j = (c&1) ? n-1 : 0;
+        double i = (c&2) ? n-1 : 0;
+        umin = min(umin,a[0]+a[1]*j+a[2]*i);
+        umax = max(umax,a[0]+a[1]*j+a[2]*i);
+        vmin = min(vmin,a[3]+a[4]*j+a[5]*i);
+        vmax = max(vmax,a[3]+a[4]*j+a[5]*i);
+
+    }
+
+    // leave one pixel of margin on each side for rounding in single precision
+    bool inside = umin>=1 && vmin>=1 && umax<field.cols-2 && vmax<field.rows-2;
+
+    for(size_t i=0; i<n; i++) {
+
+        double u0 = a[0] + a[2]*i;
+        double v0 = a[3] + a[5]*i;
+        float* row = out + i*n;
+        size_t j = 0;
+
+#ifdef __SSE4_1__
+        if(inside) {
+
+            __m128 step = _mm_set_ps(3,2,1,0);
+            __m128 du = _mm_set1_ps(a[1]);
+            __m128 dv = _mm_set1_ps(a[4]);
+            __m128 one = _mm_set1_ps(1.0f);
+            const uchar* base = field.ptr<uchar>(0);
+            int ju[4], iv[4];
+            float p00[4], p01[4], p10[4], p11[4];
+
+            // single precision is only used relative to the integer part of the row origin
+            int ub = (int)floor(u0);
+            int vb = (int)floor(v0);
+            __m128 ur = _mm_set1_ps(u0 - ub);
+            __m128 vr = _mm_set1_ps(v0 - vb);
+
+            for(; j+4<=n; j+=4) {
+
+                __m128 jj = _mm_add_ps(_mm_set1_ps(float(j)),step);
+                __m128 u = _mm_add_ps(ur,_mm_mul_ps(jj,du));
+                __m128 v = _mm_add_ps(vr,_mm_mul_ps(jj,dv));
+                __m128 flu = _mm_floor_ps(u);
+                __m128 flv = _mm_floor_ps(v);
+                __m128 fu = _mm_sub_ps(u,flu);
+                __m128 fv = _mm_sub_ps(v,flv);
+                _mm_storeu_si128((__m128i*)ju,_mm_cvtps_epi32(flu));
+                _mm_storeu_si128((__m128i*)iv,_mm_cvtps_epi32(flv));
+
+                // gather
+                for(size_t q=0; q<4; q++) {
+
+                    const T* r0 = (const T*)(base + (vb+iv[q])*field.step) + ub + ju[q];
+                    const T* r1 = (const T*)((const uchar*)r0 + field.step);
+                    p00[q] = r0[0];
+                    p01[q] = r0[1];
+                    p10[q] = r1[0];
+                    p11[q] = r1[1];
+
+                }
+
+                __m128 gu = _mm_sub_ps(one,fu);
+                __m128 I0 = _mm_add_ps(_mm_mul_ps(gu,_mm_loadu_ps(p00)),_mm_mul_ps(fu,_mm_loadu_ps(p01)));
+                __m128 I1 = _mm_add_ps(_mm_mul_ps(gu,_mm_loadu_ps(p10)),_mm_mul_ps(fu,_mm_loadu_ps(p11)));
+                __m128 I = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(one,fv),I0),_mm_mul_ps(fv,I1));
+                _mm_storeu_ps(row+j,I);
+
+            }
+
+        }
+#endif
+
+        for(; j<n; j++)
+            row[j] = Bilinear<T>(field,u0+a[1]*j,v0+a[4]*j);
+
+    }
+
+}
+
+//! Dispatches the warp on the pixel type.
+static bool Warp(const Mat& img, const double* a, size_t n, float* out) {
+
+    switch(img.type()) {
+
+    case CV_8UC1:
+        Warp<uchar>(img,a,n,out);
+        return 0;
+    case CV_32FC1:
+        Warp<float>(img,a,n,out);
+        return 0;
+    default:
+        return 1;
+
+    }
+
+}
+
+CPatchBuffer::CPatchBuffer(size_t size):
+    m_size(size),
+    m_npatches(0),
+    m_nchannels(1),
+    m_data() {}
+
+void CPatchBuffer::Grid(CRectangle<double> roi, size_t n, double* a) {
+
+    double h = n>1 ? 2.0/(double)(n-1) : 0;
+
+    vec2 o = roi.TransformFrom(-1.0,-1.0);
+    vec2 eu = roi.TransformFrom(-1.0+h,-1.0) - o;
+    vec2 ev = roi.TransformFrom(-1.0,-1.0+h) - o;
+
+    a[0] = o.Get(0);
+    a[1] = eu.Get(0);
+    a[2] = ev.Get(0);
+    a[3] = o.Get(1);
+    a[4] = eu.Get(1);
+    a[5] = ev.Get(1);
+
+}
+
+bool CPatchBuffer::IsCompatible(size_t n, bool gradients) const {
+
+    if(n!=m_size) {
+
+        cerr << "ERROR: Patch size does not match the sampling grid of the descriptor." << endl;
+        return false;
+
+    }
+
+    if(gradients && !HasGradients()) {
+
+        cerr << "ERROR: Patches do not contain derivatives." << endl;
+        return false;
+
+    }
+
+    return true;
+
+}
+
+void CPatchBuffer::Init(const vector<CRectangle<double> >& rois, size_t nchannels, vector<double>& grids) {
+
+    m_npatches = rois.size();
+    m_nchannels = nchannels;
+
+    // only grow, the buffer is reused from frame to frame
+    size_t length = m_npatches*m_nchannels*m_size*m_size;
+
+    if(m_data.size()<length)
+        m_data.resize(length);
+
+    grids.resize(6*m_npatches);
+
+    for(size_t k=0; k<m_npatches; k++)
+        Grid(rois[k],m_size,&grids[6*k]);
+
+}
+
+void CPatchBuffer::Compute(const Mat& img, const vector<CRectangle<double> >& rois) {
+
+    vector<double> grids;
+    Init(rois,1,grids);
+
+    size_t n2 = m_size*m_size;
+    bool error = false;
+
+    #pragma omp parallel for reduction(||:error)
+    for(int k=0; k<int(m_npatches); k++) {
+
+        if(Warp(img,&grids[6*k],m_size,&m_data[k*n2]))
+            error = true;
+
+    }
+
+    if(error)
+        cerr << "ERROR: Patches can only be extracted from 8-bit or single-precision gray-scale images." << endl;
+
+}
+
+void CPatchBuffer::Compute(const CGradientCache& cache, const vector<CRectangle<double> >& rois) {
+
+    vector<double> grids;
+    Init(rois,3,grids);
+
+    size_t n2 = m_size*m_size;
+    bool error = false;
+
+    #pragma omp parallel for reduction(||:error)
+    for(int k=0; k<int(m_npatches); k++) {
+
+        float* patch = &m_data[3*k*n2];
+
+        if(Warp(cache.GetImage(),&grids[6*k],m_size,patch))
+            error = true;
+
+        Warp<float>(cache.GetGradientU(),&grids[6*k],m_size,patch+n2);
+        Warp<float>(cache.GetGradientV(),&grids[6*k],m_size,patch+2*n2);
+
+    }
+
+    if(error)
+        cerr << "ERROR: Patches can only be extracted from 8-bit or single-precision gray-scale images." << endl;
+
+}
+
+} // end of namespace
@@ -0,0 +1,103 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef R4RPATCH_H_
+#define R4RPATCH_H_
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+#include "rect.h"
+#include "gcache.h"
+
+namespace R4R {
+
+/*! \brief canonical patches of a batch of regions of interest
+ *
+ * \details All regions of a pyramid level are warped once per frame onto a regular grid of
+ * \f$n\times n\f$ samples covering \f$[-1,1]\times[-1,1]\f$ in the local coordinates of the region.
+ * This is the grid neighborhood descriptors sample on, so that they can be computed from the
+ * shared buffer instead of interpolating the image themselves. Sampling is bilinear with the
+ * image continued by zero. Besides the intensity, the buffer can hold the derivatives of a
+ * CGradientCache warped onto the same grid.
+ *
+ */
+class CPatchBuffer {
+
+public:
+
+    //! Constructor.
+    CPatchBuffer(size_t size = 15);
+
+    //! Warps the intensity of an 8-bit or single-precision image.
+    void Compute(const cv::Mat& img, const std::vector<CRectangle<double> >& rois);
+
+    //! Warps the intensity and the derivatives of a pyramid level.
+    void Compute(const CGradientCache& cache, const std::vector<CRectangle<double> >& rois);
+
+    //! Number of samples per dimension.
+    size_t Size() const { return m_size; }
+
+    //! Number of patches.
+    size_t NPatches() const { return m_npatches; }
+
+    //! Checks whether derivatives are available.
+    bool HasGradients() const { return m_nchannels==3; }
+
+    //! Intensity of the k-th patch in row-major order.
+    const float* GetIntensity(size_t k) const { return &m_data[k*m_nchannels*m_size*m_size]; }
+
+    //! Derivative w.r.t. the column index of the k-th patch.
+    const float* GetGradientU(size_t k) const { return &m_data[(k*m_nchannels+1)*m_size*m_size]; }
+
+    //! Derivative w.r.t. the row index of the k-th patch.
+    const float* GetGradientV(size_t k) const { return &m_data[(k*m_nchannels+2)*m_size*m_size]; }
+
+    //! Checks whether the buffer can serve a descriptor sampling on a grid of given size.
+    bool IsCompatible(size_t n, bool gradients) const;
+
+    /*! \brief Computes the affine map from grid indices to image coordinates.
+     *
+     * \param[in] roi region of interest
+     * \param[in] n number of samples per dimension
+     * \param[out] a coefficients such that sample \f$(i,j)\f$ is located at
+     * \f$(a_0+a_1j+a_2i,a_3+a_4j+a_5i)\f$
+     *
+     */
+    static void Grid(CRectangle<double> roi, size_t n, double* a);
+
+private:
+
+    size_t m_size;                      //!< number of samples per dimension
+    size_t m_npatches;                  //!< number of patches
+    size_t m_nchannels;                 //!< number of fields per patch
+    std::vector<float> m_data;          //!< patches, channels of a patch are contiguous
+
+    //! Allocates the buffer and computes the grids.
+    void Init(const std::vector<CRectangle<double> >& rois, size_t nchannels, std::vector<double>& grids);
+
+};
+
+} // end of namespace
+
+#endif /* PATCH_H_ */
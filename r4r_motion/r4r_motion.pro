@@ -21,7 +21,9 @@
 #
 ######################################################################################
 
-QMAKE_CXXFLAGS += -std=c++0x -O3
+QMAKE_CXXFLAGS += -std=c++0x -O3 -msse4 -fopenmp
+
+LIBS += -fopenmp
 
 TARGET = r4r_motion
 TEMPLATE = lib
@@ -38,7 +40,12 @@ SOURCES += tracker.cpp \
     dagg.cpp \
     descspecial.cpp \
     pcl.cpp \
-    bbox.cpp
+    bbox.cpp \
+    tstore.cpp \
+    gcache.cpp \
+    patch.cpp \
+    ogrid.cpp \
+    fast.cpp
 
 HEADERS += tracker.h \
     stracker.h \
@@ -50,7 +57,12 @@ HEADERS += tracker.h \
     dagg.h \
     descspecial.h \
     pcl.h \
-    bbox.h
+    bbox.h \
+    tstore.h \
+    gcache.h \
+    patch.h \
+    ogrid.h \
+    fast.h
 
 # make sure that r4r_core is up to date
 DEPENDPATH += $$PWD/../r4r_core
@@ -35,12 +35,20 @@ namespace R4R {
 
 CSimpleTracker::CSimpleTracker(const CParameters *params):
 	CTracker(params),
-    m_detector(m_params->GetDoubleParameter("FEATURE_THRESHOLD"))
+    m_detector(int(m_params->GetDoubleParameter("FEATURE_THRESHOLD"))),
+    m_lk(m_params->GetIntParameter("TRACKING_HSIZE"),
+         m_params->GetIntParameter("LK_PYRAMID_LEVEL"),
+         m_params->GetIntParameter("MAX_ITER"),
+         m_params->GetDoubleParameter("ACCURACY"),
+         m_params->GetDoubleParameter("LAMBDA"))
 	{
 
 	// generate sample points for tests performed in BRIEF descriptor
     CBRIEF::GenerateSamplePoints();
 
+    // the store keeps as much history as the tracklets themselves
+    m_store.ResizeTracklets(m_params->GetIntParameter("BUFFER_LENGTH"));
+
 }
 
 void CSimpleTracker::Init(const std::vector<Mat>& pyramid) {
@@ -55,25 +63,27 @@ void CSimpleTracker::Update(const vector<Mat>& pyramid0, const vector<Mat>& pyra
     // sort features according to scale, this setup allows for scale changes
     vector<vector<Point2f> > points0(pyramid0.size());
     vector<vector<Point2f> > points1(pyramid0.size());
-    vector<vector<shared_ptr<mytracklet> > > tracklets(pyramid0.size());
+    vector<vector<size_t> > tracklets(pyramid0.size());
 
-    list<shared_ptr<mytracklet > >::iterator it;
+    // the latest states are read from the columns of the store
+    const vector<vec2f>& locations = m_store.GetLocations();
+    const vector<float>& scales = m_store.GetScales();
+    vector<unsigned char>& alive = m_store.GetStatus();
 
-    for(it=m_data.begin(); it!=m_data.end(); it++) {
+    for(size_t k=0; k<alive.size(); k++) {
 
         // only consider live tracks
-        if((*it)->GetStatus()) {
+        if(alive[k]) {
 
-            const imfeature& f0 = (*it)->GetLatestState();
-            const vec2f& u0 = f0.GetLocation();
-            u_int scale = u_int(f0.GetScale());
+            const vec2f& u0 = locations[k];
+            u_int scale = u_int(scales[k]);
 
             // make sure we can track at that level
             if(scale<pyramid0.size() && scale<pyramid1.size()) {
 
                 points0[scale].push_back(Point2f(u0.Get(0),u0.Get(1)));
                 points1[scale].push_back(Point2f(u0.Get(0),u0.Get(1)));
-                tracklets[scale].push_back(*it);                            // keep order in which tracklets are added
+                tracklets[scale].push_back(k);                              // keep order in which tracklets are added
 
             }
 
@@ -81,44 +91,25 @@ void CSimpleTracker::Update(const vector<Mat>& pyramid0, const vector<Mat>& pyra
 
     }
 
+    // track all scales at once
+    vector<vector<uchar> > status;
+    vector<vector<float> > error;
+    m_lk.Track(pyramid0,pyramid1,points0,points1,status,error);
+
     for(size_t s=0; s<pyramid0.size(); s++) {
 
-        // error/status flags
-        vector<uchar> status;
-		vector<float> error;
-
-		// check if there are features at that scale
-        if(points0[s].size()>0) {
-
-			// perform LK tracking
-			calcOpticalFlowPyrLK(pyramid0[s],
-								 pyramid1[s],
-                                 points0[s],
-                                 points1[s],
-								 status,
-								 error,
-                                 Size(2*m_params->GetIntParameter("TRACKING_HSIZE")+1,2*m_params->GetIntParameter("TRACKING_HSIZE")+1),
-                                 m_params->GetIntParameter("LK_PYRAMID_LEVEL"),
-								 TermCriteria(TermCriteria::COUNT|TermCriteria::EPS,
-                                              m_params->GetIntParameter("MAX_ITER"),
-                                              m_params->GetDoubleParameter("ACCURACY")),
-                                 m_params->GetDoubleParameter("LAMBDA"),
-                                 0);
-
-            // update tracklets
-            for(size_t i=0; i<tracklets[s].size(); i++) {
-
-                if(status[i] && points1[s][i].x>0 && points1[s][i].x<pyramid1[s].cols-1 && points1[s][i].y>0 && points1[s][i].y<pyramid1[s].rows-1) {
-
-                    vec2f loc = { points1[s][i].x, points1[s][i].y };
-                    imfeature x(loc,s,0);
-                    tracklets[s][i]->Update(x);
+        // update tracklets
+        for(size_t i=0; i<tracklets[s].size(); i++) {
 
-                }
-                else
-                    tracklets[s][i]->SetStatus(false);
+            if(status[s][i] && points1[s][i].x>0 && points1[s][i].x<pyramid1[s].cols-1 && points1[s][i].y>0 && points1[s][i].y<pyramid1[s].rows-1) {
+
+                vec2f loc = { points1[s][i].x, points1[s][i].y };
+                imfeature x(loc,s,0);
+                GetTracklet(tracklets[s][i])->Update(x);
 
             }
+            else
+                alive[tracklets[s][i]] = 0;
 
         }
 
@@ -130,17 +121,17 @@ void CSimpleTracker::Update(const vector<Mat>& pyramid0, const vector<Mat>& pyra
 
 void CSimpleTracker::Clean(const vector<Mat>& pyramid0, const vector<Mat>& pyramid1) {
 
-    list<shared_ptr<mytracklet> >::iterator it;
+    const vector<float>& qualities = m_store.GetQualities();
+    vector<unsigned char>& alive = m_store.GetStatus();
+    float maxdist = float(m_params->GetIntParameter("MAX_HAMMING_DISTANCE"));
 
     // now go through all tracklets
-    for(it=m_data.begin(); it!=m_data.end(); it++) {
-
-        const imfeature& f = (*it)->GetLatestState();
+    for(size_t k=0; k<alive.size(); k++) {
 
         // if feature is still alive  but its quality is too low in terms of the
         // distance between its descriptor and the reference, then kill it
-        if((*it)->GetStatus() && f.GetQuality()>m_params->GetIntParameter("MAX_HAMMING_DISTANCE"))
-            (*it)->SetStatus(false);
+        if(alive[k] && qualities[k]>maxdist)
+            alive[k] = 0;
 
 	}
 
@@ -148,21 +139,20 @@ void CSimpleTracker::Clean(const vector<Mat>& pyramid0, const vector<Mat>& pyram
 
 void CSimpleTracker::AddTracklets(const vector<Mat>& pyramid) {
 
-    // initialize pyramid of integral images
-    vector<CIntImage<size_t> > imgs;
+    int hsize = m_params->GetIntParameter("MINIMAL_FEATURE_HDISTANCE_INIT");
+
+    // adapt the occupancy grids to the pyramid, memory is kept from frame to frame
+    m_grids.resize(pyramid.size());
     for(u_int s=0; s<pyramid.size(); s++)
-        imgs.push_back(CIntImage<size_t>(pyramid[s].cols,pyramid[s].rows));
+        m_grids[s].Resize(pyramid[s].cols,pyramid[s].rows,2*hsize);
 
     // collect and count feature we already have per scale
-    vector<size_t> n = ComputeFeatureDensity(imgs);
+    vector<size_t> n = ComputeFeatureDensity(m_grids);
     size_t active = std::accumulate(n.begin(),n.end(),0);
 
     // only do something if we have too little tracks
     if(active<=size_t(m_params->GetIntParameter("MIN_NO_FEATURES"))) {
 
-        int hsize = m_params->GetIntParameter("MINIMAL_FEATURE_HDISTANCE_INIT");
-        vec2f hsize2 = { float(hsize), float(hsize) };
-
         for(u_int s = 0; s<pyramid.size(); s++) {
 
             // how many to add per scale
@@ -171,42 +161,29 @@ void CSimpleTracker::AddTracklets(const vector<Mat>& pyramid) {
             // if we have enough, don't do anything
             if(ntoadd>0) {
 
-                // detect
-                vector<KeyPoint> keypoints;
-                m_detector.detect(pyramid[s],keypoints);
-
-                // only do something if there were detections at scale s
-                if(keypoints.size()>0) {
-
-                    // keep the best but no more than the number to add
-                    KeyPointsFilter::retainBest(keypoints,ntoadd);
-
-                    // add potential
-                    for(size_t i=0; i<keypoints.size(); i++)
-                        imgs[s].AddMass(keypoints[i].pt.y,keypoints[i].pt.x,1);
-
-                    // compute the integral image
-                    imgs[s].Compute();
-
-                    for(size_t i=0; i<keypoints.size(); i++) {
-
-                        vec2f loc = { float(keypoints[i].pt.x), float(keypoints[i].pt.y) };
+                // spread the new features evenly over the cells
+                size_t quota = (size_t(ntoadd) + m_grids[s].NCells() - 1)/m_grids[s].NCells();
 
-                        // only features that are separated from all other candidates and existing features are accepted
-                        if(imgs[s].EvaluateApproximately(loc,hsize2)==1) {
+                // detect the strongest corners per cell, with spares for those too close to existing tracks
+                vector<vec2f> locations;
+                vector<float> responses;
+                m_detector.Detect(pyramid[s],2*hsize,4*quota,locations,responses);
 
-                            // create feature
-                            imfeature x(loc,s,0);
-
-                            // create new tracklet with feature, FIXME: get size restriction from parameters
-                            CSimpleTrackerTracklet* tracklet = new CSimpleTrackerTracklet(m_global_t,x,m_params->GetIntParameter("BUFFER_LENGTH"));
-                            this->AddTracklet(tracklet);
+                // only do something if there were detections at scale s
+                if(locations.size()>0) {
 
+                    // only features that are separated from all other candidates and existing features are accepted
+                    vector<size_t> accepted;
+                    m_grids[s].Select(locations,responses,float(hsize),size_t(ntoadd),quota,accepted);
 
-                            // compute reference feature descriptor
+                    for(size_t i=0; i<accepted.size(); i++) {
 
+                        // create feature
+                        imfeature x(locations[accepted[i]],s,0);
 
-                        }
+                        // create new tracklet with feature, FIXME: get size restriction from parameters
+                        CSimpleTrackerTracklet* tracklet = new CSimpleTrackerTracklet(m_global_t,x,m_params->GetIntParameter("BUFFER_LENGTH"));
+                        this->AddTracklet(tracklet);
 
                     }
 
@@ -216,34 +193,25 @@ void CSimpleTracker::AddTracklets(const vector<Mat>& pyramid) {
 
         }
 
-    }
-    else {  // only compute integral images
-
-        for(u_int s = 0; s<pyramid.size(); s++)
-            imgs[s].Compute();
-
     }
 
-    // since we already have the integral images computed, we might as well
-    //  check whether two tracks got too close to each other
-    list<shared_ptr<mytracklet> >::iterator it;
+    // since the grids are up to date, we might as well check whether two
+    // tracks got too close to each other
+    const vector<vec2f>& x = m_store.GetLocations();
+    const vector<float>& scales = m_store.GetScales();
+    vector<unsigned char>& alive = m_store.GetStatus();
 
-    int hsize = m_params->GetIntParameter("MINIMAL_FEATURE_HDISTANCE_CLEAN");
-    vec2f hsize2 = { float(hsize), float(hsize) };
+    float hclean = float(m_params->GetIntParameter("MINIMAL_FEATURE_HDISTANCE_CLEAN"));
 
     // now go through all tracklets
-    for(it=m_data.begin(); it!=m_data.end(); it++) {
+    for(size_t k=0; k<alive.size(); k++) {
 
-        const imfeature& f = (*it)->GetLatestState();
-        const vec2f& x = f.GetLocation();
-        u_int s = u_int(f.GetScale());
+        u_int s = u_int(scales[k]);
 
-        // if feature is still alive and we have a integral image at its scale but
+        // if feature is still alive and we have a grid at its scale but
         // it violates the distance assumption, kill it
-        if((*it)->GetStatus() && s<imgs.size() && imgs[s].EvaluateApproximately<float>(x,hsize2)>1)
-            (*it)->SetStatus(false);
-
-
+        if(alive[k] && s<m_grids.size() && m_grids[s].Count(x[k],hclean)>1)
+            alive[k] = 0;
 
     }
 
@@ -262,15 +230,20 @@ void CSimpleTracker::UpdateDescriptors(const std::vector<cv::Mat>& pyramid) {
 
     }*/
 
-    list<shared_ptr<mytracklet> >::iterator it;
+    // collect active features and their regions of interest by scale
+    vector<vector<vec2f> > locations(pyramid.size());
+    vector<vector<CRectangle<double> > > rois(pyramid.size());
+    const vector<vec2f>& latest = m_store.GetLocations();
+    const vector<float>& scales = m_store.GetScales();
+    vector<float>& qualities = m_store.GetQualities();
+    const vector<unsigned char>& alive = m_store.GetStatus();
 
-    for(it=m_data.begin(); it!=m_data.end(); it++) {
+    for(size_t k=0; k<alive.size(); k++) {
 
-        if((*it)->GetStatus()) {
+        if(alive[k]) {
 
-            imfeature& x = (*it)->GetLatestState();
-            const vec2f& u0 = x.GetLocation();
-            int s = int(x.GetScale());
+            const vec2f& u0 = latest[k];
+            int s = int(scales[k]);
 
             // create region of interest
             CRectangle<double> droi(u0.Get(0),
@@ -282,23 +255,88 @@ void CSimpleTracker::UpdateDescriptors(const std::vector<cv::Mat>& pyramid) {
             if(s)
                 droi.Scale(1.0/double(2<<(s-1)));
 
-            // compute brief descriptor
-            CBRIEF* briefdesc1 = new CBRIEF(droi);
-            briefdesc1->Compute(pyramid[s]);
+            locations[s].push_back(u0);
+            rois[s].push_back(droi);
 
-            // cast and attach it to the feature
-            shared_ptr<CAbstractDescriptor> brief(briefdesc1);
-            x.AttachDescriptor("BRIEF",brief);
+        }
+
+    }
+
+    // compute BRIEF descriptors level by level
+    vector<vector<shared_ptr<CPackedBRIEF> > > briefs(pyramid.size());
+
+    for(size_t s=0; s<pyramid.size(); s++) {
+
+        if(m_brief_patterns.size()<=s)
+            m_brief_patterns.push_back(CBRIEFPattern(m_params->GetIntParameter("DESCRIPTOR_HSIZE")/double(1<<s)));
+
+        CPackedBRIEF::Compute(pyramid[s],m_brief_patterns[s],locations[s],briefs[s]);
+
+    }
+
+    vector<size_t> counter(pyramid.size(),0);
+
+    // differentiate each level only once for all gradient-based descriptors, COMPUTE_HOG=2 selects integral HoG
+    bool ihog = m_params->GetIntParameter("COMPUTE_HOG")==2;
+    vector<CGradientCache> caches(pyramid.size(),CGradientCache(ihog ? 9 : 0,false,ihog));
+
+    if(m_params->GetIntParameter("COMPUTE_GRAD") || m_params->GetIntParameter("COMPUTE_HOG")) {
+
+        for(size_t s=0; s<pyramid.size(); s++) {
+
+            if(locations[s].size()>0)
+                caches[s].Compute(pyramid[s]);
+
+        }
+
+    }
+
+    // warp all regions once per level for the identity and gradient descriptors
+    bool id = m_params->GetIntParameter("COMPUTE_ID");
+    bool grad = m_params->GetIntParameter("COMPUTE_GRAD");
+    vector<CPatchBuffer> patches(pyramid.size(),CPatchBuffer(2*m_params->GetIntParameter("DESCRIPTOR_HSIZE")+1));
+
+    if(id || grad) {
+
+        for(size_t s=0; s<pyramid.size(); s++) {
+
+            if(rois[s].size()==0)
+                continue;
+
+            if(grad)
+                patches[s].Compute(caches[s],rois[s]);
+            else
+                patches[s].Compute(pyramid[s],rois[s]);
+
+        }
+
+    }
+
+    for(size_t l=0; l<alive.size(); l++) {
+
+        if(alive[l]) {
 
             // interpret tracklet as simple tracker tracklet
-            shared_ptr<CSimpleTrackerTracklet> tracklet = static_pointer_cast<CSimpleTrackerTracklet>(*it);
+            CSimpleTrackerTracklet* tracklet = static_cast<CSimpleTrackerTracklet*>(GetTracklet(l));
+
+            imfeature& x = tracklet->GetLatestState();
+            int s = int(scales[l]);
+
+            // features are visited in the order they were collected
+            size_t k = counter[s]++;
+            const CRectangle<double>& droi = rois[s][k];
+
+            // get brief descriptor and attach it to the feature
+            shared_ptr<CPackedBRIEF> briefdesc1 = briefs[s][k];
+            shared_ptr<CAbstractDescriptor> brief = static_pointer_cast<CAbstractDescriptor>(briefdesc1);
+            x.AttachDescriptor("BRIEF",brief);
 
             float quality;
             // check whether this has just been added or not
             if(tracklet->m_reference_feature.HasDescriptor("BRIEF")) {
 
                 shared_ptr<CAbstractDescriptor> desc0 = tracklet->m_reference_feature.GetDescriptor("BRIEF");
-                shared_ptr<CBRIEF> briefdesc0 = static_pointer_cast<CBRIEF>(desc0);
+                shared_ptr<CPackedBRIEF> briefdesc0 = static_pointer_cast<CPackedBRIEF>(desc0);
                 quality = briefdesc0->Distance(*briefdesc1);
 
             } else {
@@ -308,17 +346,18 @@ void CSimpleTracker::UpdateDescriptors(const std::vector<cv::Mat>& pyramid) {
 
             }
 
-            // set quality
+            // set quality, Clean() reads it from the store
             x.SetQuality(quality);
+            qualities[l] = quality;
 
-            if(m_params->GetIntParameter("COMPUTE_ID")) {
+            if(id) {
 
                 // compute identity descriptor
                 CIdentityDescriptor* tempid = new CIdentityDescriptor(droi,
                                                                       (size_t)m_params->GetIntParameter("NORMALIZE_ID"),
                                                                       (size_t)m_params->GetIntParameter("DESCRIPTOR_HSIZE"));
 
-                tempid->Compute(pyramid[s]);
+                tempid->Compute(patches[s],k);
 
                 // cast and attach
                 shared_ptr<CAbstractDescriptor> id(tempid);
@@ -326,14 +365,14 @@ void CSimpleTracker::UpdateDescriptors(const std::vector<cv::Mat>& pyramid) {
 
             }
 
-            if(m_params->GetIntParameter("COMPUTE_GRAD")) {
+            if(grad) {
 
                 // compute normalized gradient field
                 CIdentityGradientDescriptor* temp = new CIdentityGradientDescriptor(droi,
                                                                                     m_params->GetDoubleParameter("ALPHA_GRAD_NORM"),
                                                                                     (size_t)m_params->GetIntParameter("NORMALIZE_GRAD"),
                                                                                     (size_t)m_params->GetIntParameter("DESCRIPTOR_HSIZE"));
-                temp->Compute(pyramid[s]);
+                temp->Compute(patches[s],k);
 
                 // cast and attach
                 shared_ptr<CAbstractDescriptor> idg(temp);
@@ -345,7 +384,11 @@ void CSimpleTracker::UpdateDescriptors(const std::vector<cv::Mat>& pyramid) {
 
                 // compute HoG
                 CHistogramOfGradients* temp = new CHistogramOfGradients(droi);
-                temp->Compute(pyramid[s]);
+
+                if(ihog)
+                    temp->ComputeIntegral(caches[s]);
+                else
+                    temp->Compute(caches[s]);
 
                 // cast and attach
                 shared_ptr<CAbstractDescriptor> pdesc(temp);
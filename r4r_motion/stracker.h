@@ -26,6 +26,8 @@
 
 #include "tracker.h"
 #include "descriptor.h"
+#include "lk.h"
+#include "fast.h"
 
 
 #include <opencv2/opencv.hpp>
@@ -81,8 +83,8 @@ private:
  * - ACCURACY time derivative of objective below which to break off Gauss-Newton iteration
  * - LAMBDA relative weight of the spatial image derivatives impact to the optical flow estimation
  *
- * Features stem from FAST detection with non-maximum suppression.  A weak minimal distance constraint is enforced
- * through integral images. A BRIEF descriptor is computed for every feature which enables a comparison with the
+ * Features stem from FAST detection with non-maximum suppression, keeping only the strongest corners per grid cell.
+ * A weak minimal distance constraint is enforced through occupancy grids. A BRIEF descriptor is computed for every feature which enables a comparison with the
  * initial configuration of the corresponding tracklet. This provides a simple but efficient mechanism for occlusion
  * detection.
  *
@@ -118,7 +120,9 @@ public:
 
 protected:
 
-	cv::FastFeatureDetector m_detector;						//!< feature detector
+    CFASTDetector m_detector;                               //!< feature detector
+    CPyramidalLukasKanade m_lk;                             //!< low-level motion estimation
+    std::vector<CBRIEFPattern> m_brief_patterns;            //!< BRIEF sampling patterns for all scales
 
 };
 
@@ -35,13 +35,19 @@ template<template<class Tracklet, class Allocator = std::allocator<Tracklet> > c
 CTracker<TrackerContainer,TrackletContainer>::CTracker():
     m_data(),
     m_params(nullptr),
-    m_global_t(0) {}
+    m_global_t(0),
+    m_grids(),
+    m_store(),
+    m_slots() {}
 
 template<template<class Tracklet, class Allocator = std::allocator<Tracklet> > class TrackerContainer,template<class T, class Allocator = std::allocator<T> > class TrackletContainer>
 CTracker<TrackerContainer,TrackletContainer>::CTracker(const CParameters *params):
     m_data(),
     m_params(params),
-    m_global_t(0) {}
+    m_global_t(0),
+    m_grids(),
+    m_store(),
+    m_slots() {}
 
 
 template<template<class Tracklet, class Allocator = std::allocator<Tracklet> > class TrackerContainer,template<class T, class Allocator = std::allocator<T> > class TrackletContainer>
@@ -49,9 +55,14 @@ CTracker<TrackerContainer,TrackletContainer>::~CTracker() {
 
     typename TrackerContainer<shared_ptr<CTracklet<TrackletContainer> > >::iterator it;
 
-    for(it=m_data.begin(); it!=m_data.end(); it++)
+    // tracklets held elsewhere must not refer to the store anymore
+    for(it=m_data.begin(); it!=m_data.end(); it++) {
+
+        (*it)->Release();
         it->reset();
 
+    }
+
 }
 
 template<template<class Tracklet, class Allocator = std::allocator<Tracklet> > class TrackerContainer,template<class T, class Allocator = std::allocator<T> > class TrackletContainer>
@@ -66,9 +77,23 @@ void CTracker<TrackerContainer,TrackletContainer>::DeleteInvalidTracks() {
 
         if((*it)->GetStatus())
             valid.push_back((*it));
-        else // reset shared ptr
+        else {
+
+            // free the slot in the store before resetting the shared ptr
+            shared_ptr<CStoredTracklet> stored = (*it)->GetStoredTracklet();
+            (*it)->Release();
+
+            if(stored) {
+
+                m_slots[stored->GetId().index] = nullptr;
+                m_store.Remove(stored->GetId());
+
+            }
+
             it->reset();
 
+        }
+
     }
 
     // replace data
@@ -82,6 +107,7 @@ shared_ptr<CTracklet<TrackletContainer> > CTracker<TrackerContainer,TrackletCont
     shared_ptr<CTracklet<TrackletContainer> > tracklet(new CTracklet<TrackletContainer>(m_global_t,x));
 
     m_data.push_back(tracklet);
+    Bind(tracklet.get());
 
 	return tracklet;
 
@@ -91,24 +117,28 @@ template<template<class Tracklet, class Allocator = std::allocator<Tracklet> > c
 void CTracker<TrackerContainer,TrackletContainer>::AddTracklet(CTracklet<TrackletContainer>* tracklet) {
 
     m_data.push_back(shared_ptr<CTracklet<TrackletContainer> >(tracklet));
+    Bind(tracklet);
 
 }
 
 template<template<class Tracklet, class Allocator = std::allocator<Tracklet> > class TrackerContainer,template<class T, class Allocator = std::allocator<T> > class TrackletContainer>
-size_t CTracker<TrackerContainer,TrackletContainer>::ActiveCapacity() const {
+void CTracker<TrackerContainer,TrackletContainer>::Bind(CTracklet<TrackletContainer>* tracklet) {
 
-	size_t result = 0;
+    CTrackletId id = m_store.Add(tracklet->GetCreationTime(),tracklet->GetLatestState());
+    m_store.GetStatus()[m_store.GetIndex(id)] = tracklet->GetStatus();
 
-    typename TrackerContainer<shared_ptr<CTracklet<TrackletContainer> > >::const_iterator it;
+    if(id.index>=m_slots.size())
+        m_slots.resize(id.index+1,nullptr);
 
-    for(it=m_data.begin(); it!=m_data.end(); it++) {
+    m_slots[id.index] = tracklet;
+    tracklet->Bind(m_store,id);
 
-        if((*it)->GetStatus())
-            result++;
+}
 
-    }
+template<template<class Tracklet, class Allocator = std::allocator<Tracklet> > class TrackerContainer,template<class T, class Allocator = std::allocator<T> > class TrackletContainer>
+size_t CTracker<TrackerContainer,TrackletContainer>::ActiveCapacity() const {
 
-	return result;
+    return m_store.ActiveCapacity();
 
 }
 
@@ -268,48 +298,21 @@ map<shared_ptr<CTracklet<TrackletContainer> >,list<shared_ptr<CTracklet<Tracklet
 template<template<class Tracklet, class Allocator = std::allocator<Tracklet> > class TrackerContainer,template<class T, class Allocator = std::allocator<T> > class TrackletContainer>
 void CTracker<TrackerContainer,TrackletContainer>::SetAllTrackletsActive() {
 
-    typename TrackerContainer<shared_ptr<CTracklet<TrackletContainer> > >::iterator it;
-
-    for(it=m_data.begin(); it!=m_data.end(); it++) {
-
-        (*it)->SetStatus(true);
-
-    }
+    m_store.SetAllTrackletsActive();
 
 }
 
 template<template<class Tracklet, class Allocator = std::allocator<Tracklet> > class TrackerContainer,template<class T, class Allocator = std::allocator<T> > class TrackletContainer>
 vector<size_t> CTracker<TrackerContainer,TrackletContainer>::ComputeFeatureDensity(vector<CIntImage<size_t> >& imgs) const {
 
-    typename TrackerContainer<shared_ptr<CTracklet<TrackletContainer> > >::const_iterator it;
-    vector<size_t> n(imgs.size());
-
-    for(it=m_data.begin(); it!=m_data.end(); it++) {
-
-        // only consider active tracklets
-        if((*it)->GetStatus()) {
-
-            // get the current feature
-            const imfeature& f = (*it)->GetLatestState();
-
-            // see what scale it is at (possibly with rounding)
-            u_int s = u_int(f.GetScale());
-
-            // count
-            n[s]++;
-
-            // set Dirac impulse at location in integral image
-            const vec2f& x = f.GetLocation();
+    return m_store.ComputeFeatureDensity(imgs);
 
-            // make sure we have an image at that scale
-            if(s<imgs.size())
-                imgs[s].AddMass(x.Get(1),x.Get(0),1.0);
-
-        }
+}
 
-    }
+template<template<class Tracklet, class Allocator = std::allocator<Tracklet> > class TrackerContainer,template<class T, class Allocator = std::allocator<T> > class TrackletContainer>
+vector<size_t> CTracker<TrackerContainer,TrackletContainer>::ComputeFeatureDensity(vector<COccupancyGrid>& grids) const {
 
-    return n;
+    return m_store.ComputeFeatureDensity(grids);
 
 }
 
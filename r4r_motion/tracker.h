@@ -48,6 +48,8 @@
 #include "params.h"
 #include "image.h"
 #include "dagg.h"
+#include "ogrid.h"
+#include "tstore.h"
 
 namespace R4R {
 
@@ -164,6 +166,15 @@ public:
 	 */
     std::vector<size_t> ComputeFeatureDensity(std::vector<CIntImage<size_t> >& imgs) const;
 
+    /*! \brief Enters the locations of active features into occupancy grids.
+     *
+     * \details The grids are cleared first. Features at scales without a grid are only counted.
+     *
+     * \returns number of active features per scale
+     *
+     */
+    std::vector<size_t> ComputeFeatureDensity(std::vector<COccupancyGrid>& grids) const;
+
 	//! Returns the set of parameters.
     const CParameters& GetParameters() { return *m_params; }
 
@@ -176,6 +187,9 @@ public:
     //! Adjusts the size of all tracklet buffer.
     void ResizeTracklets(size_t n);
 
+    //! Read-only access to the columns of the tracklets.
+    const CTrackletStore& GetStore() const { return m_store; }
+
 #ifdef QT_GUI_LIB
     //! Draws active tracklets into an image.
     void Draw(QImage& img, size_t length) const;
@@ -189,6 +203,15 @@ protected:
     TrackerContainer<std::shared_ptr<CTracklet<TrackletContainer> > >  m_data;     //!< container holding the tracklets
     const CParameters* m_params;                                                   //!< container for user-defined parameters
     size_t m_global_t;                                                             //!< global time variable
+    std::vector<COccupancyGrid> m_grids;                                           //!< occupancy of each pyramid level, kept between frames
+    CTrackletStore m_store;                                                        //!< latest state and status of all tracklets in m_data
+    std::vector<CTracklet<TrackletContainer>*> m_slots;                            //!< tracklet bound to each slot of the store
+
+    //! Registers a tracklet with the store.
+    void Bind(CTracklet<TrackletContainer>* tracklet);
+
+    //! Tracklet at a dense index of the store.
+    CTracklet<TrackletContainer>* GetTracklet(size_t k) const { return m_slots[m_store.GetId(k).index]; }
 
 };
 
@@ -40,7 +40,8 @@ CTracklet<Container>::CTracklet(size_t t0, const imfeature& x0, size_t maxlength
     m_data(),
 	m_t0(t0),
     m_status(true),
-    m_hash(GenerateHash(t0,x0)) {
+    m_hash(GenerateHash(t0,x0)),
+    m_stored() {
 
     m_data.push_back(x0);
 
@@ -51,7 +52,8 @@ CTracklet<CRingBuffer>::CTracklet(size_t t0, const imfeature& x0, size_t maxleng
     m_data(maxlength),
     m_t0(t0),
     m_status(true),
-    m_hash(GenerateHash(t0,x0)) {
+    m_hash(GenerateHash(t0,x0)),
+    m_stored() {
 
     m_data.push_back(x0);
 
@@ -62,6 +64,22 @@ void CTracklet<Container>::Update(const imfeature& x) {
 
     m_data.push_back(x);
 
+    if(m_stored)
+        m_stored->Update(x);
+
+}
+
+template<template<class T, class Allocator = std::allocator<T> > class Container>
+void CTracklet<Container>::Release() {
+
+    if(!m_stored)
+        return;
+
+    if(m_stored->IsValid())
+        m_status = m_stored->GetStatus();
+
+    m_stored.reset();
+
 }
 
 template<template<class T,class Allocator = std::allocator<T> > class Container>
@@ -38,6 +38,7 @@
 
 #include "feature.h"
 #include "rbuffer.h"
+#include "tstore.h"
 
 namespace R4R {
 
@@ -59,6 +60,19 @@ public:
     //! Directly updates the state without any filtering.
     void Update(const imfeature& x);
 
+    /*! \brief Binds the tracklet to a store.
+     *
+     * \details From then on, the status is kept in the store, and updates are mirrored into it.
+     *
+     */
+    void Bind(CTrackletStore& store, const CTrackletId& id) { m_stored = std::make_shared<CStoredTracklet>(store,id); }
+
+    //! Copies the status back from the store and unbinds the tracklet.
+    void Release();
+
+    //! Access to the store adaptor, empty if the tracklet is not bound.
+    const std::shared_ptr<CStoredTracklet>& GetStoredTracklet() const { return m_stored; }
+
     /*! \brief Provides access to previous feature position.
      *
      * \param[in] steps number of steps to go back in time
@@ -95,10 +109,10 @@ public:
     float GetScale() const { return m_data.back().GetScale(); }
 
     //! Gets the status.
-    bool GetStatus() const { return m_status; }
+    bool GetStatus() const { return m_stored ? m_stored->GetStatus() : m_status; }
 
     //! Sets the status flag.
-    void SetStatus(bool status) { m_status = status; }
+    void SetStatus(bool status) { if(m_stored) m_stored->SetStatus(status); else m_status = status; }
 
     /*! \brief Gets the creation time.
      *
@@ -139,6 +153,7 @@ private:
     size_t m_t0;                       //!< creation time
     bool m_status;                     //!< status
     std::string m_hash;                //!< hash key for tracklet
+    std::shared_ptr<CStoredTracklet> m_stored;  //!< latest state and status in a store, if bound
 
 };
 
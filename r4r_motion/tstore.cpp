@@ -0,0 +1,324 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "tstore.h"
+
+#include <math.h>
+
+using namespace std;
+
+namespace R4R {
+
+CTrackletStore::CTrackletStore(size_t maxlength):
+    m_maxlength(maxlength),
+    m_dense(),
+    m_generation(),
+    m_free(),
+    m_slot(),
+    m_location(),
+    m_scale(),
+    m_quality(),
+    m_status(),
+    m_t0(),
+    m_history(),
+    m_head(),
+    m_length() {
+
+    if(maxlength==0) {
+
+        cerr << "ERROR: Tracklets must hold at least one state." << endl;
+        m_maxlength = 1;
+
+    }
+
+}
+
+CTrackletId CTrackletStore::Add(size_t t0, const imfeature& x0) {
+
+    u_int slot;
+
+    if(m_free.size()>0) {
+
+        slot = m_free.back();
+        m_free.pop_back();
+
+    }
+    else {
+
+        slot = m_dense.size();
+        m_dense.push_back(0);
+        m_generation.push_back(0);
+        m_head.push_back(0);
+        m_length.push_back(0);
+        m_history.resize(m_history.size()+m_maxlength);
+
+    }
+
+    m_dense[slot] = m_slot.size();
+    m_head[slot] = m_maxlength - 1;
+    m_length[slot] = 0;
+
+    m_slot.push_back(slot);
+    m_location.push_back(x0.GetLocation());
+    m_scale.push_back(x0.GetScale());
+    m_quality.push_back(x0.GetQuality());
+    m_status.push_back(1);
+    m_t0.push_back(t0);
+
+    Update(m_slot.size()-1,x0.GetLocation(),x0.GetScale(),x0.GetQuality());
+
+    CTrackletId id = { slot, m_generation[slot] };
+
+    return id;
+
+}
+
+bool CTrackletStore::IsValid(const CTrackletId& id) const {
+
+    return id.index<m_generation.size() && m_generation[id.index]==id.generation && m_dense[id.index]<m_slot.size() && m_slot[m_dense[id.index]]==id.index;
+
+}
+
+CTrackletId CTrackletStore::GetId(size_t k) const {
+
+    CTrackletId id = { m_slot[k], m_generation[m_slot[k]] };
+
+    return id;
+
+}
+
+bool CTrackletStore::Remove(const CTrackletId& id) {
+
+    if(!IsValid(id))
+        return false;
+
+    size_t k = m_dense[id.index];
+    size_t last = m_slot.size() - 1;
+
+    // move the last tracklet into the gap
+    if(k!=last) {
+
+        m_slot[k] = m_slot[last];
+        m_location[k] = m_location[last];
+        m_scale[k] = m_scale[last];
+        m_quality[k] = m_quality[last];
+        m_status[k] = m_status[last];
+        m_t0[k] = m_t0[last];
+        m_dense[m_slot[k]] = k;
+
+    }
+
+    m_slot.pop_back();
+    m_location.pop_back();
+    m_scale.pop_back();
+    m_quality.pop_back();
+    m_status.pop_back();
+    m_t0.pop_back();
+
+    // invalidate all handles to the slot
+    m_generation[id.index]++;
+    m_free.push_back(id.index);
+
+    return true;
+
+}
+
+void CTrackletStore::Update(size_t k, const vec2f& x, float scale, float quality) {
+
+    u_int slot = m_slot[k];
+
+    m_location[k] = x;
+    m_scale[k] = scale;
+    m_quality[k] = quality;
+
+    // advance the ring
+    m_head[slot] = (m_head[slot] + 1)%m_maxlength;
+
+    if(m_length[slot]<m_maxlength)
+        m_length[slot]++;
+
+    CState& state = m_history[slot*m_maxlength+m_head[slot]];
+    state.location = x;
+    state.scale = scale;
+
+}
+
+const CTrackletStore::CState& CTrackletStore::GetPastState(size_t k, size_t steps) const {
+
+    u_int slot = m_slot[k];
+
+    if(steps>=m_length[slot]) {
+
+        cerr << "ERROR: Tracklet history is not long enough." << endl;
+        steps = m_length[slot] - 1;
+
+    }
+
+    size_t i = (m_head[slot] + m_maxlength - steps)%m_maxlength;
+
+    return m_history[slot*m_maxlength+i];
+
+}
+
+const vec2f& CTrackletStore::GetPastLocation(size_t k, size_t steps) const {
+
+    return GetPastState(k,steps).location;
+
+}
+
+vec2f CTrackletStore::GetPastLocationAtNativeScale(size_t k, size_t steps) const {
+
+    const CState& state = GetPastState(k,steps);
+
+    return state.location*float(pow(2,state.scale));
+
+}
+
+size_t CTrackletStore::ActiveCapacity() const {
+
+    size_t result = 0;
+
+    for(size_t k=0; k<m_status.size(); k++)
+        result += m_status[k];
+
+    return result;
+
+}
+
+void CTrackletStore::DeleteInvalidTracks() {
+
+    // go backwards, so that swapped-in tracklets have already been checked
+    for(size_t k=m_slot.size(); k>0; k--) {
+
+        if(!m_status[k-1])
+            Remove(GetId(k-1));
+
+    }
+
+}
+
+void CTrackletStore::SetAllTrackletsActive() {
+
+    fill(m_status.begin(),m_status.end(),1);
+
+}
+
+CTrackletId CTrackletStore::SearchFittestTracklet(size_t t) const {
+
+    CTrackletId result = { u_int(m_dense.size()), 0 };
+    size_t max = 0;
+
+    for(size_t k=0; k<m_t0.size(); k++) {
+
+        size_t lifetime = t - m_t0[k];
+
+        if(lifetime>=max) {
+
+            result = GetId(k);
+            max = lifetime;
+
+        }
+
+    }
+
+    return result;
+
+}
+
+vector<size_t> CTrackletStore::ComputeFeatureDensity(vector<CIntImage<size_t> >& imgs) const {
+
+    vector<size_t> n(imgs.size());
+
+    for(size_t k=0; k<m_status.size(); k++) {
+
+        // only consider active tracklets at scales for which there is an image
+        u_int s = u_int(m_scale[k]);
+
+        if(m_status[k] && s<imgs.size()) {
+
+            n[s]++;
+            imgs[s].AddMass(m_location[k].Get(1),m_location[k].Get(0),1.0);
+
+        }
+
+    }
+
+    return n;
+
+}
+
+vector<size_t> CTrackletStore::ComputeFeatureDensity(vector<COccupancyGrid>& grids) const {
+
+    vector<size_t> n(grids.size());
+
+    for(size_t s=0; s<grids.size(); s++)
+        grids[s].Clear();
+
+    for(size_t k=0; k<m_status.size(); k++) {
+
+        // only consider active tracklets at scales for which there is a grid
+        u_int s = u_int(m_scale[k]);
+
+        if(m_status[k] && s<grids.size()) {
+
+            n[s]++;
+            grids[s].Insert(m_location[k]);
+
+        }
+
+    }
+
+    return n;
+
+}
+
+void CTrackletStore::ResizeTracklets(size_t n) {
+
+    if(n==0 || n==m_maxlength)
+        return;
+
+    vector<CState> history(m_dense.size()*n);
+
+    for(size_t slot=0; slot<m_dense.size(); slot++) {
+
+        // copy the most recent states, oldest first
+        size_t length = min<size_t>(m_length[slot],n);
+
+        for(size_t i=0; i<length; i++) {
+
+            size_t j = (m_head[slot] + m_maxlength - (length - 1 - i))%m_maxlength;
+            history[slot*n+i] = m_history[slot*m_maxlength+j];
+
+        }
+
+        m_length[slot] = length;
+        m_head[slot] = length>0 ? length - 1 : n - 1;
+
+    }
+
+    m_history.swap(history);
+    m_maxlength = n;
+
+}
+
+} // end of namespace
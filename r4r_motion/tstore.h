@@ -0,0 +1,239 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef R4RTSTORE_H_
+#define R4RTSTORE_H_
+
+#include <vector>
+
+#include "feature.h"
+#include "image.h"
+#include "ogrid.h"
+
+namespace R4R {
+
+/*! \brief generational handle of a tracklet
+ *
+ * \details The index refers to a slot which is recycled after the tracklet has been removed. The
+ * generation counter of the slot is incremented at the same time so that stale handles can be
+ * detected.
+ *
+ */
+struct CTrackletId {
+
+    u_int index;                    //!< slot index
+    u_int generation;               //!< generation of the slot at creation time
+
+    bool operator==(const CTrackletId& id) const { return index==id.index && generation==id.generation; }
+
+    bool operator!=(const CTrackletId& id) const { return !operator==(id); }
+
+};
+
+/*! \brief tracklet container with structure-of-arrays layout
+ *
+ * \details The state that is touched in every frame (latest location, scale, quality, status, and
+ * creation time) is kept in contiguous columns which are densely packed, i.e., removal swaps the
+ * last tracklet into the gap. Handles stay valid because they point to slots which map to the
+ * dense columns. The trajectories share a single arena in which every slot owns a ring buffer of
+ * fixed length. Descriptors are not stored here.
+ *
+ */
+class CTrackletStore {
+
+public:
+
+    //! Constructor.
+    CTrackletStore(size_t maxlength = 200);
+
+    //! Adds a new tracklet and returns its handle.
+    CTrackletId Add(size_t t0, const imfeature& x0);
+
+    //! Removes a tracklet, returns false if the handle is stale.
+    bool Remove(const CTrackletId& id);
+
+    //! Checks whether a handle refers to an existing tracklet.
+    bool IsValid(const CTrackletId& id) const;
+
+    //! Dense index of a tracklet.
+    size_t GetIndex(const CTrackletId& id) const { return m_dense[id.index]; }
+
+    //! Handle of the tracklet at a dense index.
+    CTrackletId GetId(size_t k) const;
+
+    //! Appends a state to the tracklet at a dense index.
+    void Update(size_t k, const vec2f& x, float scale, float quality = 0);
+
+    //! Appends a state to a tracklet.
+    void Update(const CTrackletId& id, const imfeature& x) { Update(GetIndex(id),x.GetLocation(),x.GetScale(),x.GetQuality()); }
+
+    //! Provides access to previous feature position of the tracklet at a dense index.
+    const vec2f& GetPastLocation(size_t k, size_t steps) const;
+
+    //! Provides access to previous feature position w.r.t. to the native scale.
+    vec2f GetPastLocationAtNativeScale(size_t k, size_t steps) const;
+
+    //! Number of states in the history of the tracklet at a dense index.
+    size_t GetLifetime(size_t k) const { return m_length[m_slot[k]]; }
+
+    //! Computes the number of tracklets in the container.
+    size_t Capacity() const { return m_slot.size(); }
+
+    //! Computes the number of tracklets in the container that are still alive.
+    size_t ActiveCapacity() const;
+
+    //! Deletes all tracklets which have died.
+    void DeleteInvalidTracks();
+
+    //! Sets all tracklets to active.
+    void SetAllTrackletsActive();
+
+    //! Searches for the tracklet with maximal life time.
+    CTrackletId SearchFittestTracklet(size_t t) const;
+
+    //! \copydoc CTracker::ComputeFeatureDensity(std::vector<CIntImage<size_t> >&)
+    std::vector<size_t> ComputeFeatureDensity(std::vector<CIntImage<size_t> >& imgs) const;
+
+    //! \copydoc CTracker::ComputeFeatureDensity(std::vector<COccupancyGrid>&)
+    std::vector<size_t> ComputeFeatureDensity(std::vector<COccupancyGrid>& grids) const;
+
+    //! Adjusts the length of all histories, this drops old states.
+    void ResizeTracklets(size_t n);
+
+    //! Latest locations.
+    std::vector<vec2f>& GetLocations() { return m_location; }
+
+    //! Latest scales.
+    std::vector<float>& GetScales() { return m_scale; }
+
+    //! Latest qualities.
+    std::vector<float>& GetQualities() { return m_quality; }
+
+    //! Status flags.
+    std::vector<unsigned char>& GetStatus() { return m_status; }
+
+    //! Creation times.
+    const std::vector<size_t>& GetCreationTimes() const { return m_t0; }
+
+private:
+
+    /*! \brief element of the history arena
+     *
+     */
+    struct CState {
+
+        vec2f location;
+        float scale;
+
+    };
+
+    size_t m_maxlength;                             //!< length of the history of each tracklet
+
+    // slots
+    std::vector<u_int> m_dense;                     //!< dense index of each slot
+    std::vector<u_int> m_generation;                //!< generation of each slot
+    std::vector<u_int> m_free;                      //!< list of free slots
+
+    // dense columns
+    std::vector<u_int> m_slot;                      //!< slot of each tracklet
+    std::vector<vec2f> m_location;                  //!< latest locations
+    std::vector<float> m_scale;                     //!< latest scales
+    std::vector<float> m_quality;                   //!< latest qualities
+    std::vector<unsigned char> m_status;            //!< status flags
+    std::vector<size_t> m_t0;                       //!< creation times
+
+    // history
+    std::vector<CState> m_history;                  //!< arena holding one ring buffer per slot
+    std::vector<u_int> m_head;                      //!< position of the latest state in the ring of each slot
+    std::vector<u_int> m_length;                    //!< number of states in the ring of each slot
+
+    //! Access to the history of a slot.
+    const CState& GetPastState(size_t k, size_t steps) const;
+
+};
+
+/*! \brief adaptor which exposes a tracklet in a CTrackletStore through the interface of CTracklet
+ *
+ */
+class CStoredTracklet {
+
+public:
+
+    //! Constructor.
+    CStoredTracklet(CTrackletStore& store, const CTrackletId& id):m_store(store), m_id(id) {}
+
+    //! Directly updates the state without any filtering.
+    void Update(const imfeature& x) { m_store.Update(m_id,x); }
+
+    //! Provides access to previous feature position.
+    const vec2f& GetPastLocation(size_t steps) const { return m_store.GetPastLocation(Index(),steps); }
+
+    //! Provides access to previous feature position w.r.t. to the native scale.
+    vec2f GetPastLocationAtNativeScale(size_t steps) const { return m_store.GetPastLocationAtNativeScale(Index(),steps); }
+
+    //! Provides access to the current feature position.
+    const vec2f& GetLatestLocation() const { return m_store.GetLocations()[Index()]; }
+
+    //! Provides access to the current feature position w.r.t. to the native scale.
+    vec2f GetLatestLocationAtNativeScale() const { return GetPastLocationAtNativeScale(0); }
+
+    //! Returns the current scale.
+    float GetScale() const { return m_store.GetScales()[Index()]; }
+
+    //! Gets the status.
+    bool GetStatus() const { return m_store.GetStatus()[Index()]; }
+
+    //! Sets the status flag.
+    void SetStatus(bool status) { m_store.GetStatus()[Index()] = status; }
+
+    //! Returns the latest quality.
+    float GetQuality() const { return m_store.GetQualities()[Index()]; }
+
+    //! Sets the latest quality.
+    void SetQuality(float quality) { m_store.GetQualities()[Index()] = quality; }
+
+    //! Gets the creation time.
+    size_t GetCreationTime() const { return m_store.GetCreationTimes()[Index()]; }
+
+    //! Life-time of tracklet.
+    size_t GetLifetime() const { return m_store.GetLifetime(Index()); }
+
+    //! Checks whether the tracklet still exists.
+    bool IsValid() const { return m_store.IsValid(m_id); }
+
+    //! Returns the handle.
+    const CTrackletId& GetId() const { return m_id; }
+
+private:
+
+    CTrackletStore& m_store;                //!< store holding the data
+    CTrackletId m_id;                       //!< handle
+
+    //! Current dense index.
+    size_t Index() const { return m_store.GetIndex(m_id); }
+
+};
+
+} // end of namespace
+
+#endif /* TSTORE_H_ */
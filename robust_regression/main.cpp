@@ -158,14 +158,28 @@ COsbourneFunction::COsbourneFunction():
 
 void COsbourneFunction::ComputeResidual(vec& r) const {
 
-    for(size_t i=0; i<GetNumberOfDataPoints(); i++)
-        r(i) = (m_y[i] - (m_model.Get(0) + m_model.Get(1)*exp(-m_model.Get(3)*m_t[i]) + m_model.Get(2)*exp(-m_model.Get(4)*m_t[i])));
+    ComputeResidual(0,GetNumberOfDataPoints(),r);
+
+}
+
+bool COsbourneFunction::ComputeResidual(size_t begin, size_t end, vec& r) const {
+
+    for(size_t i=begin; i<end; i++)
+        r(i) = (m_model.Get(0) + m_model.Get(1)*exp(-m_model.Get(3)*m_t[i]) + m_model.Get(2)*exp(-m_model.Get(4)*m_t[i])) - m_y[i];
+
+    return true;
 
 }
 
 void COsbourneFunction::ComputeResidualAndJacobian(vec& r, mat& J) const {
 
-    for(size_t i=0; i<GetNumberOfDataPoints(); i++) {
+    ComputeResidualAndJacobian(0,GetNumberOfDataPoints(),r,J);
+
+}
+
+bool COsbourneFunction::ComputeResidualAndJacobian(size_t begin, size_t end, vec& r, mat& J) const {
+
+    for(size_t i=begin; i<end; i++) {
 
         r(i) = m_weights.Get(i)*((m_model.Get(0) + m_model.Get(1)*exp(-m_model.Get(3)*m_t[i]) + m_model.Get(2)*exp(-m_model.Get(4)*m_t[i])) - m_y[i]);
 
@@ -177,6 +191,8 @@ void COsbourneFunction::ComputeResidualAndJacobian(vec& r, mat& J) const {
 
     }
 
+    return true;
+
 }
 
 void COsbourneFunction::DisturbSamplePoints(size_t noutlier, double strength) {
@@ -67,6 +67,12 @@ public:
     //! \copydoc CLeastSquaresProblem::ComputeResidual(vec&)
     void ComputeResidual(vec& r) const;
 
+    //! \copydoc CLeastSquaresProblem::ComputeResidualAndJacobian(size_t,size_t,CDenseVector<T>&,Matrix&)
+    bool ComputeResidualAndJacobian(size_t begin, size_t end, vec& r, mat& J) const;
+
+    //! \copydoc CLeastSquaresProblem::ComputeResidual(size_t,size_t,CDenseVector<T>&)
+    bool ComputeResidual(size_t begin, size_t end, vec& r) const;
+
     //! Generates abscissae and ordinates pairs.
     void DisturbSamplePoints(size_t noutlier, double strength);
 
@@ -25,6 +25,7 @@
 #include "ui_mainwindow.h"
 
 #include "nabla.h"
+#include "tv.h"
 
 #include <QFileDialog>
 
@@ -42,7 +43,9 @@ MainWindow::MainWindow(QWidget *parent) :
     m_f(),
     m_A(),
     m_nabla(),
-    m_u()
+    m_u(),
+    m_M(),
+    m_poisson()
 {
     ui->setupUi(this);
     this->setFixedSize(this->width(),this->height());
@@ -89,6 +92,9 @@ void MainWindow::on_actionOpen_triggered()
     der.ComputeGradientOperator(m_nabla);
     der.ComputeJacobian(m_A);
 
+    // transforms of the direct solver depend on the image size only
+    m_poisson.reset(new CScreenedPoissonSolver<float>(m_M,m_u.NRows(),m_u.NCols()));
+
 }
 
 void MainWindow::show_image() {
@@ -149,46 +155,82 @@ void MainWindow::on_iterButton_clicked() {
     if(m_f.NElems()==0)
         return;
 
-    // create linear solver
-    CPreconditioner<CCSRMatrix<float,size_t>,float> M;
-    CConjugateGradientMethodLeastSquares<CCSRMatrix<float,size_t>,float> linsolver(M,
-                                                                ui->linIterSpinBox->value(),
-                                                                1e-20,
-                                                                true);
-    // get reshaped version of f and u
-    vecf u = vecf(m_u);
-    vecf f = vecf(m_f);
-
-    // create SB solver
-    CSplitBregman<CCSRMatrix<float,size_t>,float> solver(m_A,
-                                      m_nabla,
-                                      f,
-                                      u,
-                                      R4R::DIM::TWO,
-                                      linsolver,
-                                      ui->muEdit->text().toFloat(),
-                                      ui->lambdaEdit->text().toFloat(),
-                                      ui->epsEdit->text().toFloat());
-
+    vector<double> error, constraint;
 
 #ifdef HAVE_TBB
     tick_count t0, t1;
-    t0 = tick_count::now();
 #endif
-    // iterate
-    solver.Iterate(ui->niterSpinBox->value());
+
+    if(ui->pdCheckBox->isChecked()) {
+
+        // matrix-free primal-dual method, no need for the penalty and CGLS
+        CPrimalDualTV<float> solver(m_f,
+                                    m_u,
+                                    ui->muEdit->text().toFloat(),
+                                    FIDELITY::L2,
+                                    ui->epsEdit->text().toFloat());
+        solver.SetAdaptiveStepSizes(true);
+
+#ifdef HAVE_TBB
+        t0 = tick_count::now();
+#endif
+        solver.Iterate(ui->niterSpinBox->value());
 #ifdef HAVE_TBB
-    t1 = tick_count::now();
-    cout << "Time to execute step: " << (t1-t0).seconds() << " s" << endl;
+        t1 = tick_count::now();
+        cout << "Time to execute step: " << (t1-t0).seconds() << " s" << endl;
 #endif
 
-    // convert back to image
-    m_u = matf(m_u.NRows(),m_u.NCols(),u);
+        error = solver.GetTotalError();
+        constraint = solver.GetConstraintViolation();
 
-    // show errors
-    vector<double>& error = solver.GetTotalError();
-    vector<double>& constraint = solver.GetConstraintViolation();
+    }
+    else {
+
+        // create linear solver
+        CConjugateGradientMethodLeastSquares<CLinearOperator<float>,float> cgls(m_M,
+                                                                    ui->linIterSpinBox->value(),
+                                                                    1e-20,
+                                                                    true);
+
+        // direct solver for the u-subproblem if desired
+        const CIterativeLinearSolver<CLinearOperator<float>,float>* linsolver = &cgls;
+        if(ui->directCheckBox->isChecked())
+            linsolver = m_poisson.get();
+
+        // get reshaped version of f and u
+        vecf u = vecf(m_u);
+        vecf f = vecf(m_f);
+
+        // create SB solver
+        CSplitBregman<CCSRMatrix<float,size_t>,float> solver(m_A,
+                                          m_nabla,
+                                          f,
+                                          u,
+                                          R4R::DIM::TWO,
+                                          *linsolver,
+                                          ui->muEdit->text().toFloat(),
+                                          ui->lambdaEdit->text().toFloat(),
+                                          ui->epsEdit->text().toFloat());
 
+#ifdef HAVE_TBB
+        t0 = tick_count::now();
+#endif
+        // iterate
+        solver.Iterate(ui->niterSpinBox->value());
+#ifdef HAVE_TBB
+        t1 = tick_count::now();
+        cout << "Time to execute step: " << (t1-t0).seconds() << " s" << endl;
+#endif
+
+        // convert back to image
+        m_u = matf(m_u.NRows(),m_u.NCols(),u);
+
+        error = solver.GetTotalError();
+        constraint = solver.GetConstraintViolation();
+
+    }
+
+    // show errors
     if(!error.empty() && !constraint.empty()) {
 
         ui->errorLcdNumber->display(error.back());
@@ -30,6 +30,9 @@
 #include "types.h"
 #include "lm.h"
 #include "image.h"
+#include "fft.h"
+
+#include <memory>
 
 namespace Ui {
 class MainWindow;
@@ -64,6 +67,8 @@ private:
     R4R::CCSRMatrix<float,size_t> m_A;
     R4R::CCSRMatrix<float,size_t> m_nabla;
     R4R::matf m_u;
+    R4R::CPreconditioner<R4R::CLinearOperator<float>,float> m_M;
+    std::shared_ptr<R4R::CScreenedPoissonSolver<float> > m_poisson;
 
 };
 
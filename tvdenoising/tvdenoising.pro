@@ -49,6 +49,12 @@ unix:!symbian|win32: {
     LIBS += -L$$OUT_PWD/../r4r_core/ \
             -lr4r_core
 
+    # must agree with r4r_core because of the direct solver
+    packagesExist(fftw3) {
+        DEFINES += HAVE_FFTW
+        LIBS += -lfftw3
+    }
+
     target.path = $$OUT_PWD/../bin
     INSTALLS += target
 
@@ -0,0 +1,207 @@
+/*////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2013, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////*/
+
+#include "ffttest.h"
+#include "fft.h"
+
+using namespace R4R;
+using namespace std;
+
+// direct evaluation of the two-dimensional DFT of a row-major array
+static vector<complex<double> > DFT(const complex<double>* x, size_t nrows, size_t ncols, bool inverse) {
+
+    vector<complex<double> > y(nrows*ncols);
+    double sign = inverse ? 1 : -1;
+
+    for(size_t k=0; k<nrows; k++) {
+
+        for(size_t l=0; l<ncols; l++) {
+
+            for(size_t i=0; i<nrows; i++) {
+
+                for(size_t j=0; j<ncols; j++) {
+
+                    double phi = 2*M_PI*(double(i*k)/double(nrows) + double(j*l)/double(ncols));
+                    y[k*ncols+l] += x[i*ncols+j]*polar(1.0,sign*phi);
+
+                }
+
+            }
+
+        }
+
+    }
+
+    return y;
+
+}
+
+CFourierTransformTest::CFourierTransformTest(QObject* parent):
+  QObject(parent),
+  m_tolerance(1e-9) {
+
+}
+
+void CFourierTransformTest::init() {
+
+}
+
+void CFourierTransformTest::testFastFourierTransform() {
+
+    // powers of two, odd, and even lengths which are not
+    const size_t lengths[] = { 1, 2, 16, 7, 12, 30, 97 };
+
+    for(size_t n : lengths) {
+
+        CFastFourierTransform fft(n);
+        QCOMPARE(fft.Size(),n);
+
+        vector<complex<double> > x(n);
+
+        for(size_t i=0; i<n; i++)
+            x[i] = complex<double>(sin(1.0+i),cos(0.3*i*i));
+
+        for(size_t l=0; l<2; l++) {
+
+            vector<complex<double> > y = x;
+            fft.Transform(&y[0],l==1);
+
+            vector<complex<double> > yref = DFT(&x[0],1,n,l==1);
+
+            for(size_t i=0; i<n; i++)
+                QVERIFY(abs(y[i]-yref[i])<m_tolerance*n);
+
+        }
+
+        // neither direction is normalized
+        vector<complex<double> > y = x;
+        fft.Transform(&y[0]);
+        fft.Transform(&y[0],true);
+
+        for(size_t i=0; i<n; i++)
+            QVERIFY(abs(y[i]-double(n)*x[i])<m_tolerance*n);
+
+    }
+
+}
+
+void CFourierTransformTest::testFourierPlanCache() {
+
+    // more arrays than fit into one batch, and a remainder
+    const size_t nrows = 6, ncols = 5, n = nrows*ncols, howmany = CFourierPlanCache::BATCH + 7;
+
+    vector<complex<double> > x(n*howmany);
+
+    for(size_t i=0; i<x.size(); i++)
+        x[i] = complex<double>(sin(0.1*i),cos(0.7*i));
+
+    vector<complex<double> > y = x;
+    CFourierPlanCache::Transform(&y[0],nrows,ncols,howmany);
+
+    for(size_t k=0; k<howmany; k++) {
+
+        vector<complex<double> > yref = DFT(&x[k*n],nrows,ncols,false);
+
+        for(size_t i=0; i<n; i++)
+            QVERIFY(abs(y[k*n+i]-yref[i])<m_tolerance*n);
+
+    }
+
+    CFourierPlanCache::Transform(&y[0],nrows,ncols,howmany,true);
+
+    for(size_t i=0; i<x.size(); i++)
+        QVERIFY(abs(y[i]-double(n)*x[i])<m_tolerance*n);
+
+    // concurrent calls, each on its own scratch memory, sizes are planned on first use
+    const int nthreads = 4;
+    vector<double> errors(nthreads,0);
+
+    #pragma omp parallel for num_threads(nthreads)
+    for(int t=0; t<nthreads; t++) {
+
+        size_t m = 3 + t;
+        complex<double>* z = CFourierPlanCache::Scratch(m*m);
+
+        for(size_t i=0; i<m*m; i++)
+            z[i] = x[i];
+
+        CFourierPlanCache::Transform(z,m,m);
+
+        vector<complex<double> > zref = DFT(&x[0],m,m,false);
+
+        for(size_t i=0; i<m*m; i++)
+            errors[t] = max(errors[t],abs(z[i]-zref[i]));
+
+    }
+
+    for(int t=0; t<nthreads; t++)
+        QVERIFY(errors[t]<m_tolerance*n);
+
+    CFourierPlanCache::Clear();
+
+}
+
+void CFourierTransformTest::testDiscreteCosineTransform() {
+
+    const size_t nrows = 7, ncols = 4;
+
+    CDiscreteCosineTransform dct(nrows,ncols);
+
+    vector<double> x(nrows*ncols);
+
+    for(size_t i=0; i<x.size(); i++)
+        x[i] = sin(1.0+i*i);
+
+    copy(x.begin(),x.end(),dct.Data());
+    dct.Forward();
+
+    // REDFT10 along both dimensions of the column-major array
+    for(size_t k=0; k<nrows; k++) {
+
+        for(size_t l=0; l<ncols; l++) {
+
+            double sum = 0;
+
+            for(size_t i=0; i<nrows; i++) {
+
+                for(size_t j=0; j<ncols; j++)
+                    sum += 4*x[j*nrows+i]*cos(M_PI*k*(i+0.5)/nrows)*cos(M_PI*l*(j+0.5)/ncols);
+
+            }
+
+            QVERIFY(fabs(dct.Data()[l*nrows+k]-sum)<m_tolerance*x.size());
+
+        }
+
+    }
+
+    dct.Inverse();
+
+    for(size_t i=0; i<x.size(); i++)
+        QVERIFY(fabs(dct.Data()[i]-4*x.size()*x[i])<m_tolerance*x.size());
+
+}
+
+void CFourierTransformTest::cleanup() {
+
+}
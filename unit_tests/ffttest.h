@@ -0,0 +1,58 @@
+/*////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2013, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////*/
+
+#ifndef FFTTEST_H
+#define FFTTEST_H
+
+#include <QtTest/QtTest>
+
+class CFourierTransformTest:public QObject {
+
+  Q_OBJECT
+
+public:
+
+  explicit CFourierTransformTest(QObject* parent = nullptr);
+
+private:
+
+    double m_tolerance;
+
+private slots:
+
+  void init();
+
+  //! Tests radix-2 and Bluestein transforms against the DFT.
+  void testFastFourierTransform();
+
+  //! Tests batched two-dimensional transforms from concurrent threads against the DFT.
+  void testFourierPlanCache();
+
+  //! Tests the two-dimensional DCT-II and its inverse against the definition.
+  void testDiscreteCosineTransform();
+
+  void cleanup();
+
+};
+
+#endif // FFTTEST_H
@@ -0,0 +1,172 @@
+/*////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2013, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////*/
+
+#include "imagetest.h"
+#include "image.h"
+
+using namespace R4R;
+using namespace std;
+
+// integral by the two-dimensional recursion, compared to the image within a relative tolerance
+template<typename T>
+static bool CheckIntegral(size_t width, size_t height, double tolerance) {
+
+    CIntImage<T> img(width,height);
+    vector<double> ref(height*width);
+
+    for(size_t i=0; i<height; i++) {
+
+        for(size_t j=0; j<width; j++) {
+
+            T val = T((i*31+j*17)%7);
+            img.AddMass(i,j,val);
+
+            ref[i*width+j] = double(val);
+
+            if(i>0)
+                ref[i*width+j] += ref[(i-1)*width+j];
+
+            if(j>0)
+                ref[i*width+j] += ref[i*width+j-1];
+
+            if(i>0 && j>0)
+                ref[i*width+j] -= ref[(i-1)*width+j-1];
+
+        }
+
+    }
+
+    img.Compute();
+
+    for(size_t i=0; i<height; i++) {
+
+        for(size_t j=0; j<width; j++) {
+
+            if(fabs(double(img.Get(i,j))-ref[i*width+j])>tolerance*(1+ref[i*width+j]))
+                return false;
+
+        }
+
+    }
+
+    return true;
+
+}
+
+CIntegralImageTest::CIntegralImageTest(QObject* parent):
+  QObject(parent) {
+
+}
+
+void CIntegralImageTest::init() {
+
+}
+
+void CIntegralImageTest::testCompute() {
+
+    // sizes not divisible by the vector width, and large enough for threads and several tiles
+    const size_t sizes[][2] = { { 1, 1 }, { 7, 5 }, { 37, 23 }, { 41, 2053 } };
+
+    for(size_t k=0; k<4; k++) {
+
+        QVERIFY(CheckIntegral<int>(sizes[k][0],sizes[k][1],0));
+        QVERIFY(CheckIntegral<size_t>(sizes[k][0],sizes[k][1],0));
+        QVERIFY(CheckIntegral<double>(sizes[k][0],sizes[k][1],1e-12));
+        QVERIFY(CheckIntegral<float>(sizes[k][0],sizes[k][1],1e-5));
+
+    }
+
+}
+
+void CIntegralImageTest::testUpdate() {
+
+    const size_t width = 29, height = 19;
+
+    CIntImage<int> img(width,height), ref(width,height);
+    img.AddMass(3,4,2);
+    img.AddMass(10,20,5);
+    img.Compute();
+
+    img.AddMassToIntegral(7,9,3);
+    img.RemoveMassFromIntegral(10,20,5);
+
+    // outside, ignored
+    img.AddMassToIntegral(height,0,1);
+
+    ref.AddMass(3,4,2);
+    ref.AddMass(7,9,3);
+    ref.Compute();
+
+    for(size_t i=0; i<height; i++) {
+
+        for(size_t j=0; j<width; j++)
+            QCOMPARE(img.Get(i,j),ref.Get(i,j));
+
+    }
+
+    // reset keeps the size and clears
+    img.Reset(width,height);
+    QCOMPARE(img.Get(height-1,width-1),0);
+
+    img.Reset(width+1,height);
+    QCOMPARE(img.Width(),width+1);
+
+}
+
+void CIntegralImageTest::testEvaluate() {
+
+    CIntImage<int> img(50,40);
+    CIntImage<double> dimg(50,40);
+
+    // features on a regular grid with spacing 5
+    for(size_t i=0; i<40; i+=5) {
+
+        for(size_t j=0; j<50; j+=5) {
+
+            img.AddMass(i,j,1);
+            dimg.AddMass(i,j,1);
+
+        }
+
+    }
+
+    img.Compute();
+    dimg.Compute();
+
+    // the window excludes the top and left boundary, i.e., rows and columns 15, 20, 25, 30
+    vec2 x = { 22, 22 };
+    vec2 h = { 10, 10 };
+
+    QCOMPARE(img.EvaluateApproximately(x,h),16);
+    QCOMPARE((dimg.Evaluate<double,double>(x,h)),16.0);
+
+    // the window is clipped at the image boundary, which again excludes row and column 0
+    vec2 y = { 2, 2 };
+
+    QCOMPARE(img.EvaluateApproximately(y,h),4);
+
+}
+
+void CIntegralImageTest::cleanup() {
+
+}
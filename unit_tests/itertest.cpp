@@ -0,0 +1,397 @@
+/*////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2013, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////*/
+
+#include "itertest.h"
+
+using namespace R4R;
+using namespace std;
+
+//! Operator which counts how often it is applied.
+class CCountingOperator:public CAbstractLinearOperator<double> {
+
+public:
+
+    CCountingOperator(const CLinearOperator<double>& A):
+        m_A(A),
+        m_napplications(0) {}
+
+    size_t NRows() const { return m_A.NRows(); }
+
+    size_t NCols() const { return m_A.NCols(); }
+
+    void Apply(const CDenseArray<double>& x, CDenseArray<double>& y) const {
+
+        m_napplications++;
+        m_A.Multiply(x,y);
+
+    }
+
+    void ApplyTranspose(const CDenseArray<double>& x, CDenseArray<double>& y) const {
+
+        m_napplications++;
+        CLinearOperator<double>::Transpose(m_A).Multiply(x,y);
+
+    }
+
+    CDenseVector<double> Diagonal(bool normal = false) const { return m_A.Diagonal(normal); }
+
+    size_t GetNumberOfApplications() const { return m_napplications; }
+
+private:
+
+    CLinearOperator<double> m_A;
+    mutable size_t m_napplications;
+
+};
+
+CIterativeSolverTest::CIterativeSolverTest(QObject* parent):
+  QObject(parent),
+  m_A(50,50),
+  m_b(50),
+  m_tolerance(1e-6) {
+
+}
+
+void CIterativeSolverTest::init() {
+
+    // shifted 1d Laplacian
+    for(size_t i=0; i<m_A.NRows(); i++) {
+
+        m_A(i,i) = 2.1;
+
+        if(i>0)
+            m_A(i,i-1) = -1;
+
+        if(i<m_A.NRows()-1)
+            m_A(i,i+1) = -1;
+
+        m_b(i) = sin(double(i));
+
+    }
+
+}
+
+void CIterativeSolverTest::testSpectrumEstimator() {
+
+    // diagonal matrix, Lanczos terminates with the exact spectrum
+    mat D(10,10);
+
+    for(size_t i=0; i<D.NRows(); i++)
+        D(i,i) = i+1;
+
+    CSpectrumEstimator<mat,double> estimator(10);
+
+    double lmin, lmax;
+    estimator.Estimate(D,lmin,lmax);
+
+    QVERIFY(fabs(lmin-1)<m_tolerance);
+    QVERIFY(fabs(lmax-10)<m_tolerance);
+    QVERIFY(fabs(estimator.ConditionNumber(D)-10)<m_tolerance);
+
+}
+
+void CIterativeSolverTest::testChebyshevIteration() {
+
+    CPreconditioner<mat,double> M;
+
+    CConjugateGradientMethod<mat,double> cg(M,1000,1e-10);
+    vec xcg(m_b.NElems());
+    cg.Iterate(m_A,m_b,xcg);
+
+    CChebyshevIteration<mat,double> chebyshev(M,1000,1e-10);
+    vec x(m_b.NElems());
+    vector<double> res = chebyshev.Iterate(m_A,m_b,x);
+
+    QVERIFY(res.back()<1e-10);
+    QVERIFY((x-xcg).Norm2()<m_tolerance);
+
+    // consistent overdetermined system, the work vectors are reused in the second solve
+    mat A(m_A.NRows()+10,m_A.NCols());
+
+    for(size_t i=0; i<A.NRows(); i++) {
+
+        for(size_t j=0; j<A.NCols(); j++)
+            A(i,j) = i<m_A.NRows() ? m_A.Get(i,j) : (i+j)%3;
+
+    }
+
+    vec b = A*xcg;
+
+    CChebyshevIterationLeastSquares<mat,double> chebyshevls(M,10000,1e-12);
+
+    for(size_t l=0; l<2; l++) {
+
+        vec xls(m_b.NElems());
+        chebyshevls.Iterate(A,b,xls);
+
+        QVERIFY((xls-xcg).Norm2()<m_tolerance);
+
+    }
+
+}
+
+void CIterativeSolverTest::testNonsymmetricSolvers() {
+
+    // upwind-biased perturbation of the test matrix
+    mat A = m_A.Clone();
+
+    for(size_t i=1; i<A.NRows(); i++) {
+
+        A(i,i-1) = -1.5;
+        A(i-1,i) = -0.5;
+
+    }
+
+    CPreconditioner<mat,double> M;
+
+    for(size_t l=1; l<=4; l*=2) {
+
+        CBiConjugateGradientStabilizedMethod<mat,double> bicgstab(M,1000,1e-10,true,l);
+        vec x(m_b.NElems());
+        bicgstab.Iterate(A,m_b,x);
+
+        QVERIFY((A*x-m_b).Norm2()<m_tolerance);
+
+    }
+
+    CGeneralizedMinimalResidualMethod<mat,double> gmres(M,1000,1e-10,true,10);
+    vec x(m_b.NElems());
+    gmres.Iterate(A,m_b,x);
+
+    QVERIFY((A*x-m_b).Norm2()<m_tolerance);
+
+}
+
+void CIterativeSolverTest::testPreconditionedNonsymmetricSolvers() {
+
+    // nonsymmetric perturbation of the test matrix with columns of very different scale, which the
+    // right-preconditioned methods undo by the Jacobi preconditioner
+    mat A = m_A.Clone();
+
+    for(size_t i=1; i<A.NRows(); i++) {
+
+        A(i,i-1) = -1.5;
+        A(i-1,i) = -0.5;
+
+    }
+
+    for(size_t j=0; j<A.NCols(); j++) {
+
+        double s = 1 + 0.1*j*j;
+
+        for(size_t i=0; i<A.NRows(); i++)
+            A(i,j) *= s;
+
+    }
+
+    CPreconditioner<mat,double> I;
+    CJacobiPreconditioner<mat,double> M(A);
+
+    for(size_t l=1; l<=4; l*=2) {
+
+        CBiConjugateGradientStabilizedMethod<mat,double> bicgstab(M,1000,1e-10,true,l);
+        vec x(m_b.NElems());
+        vector<double> res = bicgstab.Iterate(A,m_b,x);
+
+        QVERIFY(res.back()<1e-10);
+        QVERIFY((A*x-m_b).Norm2()<m_tolerance);
+
+        CBiConjugateGradientStabilizedMethod<mat,double> plain(I,1000,1e-10,true,l);
+        vec y(m_b.NElems());
+        vector<double> resplain = plain.Iterate(A,m_b,y);
+
+        QVERIFY(res.size()<=resplain.size());
+
+    }
+
+    CGeneralizedMinimalResidualMethod<mat,double> gmres(M,1000,1e-10,true,10);
+    vec x(m_b.NElems());
+    vector<double> res = gmres.Iterate(A,m_b,x);
+
+    QVERIFY(res.back()<1e-10);
+    QVERIFY((A*x-m_b).Norm2()<m_tolerance);
+
+    CGeneralizedMinimalResidualMethod<mat,double> plain(I,1000,1e-10,true,10);
+    vec y(m_b.NElems());
+    vector<double> resplain = plain.Iterate(A,m_b,y);
+
+    QVERIFY(res.size()<=resplain.size());
+
+}
+
+void CIterativeSolverTest::testMatrixFreeOperator() {
+
+    const size_t height = 5, width = 7, n = height*width;
+
+    CLinearOperator<double> D(make_shared<CGradientOperator<double> >(height,width));
+    const CLinearOperator<double> Dt = CLinearOperator<double>::Transpose(D);
+
+    // assemble the operator and its adjoint column by column
+    mat In(n,n), Im(2*n,2*n);
+    In.Eye();
+    Im.Eye();
+    mat G = D*In;
+    mat Gt = Dt*Im;
+
+    for(size_t i=0; i<2*n; i++) {
+
+        for(size_t j=0; j<n; j++)
+            QCOMPARE(G.Get(i,j),Gt.Get(j,i));
+
+    }
+
+    // assemble the forward differences like the denoising demo, the last row and column have no
+    // vertical and horizontal derivative, respectively
+    vector<CCSRTriple<double,size_t> > entries;
+
+    for(size_t j=0; j<width; j++) {
+
+        for(size_t i=0; i<height; i++) {
+
+            size_t row = j*height + i;
+
+            if(j<width-1) {
+
+                entries.push_back(CCSRTriple<double,size_t>(row,row,-1.0));
+                entries.push_back(CCSRTriple<double,size_t>(row,row+height,1.0));
+
+            }
+
+            if(i<height-1) {
+
+                entries.push_back(CCSRTriple<double,size_t>(n+row,row,-1.0));
+                entries.push_back(CCSRTriple<double,size_t>(n+row,row+1,1.0));
+
+            }
+
+        }
+
+    }
+
+    CCSRMatrix<double,size_t> nabla(2*n,n,entries);
+    mat N = nabla*In;
+
+    for(size_t i=0; i<2*n; i++) {
+
+        for(size_t j=0; j<n; j++)
+            QCOMPARE(G.Get(i,j),N.Get(i,j));
+
+    }
+
+    // the normal diagonal consists of the squared column norms
+    vec d = D.Diagonal(true);
+
+    for(size_t j=0; j<n; j++) {
+
+        double sum = 0;
+
+        for(size_t i=0; i<2*n; i++)
+            sum += G.Get(i,j)*G.Get(i,j);
+
+        QCOMPARE(d.Get(j),sum);
+
+    }
+
+    // consistent least-squares problem
+    vec xtrue(n);
+    xtrue.Rand(0,1);
+    vec g = D*xtrue;
+
+    CJacobiPreconditioner<CLinearOperator<double>,double> M(D,true);
+    CConjugateGradientMethodLeastSquares<CLinearOperator<double>,double> solver(M,1000,1e-12);
+    vec x(n);
+    solver.Iterate(D,g,x);
+
+    QVERIFY((D*x-g).Norm2()<m_tolerance);
+
+}
+
+void CIterativeSolverTest::testScreenedPoissonSolver() {
+
+    const size_t height = 6, width = 7, n = height*width;
+    const double mu = 0.5, lambda = 2;
+
+    // assemble identity and gradient, and stack them like the u-subproblem of split Bregman
+    mat In(n,n);
+    In.Eye();
+    CLinearOperator<double> D(make_shared<CGradientOperator<double> >(height,width));
+    mat G = D*In;
+
+    vector<CCSRTriple<double,size_t> > ti, tg;
+
+    for(size_t i=0; i<2*n; i++) {
+
+        for(size_t j=0; j<n; j++) {
+
+            if(G.Get(i,j)!=0)
+                tg.push_back(CCSRTriple<double,size_t>(i,j,G.Get(i,j)));
+
+        }
+
+        if(i<n)
+            ti.push_back(CCSRTriple<double,size_t>(i,i,1));
+
+    }
+
+    CCSRMatrix<double,size_t> I(n,n,ti), N(2*n,n,tg);
+    CLinearOperator<double> A(make_shared<CStackedOperator<CCSRMatrix<double,size_t>,double> >(I,N,mu,-lambda));
+
+    vec b(3*n);
+
+    for(size_t i=0; i<b.NElems(); i++)
+        b(i) = sin(double(i));
+
+    CPreconditioner<CLinearOperator<double>,double> M;
+    CConjugateGradientMethodLeastSquares<CLinearOperator<double>,double> cgls(M,1000,1e-14);
+    vec xcgls(n);
+    cgls.Iterate(A,b,xcgls);
+
+    CScreenedPoissonSolver<double> poisson(M,height,width);
+
+    double alpha, beta;
+    QVERIFY(poisson.Recognize(A,alpha,beta));
+    QVERIFY(fabs(alpha-mu*mu)<m_tolerance);
+    QVERIFY(fabs(beta-lambda*lambda)<m_tolerance);
+
+    vec x(n);
+    QVERIFY(!poisson.Iterate(A,b,x).empty());
+    QVERIFY((x-xcgls).Norm2()<m_tolerance*xcgls.Norm2());
+
+    // the operator is probed in the first call only, which costs four applications
+    shared_ptr<CCountingOperator> counter = make_shared<CCountingOperator>(A);
+    CLinearOperator<double> C(counter);
+
+    vec y(n);
+    poisson.Iterate(C,b,y);
+    size_t first = counter->GetNumberOfApplications();
+    poisson.Iterate(C,b,y);
+
+    QCOMPARE(counter->GetNumberOfApplications()-first,first-4);
+    QVERIFY((y-xcgls).Norm2()<m_tolerance*xcgls.Norm2());
+
+}
+
+void CIterativeSolverTest::cleanup(){
+
+
+}
@@ -0,0 +1,72 @@
+/*////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2013, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////*/
+
+#ifndef ITERTEST_H
+#define ITERTEST_H
+
+#include <QtTest/QtTest>
+
+#include "iter.h"
+#include "fft.h"
+
+class CIterativeSolverTest:public QObject {
+
+  Q_OBJECT
+
+public:
+
+  explicit CIterativeSolverTest(QObject* parent = nullptr);
+
+private:
+
+    R4R::CDenseArray<double> m_A;                //!< symmetric positive-definite test matrix
+    R4R::CDenseVector<double> m_b;               //!< right-hand side
+    double m_tolerance;
+
+private slots:
+
+  void init();
+
+  //! Tests Lanczos estimation of the spectrum.
+  void testSpectrumEstimator();
+
+  //! Tests the Chebyshev iteration against the CG method.
+  void testChebyshevIteration();
+
+  //! Tests BiCGStab(l) and GMRES(m) on a nonsymmetric system.
+  void testNonsymmetricSolvers();
+
+  //! Tests BiCGStab(l) and GMRES(m) with a Jacobi preconditioner on a badly scaled nonsymmetric system.
+  void testPreconditionedNonsymmetricSolvers();
+
+  //! Tests the matrix-free gradient operator against its assembled counterpart.
+  void testMatrixFreeOperator();
+
+  //! Tests the DCT-based screened Poisson solver against CGLS.
+  void testScreenedPoissonSolver();
+
+  void cleanup();
+
+};
+
+#endif // ITERTEST_H
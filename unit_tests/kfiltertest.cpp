@@ -0,0 +1,218 @@
+/*////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2013, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////*/
+
+#include "kfiltertest.h"
+#include "kfilter.h"
+
+#include <vector>
+
+using namespace R4R;
+using namespace std;
+
+// constant-velocity model in the plane
+static void ConstantVelocityModel(CMatrix<float,4,4>& A, CMatrix<float,2,4>& C, CMatrix<float,4,4>& Q, CMatrix<float,2,2>& R) {
+
+    A.Eye();
+    A(0,2) = 1;
+    A(1,3) = 1;
+
+    C(0,0) = 1;
+    C(1,1) = 1;
+
+    Q.Eye();
+    Q = Q*0.01f;
+
+    R.Eye();
+    R = R*0.5f;
+
+}
+
+// noisy measurement of the i-th trajectory at time t
+static CVector<float,2> Measurement(size_t i, size_t t) {
+
+    CVector<float,2> y;
+    y(0) = 0.3*t + sin(double(t+i));
+    y(1) = -0.2*t + cos(double(3*t)) + 0.01*i;
+
+    return y;
+
+}
+
+CKalmanFilterTest::CKalmanFilterTest(QObject* parent):
+  QObject(parent),
+  m_tolerance(1e-3) {
+
+}
+
+void CKalmanFilterTest::init() {
+
+}
+
+void CKalmanFilterTest::testFixedKalmanFilter() {
+
+    CMatrix<float,4,4> A, Q;
+    CMatrix<float,2,4> C;
+    CMatrix<float,2,2> R;
+    CMatrix<float,4,1> B;
+    ConstantVelocityModel(A,C,Q,R);
+
+    mat Ad(4,4), Bd(4,1), Cd(2,4), Qd(4,4), Rd(2,2);
+
+    for(size_t i=0; i<4; i++) {
+
+        for(size_t j=0; j<4; j++) {
+
+            Ad(i,j) = A.Get(i,j);
+            Qd(i,j) = Q.Get(i,j);
+
+            if(i<2)
+                Cd(i,j) = C.Get(i,j);
+
+            if(i<2 && j<2)
+                Rd(i,j) = R.Get(i,j);
+
+        }
+
+    }
+
+    vec x0(4);
+    CKalmanFilter dynamic(Ad,Bd,Cd,Qd,Rd,x0);
+    CFixedKalmanFilter<float,4,2> fixed(A,B,C,Q,R);
+
+    for(size_t t=0; t<50; t++) {
+
+        CVector<float,2> y = Measurement(0,t);
+        vec yd(2);
+        yd(0) = y.Get(0);
+        yd(1) = y.Get(1);
+
+        dynamic.Predict();
+        dynamic.Update(yd);
+        fixed.Predict();
+        fixed.Update(y);
+
+    }
+
+    vec xd = dynamic.GetState();
+    mat Pd = dynamic.GetCovariance();
+
+    for(size_t i=0; i<4; i++) {
+
+        QVERIFY(fabs(xd.Get(i)-fixed.GetState().Get(i))<m_tolerance*(1+fabs(xd.Get(i))));
+
+        for(size_t j=0; j<4; j++)
+            QVERIFY(fabs(Pd.Get(i,j)-fixed.GetCovariance().Get(i,j))<m_tolerance);
+
+    }
+
+}
+
+void CKalmanFilterTest::testKalmanFilterBank() {
+
+    CMatrix<float,4,4> A, Q;
+    CMatrix<float,2,4> C;
+    CMatrix<float,2,2> R;
+    CMatrix<float,4,1> B;
+    ConstantVelocityModel(A,C,Q,R);
+
+    // more filters than fit into one block
+    const size_t n = 150;
+
+    CKalmanFilterBank<float,4,2> bank(A,C,Q,R);
+    vector<CFixedKalmanFilter<float,4,2> > filters;
+
+    CMatrix<float,4,4> P0;
+    P0.Eye();
+
+    for(size_t i=0; i<n; i++) {
+
+        CVector<float,4> x0;
+        x0(0) = 0.1*i;
+
+        QCOMPARE(bank.Add(x0,P0),i);
+        filters.push_back(CFixedKalmanFilter<float,4,2>(A,B,C,Q,R,x0,P0));
+
+    }
+
+    matf y(n,2);
+
+    for(size_t t=0; t<50; t++) {
+
+        bank.Predict();
+
+        for(size_t i=0; i<n; i++) {
+
+            CVector<float,2> yi = Measurement(i,t);
+            y(i,0) = yi.Get(0);
+            y(i,1) = yi.Get(1);
+
+            filters[i].Predict();
+
+            // some filters miss measurements
+            if(i%5==3 && t%7==3)
+                y(i,0) = NAN;
+            else
+                filters[i].Update(yi);
+
+        }
+
+        bank.Update(y);
+
+    }
+
+    for(size_t k=0; k<n; k++) {
+
+        CVector<float,4> x = bank.GetState(k);
+        CMatrix<float,4,4> P = bank.GetCovariance(k);
+
+        for(size_t i=0; i<4; i++) {
+
+            QVERIFY(fabs(x.Get(i)-filters[k].GetState().Get(i))<m_tolerance*(1+fabs(x.Get(i))));
+
+            for(size_t j=0; j<4; j++)
+                QVERIFY(fabs(P.Get(i,j)-filters[k].GetCovariance().Get(i,j))<m_tolerance);
+
+        }
+
+    }
+
+    // the last filter moves into the vacant slot
+    CVector<float,4> xlast = bank.GetState(n-1);
+    QCOMPARE(bank.Remove(7),n-1);
+    QCOMPARE(bank.Size(),n-1);
+
+    for(size_t i=0; i<4; i++)
+        QCOMPARE(bank.GetState(7).Get(i),xlast.Get(i));
+
+    // removal from an empty bank leaves it empty
+    while(bank.Size()>0)
+        bank.Remove(0);
+
+    QCOMPARE(bank.Remove(0),size_t(0));
+    QCOMPARE(bank.Size(),size_t(0));
+
+}
+
+void CKalmanFilterTest::cleanup() {
+
+}
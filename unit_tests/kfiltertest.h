@@ -0,0 +1,55 @@
+/*////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2013, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////*/
+
+#ifndef KFILTERTEST_H
+#define KFILTERTEST_H
+
+#include <QtTest/QtTest>
+
+class CKalmanFilterTest:public QObject {
+
+  Q_OBJECT
+
+public:
+
+  explicit CKalmanFilterTest(QObject* parent = nullptr);
+
+private:
+
+    double m_tolerance;
+
+private slots:
+
+  void init();
+
+  //! Tests the fixed-size filter against the dynamic one.
+  void testFixedKalmanFilter();
+
+  //! Tests a bank of filters against fixed-size filters run one by one.
+  void testKalmanFilterBank();
+
+  void cleanup();
+
+};
+
+#endif // KFILTERTEST_H
@@ -0,0 +1,599 @@
+/*////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2013, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////*/
+
+#include "lmtest.h"
+#include "schur.h"
+#include "autodiff.h"
+#include "batchlm.h"
+
+using namespace R4R;
+using namespace std;
+
+//! Perturbed samples of the block test function at \f$a_i=0.5+0.01i\f$, \f$p=(2,0.3,-1)\f$.
+static double Observation(size_t row) {
+
+    double a = 0.5 + 0.01*(row/4);
+    double t = row%4 + 1;
+
+    return 2.0*exp(-a*t) + 0.3*a*t - 1 + 0.01*sin(double(row));
+
+}
+
+/*! \brief block test problem
+ *
+ * Residuals \f$r_{ik}=p_0\exp(-a_it_k)+p_1a_it_k+p_2-y_{ik}\f$ with one local parameter
+ * \f$a_i\f$ per block and three global parameters \f$p_j\f$, plus priors on the latter.
+ *
+ */
+class CBlockExponentialProblem:public CLeastSquaresProblem<CCSRMatrix<double>,double> {
+
+public:
+
+    CBlockExponentialProblem(size_t nblocks):
+        CLeastSquaresProblem<CCSRMatrix<double>,double>(4*nblocks+3,nblocks+3),
+        m_nblocks(nblocks),
+        m_y(4*nblocks+3) {
+
+        for(size_t i=0; i<4*m_nblocks; i++)
+            m_y(i) = Observation(i);
+
+        m_y(4*m_nblocks) = 2;
+        m_y(4*m_nblocks+1) = 0.3;
+        m_y(4*m_nblocks+2) = -1;
+
+        for(size_t i=0; i<m_noparams; i++)
+            m_model(i) = i<m_nblocks ? 0.4 : 0.5;
+
+    }
+
+    void ComputeResidualAndJacobian(vec& r, CCSRMatrix<double>& J) const {
+
+        vector<CCSRTriple<double,size_t> > triples;
+
+        const double* x = m_model.Data().get();
+
+        for(size_t i=0; i<m_nblocks; i++) {
+
+            for(size_t k=0; k<4; k++) {
+
+                size_t row = 4*i + k;
+                double t = k + 1;
+                double e = exp(-x[i]*t);
+
+                r(row) = x[m_nblocks]*e + x[m_nblocks+1]*x[i]*t + x[m_nblocks+2] - m_y.Get(row);
+
+                triples.push_back(CCSRTriple<double,size_t>(row,i,-t*e*x[m_nblocks]+x[m_nblocks+1]*t));
+                triples.push_back(CCSRTriple<double,size_t>(row,m_nblocks,e));
+                triples.push_back(CCSRTriple<double,size_t>(row,m_nblocks+1,x[i]*t));
+                triples.push_back(CCSRTriple<double,size_t>(row,m_nblocks+2,1));
+
+            }
+
+        }
+
+        for(size_t j=0; j<3; j++) {
+
+            r(4*m_nblocks+j) = x[m_nblocks+j] - m_y.Get(4*m_nblocks+j);
+            triples.push_back(CCSRTriple<double,size_t>(4*m_nblocks+j,m_nblocks+j,1));
+
+        }
+
+        J = CCSRMatrix<double>(m_nopts,m_noparams,triples);
+
+    }
+
+    void ComputeResidual(vec& r) const {
+
+        CCSRMatrix<double> J(0,0);
+        ComputeResidualAndJacobian(r,J);
+
+    }
+
+    bool ComputeResidualAndJacobian(size_t begin, size_t end, vec& r, CCSRMatrix<double>& J) const {
+
+        const size_t* rowptr = J.GetRowPtr()->data();
+        size_t* cols = J.GetCols()->data();
+        double* vals = J.GetValues()->data();
+        const double* x = m_model.Data().get();
+
+        for(size_t row=begin; row<end; row++) {
+
+            size_t offset = rowptr[row];
+            double w = m_weights.Get(row);
+
+            if(row<4*m_nblocks) {
+
+                size_t i = row/4;
+                double t = row%4 + 1;
+                double e = exp(-x[i]*t);
+
+                r(row) = w*(x[m_nblocks]*e + x[m_nblocks+1]*x[i]*t + x[m_nblocks+2] - m_y.Get(row));
+
+                cols[offset] = i;
+                cols[offset+1] = m_nblocks;
+                cols[offset+2] = m_nblocks + 1;
+                cols[offset+3] = m_nblocks + 2;
+                vals[offset] = w*(-t*e*x[m_nblocks]+x[m_nblocks+1]*t);
+                vals[offset+1] = w*e;
+                vals[offset+2] = w*x[i]*t;
+                vals[offset+3] = w;
+
+            }
+            else {
+
+                size_t j = row - 4*m_nblocks;
+                r(row) = w*(x[m_nblocks+j] - m_y.Get(row));
+                cols[offset] = m_nblocks + j;
+                vals[offset] = w;
+
+            }
+
+        }
+
+        return true;
+
+    }
+
+    size_t GetJacobianRowLength(size_t i) const { return i<4*m_nblocks ? 4 : 1; }
+
+    void GetBlockPartition(size_t& nblocks, size_t& blocksize) const {
+
+        nblocks = m_nblocks;
+        blocksize = 1;
+
+    }
+
+private:
+
+    size_t m_nblocks;
+    vec m_y;
+
+};
+
+//! Residual functor of the blocks of CBlockExponentialProblem without priors.
+struct CBlockExponentialFunctor {
+
+    size_t m_nblocks;
+
+    void GetParameterIndices(size_t i, size_t* indices) const {
+
+        indices[0] = i;
+
+        for(size_t j=0; j<3; j++)
+            indices[j+1] = m_nblocks + j;
+
+    }
+
+    template<typename U> void operator()(size_t i, const U* x, U* r) const {
+
+        for(size_t k=0; k<4; k++) {
+
+            double t = k + 1;
+            r[k] = x[1]*exp(-x[0]*t) + x[2]*x[0]*t + x[3] - Observation(4*i+k);
+
+        }
+
+    }
+
+};
+
+//! Perturbed samples of \f$a\exp(-bt_k)\f$ in the \f$i\f$-th problem of a batch.
+static double ExponentialSample(size_t i, size_t k) {
+
+    double a = 1 + 0.001*(i%100);
+    double b = 0.1 + 0.0005*(i%37);
+
+    return a*exp(-b*k) + 0.01*sin(double(i+k));
+
+}
+
+//! Batch of exponential fits \f$r_k=a\exp(-bt_k)-y_k\f$ with 16 samples each.
+class CExponentialBatch:public CBatchedLeastSquaresProblem<double> {
+
+public:
+
+    CExponentialBatch(size_t nproblems):
+        CBatchedLeastSquaresProblem<double>(nproblems,2) {
+
+        for(size_t i=0; i<m_nproblems; i++) {
+
+            m_model(i,0) = 0.5;
+            m_model(i,1) = 0.3;
+
+        }
+
+    }
+
+    void ComputeNormalEquations(size_t begin, size_t end, size_t stride, const double* x, double* cost, double* g, double* H) const {
+
+        for(size_t i=0; i<end-begin; i++) {
+
+            cost[i] = 0;
+            g[i] = g[stride+i] = 0;
+            H[i] = H[stride+i] = H[2*stride+i] = 0;
+
+            for(size_t k=0; k<16; k++) {
+
+                double e = exp(-x[stride+i]*k);
+                double r = x[i]*e - ExponentialSample(begin+i,k);
+                double ja = e;
+                double jb = -double(k)*x[i]*e;
+
+                cost[i] += r*r;
+                g[i] += ja*r;
+                g[stride+i] += jb*r;
+                H[i] += ja*ja;
+                H[stride+i] += jb*ja;
+                H[2*stride+i] += jb*jb;
+
+            }
+
+        }
+
+    }
+
+    void ComputeCost(size_t begin, size_t end, size_t stride, const double* x, double* cost) const {
+
+        for(size_t i=0; i<end-begin; i++) {
+
+            cost[i] = 0;
+
+            for(size_t k=0; k<16; k++) {
+
+                double r = x[i]*exp(-x[stride+i]*k) - ExponentialSample(begin+i,k);
+                cost[i] += r*r;
+
+            }
+
+        }
+
+    }
+
+};
+
+//! The \f$i\f$-th problem of CExponentialBatch on its own.
+class CExponentialProblem:public CLeastSquaresProblem<mat,double> {
+
+public:
+
+    CExponentialProblem(size_t i):
+        CLeastSquaresProblem<mat,double>(16,2),
+        m_i(i) {
+
+        m_model(0) = 0.5;
+        m_model(1) = 0.3;
+
+    }
+
+    void ComputeResidualAndJacobian(vec& r, mat& J) const {
+
+        for(size_t k=0; k<16; k++) {
+
+            double e = exp(-m_model.Get(1)*k);
+            r(k) = m_model.Get(0)*e - ExponentialSample(m_i,k);
+            J(k,0) = e;
+            J(k,1) = -double(k)*m_model.Get(0)*e;
+
+        }
+
+    }
+
+    void ComputeResidual(vec& r) const {
+
+        for(size_t k=0; k<16; k++)
+            r(k) = m_model.Get(0)*exp(-m_model.Get(1)*k) - ExponentialSample(m_i,k);
+
+    }
+
+private:
+
+    size_t m_i;
+
+};
+
+/*! \brief weighted test problem
+ *
+ * Residuals \f$w_k(p_0\exp(-p_1t_k)+p_2-y_k)\f$, where the weights are applied by the problem as
+ * demanded by CLeastSquaresProblem, i.e., ComputeResidual() returns the same sign unweighted.
+ *
+ */
+class CWeightedExponentialProblem:public CLeastSquaresProblem<mat,double> {
+
+public:
+
+    CWeightedExponentialProblem():
+        CLeastSquaresProblem<mat,double>(30,3) {
+
+        for(size_t k=0; k<m_nopts; k++)
+            m_weights(k) = 1 + 0.1*k;
+
+        m_model(0) = 1;
+        m_model(1) = 0.5;
+        m_model(2) = 0;
+
+    }
+
+    void ComputeResidualAndJacobian(vec& r, mat& J) const {
+
+        for(size_t k=0; k<m_nopts; k++) {
+
+            double e = exp(-m_model.Get(1)*k);
+            double w = m_weights.Get(k);
+
+            r(k) = w*(m_model.Get(0)*e + m_model.Get(2) - Observation(k));
+            J(k,0) = w*e;
+            J(k,1) = -w*double(k)*m_model.Get(0)*e;
+            J(k,2) = w;
+
+        }
+
+    }
+
+    void ComputeResidual(vec& r) const {
+
+        for(size_t k=0; k<m_nopts; k++)
+            r(k) = m_model.Get(0)*exp(-m_model.Get(1)*k) + m_model.Get(2) - Observation(k);
+
+    }
+
+    //! Gradient of the weighted objective.
+    vec ComputeGradient() const {
+
+        vec r(m_nopts), g(m_noparams);
+        mat J(m_nopts,m_noparams);
+        ComputeResidualAndJacobian(r,J);
+
+        for(size_t j=0; j<m_noparams; j++) {
+
+            for(size_t k=0; k<m_nopts; k++)
+                g(j) += J.Get(k,j)*r.Get(k);
+
+        }
+
+        return g;
+
+    }
+
+private:
+
+    static double Observation(size_t k) { return 2*exp(-0.2*k) + 0.5 + 0.05*sin(3.0*k); }
+
+};
+
+CLeastSquaresTest::CLeastSquaresTest(QObject* parent):
+  QObject(parent),
+  m_nblocks(50),
+  m_tolerance(1e-6) {
+
+}
+
+void CLeastSquaresTest::init() {
+
+}
+
+void CLeastSquaresTest::testSchurComplementSolver() {
+
+    CBlockExponentialProblem problem(m_nblocks);
+
+    vec r(problem.GetNumberOfDataPoints());
+    CCSRMatrix<double> J(problem.GetNumberOfDataPoints(),problem.GetNumberOfModelParameters());
+    problem.ComputeResidualAndJacobian(r,J);
+
+    CPreconditioner<CCSRMatrix<double>,double> M;
+    CConjugateGradientMethodLeastSquares<CCSRMatrix<double>,double> cgls(M,100000,1e-13);
+
+    // undamped and damped normal equations, reduced system by Cholesky and by PCG
+    for(size_t l=0; l<2; l++) {
+
+        double lambda = 0.3*l;
+
+        CSchurComplementSolver<double> schur(problem);
+        CSchurComplementSolver<double> schurpcg(problem,100,1e-13);
+        cgls.SetLambda(lambda);
+        schur.SetLambda(lambda);
+        schurpcg.SetLambda(lambda);
+
+        vec x(problem.GetNumberOfModelParameters()), xs(x.NElems()), xp(x.NElems());
+        cgls.Iterate(J,r,x);
+        schur.Iterate(J,r,xs);
+        schurpcg.Iterate(J,r,xp);
+
+        QVERIFY((x-xs).Norm2()<m_tolerance*x.Norm2());
+        QVERIFY((x-xp).Norm2()<m_tolerance*x.Norm2());
+
+    }
+
+}
+
+void CLeastSquaresTest::testRowRangeEvaluation() {
+
+    CBlockExponentialProblem problem(m_nblocks);
+
+    const size_t m = problem.GetNumberOfDataPoints();
+    const size_t n = problem.GetNumberOfModelParameters();
+
+    vec r(m);
+    CCSRMatrix<double> J(m,n);
+    problem.ComputeResidualAndJacobian(r,J);
+
+    // assemble from uneven ranges in reverse order
+    vec rr(m);
+    CCSRMatrix<double> Jr(m,n);
+    problem.PrepareJacobian(Jr);
+
+    const size_t bounds[] = { 0, 1, 7, 100, m - 2, m };
+
+    for(size_t k=5; k>0; k--)
+        QVERIFY(problem.ComputeResidualAndJacobian(bounds[k-1],bounds[k],rr,Jr));
+
+    for(size_t i=0; i<m; i++)
+        QCOMPARE(rr.Get(i),r.Get(i));
+
+    QVERIFY(*Jr.GetRowPtr()==*J.GetRowPtr());
+    QVERIFY(*Jr.GetCols()==*J.GetCols());
+    QVERIFY(*Jr.GetValues()==*J.GetValues());
+
+}
+
+void CLeastSquaresTest::testAutomaticDifferentiation() {
+
+    CBlockExponentialProblem problem(m_nblocks);
+
+    vec r(problem.GetNumberOfDataPoints());
+    CCSRMatrix<double> J(problem.GetNumberOfDataPoints(),problem.GetNumberOfModelParameters());
+    problem.ComputeResidualAndJacobian(r,J);
+
+    CBlockExponentialFunctor f = { m_nblocks };
+    CAutoDiffLeastSquaresProblem<CBlockExponentialFunctor,double,4,4> autodiff(f,m_nblocks,problem.GetNumberOfModelParameters());
+    autodiff.Get() = problem.Get().Clone();
+
+    vec ra(autodiff.GetNumberOfDataPoints());
+    CCSRMatrix<double> Ja(autodiff.GetNumberOfDataPoints(),autodiff.GetNumberOfModelParameters());
+    autodiff.ComputeResidualAndJacobian(ra,Ja);
+
+    // the leading rows of the analytic Jacobian have the same structure
+    const vector<size_t>& cols = *J.GetCols();
+    const vector<double>& vals = *J.GetValues();
+    const vector<size_t>& colsa = *Ja.GetCols();
+    const vector<double>& valsa = *Ja.GetValues();
+
+    QCOMPARE(colsa.size(),4*4*m_nblocks);
+
+    for(size_t i=0; i<ra.NElems(); i++)
+        QVERIFY(fabs(ra.Get(i)-r.Get(i))<m_tolerance);
+
+    for(size_t i=0; i<colsa.size(); i++) {
+
+        QCOMPARE(colsa[i],cols[i]);
+        QVERIFY(fabs(valsa[i]-vals[i])<m_tolerance);
+
+    }
+
+}
+
+void CLeastSquaresTest::testDenseLevenbergMarquardt() {
+
+    CPreconditioner<CCSRMatrix<double>,double> M;
+    CConjugateGradientMethodLeastSquares<CCSRMatrix<double>,double> cgls(M,100000,1e-14);
+
+    CBlockExponentialProblem iterative(m_nblocks), dense(m_nblocks);
+
+    CLevenbergMarquardt<CCSRMatrix<double>,double> lmi(iterative,cgls,1.0);
+    lmi.SetDenseThreshold(0);
+    vec ri = lmi.Iterate(50,1e-12,1e-14,true);
+
+    CLevenbergMarquardt<CCSRMatrix<double>,double> lmd(dense,cgls,1.0);
+    lmd.SetDenseThreshold(dense.GetNumberOfModelParameters());
+    vec rd = lmd.Iterate(50,1e-12,1e-14,true);
+
+    QVERIFY(fabs(ri.Norm2()-rd.Norm2())<m_tolerance);
+    QVERIFY((iterative.Get()-dense.Get()).Norm2()<m_tolerance*iterative.Get().Norm2());
+
+}
+
+void CLeastSquaresTest::testBatchedLevenbergMarquardt() {
+
+    // more problems than fit into one chunk
+    const size_t n = 600;
+
+    CExponentialBatch batch(n);
+    CBatchedLevenbergMarquardt<double> lmb(batch);
+    lmb.Iterate(100,1e-12,1e-12);
+
+    CPreconditioner<mat,double> M;
+    CConjugateGradientMethodLeastSquares<mat,double> cgls(M,100,1e-14);
+
+    for(size_t i=0; i<n; i+=97) {
+
+        QVERIFY(lmb.GetConverged()[i]);
+
+        CExponentialProblem problem(i);
+        CLevenbergMarquardt<mat,double> lm(problem,cgls,1e-3);
+        lm.Iterate(100,1e-12,1e-12,true);
+
+        QVERIFY(fabs(batch.Get().Get(i,0)-problem.Get().Get(0))<m_tolerance);
+        QVERIFY(fabs(batch.Get().Get(i,1)-problem.Get().Get(1))<m_tolerance);
+
+    }
+
+}
+
+void CLeastSquaresTest::testGlobalizationStrategies() {
+
+    CPreconditioner<CCSRMatrix<double>,double> M;
+    CConjugateGradientMethodLeastSquares<CCSRMatrix<double>,double> cgls(M,100000,1e-14);
+
+    CBlockExponentialProblem reference(m_nblocks), dogleg(m_nblocks), geodesic(m_nblocks);
+    CBlockExponentialProblem* problems[] = { &reference, &dogleg, &geodesic };
+
+    // non-uniform weights
+    for(size_t l=0; l<3; l++) {
+
+        vec& weights = problems[l]->GetWeights();
+
+        for(size_t i=0; i<weights.NElems(); i++)
+            weights(i) = 1 + 0.5*sin(double(i))*sin(double(i));
+
+    }
+
+    CLevenbergMarquardt<CCSRMatrix<double>,double> lmr(reference,cgls,1.0);
+    lmr.Iterate(100,1e-12,1e-14,true);
+
+    CLevenbergMarquardt<CCSRMatrix<double>,double> lmd(dogleg,cgls,1.0);
+    lmd.SetStrategy(LMSTRATEGY::DOGLEG);
+    lmd.Iterate(100,1e-12,1e-14,true);
+
+    CLevenbergMarquardt<CCSRMatrix<double>,double> lmg(geodesic,cgls,1.0);
+    lmg.SetGeodesicAcceleration(true);
+    lmg.Iterate(100,1e-12,1e-14,true);
+
+    QVERIFY((reference.Get()-dogleg.Get()).Norm2()<m_tolerance*reference.Get().Norm2());
+    QVERIFY((reference.Get()-geodesic.Get()).Norm2()<m_tolerance*reference.Get().Norm2());
+
+}
+
+void CLeastSquaresTest::testWeightedGeodesicAcceleration() {
+
+    CPreconditioner<mat,double> M;
+    CConjugateGradientMethodLeastSquares<mat,double> cgls(M,100,1e-14);
+
+    CWeightedExponentialProblem reference, geodesic;
+
+    CLevenbergMarquardt<mat,double> lmr(reference,cgls,1e-3);
+    lmr.Iterate(200,1e-14,1e-14,true);
+
+    CLevenbergMarquardt<mat,double> lmg(geodesic,cgls,1e-3);
+    lmg.SetGeodesicAcceleration(true);
+    lmg.Iterate(200,1e-14,1e-14,true);
+
+    // both arrive at a stationary point of the weighted objective, a sign mismatch between the
+    // weighted and unweighted residual makes every accelerated step fail
+    QVERIFY(reference.ComputeGradient().Norm2()<m_tolerance);
+    QVERIFY(geodesic.ComputeGradient().Norm2()<m_tolerance);
+    QVERIFY((reference.Get()-geodesic.Get()).Norm2()<m_tolerance*reference.Get().Norm2());
+
+}
+
+void CLeastSquaresTest::cleanup() {
+
+}
@@ -0,0 +1,71 @@
+/*////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2013, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////*/
+
+#ifndef LMTEST_H
+#define LMTEST_H
+
+#include <QtTest/QtTest>
+
+class CLeastSquaresTest:public QObject {
+
+  Q_OBJECT
+
+public:
+
+  explicit CLeastSquaresTest(QObject* parent = nullptr);
+
+private:
+
+    size_t m_nblocks;                           //!< number of blocks of the test problem
+    double m_tolerance;
+
+private slots:
+
+  void init();
+
+  //! Tests the Schur complement solver against CGLS.
+  void testSchurComplementSolver();
+
+  //! Tests evaluation of residual and Jacobian by row ranges against the full evaluation.
+  void testRowRangeEvaluation();
+
+  //! Tests the Jacobian obtained by automatic differentiation against the analytic one.
+  void testAutomaticDifferentiation();
+
+  //! Tests Levenberg-Marquardt with dense Cholesky against the iterative linear solver.
+  void testDenseLevenbergMarquardt();
+
+  //! Tests batched Levenberg-Marquardt against solving the problems one by one.
+  void testBatchedLevenbergMarquardt();
+
+  //! Tests dogleg and geodesic acceleration against the damped method.
+  void testGlobalizationStrategies();
+
+  //! Tests geodesic acceleration on a problem which applies non-unit weights itself.
+  void testWeightedGeodesicAcceleration();
+
+  void cleanup();
+
+};
+
+#endif // LMTEST_H
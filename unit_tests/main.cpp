@@ -25,6 +25,14 @@
 #include "rbuffertest.h"
 #include "darraytest.h"
 #include "kernelstest.h"
+#include "itertest.h"
+#include "lmtest.h"
+#include "tvtest.h"
+#include "kfiltertest.h"
+#include "pegasostest.h"
+#include "ffttest.h"
+#include "imagetest.h"
+#include "motiontest.h"
 
 int main() {
 
@@ -40,4 +48,28 @@ int main() {
     CKernelsTest kt;
     QTest::qExec(&kt);
 
+    CIterativeSolverTest it;
+    QTest::qExec(&it);
+
+    CLeastSquaresTest lst;
+    QTest::qExec(&lst);
+
+    CTotalVariationTest tvt;
+    QTest::qExec(&tvt);
+
+    CKalmanFilterTest kft;
+    QTest::qExec(&kft);
+
+    CPegasosTest pt;
+    QTest::qExec(&pt);
+
+    CFourierTransformTest fftt;
+    QTest::qExec(&fftt);
+
+    CIntegralImageTest iit;
+    QTest::qExec(&iit);
+
+    CMotionTest mt;
+    QTest::qExec(&mt);
+
 }
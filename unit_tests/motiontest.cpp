@@ -0,0 +1,726 @@
+/*////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2013, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////*/
+
+#include "motiontest.h"
+#include "lk.h"
+#include "descriptor.h"
+#include "gcache.h"
+#include "descspecial.h"
+#include "patch.h"
+#include "ogrid.h"
+#include "fast.h"
+#include "tstore.h"
+#include "stracker.h"
+#include "params.h"
+
+using namespace R4R;
+using namespace cv;
+using namespace std;
+
+// smooth intensity profile
+static float Intensity(float x, float y) {
+
+    return 128 + 40*sin(0.11*x + 0.3*sin(0.05*y)) + 30*cos(0.17*y + 0.07*x) + 20*sin(0.31*x)*cos(0.23*y);
+
+}
+
+// bilinear interpolation of an 8-bit image continued by zero
+static double Bilinear(const Mat& img, double u, double v) {
+
+    int i = (int)floor(v);
+    int j = (int)floor(u);
+
+    if(i<0 || i>=img.rows || j<0 || j>=img.cols)
+        return 0;
+
+    double vd = v - i;
+    double ud = u - j;
+    double I[2][2];
+
+    for(int p=0; p<2; p++) {
+
+        for(int q=0; q<2; q++)
+            I[p][q] = (i+p<img.rows && j+q<img.cols) ? img.at<uchar>(i+p,j+q) : 0;
+
+    }
+
+    return (1-vd)*((1-ud)*I[0][0] + ud*I[0][1]) + vd*((1-ud)*I[1][0] + ud*I[1][1]);
+
+}
+
+// scalar FAST score, zero if the pixel fails the segment test
+static int FASTScore(const Mat& img, int i, int j, int t, size_t arc) {
+
+    const int circle[16][2] = { {0,-3}, {1,-3}, {2,-2}, {3,-1}, {3,0}, {3,1}, {2,2}, {1,3},
+                                {0,3}, {-1,3}, {-2,2}, {-3,1}, {-3,0}, {-3,-1}, {-2,-2}, {-1,-3} };
+
+    int c = img.at<uchar>(i,j);
+    int state[16];
+    int sb = 0, sd = 0;
+
+    for(size_t k=0; k<16; k++) {
+
+        int x = img.at<uchar>(i+circle[k][1],j+circle[k][0]);
+        state[k] = x>c+t ? 1 : (x<c-t ? -1 : 0);
+
+        if(state[k]>0)
+            sb += x - c - t;
+        else if(state[k]<0)
+            sd += c - t - x;
+
+    }
+
+    // look for an arc starting at every position of the circle
+    for(size_t k=0; k<16; k++) {
+
+        if(state[k]==0)
+            continue;
+
+        size_t l = 1;
+
+        while(l<arc && state[(k+l)%16]==state[k])
+            l++;
+
+        if(l==arc)
+            return max(sb,sd);
+
+    }
+
+    return 0;
+
+}
+
+CMotionTest::CMotionTest(QObject* parent):
+  QObject(parent),
+  m_img0(120,160,CV_32FC1),
+  m_img1(120,160,CV_32FC1),
+  m_dx(1.7),
+  m_dy(-1.2) {
+
+}
+
+void CMotionTest::init() {
+
+    for(int i=0; i<m_img0.rows; i++) {
+
+        for(int j=0; j<m_img0.cols; j++) {
+
+            m_img0.at<float>(i,j) = Intensity(j,i);
+            m_img1.at<float>(i,j) = Intensity(j-m_dx,i-m_dy);
+
+        }
+
+    }
+
+}
+
+void CMotionTest::testPyramidalLukasKanade() {
+
+    vector<Point2f> points0;
+
+    for(int i=20; i<m_img0.rows-20; i+=10) {
+
+        for(int j=20; j<m_img0.cols-20; j+=10)
+            points0.push_back(Point2f(j+0.3f,i+0.6f));
+
+    }
+
+    CPyramidalLukasKanade lk(7,2,30,1e-6,1e-4);
+    vector<Point2f> points1;
+    vector<uchar> status;
+    vector<float> error;
+    lk.Track(m_img0,m_img1,points0,points1,status,error);
+
+    vector<Point2f> pointscv;
+    vector<uchar> statuscv;
+    vector<float> errorcv;
+    calcOpticalFlowPyrLK(m_img0,m_img1,points0,pointscv,statuscv,errorcv,Size(15,15),2,TermCriteria(TermCriteria::COUNT|TermCriteria::EPS,30,1e-3));
+
+    QCOMPARE(points1.size(),points0.size());
+
+    for(size_t i=0; i<points0.size(); i++) {
+
+        QVERIFY(status[i]);
+        QVERIFY(fabs(points1[i].x-points0[i].x-m_dx)<0.05);
+        QVERIFY(fabs(points1[i].y-points0[i].y-m_dy)<0.05);
+
+        if(statuscv[i]) {
+
+            QVERIFY(fabs(points1[i].x-pointscv[i].x)<0.05);
+            QVERIFY(fabs(points1[i].y-pointscv[i].y)<0.05);
+
+        }
+
+    }
+
+    // several scales at once give the same result as one scale at a time
+    vector<Mat> pyramid0, pyramid1;
+    CPyramidalLukasKanade::BuildPyramid(m_img0,1,pyramid0);
+    CPyramidalLukasKanade::BuildPyramid(m_img1,1,pyramid1);
+
+    vector<vector<Point2f> > p0(2), p1;
+    vector<vector<uchar> > st;
+    vector<vector<float> > err;
+    p0[0] = points0;
+
+    for(size_t i=0; i<points0.size(); i++)
+        p0[1].push_back(points0[i]*0.5f);
+
+    lk.Track(pyramid0,pyramid1,p0,p1,st,err);
+
+    for(size_t s=0; s<2; s++) {
+
+        // points of matching size would serve as initial guess
+        points1.clear();
+        lk.Track(pyramid0[s],pyramid1[s],p0[s],points1,status,error);
+
+        for(size_t i=0; i<points1.size(); i++) {
+
+            QCOMPARE(st[s][i],status[i]);
+            QCOMPARE(p1[s][i].x,points1[i].x);
+            QCOMPARE(p1[s][i].y,points1[i].y);
+
+        }
+
+    }
+
+}
+
+void CMotionTest::testPackedBRIEF() {
+
+    // smoothed noise
+    Mat noise(120,160,CV_8UC1), img;
+
+    for(int i=0; i<noise.rows; i++) {
+
+        for(int j=0; j<noise.cols; j++)
+            noise.at<uchar>(i,j) = (uchar)(127.5*(1 + sin(12.9898*i + 78.233*j + 0.001*i*j)));
+
+    }
+
+    GaussianBlur(noise,img,Size(0,0),1.0);
+
+    CBRIEF::GenerateSamplePoints();
+
+    // features away from the boundary, where sampling differs
+    vector<vec2f> locations;
+
+    for(size_t k=0; k<200; k++) {
+
+        vec2f x = { float(30 + 100*fabs(sin(1.3*k))), float(30 + 60*fabs(cos(0.7*k))) };
+        locations.push_back(x);
+
+    }
+
+    CBRIEFPattern pattern(15);
+    vector<shared_ptr<CPackedBRIEF> > batch;
+    CPackedBRIEF::Compute(img,pattern,locations,batch);
+
+    QCOMPARE(batch.size(),locations.size());
+
+    size_t nmismatches = 0, ndifferences = 0;
+
+    for(size_t k=0; k<locations.size(); k++) {
+
+        CRectangle<double> roi(locations[k].Get(0),locations[k].Get(1),15,15);
+
+        CBRIEF brief(roi);
+        brief.Compute(img);
+
+        // single and batched extraction agree up to ties broken by rounding
+        CPackedBRIEF packed(roi);
+        packed.Compute(img);
+        ndifferences += packed.Distance(*batch[k]);
+
+        // test results agree with the unpacked descriptor up to rounding
+        const uint64_t* bits = (const uint64_t*)batch[k]->GetData();
+
+        for(size_t i=0; i<256; i++)
+            nmismatches += (((bits[i/64]>>(i%64))&1)!=0)!=brief.Get()(i);
+
+    }
+
+    QVERIFY(ndifferences<0.001*256*locations.size());
+    QVERIFY(nmismatches<0.005*256*locations.size());
+
+    // population count against bitwise comparison
+    for(size_t k=1; k<locations.size(); k++) {
+
+        const uint64_t* a = (const uint64_t*)batch[k-1]->GetData();
+        const uint64_t* b = (const uint64_t*)batch[k]->GetData();
+
+        u_int distance = 0;
+
+        for(size_t i=0; i<256; i++)
+            distance += ((a[i/64]>>(i%64))&1)!=((b[i/64]>>(i%64))&1);
+
+        QCOMPARE(batch[k]->Distance(*batch[k-1]),distance);
+
+    }
+
+}
+
+void CMotionTest::testGradientCache() {
+
+    for(size_t l=0; l<2; l++) {
+
+        CGradientCache cache(9,l==1,true);
+        cache.Compute(m_img0);
+
+        QVERIFY(cache.HasIntegralHistograms());
+
+        // central differences in the interior
+        double gu, gv;
+        cache.Gradient(37,52,gu,gv);
+        QVERIFY(fabs(gu-0.5*(m_img0.at<float>(52,38)-m_img0.at<float>(52,36)))<1e-4);
+        QVERIFY(fabs(gv-0.5*(m_img0.at<float>(53,37)-m_img0.at<float>(51,37)))<1e-4);
+
+        // rectangles partly outside the image are clipped
+        const int rects[4][4] = { { 0, 0, 120, 160 }, { 13, 27, 41, 90 }, { -5, 150, 30, 170 }, { 60, 60, 61, 61 } };
+
+        for(size_t r=0; r<4; r++) {
+
+            vector<double> hist(cache.NBins()), ref(cache.NBins(),0);
+            cache.Histogram(rects[r][0],rects[r][1],rects[r][2],rects[r][3],&hist[0]);
+
+            for(int i=max(rects[r][0],0); i<min(rects[r][2],m_img0.rows); i++) {
+
+                for(int j=max(rects[r][1],0); j<min(rects[r][3],m_img0.cols); j++)
+                    ref[cache.GetOrientation().at<uchar>(i,j)] += cache.GetMagnitude().at<float>(i,j);
+
+            }
+
+            for(size_t b=0; b<cache.NBins(); b++)
+                QVERIFY(fabs(hist[b]-ref[b])<1e-6*(1+ref[b]));
+
+        }
+
+    }
+
+}
+
+void CMotionTest::testIntegralHistogramOfGradients() {
+
+    Mat img;
+    m_img0.convertTo(img,CV_8U);
+
+    for(size_t l=0; l<2; l++) {
+
+        CGradientCache cache(9,l==1,true);
+        cache.Compute(img);
+
+        // 3x3 cells of 6x6 samples which fall onto the pixels
+        CRectangle<double> roi(60.5,50.5,8.5,8.5);
+
+        CHistogramOfGradients sampled(roi,3,6,9,l==1,0);
+        sampled.Compute(img);
+
+        CHistogramOfGradients cached(roi,3,6,9,l==1,0);
+        cached.Compute(cache);
+
+        CHistogramOfGradients integral(roi,3,6,9,l==1,0);
+        integral.ComputeIntegral(cache);
+
+        double norm = sampled.Get().Norm2();
+
+        QVERIFY(norm>0);
+        QVERIFY((sampled.Get()-cached.Get()).Norm2()<1e-5*norm);
+        QVERIFY((sampled.Get()-integral.Get()).Norm2()<1e-5*norm);
+
+    }
+
+}
+
+void CMotionTest::testPatchBuffer() {
+
+    Mat img;
+    m_img0.convertTo(img,CV_8U);
+
+    CGradientCache cache;
+    cache.Compute(img);
+
+    // interior, rotated, touching the left and top margin, and crossing the boundaries
+    vector<CRectangle<double> > rois;
+    rois.push_back(CRectangle<double>(80.3,60.7,7,7,0.4));
+    rois.push_back(CRectangle<double>(7.6,7.2,7,7,0));
+    rois.push_back(CRectangle<double>(7.2,60,7,7,0));
+    rois.push_back(CRectangle<double>(3.1,4.9,7,7,0.2));
+    rois.push_back(CRectangle<double>(155.4,117.8,7,7,-0.3));
+
+    CPatchBuffer intensities(15), patches(15);
+    intensities.Compute(img,rois);
+    patches.Compute(cache,rois);
+
+    QCOMPARE(patches.NPatches(),rois.size());
+    QVERIFY(!intensities.HasGradients());
+    QVERIFY(patches.HasGradients());
+
+    size_t n = patches.Size();
+
+    for(size_t k=0; k<rois.size(); k++) {
+
+        double a[6];
+        CPatchBuffer::Grid(rois[k],n,a);
+
+        for(size_t i=0; i<n; i++) {
+
+            for(size_t j=0; j<n; j++) {
+
+                double u = a[0] + a[1]*j + a[2]*i;
+                double v = a[3] + a[4]*j + a[5]*i;
+                double gu, gv;
+                cache.Gradient(u,v,gu,gv);
+
+                QVERIFY(fabs(intensities.GetIntensity(k)[i*n+j]-Bilinear(img,u,v))<1e-2);
+                QVERIFY(fabs(patches.GetIntensity(k)[i*n+j]-Bilinear(img,u,v))<1e-2);
+                QVERIFY(fabs(patches.GetGradientU(k)[i*n+j]-gu)<1e-2);
+                QVERIFY(fabs(patches.GetGradientV(k)[i*n+j]-gv)<1e-2);
+
+            }
+
+        }
+
+    }
+
+}
+
+void CMotionTest::testOccupancyGrid() {
+
+    COccupancyGrid grid;
+    grid.Resize(100,60,10);
+
+    QCOMPARE(grid.NCells(),size_t(60));
+
+    // scattered points, counts in windows against brute force
+    vector<vec2f> points;
+    vector<size_t> handles;
+
+    for(size_t k=0; k<150; k++) {
+
+        vec2f x = { float(50 + 49*sin(1.7*k)), float(30 + 29*cos(0.9*k)) };
+        points.push_back(x);
+        handles.push_back(grid.Insert(x));
+
+    }
+
+    QCOMPARE(grid.Size(),points.size());
+
+    // move every third point to another cell and remove every fifth
+    for(size_t k=0; k<points.size(); k+=3) {
+
+        points[k] = { float(99 - points[k].Get(0)), float(59 - points[k].Get(1)) };
+        grid.Move(handles[k],points[k]);
+
+    }
+
+    vector<bool> alive(points.size(),true);
+
+    for(size_t k=0; k<points.size(); k+=5) {
+
+        grid.Remove(handles[k]);
+        alive[k] = false;
+
+    }
+
+    QCOMPARE(grid.Size(),size_t(120));
+
+    for(size_t k=0; k<points.size(); k++) {
+
+        size_t n = 0;
+
+        for(size_t l=0; l<points.size(); l++) {
+
+            if(alive[l] && fabs(points[l].Get(0)-points[k].Get(0))<=7 && fabs(points[l].Get(1)-points[k].Get(1))<=7)
+                n++;
+
+        }
+
+        QCOMPARE(grid.Count(points[k],7),n);
+
+    }
+
+    // freed slots are reused
+    vec2f y = { 3, 4 };
+    QVERIFY(grid.Insert(y)<points.size());
+
+    grid.Clear();
+
+    QCOMPARE(grid.Size(),size_t(0));
+    QCOMPARE(grid.Count(y,10),size_t(0));
+
+    // two existing points in the top-left cell which only block their neighborhood
+    vec2f e0 = { 1, 1 }, e1 = { 2, 2 };
+    grid.Insert(e0);
+    grid.Insert(e1);
+
+    vector<vec2f> candidates;
+    vector<float> responses;
+
+    for(size_t k=0; k<5; k++) {
+
+        vec2f x = { float(1 + 2*k), 8 };
+        candidates.push_back(x);
+        responses.push_back(float(k));
+
+    }
+
+    vector<size_t> accepted;
+    grid.Select(candidates,responses,1.5,10,2,accepted);
+
+    // the strongest two that are separated from each other, the quota ignores existing points
+    QCOMPARE(accepted.size(),size_t(2));
+    QCOMPARE(accepted[0],size_t(4));
+    QCOMPARE(accepted[1],size_t(3));
+    QCOMPARE(grid.Size(),size_t(4));
+
+    // existing and accepted points block candidates within the distance
+    vec2f z = { 9.5, 8.5 };
+    vector<vec2f> more(1,z);
+    grid.Select(more,vector<float>(),1.5,10,0,accepted);
+
+    QVERIFY(accepted.empty());
+
+}
+
+void CMotionTest::testFASTDetector() {
+
+    // blocky noise, the width leaves a remainder for the scalar loop and there are several bands
+    Mat img(75,157,CV_8UC1);
+
+    for(int i=0; i<img.rows; i++) {
+
+        for(int j=0; j<img.cols; j++)
+            img.at<uchar>(i,j) = (uchar)(127.5*(1 + sin(12.9898*(i/2) + 78.233*(j/3) + 0.001*i*j)));
+
+    }
+
+    for(size_t arc=9; arc<=12; arc+=3) {
+
+        for(int t=5; t<=40; t+=35) {
+
+            CFASTDetector detector(t,arc);
+            vector<vec2f> locations;
+            vector<float> responses;
+            detector.Detect(img,locations,responses);
+
+            // scores and non-maximum suppression in the same order
+            vector<int> scores(img.rows*img.cols,0);
+
+            for(int i=3; i<img.rows-3; i++) {
+
+                for(int j=3; j<img.cols-3; j++)
+                    scores[i*img.cols+j] = FASTScore(img,i,j,t,arc);
+
+            }
+
+            vector<vec2f> reflocations;
+            vector<float> refresponses;
+
+            for(int i=3; i<img.rows-3; i++) {
+
+                for(int j=3; j<img.cols-3; j++) {
+
+                    int s = scores[i*img.cols+j];
+                    bool maximum = s>0;
+
+                    for(int di=-1; di<=1; di++) {
+
+                        for(int dj=-1; dj<=1; dj++) {
+
+                            // ties go to the first pixel in row-major order
+                            int o = scores[(i+di)*img.cols+j+dj];
+                            bool before = di<0 || (di==0 && dj<0);
+
+                            if((di!=0 || dj!=0) && (before ? o>=s : o>s))
+                                maximum = false;
+
+                        }
+
+                    }
+
+                    if(maximum) {
+
+                        vec2f x = { float(j), float(i) };
+                        reflocations.push_back(x);
+                        refresponses.push_back(float(s));
+
+                    }
+
+                }
+
+            }
+
+            QVERIFY(reflocations.size()>0);
+            QCOMPARE(locations.size(),reflocations.size());
+
+            for(size_t k=0; k<locations.size(); k++) {
+
+                QCOMPARE(locations[k].Get(0),reflocations[k].Get(0));
+                QCOMPARE(locations[k].Get(1),reflocations[k].Get(1));
+                QCOMPARE(responses[k],refresponses[k]);
+
+            }
+
+            // all corners are kept per cell if there is no limit
+            vector<vec2f> clocations;
+            vector<float> cresponses;
+            detector.Detect(img,16,0,clocations,cresponses);
+
+            QCOMPARE(clocations.size(),locations.size());
+
+        }
+
+    }
+
+}
+
+void CMotionTest::testTrackletStore() {
+
+    CTrackletStore store(3);
+
+    vec2f x0 = { 10, 20 }, x1 = { 30, 40 }, x2 = { 50, 60 };
+    CTrackletId id0 = store.Add(0,imfeature(x0,0,0));
+    CTrackletId id1 = store.Add(1,imfeature(x1,1,0));
+    CTrackletId id2 = store.Add(2,imfeature(x2,0,0));
+
+    QCOMPARE(store.Capacity(),size_t(3));
+
+    // the history is a ring which drops the oldest states
+    for(size_t k=1; k<=3; k++) {
+
+        vec2f y = { float(30 + k), float(40 + k) };
+        store.Update(id1,imfeature(y,1,float(k)));
+
+    }
+
+    size_t k1 = store.GetIndex(id1);
+    QCOMPARE(store.GetLifetime(k1),size_t(3));
+    QCOMPARE(store.GetPastLocation(k1,0).Get(0),33.0f);
+    QCOMPARE(store.GetPastLocation(k1,2).Get(1),41.0f);
+    QCOMPARE(store.GetPastLocationAtNativeScale(k1,1).Get(0),64.0f);
+    QCOMPARE(store.GetQualities()[k1],3.0f);
+
+    // removal moves the last tracklet into the gap and invalidates the handle
+    QVERIFY(store.Remove(id0));
+    QVERIFY(!store.IsValid(id0));
+    QVERIFY(!store.Remove(id0));
+    QCOMPARE(store.GetIndex(id2),size_t(0));
+    QCOMPARE(store.GetLocations()[0].Get(0),50.0f);
+    QCOMPARE(store.GetCreationTimes()[0],size_t(2));
+
+    // the slot is recycled with a new generation
+    CTrackletId id3 = store.Add(3,imfeature(x0,0,0));
+    QCOMPARE(id3.index,id0.index);
+    QVERIFY(id3!=id0);
+    QVERIFY(!store.IsValid(id0));
+    QCOMPARE(store.GetLifetime(store.GetIndex(id3)),size_t(1));
+
+    CStoredTracklet stored(store,id2);
+    stored.SetStatus(false);
+    QCOMPARE(store.ActiveCapacity(),size_t(2));
+
+    store.DeleteInvalidTracks();
+    QVERIFY(!stored.IsValid());
+    QVERIFY(store.IsValid(id1) && store.IsValid(id3));
+
+    // run a tracker on the translated images, the tracklets write through to its store
+    CParameters params;
+    params.Set("FEATURE_THRESHOLD",20.0);
+    params.Set("TRACKING_HSIZE",7);
+    params.Set("LK_PYRAMID_LEVEL",2);
+    params.Set("MAX_ITER",30);
+    params.Set("ACCURACY",1e-6);
+    params.Set("LAMBDA",1e-4);
+    params.Set("BUFFER_LENGTH",5);
+    params.Set("MAX_HAMMING_DISTANCE",50);
+
+    CSimpleTracker tracker(&params);
+
+    vector<vec2f> initial;
+
+    for(int i=20; i<m_img0.rows-20; i+=10) {
+
+        for(int j=20; j<m_img0.cols-20; j+=10) {
+
+            vec2f x = { j + 0.3f, i + 0.6f };
+            initial.push_back(x);
+            tracker.AddTracklet(new CSimpleTrackerTracklet(0,imfeature(x,0,0),5));
+
+        }
+
+    }
+
+    vector<Mat> pyramid0, pyramid1;
+    CPyramidalLukasKanade::BuildPyramid(m_img0,1,pyramid0);
+    CPyramidalLukasKanade::BuildPyramid(m_img1,1,pyramid1);
+
+    tracker.Update(pyramid0,pyramid1);
+
+    const list<shared_ptr<mytracklet> >& data = tracker.GetData();
+    list<shared_ptr<mytracklet> >::const_iterator it;
+    size_t i = 0;
+
+    for(it=data.begin(); it!=data.end(); ++it, ++i) {
+
+        const shared_ptr<CStoredTracklet>& s = (*it)->GetStoredTracklet();
+
+        QVERIFY(s && s->GetStatus());
+        QCOMPARE(s->GetLifetime(),size_t(2));
+        QCOMPARE(s->GetLatestLocation().Get(0),(*it)->GetLatestLocation().Get(0));
+        QCOMPARE(s->GetLatestLocation().Get(1),(*it)->GetLatestLocation().Get(1));
+        QVERIFY(fabs(s->GetLatestLocation().Get(0)-initial[i].Get(0)-m_dx)<0.05);
+        QVERIFY(fabs(s->GetLatestLocation().Get(1)-initial[i].Get(1)-m_dy)<0.05);
+
+        // every other descriptor has drifted too far from the reference
+        if(i%2)
+            s->SetQuality(100);
+
+    }
+
+    tracker.Clean(pyramid0,pyramid1);
+
+    size_t nactive = (data.size() + 1)/2;
+    QCOMPARE(tracker.ActiveCapacity(),nactive);
+
+    vector<COccupancyGrid> grids(1);
+    grids[0].Resize(m_img0.cols,m_img0.rows,10);
+    QCOMPARE(tracker.ComputeFeatureDensity(grids)[0],nactive);
+    QCOMPARE(grids[0].Size(),nactive);
+
+    // deleted tracklets are unbound and keep their status
+    shared_ptr<mytracklet> dead = *(++data.begin());
+    tracker.DeleteInvalidTracks();
+
+    QCOMPARE(tracker.Capacity(),nactive);
+    QCOMPARE(tracker.GetStore().Capacity(),nactive);
+    QVERIFY(!dead->GetStoredTracklet());
+    QVERIFY(!dead->GetStatus());
+
+    for(it=data.begin(); it!=data.end(); ++it)
+        QVERIFY((*it)->GetStoredTracklet()->IsValid() && (*it)->GetStatus());
+
+}
+
+void CMotionTest::cleanup() {
+
+}
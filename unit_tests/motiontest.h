@@ -0,0 +1,77 @@
+/*////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2013, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////*/
+
+#ifndef MOTIONTEST_H
+#define MOTIONTEST_H
+
+#include <QtTest/QtTest>
+#include <opencv2/opencv.hpp>
+
+class CMotionTest:public QObject {
+
+  Q_OBJECT
+
+public:
+
+  explicit CMotionTest(QObject* parent = nullptr);
+
+private:
+
+    cv::Mat m_img0;                         //!< smooth test image
+    cv::Mat m_img1;                         //!< test image translated by #m_dx, #m_dy
+    float m_dx;                             //!< horizontal translation
+    float m_dy;                             //!< vertical translation
+
+private slots:
+
+  void init();
+
+  //! Tests the pyramidal Lucas-Kanade tracker against the ground truth and OpenCV.
+  void testPyramidalLukasKanade();
+
+  //! Tests bit-packed BRIEF descriptors against CBRIEF.
+  void testPackedBRIEF();
+
+  //! Tests integral orientation histograms against direct summation.
+  void testGradientCache();
+
+  //! Tests that sampled and integral HoG descriptors agree on axis-aligned cells.
+  void testIntegralHistogramOfGradients();
+
+  //! Tests batched patch warping against bilinear interpolation, also across the boundary.
+  void testPatchBuffer();
+
+  //! Tests counting, moving, and removing points in an occupancy grid, and greedy selection.
+  void testOccupancyGrid();
+
+  //! Tests the vectorized FAST detector against a scalar segment test.
+  void testFASTDetector();
+
+  //! Tests generational handles and histories in the tracklet store, and a tracker running on it.
+  void testTrackletStore();
+
+  void cleanup();
+
+};
+
+#endif // MOTIONTEST_H
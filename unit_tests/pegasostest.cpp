@@ -0,0 +1,146 @@
+/*////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2013, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////*/
+
+#include "pegasostest.h"
+#include "pegasos.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace R4R;
+using namespace std;
+
+CPegasosTest::CPegasosTest(QObject* parent):
+  QObject(parent),
+  m_features(8,2000),
+  m_labels(2000),
+  m_lambda(1e-2) {
+
+}
+
+void CPegasosTest::init() {
+
+    // labels by a fixed hyperplane through the origin
+    for(size_t i=0; i<m_features.NCols(); i++) {
+
+        double s = 0;
+
+        for(size_t j=0; j<m_features.NRows(); j++) {
+
+            m_features(j,i) = sin(double(13*i+7*j+1));
+            s += m_features.Get(j,i)*(double(j) - 3.5);
+
+        }
+
+        m_labels[i] = s>0 ? 1 : -1;
+
+    }
+
+}
+
+void CPegasosTest::testParallelPegasos() {
+
+    // the serial solver works on shallow copies of the features, so keep a separate set for evaluation
+    vector<vec> training, evaluation;
+
+    for(size_t i=0; i<m_features.NCols(); i++) {
+
+        vec x(m_features.NRows());
+
+        for(size_t j=0; j<m_features.NRows(); j++)
+            x(j) = m_features.Get(j,i);
+
+        training.push_back(x);
+        evaluation.push_back(x.Clone());
+
+    }
+
+    vec w0(m_features.NRows());
+    CPegasos<vec> serial(&training,&m_labels,w0,m_lambda,64,2000);
+    serial.Train(2000,true);
+
+    CParallelPegasos<double> parallel(m_features,m_labels,m_lambda,64);
+    parallel.Train(2000);
+
+    // same objective as the reference implementation
+    CPegasos<vec> reference(&evaluation,&m_labels,w0,m_lambda);
+    double res = parallel.CalcResidual();
+    QVERIFY(fabs(res-reference.CalcResidual(parallel.GetW(),parallel.GetBias()))<1e-10*res);
+
+    // both close to the minimum, the objective at zero is one
+    double ress = reference.CalcResidual(serial.GetW(),serial.GetBias());
+    QVERIFY(res<0.5);
+    QVERIFY(fabs(res-ress)<0.1*ress);
+
+    size_t correct = 0;
+
+    for(size_t i=0; i<m_features.NCols(); i++)
+        correct += (parallel.Classify(m_features.Data().get()+i*m_features.NRows())>0)==(m_labels[i]>0);
+
+    QVERIFY(correct>0.95*m_features.NCols());
+
+}
+
+void CPegasosTest::testSynchronousTraining() {
+
+    CParallelPegasos<double> first(m_features,m_labels,m_lambda,64,1);
+    first.Train(200);
+
+#ifdef _OPENMP
+    // more threads than random number generators
+    int nthreads = omp_get_max_threads();
+    omp_set_num_threads(2*nthreads+1);
+#endif
+
+    CParallelPegasos<double> second(m_features,m_labels,m_lambda,64,1);
+
+#ifdef _OPENMP
+    omp_set_num_threads(4*nthreads+3);
+#endif
+
+    second.Train(200);
+
+    CParallelPegasos<double> asynchronous(m_features,m_labels,m_lambda,64,1);
+    asynchronous.SetAsynchronous(true);
+    asynchronous.Train(200);
+
+#ifdef _OPENMP
+    omp_set_num_threads(nthreads);
+#endif
+
+    QVERIFY(asynchronous.CalcResidual()<asynchronous.GetResidual().front());
+
+    // with the same number of threads, results are reproducible
+    CParallelPegasos<double> third(m_features,m_labels,m_lambda,64,1);
+    third.Train(200);
+
+    QCOMPARE(third.GetBias(),first.GetBias());
+    QVERIFY((third.GetW()-first.GetW()).Norm2()==0);
+    QVERIFY(second.CalcResidual()<second.GetResidual().front());
+
+}
+
+void CPegasosTest::cleanup() {
+
+}
@@ -0,0 +1,60 @@
+/*////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2013, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////*/
+
+#ifndef PEGASOSTEST_H
+#define PEGASOSTEST_H
+
+#include <QtTest/QtTest>
+#include <vector>
+
+#include "darray.h"
+
+class CPegasosTest:public QObject {
+
+  Q_OBJECT
+
+public:
+
+  explicit CPegasosTest(QObject* parent = nullptr);
+
+private:
+
+    R4R::CDenseArray<double> m_features;        //!< linearly separable features as columns
+    std::vector<int> m_labels;                  //!< labels
+    double m_lambda;                            //!< regularization parameter
+
+private slots:
+
+  void init();
+
+  //! Tests the parallel solver against the serial one.
+  void testParallelPegasos();
+
+  //! Tests synchronous training for reproducibility, also when the number of threads changes.
+  void testSynchronousTraining();
+
+  void cleanup();
+
+};
+
+#endif // PEGASOSTEST_H
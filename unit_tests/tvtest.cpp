@@ -0,0 +1,131 @@
+/*////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2013, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////*/
+
+#include "tvtest.h"
+#include "tv.h"
+#include "iter.h"
+
+using namespace R4R;
+using namespace std;
+
+CTotalVariationTest::CTotalVariationTest(QObject* parent):
+  QObject(parent),
+  m_f(24,20),
+  m_mu(8),
+  m_tolerance(1e-4) {
+
+}
+
+void CTotalVariationTest::init() {
+
+    // two squares plus deterministic noise
+    for(size_t i=0; i<m_f.NRows(); i++) {
+
+        for(size_t j=0; j<m_f.NCols(); j++)
+            m_f(i,j) = ((i/8+j/8)%2) + 0.1*sin(double(7*i+13*j));
+
+    }
+
+}
+
+double CTotalVariationTest::Energy(const CDenseArray<double>& u, bool l1) const {
+
+    const size_t h = u.NRows(), w = u.NCols(), n = h*w;
+
+    CLinearOperator<double> D(make_shared<CGradientOperator<double> >(h,w));
+    vec uv(n);
+
+    for(size_t i=0; i<n; i++)
+        uv(i) = u.Data().get()[i];
+
+    vec g = D*uv;
+
+    double energy = 0;
+
+    for(size_t i=0; i<n; i++) {
+
+        double d = u.Data().get()[i] - m_f.Data().get()[i];
+        energy += sqrt(g.Get(i)*g.Get(i) + g.Get(n+i)*g.Get(n+i));
+        energy += l1 ? m_mu*fabs(d) : 0.5*m_mu*d*d;
+
+    }
+
+    return energy;
+
+}
+
+void CTotalVariationTest::testPrimalDualEnergy() {
+
+    for(size_t l=0; l<2; l++) {
+
+        FIDELITY fidelity = l ? FIDELITY::L1 : FIDELITY::L2;
+
+        CDenseArray<double> u = m_f.Clone();
+        CPrimalDualTV<double> solver(m_f,u,m_mu,fidelity,0);
+
+        // the energy of the initial guess is reported after the first iteration
+        double e0 = Energy(u,l);
+        solver.Iterate(1);
+
+        QVERIFY(fabs(solver.GetTotalError().front()-e0)<m_tolerance*e0);
+
+        // the primal-dual gap bounds the distance of the primal energy to the optimum
+        solver.Iterate(2000);
+
+        double e = Energy(u,l);
+        QVERIFY(e<=e0);
+        QVERIFY(solver.GetConstraintViolation().back()>=-m_tolerance);
+        QVERIFY(fabs(solver.GetTotalError().back()-e)<=solver.GetConstraintViolation().back()+m_tolerance*e);
+
+    }
+
+}
+
+void CTotalVariationTest::testPrimalDualVariants() {
+
+    CDenseArray<double> u = m_f.Clone();
+    CPrimalDualTV<double> solver(m_f,u,m_mu,FIDELITY::L2,1e-6);
+    solver.Iterate(20000);
+
+    CDenseArray<double> ua = m_f.Clone();
+    CPrimalDualTV<double> adaptive(m_f,ua,m_mu,FIDELITY::L2,1e-6);
+    adaptive.SetAdaptiveStepSizes(true);
+    adaptive.Iterate(100000);
+
+    CDenseArray<double> ur = m_f.Clone();
+    CPrimalDualTV<double> relaxed(m_f,ur,m_mu,FIDELITY::L2,1e-6);
+    relaxed.SetOverRelaxation(1.5);
+    relaxed.Iterate(20000);
+
+    // only the accelerated method closes the gap within the budget
+    QVERIFY(adaptive.GetConstraintViolation().back()<=1e-6);
+
+    // TV-L2 is strongly convex, so the minimizers agree
+    QVERIFY((u-ua).Norm2()<m_tolerance*u.Norm2());
+    QVERIFY((u-ur).Norm2()<m_tolerance*u.Norm2());
+
+}
+
+void CTotalVariationTest::cleanup() {
+
+}
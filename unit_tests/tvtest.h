@@ -0,0 +1,62 @@
+/*////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2013, Jonathan Balzer
+//
+// All rights reserved.
+//
+// This file is part of the R4R library.
+//
+// The R4R library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// The R4R library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the R4R library. If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////*/
+
+#ifndef TVTEST_H
+#define TVTEST_H
+
+#include <QtTest/QtTest>
+
+#include "darray.h"
+
+class CTotalVariationTest:public QObject {
+
+  Q_OBJECT
+
+public:
+
+  explicit CTotalVariationTest(QObject* parent = nullptr);
+
+private:
+
+    R4R::CDenseArray<double> m_f;               //!< noisy piecewise constant image
+    double m_mu;                                //!< weight of the data term
+    double m_tolerance;
+
+    //! Evaluates the TV-L2 or TV-L1 energy with the assembled gradient operator.
+    double Energy(const R4R::CDenseArray<double>& u, bool l1) const;
+
+private slots:
+
+  void init();
+
+  //! Tests the energy reported by the primal-dual method against the assembled functional.
+  void testPrimalDualEnergy();
+
+  //! Tests that relaxed and accelerated primal-dual iterations reach the same minimizer.
+  void testPrimalDualVariants();
+
+  void cleanup();
+
+};
+
+#endif // TVTEST_H
@@ -35,20 +35,53 @@ TEMPLATE = app
 HEADERS += camtest.h \
     rbuffertest.h \
     darraytest.h \
-    kernelstest.h
+    kernelstest.h \
+    itertest.h \
+    lmtest.h \
+    tvtest.h \
+    kfiltertest.h \
+    pegasostest.h \
+    ffttest.h \
+    imagetest.h \
+    motiontest.h
 
 SOURCES = main.cpp \
     camtest.cpp \
     rbuffertest.cpp \
     darraytest.cpp \
-    kernelstest.cpp
+    kernelstest.cpp \
+    itertest.cpp \
+    lmtest.cpp \
+    tvtest.cpp \
+    kfiltertest.cpp \
+    pegasostest.cpp \
+    ffttest.cpp \
+    imagetest.cpp \
+    motiontest.cpp
 
-INCLUDEPATH += $$PWD/../r4r_core
-DEPENDPATH += $$PWD/../r4r_core
+INCLUDEPATH += $$PWD/../r4r_core \
+               $$PWD/../r4r_motion
+
+DEPENDPATH += $$PWD/../r4r_core \
+              $$PWD/../r4r_motion
 
 unix:!symbian|win32 {
 
     LIBS += -L$$OUT_PWD/../r4r_core/ \
-            -lr4r_core
+            -L$$OUT_PWD/../r4r_motion/ \
+            -lr4r_core \
+            -lr4r_motion
+
+    # find OpenCV, the video module provides reference implementations
+    packagesExist(opencv) {
+
+        LIBS += -lopencv_core \
+            -lopencv_imgproc \
+            -lopencv_video
+
+    }
+    else {
+        error("Could not resolve mandatory dependency on OpenCV...")
+    }
 
 }